@@ -44,7 +44,13 @@ COMMAND_LINE_OPTIONS = (
      {'action': 'store_true',
       'dest': 'outputStaticMesh',
       'default': False,
-      'help': 'Forces it to output a static mesh and not a model with animation'}))
+      'help': 'Forces it to output a static mesh and not a model with animation'}),
+    (('-j', '--jobs'),
+     {'action': 'store',
+      'type': 'int',
+      'dest': 'jobs',
+      'default': 1,
+      'help': 'Number of filter manager runs (rig and animations) at a time, 0 for one per CPU'}))
 
 
 def main():
@@ -77,7 +83,8 @@ def main():
             static_mesh=options.outputStaticMesh,
             vision_model=options.outputVisionModel,
             interactive=options.interactive,
-            verbose=options.verbose)
+            verbose=options.verbose,
+            jobs=options.jobs)
 
     return success
 
@@ -0,0 +1,67 @@
+#! /usr/bin/python
+#
+# Confidential Information of Telekinesys Research Limited (t/a Havok). Not for
+# disclosure or distribution without Havok's prior written consent. This
+# software contains code, techniques and know-how which is confidential and
+# proprietary to Havok. Product and Trade Secret source code contains trade
+# secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research
+# Limited t/a Havok. All Rights Reserved. Use of this software is subject to
+# the terms of an end user license agreement.
+#
+
+"""
+packexportdata.py - Converts the per channel export_data text files
+(selectionsets/*.txt, floatchannels/*.txt) into one binary file per mesh
+(channels/<mesh>.bin) that FBXImporter maps without parsing.
+"""
+
+import sys
+
+from optparse import OptionParser
+
+import projectanarchy.exportdata
+
+COMMAND_LINE_OPTIONS = (
+    (('-m', '--mesh',),
+     {'action': 'append',
+      'dest': 'meshes',
+      'default': [],
+      'help': "Mesh name, used to split <mesh>_<channel>.txt when names contain underscores. Can be repeated."}),
+    (('-q', '--quiet',),
+     {'action': 'store_false',
+      'dest': 'verbose',
+      'default': True,
+      'help': "Don't print out status updates"}),)
+
+
+def main():
+    """
+    Converts the export_data folder passed in as an argument.
+    """
+
+    parser = OptionParser('%prog [options] export_data')
+    for options in COMMAND_LINE_OPTIONS:
+        parser.add_option(*options[0], **options[1])
+    (options, arguments) = parser.parse_args()
+
+    if len(arguments) != 1:
+        parser.print_help()
+        return False
+
+    try:
+        count = projectanarchy.exportdata.convert_text_to_binary(
+            arguments[0],
+            options.meshes,
+            options.verbose)
+    except (IOError, ValueError) as error:
+        print(error)
+        return False
+
+    if options.verbose:
+        print("Converted export data of %d mesh(es)" % count)
+
+    return True
+
+if __name__ == "__main__":
+    SUCCESS = main()
+    sys.exit(0 if SUCCESS else 1)
@@ -9,4 +9,4 @@
 # the terms of an end user license agreement.
 #
 
-__all__ = ["fbx", "hct", "utilities"]
\ No newline at end of file
+__all__ = ["exportdata", "fbx", "hct", "utilities"]
\ No newline at end of file
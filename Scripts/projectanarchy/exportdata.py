@@ -0,0 +1,183 @@
+#
+# Confidential Information of Telekinesys Research Limited (t/a Havok). Not for
+# disclosure or distribution without Havok's prior written consent. This
+# software contains code, techniques and know-how which is confidential and
+# proprietary to Havok. Product and Trade Secret source code contains trade
+# secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research
+# Limited t/a Havok. All Rights Reserved. Use of this software is subject to
+# the terms of an end user license agreement.
+#
+
+
+"""
+Reads and writes the mesh export data (vertex selection sets and float
+channels) that FBXImporter attaches to meshes as user channels.
+
+Text layout, one file per channel:
+    export_data/selectionsets/<mesh>_<channel>.txt
+    export_data/floatchannels/<mesh>_<channel>.txt
+
+Binary layout, one file per mesh holding all of its channels:
+    export_data/channels/<mesh>.bin
+
+The binary layout must match ExportDataBinaryHeader/ExportDataBinaryChannel
+in Source/ExportData.h.
+"""
+
+import os
+import struct
+
+MAGIC = 0x43584B48  # "HKXC"
+VERSION = 1
+
+KIND_SELECTION_SET = 0
+KIND_FLOAT_CHANNEL = 1
+
+DATATYPE_INT32 = 0
+DATATYPE_FLOAT32 = 1
+
+SELECTION_SETS_FOLDER = "selectionsets"
+FLOAT_CHANNELS_FOLDER = "floatchannels"
+BINARY_FOLDER = "channels"
+
+
+class Channel():
+    """
+    A single selection set (int vertex indices) or float channel (one float
+    per vertex plus its dimensions enum: 0 float, 1 distance, 2 angle)
+    """
+    def __init__(self, name, kind, values, float_dimensions=0):
+        self.name = name
+        self.kind = kind
+        self.values = values
+        self.float_dimensions = float_dimensions
+
+
+def _parse_values(filename, convert):
+    """
+    Parses whitespace separated values, skipping '#' comment lines and
+    'N:' labels the same way the importer does
+    """
+    values = []
+    with open(filename, 'rt') as text_file:
+        for line_number, line in enumerate(text_file):
+            if line.startswith('#'):
+                continue
+            for token in line.split():
+                if token.endswith(':'):
+                    continue
+                try:
+                    values.append(convert(token))
+                except ValueError:
+                    raise ValueError("%s:%d: Invalid number: %s" % (filename, line_number + 1, token))
+    return values
+
+
+def _split_channel_filename(filename, mesh_names):
+    """
+    Splits '<mesh>_<channel>.txt' into (mesh, channel). Known mesh names are
+    matched first (longest wins) since both parts may contain underscores,
+    otherwise the name is split at the first underscore.
+    """
+    base = os.path.splitext(filename)[0]
+    for mesh in sorted(mesh_names, key=len, reverse=True):
+        if base.startswith(mesh + "_"):
+            return (mesh, base[len(mesh) + 1:])
+
+    separator = base.find('_')
+    if separator <= 0:
+        return (None, None)
+    return (base[:separator], base[separator + 1:])
+
+
+def read_text_channels(export_data_path, mesh_names=()):
+    """
+    Returns a dictionary of mesh name to a list of channels, selection sets
+    first, read from the per channel text files
+    """
+    meshes = {}
+
+    folders = ((SELECTION_SETS_FOLDER, KIND_SELECTION_SET),
+               (FLOAT_CHANNELS_FOLDER, KIND_FLOAT_CHANNEL))
+
+    for (folder, kind) in folders:
+        path = os.path.join(export_data_path, folder)
+        if not os.path.isdir(path):
+            continue
+
+        for filename in sorted(os.listdir(path)):
+            if not filename.endswith(".txt"):
+                continue
+
+            (mesh, name) = _split_channel_filename(filename, mesh_names)
+            if mesh is None:
+                print("Skipping %s, expected <mesh>_<channel>.txt" % filename)
+                continue
+
+            full_path = os.path.join(path, filename)
+            if kind == KIND_SELECTION_SET:
+                channel = Channel(name, kind, _parse_values(full_path, int))
+            else:
+                values = _parse_values(full_path, float)
+                if not values:
+                    raise ValueError("%s: Missing float channel datatype" % full_path)
+                channel = Channel(name, kind, values[1:], int(values[0]))
+
+            meshes.setdefault(mesh, []).append(channel)
+
+    return meshes
+
+
+def _padded(data):
+    return data + b'\0' * (-len(data) % 4)
+
+
+def write_binary_channels(filename, mesh_name, channels):
+    """
+    Writes all channels of a mesh into a single binary sidecar file
+    """
+    mesh_name_bytes = mesh_name.encode('utf-8')
+
+    with open(filename, 'wb') as out:
+        out.write(struct.pack('<IIII', MAGIC, VERSION, len(channels), len(mesh_name_bytes)))
+        out.write(_padded(mesh_name_bytes))
+
+        for channel in channels:
+            name_bytes = channel.name.encode('utf-8')
+            if channel.kind == KIND_SELECTION_SET:
+                data_type = DATATYPE_INT32
+                payload = struct.pack('<%di' % len(channel.values), *channel.values)
+            else:
+                data_type = DATATYPE_FLOAT32
+                payload = struct.pack('<%df' % len(channel.values), *channel.values)
+
+            out.write(struct.pack('<BBBBIII', channel.kind, data_type,
+                                  channel.float_dimensions, 0,
+                                  len(name_bytes), len(channel.values), 0))
+            out.write(_padded(name_bytes))
+            out.write(payload)
+
+    return
+
+
+def convert_text_to_binary(export_data_path, mesh_names=(), verbose=True):
+    """
+    Converts every text channel file below export_data_path into one binary
+    file per mesh in export_data/channels. Returns the number of meshes written.
+    """
+    meshes = read_text_channels(export_data_path, mesh_names)
+
+    output_path = os.path.join(export_data_path, BINARY_FOLDER)
+    if meshes and not os.path.isdir(output_path):
+        os.makedirs(output_path)
+
+    for mesh in sorted(meshes):
+        # Selection sets come first, the importer adds user channels in that order
+        channels = sorted(meshes[mesh], key=lambda channel: channel.kind)
+        filename = os.path.join(output_path, mesh + ".bin")
+        write_binary_channels(filename, mesh, channels)
+
+        if verbose:
+            print("%s: %d channel(s)" % (filename, len(channels)))
+
+    return len(meshes)
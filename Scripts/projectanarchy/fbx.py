@@ -17,8 +17,18 @@ of that with Havok Content Tools filter manager. Given an FBX file it will:
 
 import sys
 import os
+import json
+import multiprocessing
+import tempfile
+import threading
+import time
 import traceback
 
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
 import utilities
 from hct import HCT
 
@@ -29,36 +39,131 @@ class HavokScene():
     a scene file that could describe an animation or mesh
     """
     def __init__(self, sceneFile, filter_set_file, asset_path,
-                 output_path, scene_length, is_root):
+                 output_path, scene_length, is_root, target_filename=""):
         self.sceneFile = sceneFile
         self.filter_set_file = filter_set_file
         self.asset_path = asset_path
         self.output_path = output_path
         self.scene_length = scene_length
         self.is_root = is_root
+        self.target_filename = target_filename
+
+        return
+
+
+class FilterManagerPool():
+    """
+    Runs the standalone filter manager on scenes on a number of worker
+    threads. The runs are independent processes working on different
+    tag file / filter set pairs. The output of each run is saved next to
+    its tag file (scene.log) and printed as one block when the run has
+    finished, so concurrent runs don't interleave.
+    """
+    def __init__(self, jobs, interactive, log):
+        self.havok_content_tools = HCT()
+        self.interactive = interactive
+        self.log = log
+        self.scenes = queue.Queue()
+        self.lock = threading.Lock()
+        self.failed_scenes = []
+
+        # The interactive filter manager needs the user, one at a time
+        if interactive or jobs < 1:
+            jobs = 1
+
+        self.workers = []
+        for _ in range(jobs):
+            worker = threading.Thread(target=self._work)
+            worker.daemon = True
+            worker.start()
+            self.workers.append(worker)
 
         return
 
+    def submit(self, havokScene):
+        self.scenes.put(havokScene)
+
+    def wait(self):
+        """
+        Waits for all submitted scenes and returns True if every run succeeded
+        """
+        for _ in self.workers:
+            self.scenes.put(None)
+        for worker in self.workers:
+            worker.join()
+
+        if self.failed_scenes:
+            self.log("Filter manager failed on %d scene(s):" % len(self.failed_scenes))
+            for sceneFile in self.failed_scenes:
+                self.log("    %s" % sceneFile)
+
+        return not self.failed_scenes
+
+    def _work(self):
+        while True:
+            havokScene = self.scenes.get()
+            if havokScene is None:
+                break
+            self._run(havokScene)
+
+    def _run(self, havokScene):
+        try:
+            (return_code, output) = self.havok_content_tools.run(
+                havokScene.sceneFile,
+                havokScene.filter_set_file,
+                havokScene.asset_path,
+                havokScene.output_path,
+                self.interactive)
+        except:
+            return_code = -1
+            output = traceback.format_exc()
+
+        (scene_path, _) = os.path.splitext(havokScene.sceneFile)
+        try:
+            with open(scene_path + ".log", 'wt') as out:
+                out.write(output)
+        except IOError:
+            pass
+
+        with self.lock:
+            self.log("Tag file: %s" % os.path.basename(havokScene.sceneFile))
+            self.log("Filter set: %s" % os.path.basename(havokScene.filter_set_file))
+            self.log("Target name: %s" % havokScene.target_filename)
+            if return_code != 0:
+                self.log("Filter manager failed (exit code %d), see %s.log" % (return_code, os.path.basename(scene_path)))
+                self.failed_scenes.append(havokScene.sceneFile)
+            self.log(utilities.line(True))
+
+
+def _read_manifest(manifest_file):
+    """
+    Returns the contents of the importer's JSON manifest, or None if it
+    hasn't been written yet. The importer replaces the file atomically so
+    it is never read half written.
+    """
+    try:
+        with open(manifest_file, 'rt') as manifest:
+            return json.load(manifest)
+    except (IOError, OSError, ValueError):
+        return None
+
+
 
 def convert(fbx_file,
             static_mesh=False,
             vision_model=False,
             interactive=False,
-            verbose=True):
+            verbose=True,
+            jobs=1):
     """
     Takes as input an FBX file and converts it to files that can be
-    used by either Vision or Animation Studio.
+    used by either Vision or Animation Studio. The filter manager runs
+    on up to 'jobs' scenes at a time (0 for one per CPU), each starting
+    as soon as the importer has saved its tag file.
     """
 
     success = False
 
-    # These are the labels that are spit out by the FBX Importer that
-    # we use to parse out the relevant information about the export
-    labelAnimationStacks = "Animation stacks:"
-    labelTagFile = "Saved tag file:"
-    labelSceneLength = "Scene length:"
-    labelBones = "Bones:"
-
     def log(message):
         """ Only print a message if we're in verbose mode """
         if verbose:
@@ -97,111 +202,103 @@ def convert(fbx_file,
 
         inputDirectory = os.path.dirname(inputFile)
 
-        log("Converting FBX to Havok Scene Format...")
-        fbxImporterOutput = utilities.run([fbxImporter, inputFile], verbose)
+        if jobs < 1:
+            jobs = multiprocessing.cpu_count()
 
-        parseIndex = fbxImporterOutput.find(labelTagFile)
-        if parseIndex == -1:
-            log("Conversion to FBX failed!")
-            log(utilities.line())
-            print(fbxImporterOutput)
-            return False
+        # The importer lists every scene in the manifest as soon as its tag file is saved
+        (manifestHandle, manifestFile) = tempfile.mkstemp(suffix=".json")
+        os.close(manifestHandle)
+        os.remove(manifestFile)
 
-        animationStacks = int(utilities.parse_text(
-            fbxImporterOutput,
-            labelAnimationStacks))
-        
-        numBones = int(utilities.parse_text(
-            fbxImporterOutput,
-            labelBones))
+        log("Converting FBX to Havok Scene Format...")
+        fbxImporterProcess = utilities.Process([fbxImporter, inputFile, "--manifest", manifestFile], verbose)
+
+        # Instantiate the Havok Content Tools class so that we can start
+        # using it to convert over the scene files as they are exported
+        filterManagerPool = FilterManagerPool(jobs, interactive, log)
 
         havokScenes = []
-        isRootNode = True
-        isAnimationExport = (animationStacks > 0) and (numBones > 0) and (not static_mesh)
-
-        # Parse the output of the FBXImporter
-        while parseIndex >= 0:
-            sceneFile = utilities.parse_text(fbxImporterOutput, labelTagFile, parseIndex)
-            sceneFile = os.path.join(inputDirectory, sceneFile)
-
-            (input_file_path, _) = os.path.splitext(sceneFile)
-            target_filename = os.path.basename(input_file_path)
-
-            if isRootNode:
-                rootName = target_filename
-            else:
-                animName = target_filename[len(rootName) + 1:]
-
-            if vision_model:
-                configFile = os.path.join(configPath, "VisionModel.hko")
-                target_filename = "%s.model" % (rootName)
-            elif isRootNode and isAnimationExport:
-                configFile = os.path.join(configPath, "AnimationRig.hko")
-                target_filename = "%s__out_rig.hkx" % (rootName)
-            elif isAnimationExport:
-                configFile = os.path.join(configPath, "Animation.hko")
-                target_filename = "%s__out_anim_%s.hkx" % (rootName, animName)
-            else:
-                configFile = os.path.join(configPath, "VisionStaticMesh.hko")
-                target_filename = "%s.vmesh" % (rootName)
-
-            configFile = os.path.abspath(os.path.join(
-                currentDirectory,
-                configFile))
-            outputConfigFile = os.path.abspath(input_file_path + ".hko")
-
-            with open(outputConfigFile, 'wt') as out:
-                for line in open(configFile):
-                    out.write(line.replace('$(output)', target_filename))
-
-            sceneLength = float(utilities.parse_text(
-                fbxImporterOutput,
-                labelSceneLength,
-                parseIndex))
-            
-            havokScene = HavokScene(sceneFile=sceneFile,
-                                    filter_set_file=outputConfigFile,
-                                    asset_path=inputDirectory,
-                                    output_path=inputDirectory,
-                                    scene_length=sceneLength,
-                                    is_root=isRootNode)
-
-            # We accumulate all scenes before actually exporting them
-            havokScenes.append(havokScene)
-
-            # We can break out of the loop early if this is just
-            # a static mesh export
-            if isRootNode and ((not isAnimationExport) or vision_model):
+        rootName = ""
+        allScenesSubmitted = False
+        manifest = None
+
+        while True:
+            importerRunning = fbxImporterProcess.is_running()
+
+            manifest = _read_manifest(manifestFile)
+            manifestScenes = manifest["scenes"] if manifest else []
+
+            while (not allScenesSubmitted) and len(havokScenes) < len(manifestScenes):
+                manifestScene = manifestScenes[len(havokScenes)]
+                isRootNode = (len(havokScenes) == 0)
+                isAnimationExport = (manifest["animationStacks"] > 0) and (manifest["bones"] > 0) and (not static_mesh)
+
+                sceneFile = os.path.join(inputDirectory, manifestScene["file"])
+
+                (input_file_path, _) = os.path.splitext(sceneFile)
+                target_filename = os.path.basename(input_file_path)
+
+                if isRootNode:
+                    rootName = target_filename
+                else:
+                    animName = target_filename[len(rootName) + 1:]
+
+                if vision_model:
+                    configFile = os.path.join(configPath, "VisionModel.hko")
+                    target_filename = "%s.model" % (rootName)
+                elif isRootNode and isAnimationExport:
+                    configFile = os.path.join(configPath, "AnimationRig.hko")
+                    target_filename = "%s__out_rig.hkx" % (rootName)
+                elif isAnimationExport:
+                    configFile = os.path.join(configPath, "Animation.hko")
+                    target_filename = "%s__out_anim_%s.hkx" % (rootName, animName)
+                else:
+                    configFile = os.path.join(configPath, "VisionStaticMesh.hko")
+                    target_filename = "%s.vmesh" % (rootName)
+
+                configFile = os.path.abspath(os.path.join(
+                    currentDirectory,
+                    configFile))
+                outputConfigFile = os.path.abspath(input_file_path + ".hko")
+
+                with open(outputConfigFile, 'wt') as out:
+                    for line in open(configFile):
+                        out.write(line.replace('$(output)', target_filename))
+
+                havokScene = HavokScene(sceneFile=sceneFile,
+                                        filter_set_file=outputConfigFile,
+                                        asset_path=inputDirectory,
+                                        output_path=inputDirectory,
+                                        scene_length=float(manifestScene["length"]),
+                                        is_root=isRootNode,
+                                        target_filename=target_filename)
+
+                havokScenes.append(havokScene)
+                filterManagerPool.submit(havokScene)
+
+                # A static mesh export only needs the root scene
+                if isRootNode and ((not isAnimationExport) or vision_model):
+                    allScenesSubmitted = True
+
+            if not importerRunning:
                 break
-            else:
-                isRootNode = False
 
-            # Get the next file that was exported
-            parseIndex = fbxImporterOutput.find(labelTagFile,
-                                                   parseIndex + 1)
+            time.sleep(0.1)
 
-        log(utilities.line())
-        log("Generating Vision / Animation Studio files")
-        log(utilities.line())
+        fbxImporterProcess.wait()
 
-        # Instantiate the Havok Content Tools class so that we can start
-        # using it to convert over the scene files we've just exported
-        havokContentTools = HCT()
-
-        # Now go through each scene and run the standalone filter manager on each one
-        for havokScene in havokScenes:
-            log("Tag file: %s" % os.path.basename(havokScene.sceneFile))
-            log("Filter set: %s" % os.path.basename(outputConfigFile))
-            log("Target name: %s" % target_filename)
-            log(utilities.line(True))
-
-            havokContentTools.run(havokScene.sceneFile,
-                                    havokScene.filter_set_file,
-                                    havokScene.asset_path,
-                                    havokScene.output_path,
-                                    interactive)
-
-        success = True
+        if os.path.exists(manifestFile):
+            os.remove(manifestFile)
+
+        filterManagerSucceeded = filterManagerPool.wait()
+
+        if (not manifest) or (manifest["status"] not in ("succeeded", "cached")) or (not havokScenes):
+            log("Conversion to FBX failed!")
+            log(utilities.line())
+            print(fbxImporterProcess.output)
+            return False
+
+        success = filterManagerSucceeded
     except IOError as error:
         print("I/O error({0}): {1}".format(error[0], error[1]))
         traceback.print_exc(file=sys.stdout)
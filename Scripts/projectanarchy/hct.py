@@ -80,6 +80,10 @@ class HCT():
     def run(self, filename, filter_set,
             asset_path, output_path,
             interactive=False, verbose=False):
+        """
+        Runs the filter set on the file and returns the exit code and
+        output of the filter manager
+        """
         arguments = [
            "-p", asset_path + "\\",
            "-o", output_path + "\\",
@@ -100,9 +104,7 @@ class HCT():
 
         # It's important that the current directory is set to the output path
         # or it won't output to the expected directory
-        utilities.run(command, False, output_path)
-
-        return
+        return utilities.run_process(command, False, output_path)
 
 class PreviewTool():
     def __init__(self):
@@ -11,6 +11,7 @@
 import subprocess
 import sys
 import os
+import threading
 
 import msvcrt as m
 
@@ -55,40 +56,64 @@ def parse_text(source, label, parse_index=0):
     end = source.find("\n", index)
     return source[index + len(label) + 1 : end]
 
-def run(arguments, verbose=False, current_directory=""):
-    if current_directory == "":
-        current_directory = os.path.dirname(arguments[0])
+class Process():
+    """
+    Runs a command in the background, collecting (and optionally echoing)
+    its output on a separate thread until it exits
+    """
+    def __init__(self, arguments, verbose=False, current_directory=""):
+        if current_directory == "":
+            current_directory = os.path.dirname(arguments[0])
 
-    disable_capture = False
-    
-    if disable_capture:
-        child = subprocess.Popen(arguments, cwd=current_directory)
-    else:
-        child = subprocess.Popen(arguments, shell=True, stdout=subprocess.PIPE, cwd=current_directory)
+        self.verbose = verbose
+        self.output = ""
+        self.child = subprocess.Popen(arguments, shell=True, stdout=subprocess.PIPE, cwd=current_directory)
 
-    output = ""
+        self.reader = threading.Thread(target=self._read)
+        self.reader.daemon = True
+        self.reader.start()
 
-    if disable_capture:
-        child.communicate()
-    else:
+        return
+
+    def _read(self):
         while True:
             try:
-                output_character = child.stdout.read(1)
+                output_character = self.child.stdout.read(1)
 
                 # handle the Python 3.0 case where it's returned as a series of bytes
                 if isinstance(output_character, bytes):
                     output_character = output_character.decode("utf-8")
 
-                if output_character == '' and child.poll() != None:
+                if output_character == '' and self.child.poll() != None:
                     break
 
-                if verbose:
+                if self.verbose:
                     sys.stdout.write(output_character)
                     sys.stdout.flush()
 
-                output += output_character
+                self.output += output_character
             except:
                 # just catch everything and break out of the loop
                 break
 
-    return output
\ No newline at end of file
+    def is_running(self):
+        return self.child.poll() == None
+
+    def wait(self):
+        """
+        Waits for the command to exit and returns its exit code
+        """
+        self.reader.join()
+        return self.child.wait()
+
+def run_process(arguments, verbose=False, current_directory=""):
+    """
+    Runs the command and returns its exit code and output
+    """
+    process = Process(arguments, verbose, current_directory)
+    return_code = process.wait()
+    return (return_code, process.output)
+
+def run(arguments, verbose=False, current_directory=""):
+    (_, output) = run_process(arguments, verbose, current_directory)
+    return output
@@ -0,0 +1,529 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "ConversionBenchmark.h"
+#include "FbxToHkxConverter.h"
+#include "ConversionCache.h"
+#include "ConversionProfiler.h"
+#include "FileUtil.h"
+#include "JsonUtil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+	// Rows and columns of a grid mesh, two triangles per quad, roughly square
+	void getGridSize(int numTriangles, int& rowsOut, int& columnsOut)
+	{
+		const int numQuads = std::max(1, (numTriangles + 1) / 2);
+		columnsOut = std::max(1, (int)sqrt((double)numQuads));
+		rowsOut = (numQuads + columnsOut - 1) / columnsOut;
+	}
+
+	FbxNode* createGridMesh(FbxScene* scene, const ConversionBenchmark::Case& benchmarkCase, hkArray<FbxNode*>& bones)
+	{
+		int rows, columns;
+		getGridSize(benchmarkCase.m_numTriangles, rows, columns);
+
+		FbxMesh* mesh = FbxMesh::Create(scene, "gridShape");
+		mesh->InitControlPoints((rows + 1) * (columns + 1));
+		FbxVector4* controlPoints = mesh->GetControlPoints();
+
+		FbxGeometryElementNormal* normals = mesh->CreateElementNormal();
+		normals->SetMappingMode(FbxGeometryElement::eByControlPoint);
+		normals->SetReferenceMode(FbxGeometryElement::eDirect);
+
+		hkArray<FbxGeometryElementUV*> uvSets;
+		for (int uvSetIndex = 0; uvSetIndex < benchmarkCase.m_numUvSets; uvSetIndex++)
+		{
+			FbxString uvSetName("uv");
+			uvSetName += uvSetIndex;
+
+			FbxGeometryElementUV* uvSet = mesh->CreateElementUV(uvSetName);
+			uvSet->SetMappingMode(FbxGeometryElement::eByControlPoint);
+			uvSet->SetReferenceMode(FbxGeometryElement::eDirect);
+			uvSets.pushBack(uvSet);
+		}
+
+		// The grid stands along Y, so bones stacked along Y can skin it row by row
+		for (int row = 0; row <= rows; row++)
+		{
+			for (int column = 0; column <= columns; column++)
+			{
+				const double u = (double)column / columns;
+				const double v = (double)row / rows;
+				controlPoints[row * (columns + 1) + column].Set(u, v * std::max(1, benchmarkCase.m_numBones), 0.0);
+				normals->GetDirectArray().Add(FbxVector4(0.0, 0.0, 1.0));
+				for (int uvSetIndex = 0; uvSetIndex < uvSets.getSize(); uvSetIndex++)
+				{
+					uvSets[uvSetIndex]->GetDirectArray().Add(FbxVector2(u * (uvSetIndex + 1), v));
+				}
+			}
+		}
+
+		FbxGeometryElementMaterial* materials = mesh->CreateElementMaterial();
+		materials->SetMappingMode(FbxGeometryElement::eAllSame);
+		materials->SetReferenceMode(FbxGeometryElement::eIndexToDirect);
+		materials->GetIndexArray().Add(0);
+
+		// Triangles directly, so the count is exact and the FBX SDK triangulation is not part of the measurement
+		int numTriangles = 0;
+		for (int row = 0; row < rows && numTriangles < benchmarkCase.m_numTriangles; row++)
+		{
+			for (int column = 0; column < columns && numTriangles < benchmarkCase.m_numTriangles; column++)
+			{
+				const int corner = row * (columns + 1) + column;
+				const int quad[4] = { corner, corner + 1, corner + columns + 2, corner + columns + 1 };
+
+				mesh->BeginPolygon(0);
+				mesh->AddPolygon(quad[0]);
+				mesh->AddPolygon(quad[1]);
+				mesh->AddPolygon(quad[2]);
+				mesh->EndPolygon();
+				numTriangles++;
+
+				if (numTriangles < benchmarkCase.m_numTriangles)
+				{
+					mesh->BeginPolygon(0);
+					mesh->AddPolygon(quad[0]);
+					mesh->AddPolygon(quad[2]);
+					mesh->AddPolygon(quad[3]);
+					mesh->EndPolygon();
+					numTriangles++;
+				}
+			}
+		}
+
+		FbxNode* meshNode = FbxNode::Create(scene, "grid");
+		meshNode->SetNodeAttribute(mesh);
+		meshNode->AddMaterial(FbxSurfacePhong::Create(scene, "gridMaterial"));
+		scene->GetRootNode()->AddChild(meshNode);
+
+		if (bones.getSize() > 0)
+		{
+			// Each row is weighted between the two bones nearest to it
+			FbxSkin* skin = FbxSkin::Create(scene, "gridSkin");
+			hkArray<FbxCluster*> clusters;
+			for (int boneIndex = 0; boneIndex < bones.getSize(); boneIndex++)
+			{
+				FbxCluster* cluster = FbxCluster::Create(scene, "");
+				cluster->SetLink(bones[boneIndex]);
+				cluster->SetLinkMode(FbxCluster::eNormalize);
+				cluster->SetTransformMatrix(meshNode->EvaluateGlobalTransform());
+				cluster->SetTransformLinkMatrix(bones[boneIndex]->EvaluateGlobalTransform());
+				clusters.pushBack(cluster);
+			}
+
+			for (int row = 0; row <= rows; row++)
+			{
+				const double bonePosition = (double)row / rows * (bones.getSize() - 1);
+				const int firstBone = std::min((int)bonePosition, bones.getSize() - 1);
+				const int secondBone = std::min(firstBone + 1, bones.getSize() - 1);
+				const double secondWeight = bonePosition - firstBone;
+
+				for (int column = 0; column <= columns; column++)
+				{
+					const int controlPoint = row * (columns + 1) + column;
+					clusters[firstBone]->AddControlPointIndex(controlPoint, 1.0 - secondWeight);
+					if (secondBone != firstBone && secondWeight > 0.0)
+					{
+						clusters[secondBone]->AddControlPointIndex(controlPoint, secondWeight);
+					}
+				}
+			}
+
+			for (int clusterIndex = 0; clusterIndex < clusters.getSize(); clusterIndex++)
+			{
+				skin->AddCluster(clusters[clusterIndex]);
+			}
+			mesh->AddDeformer(skin);
+		}
+
+		return meshNode;
+	}
+
+	// A chain of bones along Y, like a spine or a tail
+	void createSkeleton(FbxScene* scene, int numBones, hkArray<FbxNode*>& bonesOut)
+	{
+		FbxNode* parent = scene->GetRootNode();
+		for (int boneIndex = 0; boneIndex < numBones; boneIndex++)
+		{
+			FbxString boneName("bone");
+			boneName += boneIndex;
+
+			FbxSkeleton* skeleton = FbxSkeleton::Create(scene, boneName);
+			skeleton->SetSkeletonType(boneIndex == 0 ? FbxSkeleton::eRoot : FbxSkeleton::eLimbNode);
+
+			FbxNode* bone = FbxNode::Create(scene, boneName);
+			bone->SetNodeAttribute(skeleton);
+			bone->LclTranslation.Set(FbxDouble3(0.0, boneIndex == 0 ? 0.0 : 1.0, 0.0));
+			parent->AddChild(bone);
+
+			bonesOut.pushBack(bone);
+			parent = bone;
+		}
+	}
+
+	// Null nodes with one attribute group of animatable float attributes each
+	void createAttributeNodes(FbxScene* scene, const ConversionBenchmark::Case& benchmarkCase, std::vector<FbxProperty>& attributesOut)
+	{
+		for (int nodeIndex = 0; nodeIndex < benchmarkCase.m_numNodes; nodeIndex++)
+		{
+			FbxString nodeName("attributes");
+			nodeName += nodeIndex;
+
+			FbxNode* node = FbxNode::Create(scene, nodeName);
+			node->SetNodeAttribute(FbxNull::Create(scene, nodeName));
+			scene->GetRootNode()->AddChild(node);
+
+			// Attributes following an 'hkType' string property are exported as a group of that type
+			FbxProperty group = FbxProperty::Create(node, FbxStringDT, "hkTypeBenchmark");
+			group.Set(FbxString("hkBenchmarkAttributes"));
+
+			for (int attributeIndex = 0; attributeIndex < benchmarkCase.m_numAttributes; attributeIndex++)
+			{
+				FbxString attributeName("value");
+				attributeName += attributeIndex;
+
+				FbxProperty attribute = FbxProperty::Create(node, FbxFloatDT, attributeName);
+				attribute.ModifyFlag(FbxPropertyFlags::eUserDefined, true);
+				attribute.ModifyFlag(FbxPropertyFlags::eAnimatable, true);
+				attribute.Set(0.0f);
+				attributesOut.push_back(attribute);
+			}
+		}
+	}
+
+	void addSineKeys(FbxAnimCurve* curve, int numFrames, double amplitude, double phase)
+	{
+		curve->KeyModifyBegin();
+		for (int frame = 0; frame <= numFrames; frame++)
+		{
+			FbxTime time;
+			time.SetFrame(frame, FbxTime::eFrames30);
+
+			const int keyIndex = curve->KeyAdd(time);
+			curve->KeySetValue(keyIndex, (float)(amplitude * sin(frame * 0.1 + phase)));
+			curve->KeySetInterpolation(keyIndex, FbxAnimCurveDef::eInterpolationCubic);
+		}
+		curve->KeyModifyEnd();
+	}
+
+	FbxScene* createScene(FbxManager* manager, const ConversionBenchmark::Case& benchmarkCase)
+	{
+		FbxScene* scene = FbxScene::Create(manager, benchmarkCase.m_name.c_str());
+		scene->GetGlobalSettings().SetTimeMode(FbxTime::eFrames30);
+
+		hkArray<FbxNode*> bones;
+		createSkeleton(scene, benchmarkCase.m_numBones, bones);
+
+		FbxNode* meshNode = HK_NULL;
+		if (benchmarkCase.m_numTriangles > 0)
+		{
+			meshNode = createGridMesh(scene, benchmarkCase, bones);
+		}
+
+		std::vector<FbxProperty> attributes;
+		createAttributeNodes(scene, benchmarkCase, attributes);
+
+		if (bones.getSize() > 0)
+		{
+			FbxPose* bindPose = FbxPose::Create(scene, "bindPose");
+			bindPose->SetIsBindPose(true);
+			for (int boneIndex = 0; boneIndex < bones.getSize(); boneIndex++)
+			{
+				bindPose->Add(bones[boneIndex], FbxMatrix(bones[boneIndex]->EvaluateGlobalTransform()));
+			}
+			if (meshNode)
+			{
+				bindPose->Add(meshNode, FbxMatrix(meshNode->EvaluateGlobalTransform()));
+			}
+			scene->AddPose(bindPose);
+		}
+
+		for (int stackIndex = 0; stackIndex < benchmarkCase.m_numStacks; stackIndex++)
+		{
+			FbxString stackName("take");
+			stackName += stackIndex;
+
+			FbxAnimStack* stack = FbxAnimStack::Create(scene, stackName);
+			FbxAnimLayer* layer = FbxAnimLayer::Create(scene, "baseLayer");
+			stack->AddMember(layer);
+
+			FbxTime stop;
+			stop.SetFrame(benchmarkCase.m_numFrames, FbxTime::eFrames30);
+			stack->SetLocalTimeSpan(FbxTimeSpan(FbxTime(0), stop));
+
+			for (int boneIndex = 0; boneIndex < bones.getSize(); boneIndex++)
+			{
+				FbxNode* bone = bones[boneIndex];
+				const double phase = boneIndex * 0.3 + stackIndex;
+				addSineKeys(bone->LclRotation.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_X, true), benchmarkCase.m_numFrames, 20.0, phase);
+				addSineKeys(bone->LclRotation.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_Z, true), benchmarkCase.m_numFrames, 10.0, phase + 1.0);
+				addSineKeys(bone->LclTranslation.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_Y, true), benchmarkCase.m_numFrames, 0.1, phase);
+			}
+
+			for (int attributeIndex = 0; attributeIndex < (int)attributes.size(); attributeIndex++)
+			{
+				addSineKeys(attributes[attributeIndex].GetCurve(layer, true), benchmarkCase.m_numFrames, 1.0, attributeIndex * 0.1);
+			}
+		}
+
+		return scene;
+	}
+
+	int getInt(const std::map<std::string, std::string>& values, const char* key)
+	{
+		std::map<std::string, std::string>::const_iterator it = values.find(key);
+		return it != values.end() ? atoi(it->second.c_str()) : 0;
+	}
+
+	double getDouble(const std::map<std::string, std::string>& values, const char* key)
+	{
+		std::map<std::string, std::string>::const_iterator it = values.find(key);
+		return it != values.end() ? atof(it->second.c_str()) : 0.0;
+	}
+}
+
+ConversionBenchmark::Case::Case() :
+	m_numTriangles(0), m_numUvSets(0), m_numBones(0), m_numStacks(0), m_numFrames(0), m_numNodes(0), m_numAttributes(0),
+	m_seconds(0.0), m_trianglesPerSecond(0.0), m_boneFramesPerSecond(0.0), m_baselineSeconds(0.0)
+{
+}
+
+ConversionBenchmark::ConversionBenchmark(int numRuns, double tolerance) :
+	m_numRuns(std::max(1, numRuns)), m_tolerance(tolerance)
+{
+}
+
+// The baseline is written by writeResults(), one case object per line
+bool ConversionBenchmark::loadBaseline(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		return false;
+	}
+
+	m_cases.clear();
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const size_t first = line.find_first_not_of(" \t\r");
+		const size_t last = line.find_last_not_of(" \t\r,");
+		if (first == std::string::npos || line.compare(first, 8, "{\"name\":") != 0)
+		{
+			continue;
+		}
+
+		std::map<std::string, std::string> values;
+		std::string error;
+		if (!parseJsonObject(line.substr(first, last - first + 1).c_str(), values, &error))
+		{
+			printf("Cannot parse benchmark case in %s: %s\n", filename, error.c_str());
+			continue;
+		}
+
+		Case benchmarkCase;
+		benchmarkCase.m_name = values["name"];
+		benchmarkCase.m_numTriangles = getInt(values, "triangles");
+		benchmarkCase.m_numUvSets = getInt(values, "uvSets");
+		benchmarkCase.m_numBones = getInt(values, "bones");
+		benchmarkCase.m_numStacks = getInt(values, "stacks");
+		benchmarkCase.m_numFrames = getInt(values, "frames");
+		benchmarkCase.m_numNodes = getInt(values, "nodes");
+		benchmarkCase.m_numAttributes = getInt(values, "attributes");
+		benchmarkCase.m_baselineSeconds = getDouble(values, "seconds");
+		m_cases.push_back(benchmarkCase);
+	}
+
+	return !m_cases.empty();
+}
+
+void ConversionBenchmark::useDefaultCases()
+{
+	m_cases.clear();
+
+	// name, triangles, UV sets, bones, stacks, frames, nodes, attributes
+	const struct { const char* m_name; int m_values[7]; } defaults[] =
+	{
+		{ "staticMesh", { 200000, 2, 0, 0, 0, 0, 0 } },
+		{ "skinnedMesh", { 50000, 1, 64, 1, 60, 0, 0 } },
+		{ "animation", { 0, 0, 100, 4, 300, 0, 0 } },
+		{ "attributes", { 0, 0, 1, 1, 300, 50, 8 } }
+	};
+
+	for (int caseIndex = 0; caseIndex < (int)HK_COUNT_OF(defaults); caseIndex++)
+	{
+		Case benchmarkCase;
+		benchmarkCase.m_name = defaults[caseIndex].m_name;
+		benchmarkCase.m_numTriangles = defaults[caseIndex].m_values[0];
+		benchmarkCase.m_numUvSets = defaults[caseIndex].m_values[1];
+		benchmarkCase.m_numBones = defaults[caseIndex].m_values[2];
+		benchmarkCase.m_numStacks = defaults[caseIndex].m_values[3];
+		benchmarkCase.m_numFrames = defaults[caseIndex].m_values[4];
+		benchmarkCase.m_numNodes = defaults[caseIndex].m_values[5];
+		benchmarkCase.m_numAttributes = defaults[caseIndex].m_values[6];
+		m_cases.push_back(benchmarkCase);
+	}
+}
+
+bool ConversionBenchmark::run(const char* outputFolder, ConversionProfiler* profiler)
+{
+	createDirectories(outputFolder);
+
+	bool success = true;
+	for (size_t caseIndex = 0; caseIndex < m_cases.size(); caseIndex++)
+	{
+		success = runCase(m_cases[caseIndex], outputFolder, profiler) && success;
+	}
+
+	removeAll(outputFolder);
+	return success;
+}
+
+bool ConversionBenchmark::runCase(Case& benchmarkCase, const char* outputFolder, ConversionProfiler* profiler)
+{
+	ConversionProfiler::Scope caseScope(profiler, "benchmarkCase", "phase", benchmarkCase.m_name.c_str());
+
+	// Each case gets a fresh manager, so objects of earlier cases do not slow down the lookups of later ones
+	FbxManager* fbxSdkManager = FbxManager::Create();
+	FbxScene* scene = createScene(fbxSdkManager, benchmarkCase);
+
+	bool success = true;
+	int numScenes = 0;
+	benchmarkCase.m_seconds = 0.0;
+	for (int runIndex = 0; runIndex < m_numRuns && success; runIndex++)
+	{
+		FbxToHkxConverter::Options options(fbxSdkManager);
+		options.m_profiler = profiler;
+		FbxToHkxConverter converter(options);
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		success = converter.createScenes(scene, false, HK_NULL);
+		if (success)
+		{
+			converter.saveScenes(outputFolder, benchmarkCase.m_name.c_str());
+			success = (converter.getSavedFiles().getSize() == converter.getNumScenes());
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		numScenes = converter.getNumScenes();
+		if (runIndex == 0 || seconds < benchmarkCase.m_seconds)
+		{
+			benchmarkCase.m_seconds = seconds;
+		}
+	}
+
+	fbxSdkManager->Destroy();
+
+	if (!success)
+	{
+		printf("Benchmark case %s failed to convert\n", benchmarkCase.m_name.c_str());
+		benchmarkCase.m_seconds = 0.0;
+		return false;
+	}
+
+	// Stacks are only converted for scenes with bones, the rig scene holds no animation
+	const int numAnimatedScenes = std::max(0, numScenes - 1);
+	const double seconds = std::max(benchmarkCase.m_seconds, 1e-9);
+	benchmarkCase.m_trianglesPerSecond = (double)benchmarkCase.m_numTriangles * numScenes / seconds;
+	benchmarkCase.m_boneFramesPerSecond = (double)benchmarkCase.m_numBones * benchmarkCase.m_numFrames * numAnimatedScenes / seconds;
+	return true;
+}
+
+// Throughput and time are compared as one ratio, the work of a case is fixed by its parameters
+bool ConversionBenchmark::compare() const
+{
+	bool success = true;
+
+	printf("Benchmark results (best of %d runs, tolerance %0.1f%%):\n", m_numRuns, m_tolerance * 100.0);
+	for (size_t caseIndex = 0; caseIndex < m_cases.size(); caseIndex++)
+	{
+		const Case& benchmarkCase = m_cases[caseIndex];
+
+		printf("%-16s %9.4fs %12.0f tris/s %12.0f bone-frames/s", benchmarkCase.m_name.c_str(), benchmarkCase.m_seconds,
+			benchmarkCase.m_trianglesPerSecond, benchmarkCase.m_boneFramesPerSecond);
+
+		if (benchmarkCase.m_seconds <= 0.0)
+		{
+			printf("  FAILED\n");
+			success = false;
+		}
+		else if (benchmarkCase.m_baselineSeconds > 0.0)
+		{
+			const double speed = benchmarkCase.m_baselineSeconds / benchmarkCase.m_seconds;
+			const bool regressed = speed < 1.0 - m_tolerance;
+			printf("  baseline %9.4fs, %+0.1f%%%s\n", benchmarkCase.m_baselineSeconds, (speed - 1.0) * 100.0, regressed ? "  REGRESSED" : "");
+			success = success && !regressed;
+		}
+		else
+		{
+			printf("  no baseline\n");
+		}
+	}
+
+	return success;
+}
+
+bool ConversionBenchmark::writeResults(const char* filename) const
+{
+	std::string json = "{\"version\": ";
+	appendJsonString(json, FBXIMPORTER_VERSION);
+	json += ", \"cases\": [";
+
+	for (size_t caseIndex = 0; caseIndex < m_cases.size(); caseIndex++)
+	{
+		const Case& benchmarkCase = m_cases[caseIndex];
+
+		json += (caseIndex > 0) ? ",\n  {\"name\": " : "\n  {\"name\": ";
+		appendJsonString(json, benchmarkCase.m_name.c_str());
+
+		char fields[512];
+		sprintf(fields, ", \"triangles\": %d, \"uvSets\": %d, \"bones\": %d, \"stacks\": %d, \"frames\": %d, \"nodes\": %d, "
+			"\"attributes\": %d, \"seconds\": %0.4f, \"trianglesPerSecond\": %0.1f, \"boneFramesPerSecond\": %0.1f}",
+			benchmarkCase.m_numTriangles, benchmarkCase.m_numUvSets, benchmarkCase.m_numBones, benchmarkCase.m_numStacks,
+			benchmarkCase.m_numFrames, benchmarkCase.m_numNodes, benchmarkCase.m_numAttributes, benchmarkCase.m_seconds,
+			benchmarkCase.m_trianglesPerSecond, benchmarkCase.m_boneFramesPerSecond);
+		json += fields;
+	}
+	json += "\n]}\n";
+
+	FILE* file = fopen(filename, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	const bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+	return (fclose(file) == 0) && written;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,105 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONBENCHMARK
+#define HK_FBXTOHKX_CONVERSIONBENCHMARK
+
+#include <string>
+#include <vector>
+
+class ConversionProfiler;
+
+// Reproducible performance benchmark of the converter (--benchmark). Each case generates a synthetic FBX scene in
+// memory, converts it with createScenes() and saveScenes() and keeps the best time of a number of runs:
+//
+//   - a grid mesh of N triangles with K UV sets (and one material)
+//   - a skeleton of B bones, which the mesh is skinned to if it has both
+//   - S animation stacks of F frames animating every bone
+//   - extra nodes carrying P animated float attributes each
+//
+// The results are compared against a baseline file written by an earlier run, one case per line:
+//
+//   {"version": "FBXImporter 1.2", "cases": [
+//     {"name": "staticMesh", "triangles": 200000, "uvSets": 2, "bones": 0, "stacks": 0, "frames": 0, "nodes": 0,
+//      "attributes": 0, "seconds": 0.8123, "trianglesPerSecond": 246212.0, "boneFramesPerSecond": 0.0},
+//     ...
+//   ]}
+//
+// The cases and their sizes are taken from the baseline, so editing the parameters of a case (and dropping its
+// timings) changes what is measured. Without a baseline a default set of cases is run.
+class ConversionBenchmark
+{
+public:
+
+	struct Case
+	{
+		Case();
+
+		std::string m_name;
+		int m_numTriangles;
+		int m_numUvSets;
+		int m_numBones;
+		int m_numStacks;
+		int m_numFrames;
+		int m_numNodes;
+		int m_numAttributes;
+
+		// Best of the runs, 0 until the case has been run
+		double m_seconds;
+		// Triangles of all converted scenes (the mesh is converted again for each stack) per second
+		double m_trianglesPerSecond;
+		// Sampled bone transforms of all stacks per second
+		double m_boneFramesPerSecond;
+
+		// Time of the case in the baseline, 0 if it has none
+		double m_baselineSeconds;
+	};
+
+	// tolerance is the fraction a case may be slower than its baseline before it counts as a regression
+	ConversionBenchmark(int numRuns, double tolerance);
+
+	// Returns false if the file does not exist or holds no cases
+	bool loadBaseline(const char* filename);
+	void useDefaultCases();
+
+	// Runs every case, the tag files are saved to (and then removed from) outputFolder
+	bool run(const char* outputFolder, ConversionProfiler* profiler);
+
+	// Prints each case next to its baseline. Returns false if any case is slower than the tolerance allows.
+	bool compare() const;
+
+	// Writes the cases with their results in the baseline format
+	bool writeResults(const char* filename) const;
+
+private:
+
+	bool runCase(Case& benchmarkCase, const char* outputFolder, ConversionProfiler* profiler);
+
+	int m_numRuns;
+	double m_tolerance;
+	std::vector<Case> m_cases;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,350 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ConversionCache.h"
+#include "FileUtil.h"
+#include "MappedFile.h"
+
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+//-------
+
+static const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t xxhRotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxhRead64(const unsigned char* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t xxhRead32(const unsigned char* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = xxhRotl64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxhMergeRound(uint64_t acc, uint64_t val)
+{
+	acc ^= xxhRound(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t computeContentHash(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	const unsigned char* const end = p + size;
+	uint64_t h64;
+
+	if (size >= 32)
+	{
+		const unsigned char* const limit = end - 32;
+		uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		uint64_t v2 = seed + XXH_PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - XXH_PRIME64_1;
+
+		do
+		{
+			v1 = xxhRound(v1, xxhRead64(p)); p += 8;
+			v2 = xxhRound(v2, xxhRead64(p)); p += 8;
+			v3 = xxhRound(v3, xxhRead64(p)); p += 8;
+			v4 = xxhRound(v4, xxhRead64(p)); p += 8;
+		} while (p <= limit);
+
+		h64 = xxhRotl64(v1, 1) + xxhRotl64(v2, 7) + xxhRotl64(v3, 12) + xxhRotl64(v4, 18);
+		h64 = xxhMergeRound(h64, v1);
+		h64 = xxhMergeRound(h64, v2);
+		h64 = xxhMergeRound(h64, v3);
+		h64 = xxhMergeRound(h64, v4);
+	}
+	else
+	{
+		h64 = seed + XXH_PRIME64_5;
+	}
+
+	h64 += (uint64_t)size;
+
+	for (; p + 8 <= end; p += 8)
+	{
+		h64 ^= xxhRound(0, xxhRead64(p));
+		h64 = xxhRotl64(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+	if (p + 4 <= end)
+	{
+		h64 ^= (uint64_t)xxhRead32(p) * XXH_PRIME64_1;
+		h64 = xxhRotl64(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+	{
+		h64 ^= (*p) * XXH_PRIME64_5;
+		h64 = xxhRotl64(h64, 11) * XXH_PRIME64_1;
+	}
+
+	h64 ^= h64 >> 33;
+	h64 *= XXH_PRIME64_2;
+	h64 ^= h64 >> 29;
+	h64 *= XXH_PRIME64_3;
+	h64 ^= h64 >> 32;
+	return h64;
+}
+
+// Suffix of temporary files and folders that is unique across threads and processes sharing a cache
+static std::string makeTempSuffix()
+{
+	std::random_device random;
+	char suffix[32];
+	sprintf(suffix, ".tmp%08x%08x", (unsigned int)random(), (unsigned int)random());
+	return suffix;
+}
+
+bool writeFileIfChanged(const char* filename, const void* data, size_t size, bool* changedOut)
+{
+	if (changedOut)
+	{
+		*changedOut = false;
+	}
+
+	{
+		MappedFile existing;
+		if (existing.open(filename, MappedFile::ACCESS_SEQUENTIAL) && existing.getSize() == size && (size == 0 || memcmp(existing.getData(), data, size) == 0))
+		{
+			return true;
+		}
+	}
+
+	FILE* file = fopen(filename, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	const bool written = (size == 0 || fwrite(data, 1, size, file) == size);
+	const bool closed = (fclose(file) == 0);
+
+	if (changedOut)
+	{
+		*changedOut = true;
+	}
+	return written && closed;
+}
+
+//-------
+
+void ContentHasher::addString(const char* str)
+{
+	addBytes(str, str ? strlen(str) : 0);
+}
+
+bool ContentHasher::addFile(const char* filename)
+{
+	MappedFile file;
+	if (!file.open(filename, MappedFile::ACCESS_SEQUENTIAL))
+	{
+		addInt(-1);
+		return false;
+	}
+
+	addBytes(file.getData(), file.getSize());
+	return true;
+}
+
+//-------
+
+ConversionObjectStore::ConversionObjectStore(const char* folder) :
+	m_folder(folder), m_numHits(0), m_numMisses(0)
+{
+}
+
+std::string ConversionObjectStore::getEntryPath(uint64_t key) const
+{
+	char keyString[17];
+	sprintf(keyString, "%016llx", (unsigned long long)key);
+
+	// Fan out by the first byte so no single folder gets too large
+	return joinPath(joinPath(m_folder, std::string(keyString, 2)), keyString);
+}
+
+bool ConversionObjectStore::load(uint64_t key, std::vector<char>& dataOut)
+{
+	MappedFile file;
+	if (!file.open(getEntryPath(key).c_str(), MappedFile::ACCESS_SEQUENTIAL))
+	{
+		m_numMisses++;
+		return false;
+	}
+
+	dataOut.assign(file.getData(), file.getData() + file.getSize());
+	m_numHits++;
+	return true;
+}
+
+bool ConversionObjectStore::store(uint64_t key, const void* data, size_t size)
+{
+	const std::string entryPath = getEntryPath(key);
+	createDirectories(getParentPath(entryPath).c_str());
+
+	const std::string tempPath = entryPath + makeTempSuffix();
+
+	bool success = writeFileIfChanged(tempPath.c_str(), data, size);
+	if (success)
+	{
+		success = renamePath(tempPath.c_str(), entryPath.c_str());
+	}
+	if (!success)
+	{
+		removeAll(tempPath.c_str());
+	}
+	return success;
+}
+
+//-------
+
+ConversionCache::ConversionCache(const char* cacheFolder) :
+	m_folder(cacheFolder)
+{
+	addString(FBXIMPORTER_VERSION);
+}
+
+std::string ConversionCache::getEntryFolder() const
+{
+	char keyString[17];
+	sprintf(keyString, "%016llx", (unsigned long long)getKey());
+
+	return joinPath(m_folder, keyString);
+}
+
+bool ConversionCache::restore(const char* outputPath, std::string& summaryOut, std::vector<std::string>* filesOut, std::string* manifestOut) const
+{
+	const std::string entryFolder = getEntryFolder();
+
+	MappedFile summary;
+	if (!summary.open((entryFolder + "/summary.txt").c_str(), MappedFile::ACCESS_SEQUENTIAL))
+	{
+		return false;
+	}
+	summaryOut.assign(summary.getData() ? reinterpret_cast<const char*>(summary.getData()) : "", summary.getSize());
+
+	if (manifestOut)
+	{
+		MappedFile manifest;
+		manifestOut->clear();
+		if (manifest.open((entryFolder + "/manifest.txt").c_str(), MappedFile::ACCESS_SEQUENTIAL) && manifest.getData())
+		{
+			manifestOut->assign(reinterpret_cast<const char*>(manifest.getData()), manifest.getSize());
+		}
+	}
+
+	// The entry folder is only renamed into place once complete, so every listed file is there
+	const std::string filesFolder = joinPath(entryFolder, "files");
+	std::vector<std::string> names;
+	if (!listFiles(filesFolder.c_str(), names))
+	{
+		return false;
+	}
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		const std::string cachedPath = joinPath(filesFolder, names[i]);
+		MappedFile cachedFile;
+		if (!cachedFile.open(cachedPath.c_str(), MappedFile::ACCESS_SEQUENTIAL))
+		{
+			printf("Cannot read cached file: %s\n", cachedPath.c_str());
+			return false;
+		}
+
+		const std::string outputFile = joinPath(outputPath, names[i]);
+		bool changed;
+		if (!writeFileIfChanged(outputFile.c_str(), cachedFile.getData(), cachedFile.getSize(), &changed))
+		{
+			printf("Cannot save file: %s\n", outputFile.c_str());
+			return false;
+		}
+		printf("%s cached file: %s\n", changed ? "Restored" : "Unchanged", names[i].c_str());
+
+		if (filesOut)
+		{
+			filesOut->push_back(names[i]);
+		}
+	}
+
+	return true;
+}
+
+bool ConversionCache::store(const char* outputPath, const std::vector<std::string>& files, const std::string& summary, const std::string& manifest) const
+{
+	const std::string entryFolder = getEntryFolder();
+
+	// Write into a temporary folder first so concurrent runs never see a partial entry
+	const std::string tempFolder = entryFolder + makeTempSuffix();
+	const std::string tempFilesFolder = joinPath(tempFolder, "files");
+
+	removeAll(tempFolder.c_str());
+	if (!createDirectories(tempFilesFolder.c_str()))
+	{
+		printf("Cannot create cache folder: %s\n", tempFolder.c_str());
+		return false;
+	}
+
+	bool success = true;
+	for (size_t i = 0; i < files.size() && success; ++i)
+	{
+		success = copyFile(joinPath(outputPath, files[i]).c_str(), joinPath(tempFilesFolder, getFileName(files[i])).c_str());
+	}
+
+	success = success && writeFileIfChanged(joinPath(tempFolder, "summary.txt").c_str(), summary.data(), summary.size());
+	success = success && writeFileIfChanged(joinPath(tempFolder, "manifest.txt").c_str(), manifest.data(), manifest.size());
+
+	if (success)
+	{
+		// Another run may have stored the same entry in the meantime, which is just as good
+		success = renamePath(tempFolder.c_str(), entryFolder.c_str()) || isDirectory(entryFolder.c_str());
+	}
+
+	removeAll(tempFolder.c_str());
+
+	if (!success)
+	{
+		printf("Cannot store conversion in cache: %s\n", entryFolder.c_str());
+	}
+	return success;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
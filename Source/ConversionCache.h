@@ -0,0 +1,121 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONCACHE
+#define HK_FBXTOHKX_CONVERSIONCACHE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Bump whenever a converter change affects its output, so previously cached conversions are no longer used
+#define FBXIMPORTER_VERSION "FBXImporter 1.4"
+
+// 64 bit xxHash of a buffer
+uint64_t computeContentHash(const void* data, size_t size, uint64_t seed = 0);
+
+// Writes the file only if its current contents differ, so the modification time of unchanged outputs is kept.
+// changedOut (optional) is set to whether the file was written.
+bool writeFileIfChanged(const char* filename, const void* data, size_t size, bool* changedOut = NULL);
+
+// Accumulates a 64 bit key over a sequence of inputs, the size of each input is part of the key so the boundaries
+// between inputs matter
+class ContentHasher
+{
+public:
+
+	ContentHasher() : m_key(0) {}
+
+	void addBytes(const void* data, size_t size) { m_key = computeContentHash(data, size, m_key); }
+	void addString(const char* str);
+	void addInt(int value) { addBytes(&value, sizeof(value)); }
+	void addDouble(double value) { addBytes(&value, sizeof(value)); }
+	// Adds the contents of the file, or a marker if it can't be read
+	bool addFile(const char* filename);
+
+	uint64_t getKey() const { return m_key; }
+
+private:
+
+	uint64_t m_key;
+};
+
+// Content-addressed store of intermediate conversion results (<folder>/<2 hex digits>/<16 hex digits>).
+// Entries are written to a temporary file and renamed into place, so readers only ever see complete entries.
+class ConversionObjectStore
+{
+public:
+
+	ConversionObjectStore(const char* folder);
+
+	bool load(uint64_t key, std::vector<char>& dataOut);
+	bool store(uint64_t key, const void* data, size_t size);
+
+	int getNumHits() const { return m_numHits; }
+	int getNumMisses() const { return m_numMisses; }
+
+private:
+
+	std::string getEntryPath(uint64_t key) const;
+
+	std::string m_folder;
+	int m_numHits;
+	int m_numMisses;
+};
+
+// On-disk cache of converted outputs, keyed by a hash of everything that affects them: the FBX bytes, the converter
+// options, the export_data sidecars and the tool version. Each entry is a folder named after the key, holding copies
+// of the output files and the console summary that convert.py parses.
+class ConversionCache
+{
+public:
+
+	ConversionCache(const char* cacheFolder);
+
+	// Key inputs, hashed in the order they are added
+	void addBytes(const void* data, size_t size) { m_hasher.addBytes(data, size); }
+	void addString(const char* str) { m_hasher.addString(str); }
+	void addInt(int value) { m_hasher.addInt(value); }
+	bool addFile(const char* filename) { return m_hasher.addFile(filename); }
+
+	uint64_t getKey() const { return m_hasher.getKey(); }
+
+	// Copies the cached outputs of the current key to outputPath, skipping files that are already identical.
+	// filesOut and manifestOut (optional) receive the restored file names and the manifest record.
+	// Returns false on a cache miss.
+	bool restore(const char* outputPath, std::string& summaryOut, std::vector<std::string>* filesOut = NULL, std::string* manifestOut = NULL) const;
+
+	// Stores the given output files (relative to outputPath), summary and manifest record under the current key
+	bool store(const char* outputPath, const std::vector<std::string>& files, const std::string& summary, const std::string& manifest = std::string()) const;
+
+private:
+
+	std::string getEntryFolder() const;
+
+	std::string m_folder;
+	ContentHasher m_hasher;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,194 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ConversionManifest.h"
+#include "ConversionCache.h"
+#include "FileUtil.h"
+#include "JsonUtil.h"
+
+#include <stdio.h>
+#include <thread>
+
+ConversionManifest::ConversionManifest(const char* filename, const char* input, const char* outputPath) :
+	m_filename(filename), m_input(input), m_outputPath(outputPath), m_status("converting"),
+	m_numBones(0), m_numAnimStacks(0), m_start(std::chrono::steady_clock::now())
+{
+	write();
+}
+
+ConversionManifest::~ConversionManifest()
+{
+	if (m_status == "converting")
+	{
+		finish("failed");
+	}
+}
+
+void ConversionManifest::setCounts(int numBones, int numAnimStacks)
+{
+	m_numBones = numBones;
+	m_numAnimStacks = numAnimStacks;
+	write();
+}
+
+void ConversionManifest::addScene(const Scene& scene)
+{
+	m_scenes.push_back(scene);
+	if (m_files.empty() || m_files.back() != scene.m_file)
+	{
+		m_files.push_back(scene.m_file);
+	}
+	write();
+}
+
+void ConversionManifest::addFile(const char* file)
+{
+	m_files.push_back(file);
+	write();
+}
+
+void ConversionManifest::finish(const char* status)
+{
+	m_status = status;
+	if (!write())
+	{
+		printf("Cannot save file: %s\n", m_filename.c_str());
+	}
+}
+
+std::string ConversionManifest::getScenesJson() const
+{
+	if (!m_cachedScenesJson.empty())
+	{
+		return m_cachedScenesJson;
+	}
+
+	std::string json = "[";
+	for (size_t sceneIndex = 0; sceneIndex < m_scenes.size(); sceneIndex++)
+	{
+		const Scene& scene = m_scenes[sceneIndex];
+
+		json += (sceneIndex > 0) ? ",\n    {\"file\": " : "\n    {\"file\": ";
+		appendJsonString(json, scene.m_file.c_str());
+		json += ", \"variant\": ";
+		appendJsonString(json, scene.m_variant.c_str());
+		json += ", \"stack\": ";
+		appendJsonString(json, scene.m_stack.c_str());
+
+		char fields[512];
+		sprintf(fields, ", \"frames\": %d, \"length\": %0.4f, \"bones\": %d, \"meshes\": %d, \"sections\": %d, \"vertices\": %d, "
+			"\"triangles\": %d, \"convertSeconds\": %0.3f, \"saveSeconds\": %0.3f",
+			scene.m_numFrames, scene.m_length, scene.m_numBones, scene.m_numMeshes, scene.m_numSections, scene.m_numVertices,
+			scene.m_numTriangles, scene.m_convertSeconds, scene.m_saveSeconds);
+		json += fields;
+
+		if (!scene.m_sizes.empty())
+		{
+			json += ", \"sizes\": ";
+			json += scene.m_sizes;
+		}
+		json += "}";
+	}
+	json += m_scenes.empty() ? "]" : "\n  ]";
+	return json;
+}
+
+// The record is the bone and stack counts on the first line, followed by the scene entries as a JSON array
+std::string ConversionManifest::getCacheRecord() const
+{
+	char counts[64];
+	sprintf(counts, "%d %d\n", m_numBones, m_numAnimStacks);
+	return counts + getScenesJson();
+}
+
+void ConversionManifest::setCachedRecord(const std::string& record, const std::vector<std::string>& files)
+{
+	m_numBones = 0;
+	m_numAnimStacks = 0;
+	sscanf(record.c_str(), "%d %d", &m_numBones, &m_numAnimStacks);
+
+	const size_t newline = record.find('\n');
+	m_scenes.clear();
+	m_cachedScenesJson = (newline != std::string::npos && newline + 1 < record.size()) ? record.substr(newline + 1) : "[]";
+	m_files = files;
+}
+
+bool ConversionManifest::write()
+{
+	if (m_filename.empty())
+	{
+		return true;
+	}
+
+	std::string json = "{\n  \"input\": ";
+	appendJsonString(json, m_input.c_str());
+	json += ",\n  \"outputPath\": ";
+	appendJsonString(json, m_outputPath.c_str());
+	json += ",\n  \"status\": ";
+	appendJsonString(json, m_status.c_str());
+
+	char counts[128];
+	sprintf(counts, ",\n  \"bones\": %d,\n  \"animationStacks\": %d", m_numBones, m_numAnimStacks);
+	json += counts;
+
+	json += ",\n  \"scenes\": ";
+	json += getScenesJson();
+
+	json += ",\n  \"files\": [";
+	for (size_t fileIndex = 0; fileIndex < m_files.size(); fileIndex++)
+	{
+		if (fileIndex > 0)
+		{
+			json += ", ";
+		}
+		appendJsonString(json, m_files[fileIndex].c_str());
+	}
+
+	char seconds[64];
+	sprintf(seconds, "],\n  \"seconds\": %0.3f\n}\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+	json += seconds;
+
+	// Readers polling the manifest only ever see complete documents
+	const std::string tempFilename = m_filename + ".tmp";
+	if (!writeFileIfChanged(tempFilename.c_str(), json.data(), json.size()))
+	{
+		return false;
+	}
+
+	// A driver reading the manifest holds it open for a moment, which makes replacing it fail on Windows
+	bool renamed = false;
+	for (int attempt = 0; attempt < 50 && !renamed; attempt++)
+	{
+		renamed = renamePath(tempFilename.c_str(), m_filename.c_str());
+		if (!renamed)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+	if (!renamed)
+	{
+		removeAll(tempFilename.c_str());
+	}
+	return renamed;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
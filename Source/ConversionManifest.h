@@ -0,0 +1,119 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONMANIFEST
+#define HK_FBXTOHKX_CONVERSIONMANIFEST
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Machine readable record of a conversion (--manifest), for drivers that would otherwise scrape the console output.
+// The file is rewritten whenever a scene has been saved, so a driver polling it can process scene N while scene N+1
+// is still being converted. Every rewrite goes to a temporary file that is renamed into place, readers never see a
+// partial document.
+//
+//   {
+//     "input": "C:/assets/hero.fbx",
+//     "outputPath": "C:/assets",
+//     "status": "converting",                    ("converting", "succeeded", "cached" or "failed")
+//     "bones": 42,
+//     "animationStacks": 2,
+//     "scenes": [
+//       {"file": "hero.hkt", "variant": "Scene Data", "stack": "ROOT_NODE", "frames": 1, "length": 0.0000,
+//        "bones": 42, "meshes": 3, "sections": 5, "vertices": 1234, "triangles": 2002,
+//        "convertSeconds": 0.120, "saveSeconds": 0.031,    (saveSeconds covers the whole file holding the scene)
+//        "sizes": {"fileBytes": 123456, "keyframes": 81920, ...}},   (only with --sizes, see SceneSizeReport.h)
+//       ...
+//     ],
+//     "files": ["hero.hkt", "hero_Walk.hkt"],
+//     "seconds": 1.250
+//   }
+class ConversionManifest
+{
+public:
+
+	struct Scene
+	{
+		Scene() : m_numFrames(0), m_length(0.0), m_numBones(0), m_numMeshes(0), m_numSections(0), m_numVertices(0),
+			m_numTriangles(0), m_convertSeconds(0.0), m_saveSeconds(0.0) {}
+
+		// Output file holding the scene, relative to the output path
+		std::string m_file;
+		// Named variant of the scene inside the file
+		std::string m_variant;
+		// Animation stack the scene was sampled from (ROOT_NODE for the rig scene)
+		std::string m_stack;
+		int m_numFrames;
+		double m_length;
+		int m_numBones;
+		int m_numMeshes;
+		int m_numSections;
+		int m_numVertices;
+		int m_numTriangles;
+		double m_convertSeconds;
+		double m_saveSeconds;
+		// Size breakdown of the scene as a JSON object (SceneSizeReport::getJson()), empty if it was not collected
+		std::string m_sizes;
+	};
+
+	// Writes the initial manifest with status "converting". With an empty filename nothing is written, the scene
+	// entries are only collected (for the conversion cache).
+	ConversionManifest(const char* filename, const char* input, const char* outputPath);
+	// Marks the manifest as failed unless finish() was called
+	~ConversionManifest();
+
+	void setCounts(int numBones, int numAnimStacks);
+	void addScene(const Scene& scene);
+	// Adds an output file that holds no scene of its own (the scene list of a container)
+	void addFile(const char* file);
+	void finish(const char* status);
+
+	// The counts and scene entries, so they can be cached and restored with the outputs
+	std::string getCacheRecord() const;
+	// Restores the counts, scene entries and files of a cached conversion
+	void setCachedRecord(const std::string& record, const std::vector<std::string>& files);
+
+private:
+
+	ConversionManifest(const ConversionManifest&);
+	ConversionManifest& operator=(const ConversionManifest&);
+
+	std::string getScenesJson() const;
+	bool write();
+
+	std::string m_filename;
+	std::string m_input;
+	std::string m_outputPath;
+	std::string m_status;
+	int m_numBones;
+	int m_numAnimStacks;
+	std::vector<Scene> m_scenes;
+	// Set instead of m_scenes for a conversion restored from the cache
+	std::string m_cachedScenesJson;
+	std::vector<std::string> m_files;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,197 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ConversionMemoryStats.h"
+
+#include <Common/Base/Memory/System/hkMemorySystem.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+static double toMegabytes(double bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+static bool isLargerPeak(const std::pair<hkLong, int>& a, const std::pair<hkLong, int>& b)
+{
+	return a.first > b.first;
+}
+
+//-------
+
+ConversionMemoryStats::ConversionMemoryStats()
+{
+	sample(m_baseline);
+}
+
+void ConversionMemoryStats::sample(Sample& sampleOut)
+{
+	hkMemoryAllocator::MemoryStatistics heapStatistics;
+	hkMemorySystem::getInstance().getHeapStatistics(heapStatistics);
+	sampleOut.m_heapInUse = heapStatistics.m_inUse;
+	sampleOut.m_heapPeak = heapStatistics.m_peakInUse;
+
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	memset(&counters, 0, sizeof(counters));
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	sampleOut.m_rss = counters.WorkingSetSize;
+	sampleOut.m_peakRss = counters.PeakWorkingSetSize;
+#else
+	sampleOut.m_rss = 0;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm)
+	{
+		unsigned long numPages = 0, numResidentPages = 0;
+		if (fscanf(statm, "%lu %lu", &numPages, &numResidentPages) == 2)
+		{
+			sampleOut.m_rss = (size_t)numResidentPages * (size_t)sysconf(_SC_PAGESIZE);
+		}
+		fclose(statm);
+	}
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	sampleOut.m_peakRss = (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+void ConversionMemoryStats::samplePhase(const char* phase)
+{
+	Sample current;
+	sample(current);
+	updateOpenScopes(current);
+
+	printf("Memory after %s: heap %0.1f MB (peak %0.1f MB), RSS %0.1f MB (peak %0.1f MB)\n", phase,
+		toMegabytes((double)current.m_heapInUse), toMegabytes((double)current.m_heapPeak),
+		toMegabytes((double)current.m_rss), toMegabytes((double)current.m_peakRss));
+}
+
+void ConversionMemoryStats::updateOpenScopes(const Sample& current)
+{
+	for (size_t scopeIndex = 0; scopeIndex < m_openScopes.size(); scopeIndex++)
+	{
+		m_openScopes[scopeIndex].m_peak = hkMath::max2(m_openScopes[scopeIndex].m_peak, current.m_heapPeak);
+	}
+}
+
+void ConversionMemoryStats::beginScope()
+{
+	// The enclosing scopes keep the peak reached so far, the heap peak then restarts for the new scope
+	Sample current;
+	sample(current);
+	updateOpenScopes(current);
+	hkMemorySystem::getInstance().resetPeakMemoryStatistics();
+
+	OpenScope scope;
+	scope.m_peak = current.m_heapInUse;
+	scope.m_startInUse = current.m_heapInUse;
+	m_openScopes.push_back(scope);
+}
+
+void ConversionMemoryStats::endScope(const char* kind, const char* name)
+{
+	Sample current;
+	sample(current);
+	updateOpenScopes(current);
+
+	const OpenScope& scope = m_openScopes.back();
+
+	Record record;
+	record.m_kind = kind;
+	record.m_name = name;
+	record.m_peak = scope.m_peak;
+	record.m_retained = current.m_heapInUse - scope.m_startInUse;
+	m_records.push_back(record);
+
+	m_openScopes.pop_back();
+
+	if (strcmp(kind, "scene") == 0)
+	{
+		printf("Memory of scene %s: heap peak %0.1f MB, retained %0.1f MB, RSS %0.1f MB (peak %0.1f MB)\n", name,
+			toMegabytes((double)record.m_peak), toMegabytes((double)record.m_retained),
+			toMegabytes((double)current.m_rss), toMegabytes((double)current.m_peakRss));
+	}
+}
+
+void ConversionMemoryStats::printSummary(int numMeshes)
+{
+	std::vector<std::pair<hkLong, int> > meshes;
+	for (int recordIndex = 0; recordIndex < (int)m_records.size(); recordIndex++)
+	{
+		if (m_records[recordIndex].m_kind == "mesh")
+		{
+			meshes.push_back(std::make_pair(m_records[recordIndex].m_peak, recordIndex));
+		}
+	}
+	std::stable_sort(meshes.begin(), meshes.end(), isLargerPeak);
+
+	if (!meshes.empty())
+	{
+		printf("Largest mesh peaks:\n");
+		for (int meshIndex = 0; meshIndex < numMeshes && meshIndex < (int)meshes.size(); meshIndex++)
+		{
+			const Record& record = m_records[meshes[meshIndex].second];
+			printf("%10.1f MB  %s (retained %0.1f MB)\n", toMegabytes((double)record.m_peak), record.m_name.c_str(), toMegabytes((double)record.m_retained));
+		}
+	}
+
+	Sample current;
+	sample(current);
+	const hkLong leaked = current.m_heapInUse - m_baseline.m_heapInUse;
+	printf("Memory leak report: %lld bytes of Havok heap still in use after the conversion (%0.1f MB), peak RSS %0.1f MB\n",
+		(long long)leaked, toMegabytes((double)leaked), toMegabytes((double)current.m_peakRss));
+}
+
+bool ConversionMemoryStats::checkBudgets(size_t peakBudget, hkLong leakBudget)
+{
+	Sample current;
+	sample(current);
+
+	bool withinBudgets = true;
+	if (peakBudget > 0 && current.m_peakRss > peakBudget)
+	{
+		printf("Memory budget exceeded: peak RSS %0.1f MB, budget %0.1f MB\n", toMegabytes((double)current.m_peakRss), toMegabytes((double)peakBudget));
+		withinBudgets = false;
+	}
+
+	const hkLong leaked = current.m_heapInUse - m_baseline.m_heapInUse;
+	if (leakBudget >= 0 && leaked > leakBudget)
+	{
+		printf("Memory budget exceeded: %lld bytes leaked, budget %lld bytes\n", (long long)leaked, (long long)leakBudget);
+		withinBudgets = false;
+	}
+	return withinBudgets;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,126 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONMEMORYSTATS
+#define HK_FBXTOHKX_CONVERSIONMEMORYSTATS
+
+#include <Common/Base/hkBase.h>
+
+#include <string>
+#include <vector>
+
+// Memory accounting of a conversion (--memstats): samples the Havok heap statistics of the memory system and the
+// process RSS (which also covers the FBX SDK) at each phase boundary, tracks the peak Havok heap use of each scene
+// and mesh, and reports the heap memory still in use once the conversion has been torn down.
+//
+// The numbers are process-wide, so only one conversion should run at a time while they are collected.
+class ConversionMemoryStats
+{
+public:
+
+	struct Sample
+	{
+		hkLong m_heapInUse;
+		hkLong m_heapPeak;
+		size_t m_rss;
+		size_t m_peakRss;
+	};
+
+	// Tracks the peak heap use while the enclosing scope is open, does nothing if the stats are NULL.
+	// Scopes nest, an outer scope's peak includes the peaks of its inner scopes.
+	class Scope
+	{
+	public:
+
+		Scope(ConversionMemoryStats* stats, const char* kind, const char* name) :
+			m_stats(stats), m_kind(kind), m_name(name)
+		{
+			if (m_stats)
+			{
+				m_stats->beginScope();
+			}
+		}
+
+		~Scope()
+		{
+			if (m_stats)
+			{
+				m_stats->endScope(m_kind, m_name.c_str());
+			}
+		}
+
+	private:
+
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+		ConversionMemoryStats* m_stats;
+		const char* m_kind;
+		std::string m_name;
+	};
+
+	// Takes the baseline that leaks are measured against, create it once Havok is initialized
+	ConversionMemoryStats();
+
+	static void sample(Sample& sampleOut);
+
+	// Prints the current heap use and RSS after the given phase
+	void samplePhase(const char* phase);
+
+	// Prints the peak heap use of the scenes and of the largest meshes, and the heap memory in use compared to the
+	// baseline
+	void printSummary(int numMeshes);
+
+	// Returns false (and prints why) if the peak RSS or the leaked heap memory exceed the budgets (in bytes).
+	// A peak budget of 0 or a negative leak budget disables the check.
+	bool checkBudgets(size_t peakBudget, hkLong leakBudget);
+
+private:
+
+	struct Record
+	{
+		std::string m_kind;
+		std::string m_name;
+		hkLong m_peak;
+		// Heap memory the scope left allocated
+		hkLong m_retained;
+	};
+
+	struct OpenScope
+	{
+		hkLong m_peak;
+		hkLong m_startInUse;
+	};
+
+	void beginScope();
+	void endScope(const char* kind, const char* name);
+	// Folds the heap peak since the last reset into all open scopes
+	void updateOpenScopes(const Sample& current);
+
+	Sample m_baseline;
+	std::vector<OpenScope> m_openScopes;
+	std::vector<Record> m_records;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,162 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ConversionProfiler.h"
+#include "JsonUtil.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdio.h>
+#include <string.h>
+
+ConversionProfiler::ConversionProfiler() :
+	m_start(Clock::now())
+{
+}
+
+void ConversionProfiler::addEvent(const char* name, const char* category, const std::string& detail, Clock::time_point start, Clock::time_point end)
+{
+	Event event;
+	event.m_name = name;
+	event.m_category = category;
+	event.m_detail = detail;
+	event.m_start = std::chrono::duration<double, std::micro>(start - m_start).count();
+	event.m_duration = std::chrono::duration<double, std::micro>(end - start).count();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::map<std::thread::id, int>::iterator thread = m_threads.find(std::this_thread::get_id());
+	if (thread == m_threads.end())
+	{
+		thread = m_threads.insert(std::make_pair(std::this_thread::get_id(), (int)m_threads.size())).first;
+	}
+	event.m_thread = thread->second;
+
+	m_events.push_back(event);
+}
+
+bool ConversionProfiler::writeChromeTrace(const char* filename) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	FILE* file = fopen(filename, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	for (int threadIndex = 0; threadIndex < (int)m_threads.size(); threadIndex++)
+	{
+		fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"Thread %d\"}},\n", threadIndex, threadIndex);
+	}
+
+	std::string line;
+	for (size_t eventIndex = 0; eventIndex < m_events.size(); eventIndex++)
+	{
+		const Event& event = m_events[eventIndex];
+
+		line = "{\"name\": ";
+		appendJsonString(line, event.m_name);
+		line += ", \"cat\": ";
+		appendJsonString(line, event.m_category);
+
+		char timing[128];
+		sprintf(timing, ", \"ph\": \"X\", \"ts\": %0.1f, \"dur\": %0.1f, \"pid\": 1, \"tid\": %d", event.m_start, event.m_duration, event.m_thread);
+		line += timing;
+
+		if (!event.m_detail.empty())
+		{
+			line += ", \"args\": {\"detail\": ";
+			appendJsonString(line, event.m_detail.c_str());
+			line += "}";
+		}
+		line += (eventIndex + 1 < m_events.size()) ? "},\n" : "}\n";
+
+		fwrite(line.data(), 1, line.size(), file);
+	}
+	fprintf(file, "]}\n");
+
+	return fclose(file) == 0;
+}
+
+void ConversionProfiler::printSlowestNodes(int count) const
+{
+	struct NodeTime
+	{
+		NodeTime() : m_total(0.0) {}
+
+		double m_total;
+		// Time per scope name, in the order the names first appeared
+		std::vector<std::pair<const char*, double> > m_scopes;
+	};
+
+	std::map<std::string, NodeTime> nodeTimes;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (size_t eventIndex = 0; eventIndex < m_events.size(); eventIndex++)
+		{
+			const Event& event = m_events[eventIndex];
+			if (strcmp(event.m_category, "node") != 0)
+			{
+				continue;
+			}
+
+			NodeTime& nodeTime = nodeTimes[event.m_detail];
+			nodeTime.m_total += event.m_duration;
+
+			size_t scopeIndex = 0;
+			while (scopeIndex < nodeTime.m_scopes.size() && strcmp(nodeTime.m_scopes[scopeIndex].first, event.m_name) != 0)
+			{
+				scopeIndex++;
+			}
+			if (scopeIndex == nodeTime.m_scopes.size())
+			{
+				nodeTime.m_scopes.push_back(std::make_pair(event.m_name, 0.0));
+			}
+			nodeTime.m_scopes[scopeIndex].second += event.m_duration;
+		}
+	}
+
+	std::vector<std::pair<double, const std::string*> > slowest;
+	for (std::map<std::string, NodeTime>::const_iterator it = nodeTimes.begin(); it != nodeTimes.end(); ++it)
+	{
+		slowest.push_back(std::make_pair(it->second.m_total, &it->first));
+	}
+	std::sort(slowest.begin(), slowest.end(), std::greater<std::pair<double, const std::string*> >());
+
+	printf("Slowest nodes:\n");
+	for (int nodeIndex = 0; nodeIndex < count && nodeIndex < (int)slowest.size(); nodeIndex++)
+	{
+		const NodeTime& nodeTime = nodeTimes[*slowest[nodeIndex].second];
+
+		printf("%10.2f ms  %s (", nodeTime.m_total / 1000.0, slowest[nodeIndex].second->c_str());
+		for (size_t scopeIndex = 0; scopeIndex < nodeTime.m_scopes.size(); scopeIndex++)
+		{
+			printf("%s%s %0.2f ms", scopeIndex > 0 ? ", " : "", nodeTime.m_scopes[scopeIndex].first, nodeTime.m_scopes[scopeIndex].second / 1000.0);
+		}
+		printf(")\n");
+	}
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,111 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONPROFILER
+#define HK_FBXTOHKX_CONVERSIONPROFILER
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Collects timed scopes of a conversion (--profile) and writes them as Chrome trace events, which can be opened in
+// chrome://tracing or ui.perfetto.dev. Scopes may be recorded from several threads (batch mode), each shows up as a
+// track of its own.
+//
+// Categories used by the converter: "phase" (import, scene stacks, saving), "node" (per node work, the detail is the
+// node name) and "mesh" (the steps of a mesh conversion).
+class ConversionProfiler
+{
+public:
+
+	typedef std::chrono::steady_clock Clock;
+
+	// Times the enclosing scope, does nothing if the profiler is NULL. name and category are kept by pointer (use
+	// string literals), the detail is copied.
+	class Scope
+	{
+	public:
+
+		Scope(ConversionProfiler* profiler, const char* name, const char* category, const char* detail = NULL) :
+			m_profiler(profiler), m_name(name), m_category(category)
+		{
+			if (m_profiler)
+			{
+				m_detail = detail ? detail : "";
+				m_start = Clock::now();
+			}
+		}
+
+		~Scope()
+		{
+			if (m_profiler)
+			{
+				m_profiler->addEvent(m_name, m_category, m_detail, m_start, Clock::now());
+			}
+		}
+
+	private:
+
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+		ConversionProfiler* m_profiler;
+		const char* m_name;
+		const char* m_category;
+		std::string m_detail;
+		Clock::time_point m_start;
+	};
+
+	ConversionProfiler();
+
+	void addEvent(const char* name, const char* category, const std::string& detail, Clock::time_point start, Clock::time_point end);
+
+	bool writeChromeTrace(const char* filename) const;
+
+	// Prints the nodes that took longest in total over all their "node" scopes (meshes, keyframes of all stacks)
+	void printSlowestNodes(int count) const;
+
+private:
+
+	struct Event
+	{
+		const char* m_name;
+		const char* m_category;
+		std::string m_detail;
+		// Microseconds since the profiler was created
+		double m_start;
+		double m_duration;
+		int m_thread;
+	};
+
+	mutable std::mutex m_mutex;
+	std::vector<Event> m_events;
+	std::map<std::thread::id, int> m_threads;
+	Clock::time_point m_start;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,620 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ConversionServer.h"
+#include "JsonUtil.h"
+#include "ScenePipeline.h"
+
+#include <Common/Base/hkBase.h>
+#include <Common/Base/System/hkBaseSystem.h>
+#include <Common/Base/Memory/System/hkMemorySystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE ConnectionHandle;
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int ConnectionHandle;
+#endif
+
+// Requests longer than this are rejected instead of buffered
+static const size_t MAX_REQUEST_LENGTH = 1 << 20;
+// Largest input file a request may send
+static const long long MAX_INPUT_SIZE = 4LL << 30;
+
+class ConversionServer::Connection
+{
+public:
+
+	Connection(ConnectionHandle handle) : m_numPendingJobs(0), m_finished(false), m_handle(handle) {}
+
+	~Connection()
+	{
+#ifdef _WIN32
+		FlushFileBuffers(m_handle);
+		DisconnectNamedPipe(m_handle);
+		CloseHandle(m_handle);
+#else
+		::close(m_handle);
+#endif
+	}
+
+	// Reads the next newline terminated request, returns false when the client disconnected
+	bool readLine(std::string& lineOut)
+	{
+		for (;;)
+		{
+			const size_t newline = m_readBuffer.find('\n');
+			if (newline != std::string::npos)
+			{
+				lineOut.assign(m_readBuffer, 0, newline);
+				m_readBuffer.erase(0, newline + 1);
+				if (!lineOut.empty() && lineOut[lineOut.size() - 1] == '\r')
+				{
+					lineOut.erase(lineOut.size() - 1);
+				}
+				return true;
+			}
+
+			if (m_readBuffer.size() > MAX_REQUEST_LENGTH)
+			{
+				return false;
+			}
+
+			char chunk[4096];
+#ifdef _WIN32
+			DWORD numRead = 0;
+			if (!ReadFile(m_handle, chunk, sizeof(chunk), &numRead, NULL) || numRead == 0)
+			{
+				return false;
+			}
+#else
+			const ssize_t numRead = ::read(m_handle, chunk, sizeof(chunk));
+			if (numRead <= 0)
+			{
+				if (numRead < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+#endif
+			m_readBuffer.append(chunk, numRead);
+		}
+	}
+
+	// Reads the given number of bytes following a request, returns false when the client disconnected before
+	bool readBytes(size_t size, std::string& bytesOut)
+	{
+		bytesOut.clear();
+		bytesOut.reserve(size);
+
+		const size_t numBuffered = std::min(size, m_readBuffer.size());
+		bytesOut.append(m_readBuffer, 0, numBuffered);
+		m_readBuffer.erase(0, numBuffered);
+
+		while (bytesOut.size() < size)
+		{
+			char chunk[65536];
+			const size_t chunkSize = std::min(sizeof(chunk), size - bytesOut.size());
+#ifdef _WIN32
+			DWORD numRead = 0;
+			if (!ReadFile(m_handle, chunk, (DWORD)chunkSize, &numRead, NULL) || numRead == 0)
+			{
+				return false;
+			}
+#else
+			const ssize_t numRead = ::read(m_handle, chunk, chunkSize);
+			if (numRead <= 0)
+			{
+				if (numRead < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+#endif
+			bytesOut.append(chunk, numRead);
+		}
+		return true;
+	}
+
+	// Sends one message, messages of concurrent jobs are never interleaved
+	void send(const std::string& message)
+	{
+		std::lock_guard<std::mutex> lock(m_sendMutex);
+
+		const std::string line = message + "\n";
+		size_t offset = 0;
+		while (offset < line.size())
+		{
+#ifdef _WIN32
+			DWORD numWritten = 0;
+			if (!WriteFile(m_handle, line.data() + offset, (DWORD)(line.size() - offset), &numWritten, NULL))
+			{
+				return;
+			}
+#else
+#ifdef MSG_NOSIGNAL
+			const ssize_t numWritten = ::send(m_handle, line.data() + offset, line.size() - offset, MSG_NOSIGNAL);
+#else
+			const ssize_t numWritten = ::send(m_handle, line.data() + offset, line.size() - offset, 0);
+#endif
+			if (numWritten < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (numWritten <= 0)
+			{
+				// The client is gone, the job still runs to completion
+				return;
+			}
+#endif
+			offset += numWritten;
+		}
+	}
+
+	// Makes a blocking readLine() on the connection thread return
+	void interrupt()
+	{
+#ifdef _WIN32
+		CancelSynchronousIo(m_thread.native_handle());
+#else
+		::shutdown(m_handle, SHUT_RD);
+#endif
+	}
+
+	std::thread m_thread;
+	// Jobs of the connection that are queued or running, guarded by the server mutex
+	int m_numPendingJobs;
+	std::atomic<bool> m_finished;
+
+private:
+
+	ConnectionHandle m_handle;
+	std::string m_readBuffer;
+	std::mutex m_sendMutex;
+};
+
+struct ConversionServer::QueuedJob
+{
+	Connection* m_connection;
+	std::string m_id;
+	ConversionJob m_job;
+};
+
+struct ConversionServer::JobReport
+{
+	Connection* m_connection;
+	const std::string* m_id;
+};
+
+// Starts an event message, the caller appends further fields and the closing brace
+static std::string beginEvent(const std::string& id, const char* event)
+{
+	std::string message = "{\"id\": ";
+	appendJsonString(message, id.c_str());
+	message += ", \"event\": ";
+	appendJsonString(message, event);
+	return message;
+}
+
+//-------
+
+ConversionServer::ConversionServer(ConvertFunction convert, int numWorkers, StartWorkerFunction startWorker, StopWorkerFunction stopWorker) :
+	m_convert(convert), m_startWorker(startWorker), m_stopWorker(stopWorker), m_numWorkers(numWorkers), m_shutdown(false), m_stopWorkers(false)
+{
+	if (m_numWorkers <= 0)
+	{
+		m_numWorkers = hkMath::max2((int)std::thread::hardware_concurrency(), 1);
+	}
+}
+
+ConversionServer::~ConversionServer()
+{
+	HK_ASSERT(0x0, m_connections.empty() && m_workers.empty() && m_jobQueue.empty());
+}
+
+bool ConversionServer::run(const char* address)
+{
+	m_address = address;
+	m_shutdown = false;
+
+#ifdef _WIN32
+	bool listening = false;
+	while (!m_shutdown)
+	{
+		HANDLE pipe = CreateNamedPipeA(address, PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT, PIPE_UNLIMITED_INSTANCES, 65536, 65536, 0, NULL);
+		if (pipe == INVALID_HANDLE_VALUE)
+		{
+			if (!listening)
+			{
+				printf("Cannot create named pipe: %s\n", address);
+				return false;
+			}
+			break;
+		}
+		if (!listening)
+		{
+			printf("Conversion server listening on %s\n", address);
+			listening = true;
+			startWorkers();
+		}
+
+		const bool connected = ConnectNamedPipe(pipe, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+		if (!connected || m_shutdown)
+		{
+			CloseHandle(pipe);
+			continue;
+		}
+#else
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un socketAddress;
+	memset(&socketAddress, 0, sizeof(socketAddress));
+	socketAddress.sun_family = AF_UNIX;
+	if (listener < 0 || strlen(address) >= sizeof(socketAddress.sun_path))
+	{
+		printf("Cannot create socket: %s\n", address);
+		if (listener >= 0)
+		{
+			::close(listener);
+		}
+		return false;
+	}
+	strcpy(socketAddress.sun_path, address);
+
+	// Remove the socket file left behind by a previous run
+	unlink(address);
+	if (bind(listener, (const sockaddr*)&socketAddress, sizeof(socketAddress)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		printf("Cannot listen on socket: %s\n", address);
+		::close(listener);
+		return false;
+	}
+	printf("Conversion server listening on %s\n", address);
+	startWorkers();
+
+	while (!m_shutdown)
+	{
+		const int client = accept(listener, NULL, NULL);
+		if (client < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+		if (m_shutdown)
+		{
+			::close(client);
+			break;
+		}
+		ConnectionHandle pipe = client;
+#endif
+
+		Connection* connection = new Connection(pipe);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			// Clean up the connections of clients that have gone away
+			for (size_t connectionIndex = 0; connectionIndex < m_connections.size();)
+			{
+				Connection* oldConnection = m_connections[connectionIndex];
+				if (oldConnection->m_finished)
+				{
+					oldConnection->m_thread.join();
+					delete oldConnection;
+					m_connections.erase(m_connections.begin() + connectionIndex);
+				}
+				else
+				{
+					connectionIndex++;
+				}
+			}
+
+			m_connections.push_back(connection);
+			connection->m_thread = std::thread(&ConversionServer::connectionMain, this, connection);
+		}
+	}
+
+#ifndef _WIN32
+	::close(listener);
+	unlink(address);
+#endif
+
+	// Stop reading from the remaining clients, their running jobs still finish
+	std::vector<Connection*> connections;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		connections.swap(m_connections);
+	}
+	for (size_t connectionIndex = 0; connectionIndex < connections.size(); connectionIndex++)
+	{
+		Connection* connection = connections[connectionIndex];
+		while (!connection->m_finished)
+		{
+			connection->interrupt();
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		connection->m_thread.join();
+		delete connection;
+	}
+
+	// The connections waited for their jobs, the queue is empty
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopWorkers = true;
+	}
+	m_jobQueued.notify_all();
+	for (size_t workerIndex = 0; workerIndex < m_workers.size(); workerIndex++)
+	{
+		m_workers[workerIndex].join();
+	}
+	m_workers.clear();
+
+	printf("Conversion server stopped\n");
+	return true;
+}
+
+void ConversionServer::connectionMain(Connection* connection)
+{
+	std::string request;
+	while (!m_shutdown && connection->readLine(request))
+	{
+		if (request.find_first_not_of(" \t") != std::string::npos)
+		{
+			handleRequest(connection, request);
+		}
+	}
+
+	// The queued jobs still report to the connection, it is only deleted once they finished
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobFinished.wait(lock, [connection] { return connection->m_numPendingJobs == 0; });
+	}
+	connection->m_finished = true;
+}
+
+void ConversionServer::handleRequest(Connection* connection, const std::string& request)
+{
+	std::map<std::string, std::string> values;
+	std::string error;
+	if (!parseJsonObject(request.c_str(), values, &error))
+	{
+		std::string message = beginEvent("", "error");
+		message += ", \"message\": ";
+		appendJsonString(message, ("Invalid request: " + error).c_str());
+		connection->send(message + "}");
+		return;
+	}
+
+	const std::string id = values.count("id") ? values["id"] : "";
+
+	if (values.count("command"))
+	{
+		const std::string& command = values["command"];
+		if (command == "ping")
+		{
+			connection->send(beginEvent(id, "pong") + "}");
+		}
+		else if (command == "shutdown")
+		{
+			connection->send(beginEvent(id, "shutdown") + "}");
+			requestShutdown();
+		}
+		else
+		{
+			std::string message = beginEvent(id, "error");
+			message += ", \"message\": ";
+			appendJsonString(message, ("Unknown command: " + command).c_str());
+			connection->send(message + "}");
+		}
+		return;
+	}
+
+	// The input bytes follow the request, they are read even if the request is rejected below
+	std::string inputData;
+	if (values.count("size"))
+	{
+		const long long size = atoll(values["size"].c_str());
+		if (size <= 0 || size > MAX_INPUT_SIZE)
+		{
+			std::string message = beginEvent(id, "error");
+			message += ", \"message\": \"Invalid input size\"";
+			connection->send(message + "}");
+			return;
+		}
+		if (!connection->readBytes((size_t)size, inputData))
+		{
+			return;
+		}
+	}
+
+	if (values["input"].empty())
+	{
+		std::string message = beginEvent(id, "error");
+		message += ", \"message\": \"Missing input\"";
+		connection->send(message + "}");
+		return;
+	}
+
+	// A smaller palette could not hold the bones of every triangle
+	const int maxSkinBones = atoi(values["bonePalette"].c_str());
+	if (maxSkinBones != 0 && maxSkinBones < MIN_SKIN_BONE_PALETTE)
+	{
+		std::string message = beginEvent(id, "error");
+		message += ", \"message\": \"Invalid bone palette\"";
+		connection->send(message + "}");
+		return;
+	}
+
+	QueuedJob* queuedJob = new QueuedJob;
+	queuedJob->m_connection = connection;
+	queuedJob->m_id = id;
+
+	ConversionJob& job = queuedJob->m_job;
+	// The input data may be large, it is handed over instead of copied
+	job.m_inputData.swap(inputData);
+	job.m_input = values["input"];
+	job.m_output = values["output"];
+	job.m_exportDataFolder = values["data"];
+	job.m_cacheFolder = values["cache"];
+	job.m_manifestFile = values["manifest"];
+	job.m_import = values["import"];
+	job.m_unitMeters = atof(values["units"].c_str());
+	job.m_maxSkinBones = maxSkinBones;
+	job.m_noTakes = (values["noTakes"] == "true");
+	job.m_singleContainer = (values["container"] == "true");
+
+	connection->send(beginEvent(id, "queued") + "}");
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		connection->m_numPendingJobs++;
+		m_jobQueue.push_back(queuedJob);
+	}
+	m_jobQueued.notify_one();
+}
+
+void ConversionServer::startWorkers()
+{
+	m_stopWorkers = false;
+	for (int workerIndex = 0; workerIndex < m_numWorkers; workerIndex++)
+	{
+		m_workers.push_back(std::thread(&ConversionServer::workerMain, this));
+	}
+}
+
+void ConversionServer::workerMain()
+{
+	// Every thread using Havok needs its own memory router, a worker keeps it for all its jobs
+	hkMemoryRouter memoryRouter;
+	hkMemorySystem::getInstance().threadInit(memoryRouter, "FBXImporter server worker");
+	hkBaseSystem::initThread(&memoryRouter);
+
+	void* workerData = m_startWorker ? m_startWorker() : NULL;
+
+	for (;;)
+	{
+		QueuedJob* queuedJob;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobQueued.wait(lock, [this] { return m_stopWorkers || !m_jobQueue.empty(); });
+			if (m_jobQueue.empty())
+			{
+				break;
+			}
+			queuedJob = m_jobQueue.front();
+			m_jobQueue.pop_front();
+		}
+
+		runJob(*queuedJob, workerData);
+
+		// The connection may be deleted as soon as its last job is no longer pending
+		Connection* connection = queuedJob->m_connection;
+		delete queuedJob;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			connection->m_numPendingJobs--;
+		}
+		m_jobFinished.notify_all();
+	}
+
+	if (m_stopWorker)
+	{
+		m_stopWorker(workerData);
+	}
+
+	hkBaseSystem::quitThread();
+	hkMemorySystem::getInstance().threadQuit(memoryRouter);
+}
+
+void ConversionServer::runJob(QueuedJob& queuedJob, void* workerData)
+{
+	Connection* connection = queuedJob.m_connection;
+	connection->send(beginEvent(queuedJob.m_id, "started") + "}");
+
+	JobReport report;
+	report.m_connection = connection;
+	report.m_id = &queuedJob.m_id;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const int result = m_convert(queuedJob.m_job, workerData, reportJobLine, &report);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	char fields[64];
+	sprintf(fields, ", \"result\": %d, \"seconds\": %0.3f}", result, seconds);
+	connection->send(beginEvent(queuedJob.m_id, "finished") + fields);
+}
+
+void ConversionServer::reportJobLine(const char* line, void* userData)
+{
+	const JobReport* report = static_cast<const JobReport*>(userData);
+
+	std::string text = line;
+	while (!text.empty() && (text[text.size() - 1] == '\n' || text[text.size() - 1] == '\r'))
+	{
+		text.erase(text.size() - 1);
+	}
+
+	std::string message = beginEvent(*report->m_id, "progress");
+	message += ", \"line\": ";
+	appendJsonString(message, text.c_str());
+	report->m_connection->send(message + "}");
+}
+
+void ConversionServer::requestShutdown()
+{
+	m_shutdown = true;
+
+	// Wake up the listener blocked waiting for the next client
+#ifdef _WIN32
+	HANDLE pipe = CreateFileA(m_address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (pipe != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(pipe);
+	}
+#else
+	const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (client >= 0)
+	{
+		sockaddr_un socketAddress;
+		memset(&socketAddress, 0, sizeof(socketAddress));
+		socketAddress.sun_family = AF_UNIX;
+		strncpy(socketAddress.sun_path, m_address.c_str(), sizeof(socketAddress.sun_path) - 1);
+		connect(client, (const sockaddr*)&socketAddress, sizeof(socketAddress));
+		::close(client);
+	}
+#endif
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,130 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_CONVERSIONSERVER
+#define HK_FBXTOHKX_CONVERSIONSERVER
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ConversionJob
+{
+	ConversionJob() : m_unitMeters(0.0), m_maxSkinBones(0), m_noTakes(false), m_singleContainer(false) {}
+
+	std::string m_input;
+	// Contents of the input if the client sent it with the request, empty to read the input file
+	std::string m_inputData;
+	std::string m_output;
+	std::string m_exportDataFolder;
+	std::string m_cacheFolder;
+	std::string m_manifestFile;
+	// Import options (see ImportOptions.h) applied on top of the server's, e.g. "lights=0,cameras=0"
+	std::string m_import;
+	// Length of an output unit in meters, 0 keeps the unit of the input
+	double m_unitMeters;
+	// Largest bone palette of a skinned mesh section (at least MIN_SKIN_BONE_PALETTE), 0 only splits skins of more
+	// than 256 bones
+	int m_maxSkinBones;
+	bool m_noTakes;
+	bool m_singleContainer;
+};
+
+// Keeps the process (Havok memory system, FBX SDK plugin registry) warm and serves conversion jobs over a local
+// named pipe (Windows, e.g. \\.\pipe\fbximporter) or Unix domain socket (e.g. /tmp/fbximporter.sock).
+//
+// The protocol is newline delimited JSON. Requests are flat objects:
+//   {"id": "1", "input": "C:/assets/a.fbx", "output": "...", "data": "...", "cache": "...", "manifest": "...", "import": "...", "units": 0.01, "bonePalette": 64, "noTakes": false, "container": false}
+//   {"command": "ping"}
+//   {"command": "shutdown"}
+// Only "input" is required for a job. A request with a "size" (in bytes) is followed by that many bytes of the input
+// file, which is converted from memory without a temporary file. "input" then only names the outputs:
+//   {"id": "2", "input": "C:/assets/b.fbx", "size": 1048576}\n<1048576 bytes>
+// Every job is answered with a stream of events carrying the job id:
+//   {"id": "1", "event": "queued"}
+//   {"id": "1", "event": "started"}
+//   {"id": "1", "event": "progress", "line": "Saved tag file: a.hkt"}   (the lines convert.py parses)
+//   {"id": "1", "event": "finished", "result": 0, "seconds": 0.42}
+// Jobs of all connections are queued and run by a fixed number of worker threads. A connection may send further
+// requests while its jobs are running.
+class ConversionServer
+{
+public:
+
+	typedef void (*ReportFunction)(const char* line, void* userData);
+	// Converts the job on the calling worker thread (which has Havok initialized), returns 0 on success. workerData is
+	// what the StartWorkerFunction returned on that thread.
+	typedef int (*ConvertFunction)(const ConversionJob& job, void* workerData, ReportFunction report, void* userData);
+	// Creates the state a worker thread reuses across its jobs (e.g. an FbxManager), and destroys it when it stops
+	typedef void* (*StartWorkerFunction)();
+	typedef void (*StopWorkerFunction)(void* workerData);
+
+	// numWorkers 0 uses one worker thread per hardware thread, the worker functions may be NULL
+	ConversionServer(ConvertFunction convert, int numWorkers, StartWorkerFunction startWorker = NULL, StopWorkerFunction stopWorker = NULL);
+	~ConversionServer();
+
+	// Serves requests until a shutdown request arrives. Returns false if the address can't be listened on.
+	bool run(const char* address);
+
+private:
+
+	class Connection;
+	struct QueuedJob;
+	struct JobReport;
+
+	ConversionServer(const ConversionServer&);
+	ConversionServer& operator=(const ConversionServer&);
+
+	void connectionMain(Connection* connection);
+	void handleRequest(Connection* connection, const std::string& request);
+	void startWorkers();
+	void workerMain();
+	void runJob(QueuedJob& queuedJob, void* workerData);
+	static void reportJobLine(const char* line, void* userData);
+
+	void requestShutdown();
+
+	ConvertFunction m_convert;
+	StartWorkerFunction m_startWorker;
+	StopWorkerFunction m_stopWorker;
+	int m_numWorkers;
+	std::string m_address;
+	std::atomic<bool> m_shutdown;
+
+	std::mutex m_mutex;
+	std::vector<Connection*> m_connections;
+	std::vector<std::thread> m_workers;
+	// Jobs waiting for a worker, in the order they were received
+	std::deque<QueuedJob*> m_jobQueue;
+	std::condition_variable m_jobQueued;
+	// Signalled whenever a job finished, for the connections waiting for their jobs
+	std::condition_variable m_jobFinished;
+	bool m_stopWorkers;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
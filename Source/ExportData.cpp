@@ -0,0 +1,572 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "ExportData.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Export data names are matched case-insensitively, the same as the Windows file system
+static std::string toExportDataKey(const std::string& name)
+{
+	std::string key(name);
+	for (size_t i = 0; i < key.size(); ++i)
+	{
+		key[i] = (char)tolower((unsigned char)key[i]);
+	}
+	return key;
+}
+
+static inline bool isExportDataSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Converts a whole zero terminated token, returns false if it is not a number or out of range
+static bool parseExportDataNumber(const char* token, int& valueOut)
+{
+	char* numberEnd;
+	errno = 0;
+	const long value = strtol(token, &numberEnd, 10);
+	if (numberEnd == token || *numberEnd != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+	{
+		return false;
+	}
+	valueOut = (int)value;
+	return true;
+}
+
+static bool parseExportDataNumber(const char* token, float& valueOut)
+{
+	char* numberEnd;
+	errno = 0;
+	const double value = strtod(token, &numberEnd);
+	if (numberEnd == token || *numberEnd != '\0' || errno == ERANGE)
+	{
+		return false;
+	}
+	valueOut = (float)value;
+	return true;
+}
+
+// Single pass tokenizer shared by the int and float loaders. Each token is copied to a small buffer on the stack to
+// zero terminate it for strtol/strtod (the mapped file isn't), so no per-line or per-token allocations are made.
+template<typename T>
+static bool parseExportDataValues(const char* filename, const char* data, size_t size, std::vector<T>& valuesOut)
+{
+	valuesOut.clear();
+
+	// Rough guess, indices and floats are typically several characters long
+	valuesOut.reserve(size / 4);
+
+	const char* cur = data;
+	const char* const end = data + size;
+	const char* lineStart = data;
+	int line = 1;
+
+	int numInvalid = 0;
+	int firstInvalidLine = 0;
+	int firstInvalidColumn = 0;
+	const char* firstInvalidToken = NULL;
+	int firstInvalidTokenLength = 0;
+
+	while (cur < end)
+	{
+		const char c = *cur;
+		if (c == '\n')
+		{
+			++cur;
+			++line;
+			lineStart = cur;
+			continue;
+		}
+		if (isExportDataSpace(c))
+		{
+			++cur;
+			continue;
+		}
+
+		// Comment lines, e.g. "# UV Indices per selected vertex"
+		if (c == '#' && cur == lineStart)
+		{
+			const char* eol = static_cast<const char*>(memchr(cur, '\n', end - cur));
+			cur = eol ? eol : end;
+			continue;
+		}
+
+		const char* tokenStart = cur;
+		while (cur < end && !isExportDataSpace(*cur))
+		{
+			++cur;
+		}
+
+		// Labels, e.g. "12:"
+		if (cur[-1] == ':')
+		{
+			continue;
+		}
+
+		// Longer tokens are no valid numbers anyway
+		char token[64];
+		const size_t tokenLength = cur - tokenStart;
+		T value;
+		bool valid = tokenLength < sizeof(token);
+		if (valid)
+		{
+			memcpy(token, tokenStart, tokenLength);
+			token[tokenLength] = '\0';
+			valid = parseExportDataNumber(token, value);
+		}
+		if (valid)
+		{
+			valuesOut.push_back(value);
+		}
+		else
+		{
+			if (numInvalid == 0)
+			{
+				firstInvalidLine = line;
+				firstInvalidColumn = (int)(tokenStart - lineStart) + 1;
+				firstInvalidToken = tokenStart;
+				firstInvalidTokenLength = (int)(cur - tokenStart);
+			}
+			++numInvalid;
+		}
+	}
+
+	if (numInvalid > 0)
+	{
+		printf("%s:%d:%d: Invalid number: %.*s (%d invalid value(s) skipped)\n",
+			filename, firstInvalidLine, firstInvalidColumn, firstInvalidTokenLength, firstInvalidToken, numInvalid);
+		return false;
+	}
+
+	return true;
+}
+
+template<typename T>
+static bool loadExportDataValues(const char* filename, std::vector<T>& valuesOut)
+{
+	MappedFile file;
+	if (!file.open(filename, MappedFile::ACCESS_SEQUENTIAL))
+	{
+		printf("Failed to open file: %s\n", filename);
+		valuesOut.clear();
+		return false;
+	}
+
+	return parseExportDataValues(filename, reinterpret_cast<const char*>(file.getData()), file.getSize(), valuesOut);
+}
+
+bool parseExportDataInts(const char* filename, const char* data, size_t size, std::vector<int>& valuesOut)
+{
+	return parseExportDataValues(filename, data, size, valuesOut);
+}
+
+bool parseExportDataFloats(const char* filename, const char* data, size_t size, std::vector<float>& valuesOut)
+{
+	return parseExportDataValues(filename, data, size, valuesOut);
+}
+
+bool loadExportDataInts(const char* filename, std::vector<int>& valuesOut)
+{
+	return loadExportDataValues(filename, valuesOut);
+}
+
+bool loadExportDataFloats(const char* filename, std::vector<float>& valuesOut)
+{
+	return loadExportDataValues(filename, valuesOut);
+}
+
+//-------
+
+static inline size_t alignExportDataSize(size_t size)
+{
+	return (size + 3) & ~(size_t)3;
+}
+
+bool ExportDataMeshChannels::loadBinary(const char* filename, const char* meshName)
+{
+	if (!m_file.open(filename, MappedFile::ACCESS_SEQUENTIAL))
+	{
+		return false;
+	}
+
+	const char* const data = reinterpret_cast<const char*>(m_file.getData());
+	const size_t size = m_file.getSize();
+
+	std::vector<ExportDataChannel> selectionSets;
+	std::vector<ExportDataChannel> floatChannels;
+
+	size_t offset = 0;
+	if (size < sizeof(ExportDataBinaryHeader))
+	{
+		printf("%s: Truncated export data header\n", filename);
+		m_file.close();
+		return false;
+	}
+
+	const ExportDataBinaryHeader* header = reinterpret_cast<const ExportDataBinaryHeader*>(data);
+	if (header->m_magic != ExportDataBinaryHeader::MAGIC || header->m_version != ExportDataBinaryHeader::CURRENT_VERSION)
+	{
+		printf("%s: Not an export data file, or unsupported version %u (expected %u)\n", filename, header->m_version, (unsigned)ExportDataBinaryHeader::CURRENT_VERSION);
+		m_file.close();
+		return false;
+	}
+	offset += sizeof(ExportDataBinaryHeader);
+
+	if (offset + header->m_meshNameLength > size)
+	{
+		printf("%s: Truncated mesh name\n", filename);
+		m_file.close();
+		return false;
+	}
+	if (meshName && toExportDataKey(std::string((const char*)data + offset, header->m_meshNameLength)) != toExportDataKey(meshName))
+	{
+		printf("%s: Mesh name mismatch, expected %s\n", filename, meshName);
+		m_file.close();
+		return false;
+	}
+	offset += alignExportDataSize(header->m_meshNameLength);
+
+	for (unsigned int channelIndex = 0; channelIndex < header->m_numChannels; ++channelIndex)
+	{
+		if (offset + sizeof(ExportDataBinaryChannel) > size)
+		{
+			printf("%s: Truncated header of channel %u\n", filename, channelIndex);
+			m_file.close();
+			return false;
+		}
+
+		const ExportDataBinaryChannel* channelHeader = reinterpret_cast<const ExportDataBinaryChannel*>(data + offset);
+		offset += sizeof(ExportDataBinaryChannel);
+
+		const size_t payloadOffset = offset + alignExportDataSize(channelHeader->m_nameLength);
+		const size_t payloadSize = (size_t)channelHeader->m_count * 4;
+		if (payloadOffset > size || payloadSize > size - payloadOffset)
+		{
+			printf("%s: Truncated data of channel %u\n", filename, channelIndex);
+			m_file.close();
+			return false;
+		}
+
+		const bool isSelectionSet = (channelHeader->m_kind == ExportDataBinaryChannel::KIND_SELECTION_SET && channelHeader->m_dataType == ExportDataBinaryChannel::DATATYPE_INT32);
+		const bool isFloatChannel = (channelHeader->m_kind == ExportDataBinaryChannel::KIND_FLOAT_CHANNEL && channelHeader->m_dataType == ExportDataBinaryChannel::DATATYPE_FLOAT32);
+		if (!isSelectionSet && !isFloatChannel)
+		{
+			printf("%s: Channel %u has unsupported kind %d / datatype %d, skipping it\n", filename, channelIndex, channelHeader->m_kind, channelHeader->m_dataType);
+		}
+		else
+		{
+			ExportDataChannel channel;
+			channel.m_name.assign(data + offset, channelHeader->m_nameLength);
+			channel.m_floatDimensions = channelHeader->m_floatDimensions;
+			channel.m_mappedValues = data + payloadOffset;
+			channel.m_numMappedValues = (int)channelHeader->m_count;
+
+			(isSelectionSet ? selectionSets : floatChannels).push_back(channel);
+		}
+
+		offset = payloadOffset + payloadSize;
+	}
+
+	m_selectionSets.insert(m_selectionSets.end(), selectionSets.begin(), selectionSets.end());
+	m_floatChannels.insert(m_floatChannels.end(), floatChannels.begin(), floatChannels.end());
+	return true;
+}
+
+bool ExportDataMeshChannels::loadSelectionSetText(const char* filename, const char* channelName)
+{
+	m_selectionSets.push_back(ExportDataChannel());
+	ExportDataChannel& channel = m_selectionSets.back();
+	channel.m_name = channelName;
+
+	return loadExportDataInts(filename, channel.m_indices);
+}
+
+bool ExportDataMeshChannels::loadFloatChannelText(const char* filename, const char* channelName)
+{
+	m_floatChannels.push_back(ExportDataChannel());
+	ExportDataChannel& channel = m_floatChannels.back();
+	channel.m_name = channelName;
+
+	const bool result = loadExportDataFloats(filename, channel.m_floats);
+	if (channel.m_floats.empty())
+	{
+		printf("%s: Missing float channel datatype\n", filename);
+		return false;
+	}
+
+	// The first entry is the enum for the data type (FLOAT/DISTANCE/ANGLE)
+	const float enumSwitch = channel.m_floats[0];
+	channel.m_floatDimensions = (int)enumSwitch;
+	if (enumSwitch != 0.f && enumSwitch != 1.f && enumSwitch != 2.f)
+	{
+		printf("Error: invalid value for hkxVertexFloatDataChannel enum datatype: %f, valid values are 0.0, 1.0, 2.0 \r\n", enumSwitch);
+		channel.m_floatDimensions = -1;
+	}
+	channel.m_floats.erase(channel.m_floats.begin());
+
+	return result;
+}
+
+//-------
+
+ExportDataIndex::ExportDataIndex() :
+	m_nextPrefetchFile(0)
+{
+}
+
+ExportDataIndex::~ExportDataIndex()
+{
+	waitForPrefetch();
+}
+
+void ExportDataIndex::build(const char* exportDataFolder)
+{
+	waitForPrefetch();
+	m_files.clear();
+	m_meshes.clear();
+	m_nextPrefetchFile = 0;
+
+	std::string path(exportDataFolder && exportDataFolder[0] ? exportDataFolder : ".");
+	if (getFileName(path).empty())
+	{
+		// Trailing separator
+		path = getParentPath(path);
+	}
+	if (toExportDataKey(getFileName(path)) != "export_data")
+	{
+		path = joinPath(path, "export_data");
+	}
+	m_path = path;
+
+	if (!isDirectory(path.c_str()))
+	{
+		printf("Extra export/mesh data not found in %s, there will be no hkxSelectionSets or hkxFloatDataChannels\n", m_path.c_str());
+		return;
+	}
+
+	// Binary sidecars, one per mesh
+	const std::string channelsFolder = joinPath(path, "channels");
+	std::vector<std::string> names;
+	listFiles(channelsFolder.c_str(), names);
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		if (toExportDataKey(getExtension(names[i])) != ".bin")
+		{
+			continue;
+		}
+
+		File file;
+		file.m_path = joinPath(channelsFolder, names[i]);
+		file.m_meshName = getStem(names[i]);
+		file.m_kind = FILE_BINARY;
+		file.m_state = FILE_PENDING;
+
+		m_meshes[toExportDataKey(file.m_meshName)].m_binaryFile = (int)m_files.size();
+		m_files.push_back(file);
+	}
+
+	addTextFiles(joinPath(path, "selectionsets"), FILE_SELECTION_SET);
+	addTextFiles(joinPath(path, "floatchannels"), FILE_FLOAT_CHANNEL);
+
+	printf("Indexed %d export data file(s) in %s\n", (int)m_files.size(), m_path.c_str());
+}
+
+void ExportDataIndex::addTextFiles(const std::string& folder, FileKind kind)
+{
+	// Sorted, so channels are always added in the same order
+	std::vector<std::string> filenames;
+	listFiles(folder.c_str(), filenames);
+
+	for (size_t i = 0; i < filenames.size(); ++i)
+	{
+		if (toExportDataKey(getExtension(filenames[i])) != ".txt")
+		{
+			continue;
+		}
+		const std::string stem = getStem(filenames[i]);
+
+		File file;
+		file.m_path = joinPath(folder, filenames[i]);
+		file.m_kind = kind;
+		file.m_state = FILE_PENDING;
+
+		const int fileIndex = (int)m_files.size();
+		m_files.push_back(file);
+
+		// <meshname>_groupname.txt = groupname, where either part may contain underscores
+		for (size_t separator = stem.find('_'); separator != std::string::npos; separator = stem.find('_', separator + 1))
+		{
+			m_meshes[toExportDataKey(stem.substr(0, separator))].m_textFiles.push_back(fileIndex);
+		}
+	}
+}
+
+const ExportDataMeshChannels* ExportDataIndex::loadFile(int fileIndex)
+{
+	File& file = m_files[fileIndex];
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (file.m_state == FILE_LOADING)
+		{
+			m_fileLoaded.wait(lock);
+		}
+		if (file.m_state == FILE_LOADED)
+		{
+			return file.m_channels.get();
+		}
+		file.m_state = FILE_LOADING;
+	}
+
+	std::shared_ptr<ExportDataMeshChannels> channels = std::make_shared<ExportDataMeshChannels>();
+	if (file.m_kind == FILE_BINARY)
+	{
+		if (!channels->loadBinary(file.m_path.c_str(), file.m_meshName.c_str()))
+		{
+			channels.reset();
+		}
+	}
+	else
+	{
+		// The channel name depends on which mesh the file is looked up for, so it's assigned by getMeshChannels()
+		if (file.m_kind == FILE_SELECTION_SET)
+		{
+			channels->loadSelectionSetText(file.m_path.c_str(), "");
+		}
+		else
+		{
+			channels->loadFloatChannelText(file.m_path.c_str(), "");
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		file.m_channels = channels;
+		file.m_state = FILE_LOADED;
+	}
+	m_fileLoaded.notify_all();
+
+	return channels.get();
+}
+
+void ExportDataIndex::prefetchThreadMain()
+{
+	for (;;)
+	{
+		int fileIndex;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_nextPrefetchFile >= (int)m_files.size())
+			{
+				return;
+			}
+			fileIndex = m_nextPrefetchFile++;
+		}
+
+		loadFile(fileIndex);
+	}
+}
+
+void ExportDataIndex::prefetch(int numThreads)
+{
+	numThreads = std::min(numThreads, (int)m_files.size());
+	for (int i = 0; i < numThreads; ++i)
+	{
+		m_threads.push_back(std::thread(&ExportDataIndex::prefetchThreadMain, this));
+	}
+}
+
+void ExportDataIndex::waitForPrefetch()
+{
+	for (size_t i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+}
+
+bool ExportDataIndex::getMeshChannels(const char* meshName, ExportDataMeshView& viewOut)
+{
+	viewOut.m_selectionSets.clear();
+	viewOut.m_floatChannels.clear();
+	viewOut.m_files.clear();
+
+	std::unordered_map<std::string, MeshFiles>::const_iterator it = m_meshes.find(toExportDataKey(meshName));
+	if (it == m_meshes.end())
+	{
+		return false;
+	}
+	const MeshFiles& meshFiles = it->second;
+
+	if (meshFiles.m_binaryFile >= 0)
+	{
+		const ExportDataMeshChannels* channels = loadFile(meshFiles.m_binaryFile);
+		if (channels)
+		{
+			viewOut.m_files.push_back(m_files[meshFiles.m_binaryFile].m_channels);
+			for (size_t i = 0; i < channels->m_selectionSets.size(); ++i)
+			{
+				ExportDataMeshView::Channel channel = { channels->m_selectionSets[i].m_name, &channels->m_selectionSets[i] };
+				viewOut.m_selectionSets.push_back(channel);
+			}
+			for (size_t i = 0; i < channels->m_floatChannels.size(); ++i)
+			{
+				ExportDataMeshView::Channel channel = { channels->m_floatChannels[i].m_name, &channels->m_floatChannels[i] };
+				viewOut.m_floatChannels.push_back(channel);
+			}
+			return true;
+		}
+	}
+
+	// Text files hold a single channel, named by the rest of the filename after "<meshname>_"
+	const size_t prefixLength = strlen(meshName) + 1;
+	for (size_t i = 0; i < meshFiles.m_textFiles.size(); ++i)
+	{
+		const int fileIndex = meshFiles.m_textFiles[i];
+		const ExportDataMeshChannels* channels = loadFile(fileIndex);
+		const File& file = m_files[fileIndex];
+
+		const bool isSelectionSet = (file.m_kind == FILE_SELECTION_SET);
+		const std::vector<ExportDataChannel>& fileChannels = isSelectionSet ? channels->m_selectionSets : channels->m_floatChannels;
+		if (fileChannels.empty())
+		{
+			continue;
+		}
+
+		ExportDataMeshView::Channel channel = { getStem(file.m_path).substr(prefixLength), &fileChannels[0] };
+		(isSelectionSet ? viewOut.m_selectionSets : viewOut.m_floatChannels).push_back(channel);
+		viewOut.m_files.push_back(file.m_channels);
+	}
+
+	return viewOut.getNumChannels() > 0;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,217 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_EXPORTDATA
+#define HK_FBXTOHKX_EXPORTDATA
+
+#include "MappedFile.h"
+
+#include <stddef.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Parses the whitespace separated values of a selection set (vertex indices) or float channel sidecar file.
+// Lines starting with '#' and tokens ending with ':' (labels) are skipped. Invalid tokens are skipped as well,
+// the first one is reported with its line and column. Returns false if the file could not be read or contained
+// invalid tokens.
+bool loadExportDataInts(const char* filename, std::vector<int>& valuesOut);
+bool loadExportDataFloats(const char* filename, std::vector<float>& valuesOut);
+
+// Same as above, parsing from a buffer that's already in memory. The filename is only used for error reporting.
+bool parseExportDataInts(const char* filename, const char* data, size_t size, std::vector<int>& valuesOut);
+bool parseExportDataFloats(const char* filename, const char* data, size_t size, std::vector<float>& valuesOut);
+
+// Binary sidecar format, one file per mesh holding all of its channels (export_data/channels/<mesh>.bin).
+// All values are little endian and every block starts at a 4 byte aligned offset, so payloads can be
+// read straight from the mapped file.
+//
+//   ExportDataBinaryHeader
+//   mesh name (m_meshNameLength bytes, zero padded to a multiple of 4)
+//   m_numChannels times:
+//     ExportDataBinaryChannel
+//     channel name (m_nameLength bytes, zero padded to a multiple of 4)
+//     m_count int32 or float32 values
+struct ExportDataBinaryHeader
+{
+	enum { MAGIC = 0x43584B48 /* "HKXC" */, CURRENT_VERSION = 1 };
+
+	unsigned int m_magic;
+	unsigned int m_version;
+	unsigned int m_numChannels;
+	unsigned int m_meshNameLength;
+};
+
+struct ExportDataBinaryChannel
+{
+	enum Kind { KIND_SELECTION_SET = 0, KIND_FLOAT_CHANNEL = 1 };
+	enum DataType { DATATYPE_INT32 = 0, DATATYPE_FLOAT32 = 1 };
+
+	unsigned char m_kind;
+	unsigned char m_dataType;
+	// hkxVertexFloatDataChannel::VertexFloatDimensions of float channels (FLOAT, DISTANCE or ANGLE)
+	unsigned char m_floatDimensions;
+	unsigned char m_padding;
+	unsigned int m_nameLength;
+	unsigned int m_count;
+	unsigned int m_reserved;
+};
+
+// A vertex selection set or float channel of a mesh. Values either point into a mapped binary sidecar, or are
+// owned by the channel when they were parsed from a text file.
+struct ExportDataChannel
+{
+	ExportDataChannel() : m_floatDimensions(0), m_mappedValues(NULL), m_numMappedValues(0) {}
+
+	int getCount() const { return m_mappedValues ? m_numMappedValues : (int)(m_indices.size() + m_floats.size()); }
+	const int* getIndices() const { return m_mappedValues ? static_cast<const int*>(m_mappedValues) : m_indices.data(); }
+	const float* getFloats() const { return m_mappedValues ? static_cast<const float*>(m_mappedValues) : m_floats.data(); }
+
+	std::string m_name;
+	int m_floatDimensions;
+
+	const void* m_mappedValues;
+	int m_numMappedValues;
+
+	std::vector<int> m_indices;
+	std::vector<float> m_floats;
+};
+
+// All user channels of a single mesh, selection sets first, in the order they are added to the hkxMesh
+class ExportDataMeshChannels
+{
+public:
+
+	// Maps a binary sidecar file and sets up views onto its channels. Returns false if the file doesn't exist
+	// or is invalid, in which case the text files should be used instead.
+	bool loadBinary(const char* filename, const char* meshName);
+
+	// Adds a channel parsed from a text file. The first value of a float channel text file is its dimensions
+	// enum, which is moved into m_floatDimensions.
+	bool loadSelectionSetText(const char* filename, const char* channelName);
+	bool loadFloatChannelText(const char* filename, const char* channelName);
+
+	int getNumChannels() const { return (int)(m_selectionSets.size() + m_floatChannels.size()); }
+
+	std::vector<ExportDataChannel> m_selectionSets;
+	std::vector<ExportDataChannel> m_floatChannels;
+
+private:
+
+	MappedFile m_file;
+};
+
+// Channels of a single mesh gathered from an ExportDataIndex, selection sets first. Keeps the files they were
+// loaded from alive.
+struct ExportDataMeshView
+{
+	struct Channel
+	{
+		std::string m_name;
+		const ExportDataChannel* m_channel;
+	};
+
+	int getNumChannels() const { return (int)(m_selectionSets.size() + m_floatChannels.size()); }
+
+	std::vector<Channel> m_selectionSets;
+	std::vector<Channel> m_floatChannels;
+	std::vector< std::shared_ptr<const ExportDataMeshChannels> > m_files;
+};
+
+// Index of an export_data folder, built with a single scan of its selectionsets, floatchannels and channels
+// subfolders. Files are loaded at most once, either on demand or ahead of time by prefetch() on a few background
+// threads, so the sidecar I/O can overlap with the FBX import.
+class ExportDataIndex
+{
+public:
+
+	ExportDataIndex();
+	~ExportDataIndex();
+
+	// Scans the folder. If the path doesn't end in "export_data" that subfolder is used instead.
+	void build(const char* exportDataFolder);
+
+	// Starts loading every indexed file on numThreads background threads
+	void prefetch(int numThreads);
+
+	// Waits for the background threads to finish
+	void waitForPrefetch();
+
+	// Collects all channels of the mesh, loading (or waiting for) its files as needed. A binary sidecar takes
+	// precedence over text files. Returns false if there is no export data for the mesh.
+	bool getMeshChannels(const char* meshName, ExportDataMeshView& viewOut);
+
+	const std::string& getPath() const { return m_path; }
+
+	// Indexed files, in scan order
+	int getNumFiles() const { return (int)m_files.size(); }
+	const std::string& getFilePath(int fileIndex) const { return m_files[fileIndex].m_path; }
+
+private:
+
+	ExportDataIndex(const ExportDataIndex&);
+	ExportDataIndex& operator=(const ExportDataIndex&);
+
+	enum FileKind { FILE_BINARY, FILE_SELECTION_SET, FILE_FLOAT_CHANNEL };
+	enum FileState { FILE_PENDING, FILE_LOADING, FILE_LOADED };
+
+	struct File
+	{
+		std::string m_path;
+		std::string m_meshName;
+		std::string m_channelName;
+		FileKind m_kind;
+		FileState m_state;
+		std::shared_ptr<const ExportDataMeshChannels> m_channels;
+	};
+
+	struct MeshFiles
+	{
+		MeshFiles() : m_binaryFile(-1) {}
+
+		int m_binaryFile;
+		std::vector<int> m_textFiles;
+	};
+
+	void addTextFiles(const std::string& folder, FileKind kind);
+	const ExportDataMeshChannels* loadFile(int fileIndex);
+	void prefetchThreadMain();
+
+	std::string m_path;
+	std::vector<File> m_files;
+	// Text files are registered under every "<mesh>_" prefix of their name, mirroring a "<mesh>_*.txt" wildcard.
+	// Keys are lower case, so meshes match their files regardless of case like the wildcard did on Windows
+	std::unordered_map<std::string, MeshFiles> m_meshes;
+
+	std::mutex m_mutex;
+	std::condition_variable m_fileLoaded;
+	int m_nextPrefetchFile;
+	std::vector<std::thread> m_threads;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
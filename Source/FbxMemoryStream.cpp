@@ -0,0 +1,155 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "FbxMemoryStream.h"
+
+#include <string.h>
+
+FbxMemoryStream::FbxMemoryStream(FbxManager* fbxSdkManager) :
+	m_fbxSdkManager(fbxSdkManager), m_data(NULL), m_size(0), m_position(0), m_error(0), m_state(eClosed), m_readerId(-1)
+{
+}
+
+bool FbxMemoryStream::openFile(const char* filename)
+{
+	if (!m_file.open(filename, MappedFile::ACCESS_SEQUENTIAL))
+	{
+		return false;
+	}
+	m_data = m_file.getData();
+	m_size = m_file.getSize();
+	detectReader();
+	return true;
+}
+
+void FbxMemoryStream::setBuffer(const void* data, size_t size)
+{
+	m_file.close();
+	m_data = static_cast<const unsigned char*>(data);
+	m_size = size;
+	detectReader();
+}
+
+void FbxMemoryStream::detectReader()
+{
+	static const char binaryHeader[] = "Kaydara FBX Binary";
+	const bool binary = (m_size >= sizeof(binaryHeader) - 1 && memcmp(m_data, binaryHeader, sizeof(binaryHeader) - 1) == 0);
+
+	FbxIOPluginRegistry* registry = m_fbxSdkManager->GetIOPluginRegistry();
+	m_readerId = registry->FindReaderIDByDescription(binary ? "FBX binary (*.fbx)" : "FBX ascii (*.fbx)");
+	if (m_readerId < 0)
+	{
+		m_readerId = registry->GetNativeReaderFormat();
+	}
+}
+
+FbxStream::EState FbxMemoryStream::GetState()
+{
+	return m_state;
+}
+
+// The importer opens and closes the stream more than once (to read the header, then to import), the data stays
+// available until the stream is destroyed
+bool FbxMemoryStream::Open(void* /*streamData*/)
+{
+	m_position = 0;
+	m_error = 0;
+	m_state = (m_size > 0) ? eOpen : eEmpty;
+	return m_data != NULL;
+}
+
+bool FbxMemoryStream::Close()
+{
+	m_position = 0;
+	m_state = eClosed;
+	return true;
+}
+
+bool FbxMemoryStream::Flush()
+{
+	return true;
+}
+
+size_t FbxMemoryStream::Write(const void* /*data*/, FbxUInt64 /*size*/)
+{
+	m_error = 1;
+	return 0;
+}
+
+size_t FbxMemoryStream::Read(void* data, FbxUInt64 size) const
+{
+	const size_t available = m_size - m_position;
+	const size_t numRead = (size < available) ? (size_t)size : available;
+	memcpy(data, m_data + m_position, numRead);
+	m_position += numRead;
+	return numRead;
+}
+
+int FbxMemoryStream::GetReaderID() const
+{
+	return m_readerId;
+}
+
+int FbxMemoryStream::GetWriterID() const
+{
+	return -1;
+}
+
+void FbxMemoryStream::Seek(const FbxInt64& offset, const FbxFile::ESeekPos& seekPos)
+{
+	FbxInt64 position = offset;
+	switch (seekPos)
+	{
+	case FbxFile::eCurrent: position += (FbxInt64)m_position; break;
+	case FbxFile::eEnd: position += (FbxInt64)m_size; break;
+	default: break;
+	}
+	SetPosition(position);
+}
+
+FbxInt64 FbxMemoryStream::GetPosition() const
+{
+	return (FbxInt64)m_position;
+}
+
+void FbxMemoryStream::SetPosition(FbxInt64 position)
+{
+	if (position < 0 || position > (FbxInt64)m_size)
+	{
+		m_error = 1;
+		position = (position < 0) ? 0 : (FbxInt64)m_size;
+	}
+	m_position = (size_t)position;
+}
+
+int FbxMemoryStream::GetError() const
+{
+	return m_error;
+}
+
+void FbxMemoryStream::ClearError()
+{
+	m_error = 0;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,87 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_FBXMEMORYSTREAM
+#define HK_FBXTOHKX_FBXMEMORYSTREAM
+
+#define FBXSDK_NEW_API
+
+#pragma warning(push,3)
+#include <fbxsdk.h>
+#pragma warning(pop)
+
+#include "MappedFile.h"
+
+// An FbxStream over bytes in memory, for FbxImporter::Initialize(FbxStream*, ...): either a file mapped with
+// sequential access hints (openFile), or a buffer the caller keeps alive while importing (setBuffer), e.g. a file
+// pulled from an archive or received by the conversion server. The SDK then reads from memory instead of issuing
+// its own small buffered reads, which dominate the import time on network shares.
+//
+// The stream is read only. The reader (binary or ASCII FBX) is picked from the header of the data.
+class FbxMemoryStream : public FbxStream
+{
+public:
+
+	explicit FbxMemoryStream(FbxManager* fbxSdkManager);
+
+	// Returns false if the file cannot be mapped
+	bool openFile(const char* filename);
+	// The data is not copied
+	void setBuffer(const void* data, size_t size);
+
+	// FbxStream
+	virtual EState GetState();
+	virtual bool Open(void* streamData);
+	virtual bool Close();
+	virtual bool Flush();
+	virtual size_t Write(const void* data, FbxUInt64 size);
+	virtual size_t Read(void* data, FbxUInt64 size) const;
+	virtual int GetReaderID() const;
+	virtual int GetWriterID() const;
+	virtual void Seek(const FbxInt64& offset, const FbxFile::ESeekPos& seekPos);
+	virtual FbxInt64 GetPosition() const;
+	virtual void SetPosition(FbxInt64 position);
+	virtual int GetError() const;
+	virtual void ClearError();
+
+private:
+
+	FbxMemoryStream(const FbxMemoryStream&);
+	FbxMemoryStream& operator=(const FbxMemoryStream&);
+
+	void detectReader();
+
+	FbxManager* m_fbxSdkManager;
+	MappedFile m_file;
+	const unsigned char* m_data;
+	size_t m_size;
+	// Read() is const in the FbxStream interface
+	mutable size_t m_position;
+	mutable int m_error;
+	EState m_state;
+	int m_readerId;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
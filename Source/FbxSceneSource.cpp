@@ -0,0 +1,561 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "FbxSceneSource.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Reads an axis of the global settings as stored in the file (UpAxis and UpAxisSign, ...), keeps the given one if
+	// it is missing
+	void readAxis(const FbxGlobalSettings& settings, const char* axisName, const char* signName, SceneSource::Axis& axisInOut)
+	{
+		const FbxProperty axisProperty = settings.FindProperty(axisName);
+		const FbxProperty signProperty = settings.FindProperty(signName);
+		if (axisProperty.IsValid() && signProperty.IsValid())
+		{
+			const int axis = axisProperty.Get<FbxInt>();
+			if (axis >= 0 && axis < 3)
+			{
+				axisInOut = (SceneSource::Axis)(axis * 2 + ((signProperty.Get<FbxInt>() < 0) ? 1 : 0));
+			}
+		}
+	}
+
+	// Resolves the mapping and reference mode of a layer element to the value of a triangle corner
+	template<typename ElementType, typename ValueType>
+	bool getCornerValue(const ElementType* element, int controlPoint, int corner, ValueType& valueOut)
+	{
+		int index;
+		switch (element->GetMappingMode())
+		{
+		case FbxGeometryElement::eByControlPoint:
+			index = controlPoint;
+			break;
+		case FbxGeometryElement::eByPolygonVertex:
+			index = corner;
+			break;
+		default:
+			// Per polygon and single values are not supported for vertex data
+			return false;
+		}
+
+		switch (element->GetReferenceMode())
+		{
+		case FbxGeometryElement::eDirect:
+			valueOut = element->GetDirectArray().GetAt(index);
+			return true;
+		case FbxGeometryElement::eIndexToDirect:
+			valueOut = element->GetDirectArray().GetAt(element->GetIndexArray().GetAt(index));
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void convertColor(const FbxPropertyT<FbxDouble3>& property, float alpha, float* colorOut)
+	{
+		const FbxDouble3 color = property.Get();
+		colorOut[0] = (float)color[0];
+		colorOut[1] = (float)color[1];
+		colorOut[2] = (float)color[2];
+		colorOut[3] = alpha;
+	}
+
+	void readTexture(FbxSurfaceMaterial* material, const char* propertyName, SceneTexture::Usage usage, std::vector<SceneTexture>& texturesOut)
+	{
+		FbxProperty property = material->FindProperty(propertyName);
+		FbxFileTexture* fileTexture = property.IsValid() ? property.GetSrcObject<FbxFileTexture>(0) : NULL;
+		if (fileTexture)
+		{
+			SceneTexture texture;
+			texture.m_usage = usage;
+			texture.m_name = fileTexture->GetName();
+			texture.m_fileName = fileTexture->GetFileName();
+			texture.m_uvSetName = fileTexture->UVSet.Get().Buffer();
+			texturesOut.push_back(texture);
+		}
+	}
+
+	// Phong and Lambert materials, like FbxToHkxConverter::createMaterial()
+	void readMaterial(FbxSurfaceMaterial* fbxMaterial, SceneMaterial& materialOut)
+	{
+		materialOut.m_id = (long long)fbxMaterial->GetUniqueID();
+		materialOut.m_name = fbxMaterial->GetName();
+
+		if (fbxMaterial->GetClassId().Is(FbxSurfacePhong::ClassId))
+		{
+			FbxSurfacePhong* phong = (FbxSurfacePhong*)fbxMaterial;
+			const float transparency = 1.0f - (float)phong->TransparencyFactor.Get();
+
+			convertColor(phong->Ambient, 0.f, materialOut.m_ambient);
+			convertColor(phong->Diffuse, transparency, materialOut.m_diffuse);
+			convertColor(phong->Specular, transparency, materialOut.m_specular);
+			convertColor(phong->Emissive, 0.f, materialOut.m_emissive);
+			materialOut.m_specularExponent = (float)phong->Shininess.Get();
+			materialOut.m_specularMultiplier = (float)phong->SpecularFactor.Get();
+		}
+		else if (fbxMaterial->GetClassId().Is(FbxSurfaceLambert::ClassId))
+		{
+			FbxSurfaceLambert* lambert = (FbxSurfaceLambert*)fbxMaterial;
+			const float transparency = (float)lambert->TransparencyFactor.Get();
+
+			convertColor(lambert->Ambient, 0.f, materialOut.m_ambient);
+			convertColor(lambert->Diffuse, transparency, materialOut.m_diffuse);
+			convertColor(lambert->Emissive, 0.f, materialOut.m_emissive);
+		}
+
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sDiffuse, SceneTexture::DIFFUSE, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sSpecular, SceneTexture::SPECULAR, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sEmissive, SceneTexture::EMISSIVE, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sBump, SceneTexture::BUMP, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sDisplacementFactor, SceneTexture::DISPLACEMENT, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sNormalMap, SceneTexture::NORMAL, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sReflection, SceneTexture::REFLECTION, materialOut.m_textures);
+		readTexture(fbxMaterial, FbxSurfaceMaterial::sTransparencyFactor, SceneTexture::OPACITY, materialOut.m_textures);
+
+		materialOut.m_transparent = fbxMaterial->FindProperty(FbxSurfaceMaterial::sTransparencyFactor).IsValid();
+	}
+
+	void copyMatrix(const FbxAMatrix& matrix, double* matrixOut)
+	{
+		// The rows of the FBX matrix are the columns of the Havok one
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				matrixOut[row * 4 + column] = matrix.Get(row, column);
+			}
+		}
+	}
+
+	// The targets of the blend shape deformers of a mesh whose control points are those of meshOut. Per corner normals
+	// are only read if the mesh is the triangulated one, the corners of the original polygons are numbered differently.
+	void readBlendShapes(FbxMesh* mesh, bool triangulated, const FbxAMatrix& geometricTransform, SceneMesh& meshOut)
+	{
+		const int numControlPoints = meshOut.getNumControlPoints();
+		const int numCorners = (int)meshOut.m_triangles.size();
+		const FbxVector4* controlPoints = mesh->GetControlPoints();
+
+		const int numBlendShapes = mesh->GetDeformerCount(FbxDeformer::eBlendShape);
+		for (int blendShapeIndex = 0; blendShapeIndex < numBlendShapes; blendShapeIndex++)
+		{
+			FbxBlendShape* blendShape = (FbxBlendShape*)mesh->GetDeformer(blendShapeIndex, FbxDeformer::eBlendShape);
+			for (int channelIndex = 0; channelIndex < blendShape->GetBlendShapeChannelCount(); channelIndex++)
+			{
+				FbxBlendShapeChannel* channel = blendShape->GetBlendShapeChannel(channelIndex);
+				const double* fullWeights = channel->GetTargetShapeFullWeights();
+				for (int targetIndex = 0; targetIndex < channel->GetTargetShapeCount(); targetIndex++)
+				{
+					FbxShape* target = channel->GetTargetShape(targetIndex);
+					meshOut.m_blendShapes.push_back(SceneBlendShape());
+					SceneBlendShape& shapeOut = meshOut.m_blendShapes.back();
+					shapeOut.m_name = (target->GetName()[0] != '\0') ? target->GetName() : channel->GetName();
+					shapeOut.m_channelName = channel->GetName();
+					shapeOut.m_fullWeight = fullWeights ? (float)(fullWeights[targetIndex] * 0.01) : 1.f;
+
+					// The targets store every control point, only the ones that move are kept
+					const int numTargetPoints = std::min(target->GetControlPointsCount(), numControlPoints);
+					const FbxVector4* targetPoints = target->GetControlPoints();
+					for (int controlPoint = 0; controlPoint < numTargetPoints; controlPoint++)
+					{
+						const FbxVector4 delta = geometricTransform.MultT(targetPoints[controlPoint]) - geometricTransform.MultT(controlPoints[controlPoint]);
+						if (delta[0] != 0.0 || delta[1] != 0.0 || delta[2] != 0.0)
+						{
+							shapeOut.m_controlPoints.push_back(controlPoint);
+							shapeOut.m_positionDeltas.push_back((float)delta[0]);
+							shapeOut.m_positionDeltas.push_back((float)delta[1]);
+							shapeOut.m_positionDeltas.push_back((float)delta[2]);
+						}
+					}
+
+					const FbxGeometryElementNormal* normals = target->GetElementNormal(0);
+					const bool cornersMatch = triangulated || (normals && normals->GetMappingMode() == FbxGeometryElement::eByControlPoint);
+					if (normals && cornersMatch && !meshOut.m_normals.empty())
+					{
+						shapeOut.m_normalDeltas.resize(numCorners * 3, 0.f);
+						for (int corner = 0; corner < numCorners; corner++)
+						{
+							FbxVector4 normal;
+							if (getCornerValue(normals, meshOut.m_triangles[corner], corner, normal))
+							{
+								shapeOut.m_normalDeltas[corner * 3] = (float)normal[0] - meshOut.m_normals[corner * 3];
+								shapeOut.m_normalDeltas[corner * 3 + 1] = (float)normal[1] - meshOut.m_normals[corner * 3 + 1];
+								shapeOut.m_normalDeltas[corner * 3 + 2] = (float)normal[2] - meshOut.m_normals[corner * 3 + 2];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	FbxPropertyT<FbxDouble3>& getTransformProperty(FbxNode* node, SceneSource::Channel channel)
+	{
+		if (channel < SceneSource::ROTATION_X)
+		{
+			return node->LclTranslation;
+		}
+		return (channel < SceneSource::SCALING_X) ? node->LclRotation : node->LclScaling;
+	}
+}
+
+FbxSceneSource::FbxSceneSource(FbxScene* scene) :
+	m_scene(scene)
+{
+	m_timePerFrame.SetTime(0, 0, 0, 1, 0, m_scene->GetGlobalSettings().GetTimeMode());
+	addNodesRecursive(m_scene->GetRootNode());
+}
+
+void FbxSceneSource::addNodesRecursive(FbxNode* node)
+{
+	m_nodeIndices[node] = (int)m_nodes.size();
+	m_nodes.push_back(node);
+
+	for (int childIndex = 0; childIndex < node->GetChildCount(); childIndex++)
+	{
+		addNodesRecursive(node->GetChild(childIndex));
+	}
+}
+
+int FbxSceneSource::getNodeIndex(const FbxNode* node) const
+{
+	std::unordered_map<const FbxNode*, int>::const_iterator it = m_nodeIndices.find(node);
+	return (it != m_nodeIndices.end()) ? it->second : -1;
+}
+
+bool FbxSceneSource::isNodeFlipped(const FbxNode* node)
+{
+	if (node == NULL)
+		return false;
+
+	FbxDouble3 scaling = node->LclScaling.Get();
+	bool flipped = (scaling[0] * scaling[1] * scaling[2]) < 0;
+	return flipped != isNodeFlipped(node->GetParent());
+}
+
+void FbxSceneSource::readMesh(FbxNode* meshNode, FbxMesh* triMesh, SceneMesh& meshOut, bool blendShapes) const
+{
+	meshOut = SceneMesh();
+	meshOut.m_flipped = isNodeFlipped(meshNode);
+
+	FbxAMatrix geometricTransform;
+	{
+		FbxVector4 T = meshNode->GetGeometricTranslation(FbxNode::eSourcePivot);
+		FbxVector4 R = meshNode->GetGeometricRotation(FbxNode::eSourcePivot);
+		FbxVector4 S = meshNode->GetGeometricScaling(FbxNode::eSourcePivot);
+		geometricTransform.SetTRS(T,R,S);
+	}
+
+	const int numControlPoints = triMesh->GetControlPointsCount();
+	const FbxVector4* controlPoints = triMesh->GetControlPoints();
+	meshOut.m_positions.resize(numControlPoints * 3);
+	for (int controlPoint = 0; controlPoint < numControlPoints; controlPoint++)
+	{
+		const FbxVector4 position = geometricTransform.MultT(controlPoints[controlPoint]);
+		meshOut.m_positions[controlPoint * 3] = (float)position[0];
+		meshOut.m_positions[controlPoint * 3 + 1] = (float)position[1];
+		meshOut.m_positions[controlPoint * 3 + 2] = (float)position[2];
+	}
+
+	const int numTriangles = triMesh->GetPolygonCount();
+	const int numCorners = numTriangles * 3;
+	meshOut.m_triangles.resize(numCorners);
+	for (int triangle = 0; triangle < numTriangles; triangle++)
+	{
+		FBX_ASSERT(triMesh->GetPolygonSize(triangle) == 3);
+		for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++)
+		{
+			meshOut.m_triangles[triangle * 3 + cornerIndex] = triMesh->GetPolygonVertex(triangle, cornerIndex);
+		}
+	}
+
+	// Corners whose layer mapping is not supported are left zero (and opaque black for colors)
+	const FbxGeometryElementNormal* normals = triMesh->GetElementNormal(0);
+	if (normals)
+	{
+		meshOut.m_normals.resize(numCorners * 3, 0.f);
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			FbxVector4 normal;
+			if (getCornerValue(normals, meshOut.m_triangles[corner], corner, normal))
+			{
+				meshOut.m_normals[corner * 3] = (float)normal[0];
+				meshOut.m_normals[corner * 3 + 1] = (float)normal[1];
+				meshOut.m_normals[corner * 3 + 2] = (float)normal[2];
+			}
+		}
+	}
+
+	const FbxGeometryElementVertexColor* colors = triMesh->GetElementVertexColor(0);
+	if (colors)
+	{
+		meshOut.m_colors.resize(numCorners * 4, 0.f);
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			FbxColor color;
+			getCornerValue(colors, meshOut.m_triangles[corner], corner, color);
+			meshOut.m_colors[corner * 4] = (float)color.mRed;
+			meshOut.m_colors[corner * 4 + 1] = (float)color.mGreen;
+			meshOut.m_colors[corner * 4 + 2] = (float)color.mBlue;
+			meshOut.m_colors[corner * 4 + 3] = (float)color.mAlpha;
+		}
+	}
+
+	FbxStringList uvSetNames;
+	triMesh->GetUVSetNames(uvSetNames);
+	meshOut.m_uvSetNames.resize(uvSetNames.GetCount());
+	meshOut.m_uvSets.resize(uvSetNames.GetCount());
+	for (int uvSetIndex = 0; uvSetIndex < uvSetNames.GetCount(); uvSetIndex++)
+	{
+		meshOut.m_uvSetNames[uvSetIndex] = uvSetNames[uvSetIndex].Buffer();
+
+		std::vector<float>& uvs = meshOut.m_uvSets[uvSetIndex];
+		uvs.resize(numCorners * 2, 0.f);
+
+		const FbxGeometryElementUV* uvSet = triMesh->GetElementUV(uvSetNames[uvSetIndex].Buffer());
+		for (int corner = 0; uvSet && corner < numCorners; corner++)
+		{
+			FbxVector2 uv;
+			if (getCornerValue(uvSet, meshOut.m_triangles[corner], corner, uv))
+			{
+				uvs[corner * 2] = (float)uv[0];
+				uvs[corner * 2 + 1] = (float)uv[1];
+			}
+		}
+	}
+
+	// The first four clusters influencing a control point are kept
+	if (triMesh->GetDeformerCount(FbxDeformer::eSkin) > 0)
+	{
+		FbxSkin* skin = (FbxSkin*)triMesh->GetDeformer(0, FbxDeformer::eSkin);
+
+		meshOut.m_skinClusters.resize(numControlPoints * 4, -1);
+		meshOut.m_skinWeights.resize(numControlPoints * 4, 0.f);
+
+		const int numClusters = skin->GetClusterCount();
+		meshOut.m_clusterNodes.resize(numClusters);
+		meshOut.m_clusterBindPoses.resize(numClusters * 16);
+		for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+		{
+			FbxCluster* cluster = skin->GetCluster(clusterIndex);
+			meshOut.m_clusterNodes[clusterIndex] = getNodeIndex(cluster->GetLink());
+
+			FbxAMatrix bindPose;
+			cluster->GetTransformLinkMatrix(bindPose);
+			copyMatrix(bindPose, &meshOut.m_clusterBindPoses[clusterIndex * 16]);
+
+			const int numIndices = cluster->GetControlPointIndicesCount();
+			const int* indices = cluster->GetControlPointIndices();
+			const double* weights = cluster->GetControlPointWeights();
+			for (int k = 0; k < numIndices; k++)
+			{
+				const int controlPointFour = indices[k] * 4;
+				for (int i = controlPointFour; i < controlPointFour + 4; ++i)
+				{
+					if (meshOut.m_skinClusters[i] < 0)
+					{
+						meshOut.m_skinClusters[i] = clusterIndex;
+						meshOut.m_skinWeights[i] = (float)weights[k];
+						break;
+					}
+				}
+			}
+		}
+
+		// Zero unused indices
+		for (size_t i = 0; i < meshOut.m_skinClusters.size(); ++i)
+		{
+			if (meshOut.m_skinClusters[i] < 0)
+			{
+				meshOut.m_skinClusters[i] = 0;
+			}
+		}
+	}
+
+	// The blend shapes stay on the original mesh if triangulating did not copy them, its control points are the same
+	if (blendShapes)
+	{
+		const bool triangulated = triMesh->GetDeformerCount(FbxDeformer::eBlendShape) > 0;
+		readBlendShapes(triangulated ? triMesh : meshNode->GetMesh(), triangulated, geometricTransform, meshOut);
+	}
+}
+
+int FbxSceneSource::getNumNodes() const
+{
+	return (int)m_nodes.size();
+}
+
+int FbxSceneSource::getParent(int node) const
+{
+	return (node > 0) ? getNodeIndex(m_nodes[node]->GetParent()) : -1;
+}
+
+int FbxSceneSource::getNumChildren(int node) const
+{
+	return m_nodes[node]->GetChildCount();
+}
+
+int FbxSceneSource::getChild(int node, int childIndex) const
+{
+	return getNodeIndex(m_nodes[node]->GetChild(childIndex));
+}
+
+const char* FbxSceneSource::getNodeName(int node) const
+{
+	return m_nodes[node]->GetName();
+}
+
+SceneSource::NodeType FbxSceneSource::getNodeType(int node) const
+{
+	const FbxNodeAttribute* attribute = m_nodes[node]->GetNodeAttribute();
+	if (attribute == NULL)
+	{
+		return NODE_NULL;
+	}
+
+	switch (attribute->GetAttributeType())
+	{
+	case FbxNodeAttribute::eNull: return NODE_NULL;
+	case FbxNodeAttribute::eSkeleton: return NODE_SKELETON;
+	case FbxNodeAttribute::eMesh: return NODE_MESH;
+	case FbxNodeAttribute::eCamera: return NODE_CAMERA;
+	case FbxNodeAttribute::eLight: return NODE_LIGHT;
+	case FbxNodeAttribute::eNurbsCurve: return NODE_SPLINE;
+	default: return NODE_OTHER;
+	}
+}
+
+void FbxSceneSource::getCoordinateSystem(CoordinateSystem& systemOut) const
+{
+	const FbxGlobalSettings& settings = m_scene->GetGlobalSettings();
+	systemOut = CoordinateSystem();
+	readAxis(settings, "CoordAxis", "CoordAxisSign", systemOut.m_right);
+	readAxis(settings, "UpAxis", "UpAxisSign", systemOut.m_up);
+	readAxis(settings, "FrontAxis", "FrontAxisSign", systemOut.m_front);
+	// The system unit is in centimeters
+	systemOut.m_unitMeters = settings.GetSystemUnit().GetScaleFactor() * 0.01;
+}
+
+bool FbxSceneSource::getMesh(int node, SceneMesh& meshOut) const
+{
+	FbxNode* meshNode = m_nodes[node];
+	FbxMesh* mesh = meshNode->GetMesh();
+	if (mesh == NULL)
+	{
+		return false;
+	}
+
+	if (!mesh->IsTriangleMesh())
+	{
+		FbxGeometryConverter geometryConverter(m_scene->GetFbxManager());
+		mesh = static_cast<FbxMesh*>(geometryConverter.Triangulate(mesh, false));
+	}
+
+	readMesh(meshNode, mesh, meshOut, true);
+
+	for (int materialIndex = 0; materialIndex < meshNode->GetMaterialCount(); materialIndex++)
+	{
+		meshOut.m_materials.push_back(SceneMaterial());
+		readMaterial(meshNode->GetMaterial(materialIndex), meshOut.m_materials.back());
+	}
+
+	const FbxGeometryElementMaterial* materialElement = mesh->GetElementMaterial(0);
+	if (materialElement && materialElement->GetMappingMode() == FbxGeometryElement::eByPolygon)
+	{
+		const int numTriangles = meshOut.getNumTriangles();
+		meshOut.m_triangleMaterials.resize(numTriangles);
+		for (int triangle = 0; triangle < numTriangles; triangle++)
+		{
+			meshOut.m_triangleMaterials[triangle] = materialElement->GetIndexArray().GetAt(triangle);
+		}
+	}
+	return true;
+}
+
+int FbxSceneSource::getNumStacks() const
+{
+	return m_scene->GetSrcObjectCount<FbxAnimStack>();
+}
+
+void FbxSceneSource::getStack(int stack, Stack& stackOut) const
+{
+	const FbxAnimStack* animStack = m_scene->GetSrcObject<FbxAnimStack>(stack);
+	const FbxTimeSpan timeSpan = animStack->GetLocalTimeSpan();
+
+	stackOut.m_name = animStack->GetName();
+	stackOut.m_start = timeSpan.GetStart().GetSecondDouble();
+	stackOut.m_stop = timeSpan.GetStop().GetSecondDouble();
+
+	// Frames at start, start + timePerFrame, ... before the stop, counted in ticks
+	const FbxLongLong ticks = timeSpan.GetStop().Get() - timeSpan.GetStart().Get();
+	const FbxLongLong ticksPerFrame = m_timePerFrame.Get();
+	stackOut.m_numFrames = (ticks > 0) ? (int)((ticks + ticksPerFrame - 1) / ticksPerFrame) : 0;
+}
+
+bool FbxSceneSource::getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const
+{
+	FbxAnimStack* animStack = m_scene->GetSrcObject<FbxAnimStack>(stack);
+	if (animStack == NULL || animStack->GetMemberCount<FbxAnimLayer>() == 0)
+	{
+		return false;
+	}
+
+	static const char* components[3] = { FBXSDK_CURVENODE_COMPONENT_X, FBXSDK_CURVENODE_COMPONENT_Y, FBXSDK_CURVENODE_COMPONENT_Z };
+
+	FbxAnimLayer* animLayer = animStack->GetMember<FbxAnimLayer>(0);
+	FbxAnimCurve* curve = getTransformProperty(m_nodes[node], channel).GetCurve(animLayer, components[channel % 3]);
+	if (curve == NULL)
+	{
+		return false;
+	}
+
+	const int numKeys = curve->KeyGetCount();
+	curveOut.m_times.resize(numKeys);
+	curveOut.m_values.resize(numKeys);
+	for (int keyIndex = 0; keyIndex < numKeys; keyIndex++)
+	{
+		curveOut.m_times[keyIndex] = curve->KeyGetTime(keyIndex).GetSecondDouble();
+		curveOut.m_values[keyIndex] = curve->KeyGetValue(keyIndex);
+	}
+	return true;
+}
+
+void FbxSceneSource::evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const
+{
+	FbxTime time;
+	if (stack >= 0)
+	{
+		FbxAnimStack* animStack = m_scene->GetSrcObject<FbxAnimStack>(stack);
+		if (m_scene->GetCurrentAnimationStack() != animStack)
+		{
+			m_scene->SetCurrentAnimationStack(animStack);
+		}
+		time.Set(animStack->GetLocalTimeSpan().GetStart().Get() + frame * m_timePerFrame.Get());
+	}
+
+	copyMatrix(m_nodes[node]->EvaluateLocalTransform(time), matrixOut);
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
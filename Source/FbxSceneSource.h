@@ -0,0 +1,84 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_FBXSCENESOURCE
+#define HK_FBXTOHKX_FBXSCENESOURCE
+
+#define FBXSDK_NEW_API
+
+#pragma warning(push,3)
+#include <fbxsdk.h>
+#pragma warning(pop)
+
+#include "SceneSource.h"
+
+#include <unordered_map>
+
+// SceneSource of an FbxScene. The nodes are numbered depth first from the root node. Transforms are evaluated with
+// the FBX SDK (pivots, rotation orders and constraints included), in the stack that is passed, which becomes the
+// current animation stack of the scene.
+class FbxSceneSource : public SceneSource
+{
+public:
+
+	explicit FbxSceneSource(FbxScene* scene);
+
+	// -1 if the node is not part of the scene
+	int getNodeIndex(const FbxNode* node) const;
+	FbxNode* getFbxNode(int node) const { return m_nodes[node]; }
+
+	// Reads the geometry and skin of a triangulated mesh of the node, and its blend shape targets if blendShapes is
+	// set. getMesh() triangulates the mesh of the node first if needed, and also reads its materials.
+	void readMesh(FbxNode* meshNode, FbxMesh* triMesh, SceneMesh& meshOut, bool blendShapes) const;
+
+	// True if an odd number of the node and its ancestors have a negative scale
+	static bool isNodeFlipped(const FbxNode* node);
+
+	// SceneSource
+	virtual int getNumNodes() const;
+	virtual int getParent(int node) const;
+	virtual int getNumChildren(int node) const;
+	virtual int getChild(int node, int childIndex) const;
+	virtual const char* getNodeName(int node) const;
+	virtual NodeType getNodeType(int node) const;
+	// The axes of the global settings (the file's axis system, the scene is not converted with FbxAxisSystem)
+	virtual void getCoordinateSystem(CoordinateSystem& systemOut) const;
+	virtual bool getMesh(int node, SceneMesh& meshOut) const;
+	virtual int getNumStacks() const;
+	virtual void getStack(int stack, Stack& stackOut) const;
+	virtual bool getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const;
+	virtual void evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const;
+
+private:
+
+	void addNodesRecursive(FbxNode* node);
+
+	FbxScene* m_scene;
+	FbxTime m_timePerFrame;
+	std::vector<FbxNode*> m_nodes;
+	std::unordered_map<const FbxNode*, int> m_nodeIndices;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
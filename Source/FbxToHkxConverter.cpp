@@ -7,6 +7,13 @@
  */
 
 #include "FbxToHkxConverter.h"
+#include "ConversionCache.h"
+#include "ConversionManifest.h"
+#include "ConversionProfiler.h"
+#include "ConversionMemoryStats.h"
+#include "SceneSizeReport.h"
+#include "FbxSceneSource.h"
+#include "ScenePipeline.h"
 
 #include <Common/Base/hkBase.h>
 #include <Common/Base/Math/hkMath.h>
@@ -16,6 +23,7 @@
 #include <Common/SceneData/Scene/hkxScene.h>
 #include <Common/Serialize/Util/hkRootLevelContainer.h>
 #include <Common/Base/System/Io/IStream/hkIStream.h>
+#include <Common/Base/System/Io/Writer/Array/hkArrayStreamWriter.h>
 #include <Common/Serialize/Resource/hkResource.h>
 #include <Common/SceneData/Environment/hkxEnvironment.h>
 #include <Common/Serialize/ResourceDatabase/hkResourceHandle.h>
@@ -24,6 +32,12 @@
 
 #include <Common/Base/Algorithm/Sort/hkSort.h>
 
+#include <chrono>
+#include <ctype.h>
+#include <set>
+#include <stdarg.h>
+#include <stdio.h>
+
 // Get the matrix of the given pose
 FbxAMatrix GetPoseMatrix(FbxPose* pPose, int pNodeIndex);
 
@@ -39,14 +53,17 @@ FbxToHkxConverter::Options::Options(FbxManager *fbxSdkManager) :
 	m_fbxSdkManager(fbxSdkManager),
 	m_exportMeshes(true), m_exportMaterials(true), m_exportAttributes(true),
 	m_exportAnnotations(true), m_exportLights(true), m_exportCameras(true),
-	m_exportSplines(true), m_exportVertexTangents(true), m_exportVertexAnimations(true),
-	m_visibleOnly(false), m_selectedOnly(false), m_storeKeyframeSamplePoints(true)
+	m_exportSplines(true), m_exportVertexTangents(true), m_exportVertexAnimations(true), m_maxSkinBones(0), m_extractRigidSections(false),
+	m_exportAnimations(true), m_animationOnlyStacks(true), m_unitMeters(0.0), m_extractEmbeddedMedia(false),
+	m_visibleOnly(false), m_selectedOnly(false), m_storeKeyframeSamplePoints(true),
+	m_singleContainer(false), m_objectStore(HK_NULL),
+	m_reportFunction(HK_NULL), m_reportUserData(HK_NULL), m_manifest(HK_NULL),
+	m_profiler(HK_NULL), m_memoryStats(HK_NULL), m_reportSizes(false)
 {
-	HK_ASSERT(0x0, m_fbxSdkManager);
 }
 
 FbxToHkxConverter::FbxToHkxConverter(const Options& options) : 
-	m_options(options), m_curFbxScene(NULL), m_pose(NULL)
+	m_options(options), m_curFbxScene(NULL), m_sceneSource(NULL), m_pose(NULL), m_convertGeometry(true), m_outputScale(1.0), m_changeBasis(false), m_exportData(NULL), m_numSavedScenes(0), m_defaultSourceMaterial(HK_NULL)
 {
 }
 
@@ -73,74 +90,407 @@ void FbxToHkxConverter::clear()
 		}
 	}
 	m_convertedTextures.clear();
+
+	m_report.clear();
+	m_savedFiles.clear();
+	m_numSavedScenes = 0;
+	m_sceneConvertSeconds.clear();
+
+	delete m_sceneSource;
+	m_sceneSource = NULL;
+
+	m_convertedSourceMaterials.clear();
+	m_defaultSourceMaterial = HK_NULL;
 }
 
-void FbxToHkxConverter::saveScenes(const char* path, const char* name)
+void FbxToHkxConverter::setOutputBasis(const SceneSource& source)
 {
-	printf("Output path: %s\n", path);
+	SceneSource::CoordinateSystem system;
+	source.getCoordinateSystem(system);
 
-	for (int sceneIndex = 0; sceneIndex < m_scenes.getSize(); sceneIndex++)
+	m_outputScale = (m_options.m_unitMeters > 0.0 && system.m_unitMeters > 0.0) ? system.m_unitMeters / m_options.m_unitMeters : 1.0;
+	if (!computeOutputBasis(system, m_outputScale, m_outputBasis, m_outputBasisInverse))
 	{
-		hkxScene *scene = m_scenes[sceneIndex];
-		hkRootLevelContainer* currentRootContainer = new hkRootLevelContainer();
-		currentRootContainer->m_namedVariants.setSize(1);
+		HK_WARN(0x0, "The axis system of the scene is invalid, only its unit is converted.");
+	}
+
+	m_changeBasis = false;
+	for (int element = 0; element < 16; element++)
+	{
+		m_changeBasis = m_changeBasis || (m_outputBasis[element] != ((element % 5 == 0) ? 1.0 : 0.0));
+	}
 
-		hkRootLevelContainer::NamedVariant& sceneVariant = currentRootContainer->m_namedVariants[0];
-		sceneVariant.set("Scene Data", scene, &hkxSceneClass);
+	const char* axisNames[] = { "+X", "-X", "+Y", "-Y", "+Z", "-Z" };
+	printf("Coordinate system: right %s, up %s, front %s, unit %gm%s\n", axisNames[system.m_right], axisNames[system.m_up], axisNames[system.m_front],
+		system.m_unitMeters, m_changeBasis ? ", converted to 3ds Max axes" : "");
+	if (m_outputScale != 1.0)
+	{
+		printf("Unit scale: %g\n", m_outputScale);
+	}
+}
 
-		hkStringBuf filename = name;
+void FbxToHkxConverter::toOutputBasis(hkMatrix4& matrixInOut) const
+{
+	if (!m_changeBasis)
+	{
+		return;
+	}
 
-		if (sceneIndex > 0)
+	hkFloat32 elements[16];
+	matrixInOut.get4x4ColumnMajor(elements);
+	double matrix[16];
+	for (int element = 0; element < 16; element++)
+	{
+		matrix[element] = elements[element];
+	}
+
+	changeBasis(m_outputBasis, m_outputBasisInverse, matrix);
+
+	for (int element = 0; element < 16; element++)
+	{
+		elements[element] = (hkFloat32)matrix[element];
+	}
+	matrixInOut.set4x4ColumnMajor(elements);
+}
+
+void FbxToHkxConverter::toOutputBasis(hkVector4& vectorInOut, bool direction) const
+{
+	if (!m_changeBasis)
+	{
+		return;
+	}
+
+	// Directions are rotated (or reflected) only
+	const double scale = direction ? 1.0 / m_outputScale : 1.0;
+	double converted[3];
+	for (int row = 0; row < 3; row++)
+	{
+		converted[row] = (m_outputBasis[row] * vectorInOut(0) + m_outputBasis[4 + row] * vectorInOut(1) + m_outputBasis[8 + row] * vectorInOut(2)) * scale;
+	}
+	vectorInOut.set((hkReal)converted[0], (hkReal)converted[1], (hkReal)converted[2], vectorInOut(3));
+}
+
+void FbxToHkxConverter::report(const char* format, ...)
+{
+	char line[1024];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	line[sizeof(line) - 1] = '\0';
+
+	printf("%s", line);
+	m_report.append(line);
+
+	if (m_options.m_reportFunction)
+	{
+		m_options.m_reportFunction(line, m_options.m_reportUserData);
+	}
+}
+
+// Serializes into memory first and only touches the file if its contents changed, so unchanged outputs keep their
+// timestamps and downstream steps depending on them are not triggered again
+bool FbxToHkxConverter::saveOutputFile(const char* path, const char* filename, const void* data, int size)
+{
+	hkStringBuf filepath = path;
+	filepath.pathAppend(filename);
+
+	bool changed;
+	if (!writeFileIfChanged(filepath.cString(), data, (size_t)size, &changed))
+	{
+		return false;
+	}
+
+	if (!changed)
+	{
+		printf("Output unchanged: %s\n", filename);
+	}
+	m_savedFiles.pushBack(filename);
+	return true;
+}
+
+// The first scene is "Scene Data", the others are named after their stack with the characters that are not valid in
+// file names replaced. Names that are already taken, regardless of case, get a "_<n>" suffix.
+void FbxToHkxConverter::getSceneVariantNames(std::vector<std::string>& namesOut) const
+{
+	namesOut.clear();
+
+	std::set<std::string> usedNames;
+	usedNames.insert("scene data");
+	usedNames.insert("scene_data");
+
+	for (int sceneIndex = 0; sceneIndex < m_scenes.getSize(); sceneIndex++)
+	{
+		if (sceneIndex == 0)
 		{
-			filename.append("_");
+			namesOut.push_back("Scene Data");
+			continue;
+		}
 
-			hkStringBuf name = scene->m_rootNode->m_name;
+		hkStringBuf name = m_scenes[sceneIndex]->m_rootNode->m_name;
+
+		char invalid_characters[] = { ' ', '.', '/', '?', '<', '>', '\\', ':', '*', '|' };
+		for (int character_index = 0; character_index < sizeof(invalid_characters); character_index++ )
+		{
+			name.replace(invalid_characters[character_index], '_');
+		}
 
-			char invalid_characters[] = { ' ', '.', '/', '?', '<', '>', '\\', ':', '*', '|' };
-			for (int character_index = 0; character_index < sizeof(invalid_characters); character_index++ )
+		std::string uniqueName = name.cString();
+		for (int suffix = 1; ; suffix++)
+		{
+			std::string key = uniqueName;
+			for (size_t i = 0; i < key.size(); i++)
 			{
-				name.replace(invalid_characters[character_index], '_');
+				key[i] = (char)tolower((unsigned char)key[i]);
+			}
+			if (usedNames.insert(key).second)
+			{
+				break;
 			}
 
-			filename.append( name );
+			char suffixText[16];
+			sprintf(suffixText, "_%d", suffix);
+			uniqueName = std::string(name.cString()) + suffixText;
 		}
+		namesOut.push_back(uniqueName);
+	}
+}
 
-		PrintLine();
+void FbxToHkxConverter::setOutput(const char* path, const char* name)
+{
+	m_outputPath = path;
+	m_outputName = name;
+}
 
-		hkStringBuf tagfile = filename;
-		tagfile.append(".hkt");
+// Saves the scenes that have not been saved yet, which is all of them unless setOutput() was used
+void FbxToHkxConverter::saveScenes(const char* path, const char* name)
+{
+	if (m_numSavedScenes == 0)
+	{
+		printf("Output path: %s\n", path);
+		m_savedFiles.clear();
+	}
 
-		hkStringBuf tagpath = path;
-		tagpath.pathAppend(tagfile);
+	if (m_options.m_singleContainer)
+	{
+		saveScenesToContainer(path, name);
+		m_numSavedScenes = m_scenes.getSize();
+		return;
+	}
 
-		if ( hkSerializeUtil::save(
-				currentRootContainer,
-				hkRootLevelContainerClass,
-				hkOstream(tagpath).getStreamWriter(),
-				hkSerializeUtil::SAVE_TEXT_FORMAT) == HK_SUCCESS )
-		{
-			printf("Saved tag file: %s\n", tagfile.cString());
-		}
-		else
+	for (; m_numSavedScenes < m_scenes.getSize(); m_numSavedScenes++)
+	{
+		saveScene(m_numSavedScenes, path, name);
+	}
+}
+
+void FbxToHkxConverter::saveScene(int sceneIndex, const char* path, const char* name)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	hkxScene *scene = m_scenes[sceneIndex];
+	hkRootLevelContainer* currentRootContainer = new hkRootLevelContainer();
+	currentRootContainer->m_namedVariants.setSize(1);
+
+	hkRootLevelContainer::NamedVariant& sceneVariant = currentRootContainer->m_namedVariants[0];
+	sceneVariant.set("Scene Data", scene, &hkxSceneClass);
+
+	hkStringBuf filename = name;
+
+	if (sceneIndex > 0)
+	{
+		std::vector<std::string> sceneNames;
+		getSceneVariantNames(sceneNames);
+
+		filename.append("_");
+		filename.append(sceneNames[sceneIndex].c_str());
+	}
+
+	PrintLine();
+
+	hkStringBuf tagfile = filename;
+	tagfile.append(".hkt");
+
+	ConversionProfiler::Scope saveScope(m_options.m_profiler, "saveScene", "phase", tagfile);
+
+	hkArray<char> buffer;
+	hkArrayStreamWriter bufferWriter(&buffer, hkArrayStreamWriter::ARRAY_BORROW);
+	const bool saved = hkSerializeUtil::save(
+			currentRootContainer,
+			hkRootLevelContainerClass,
+			&bufferWriter,
+			hkSerializeUtil::SAVE_TEXT_FORMAT) == HK_SUCCESS &&
+		saveOutputFile(path, tagfile, buffer.begin(), buffer.getSize());
+	if (saved)
+	{
+		report("Saved tag file: %s\n", tagfile.cString());
+	}
+	else
+	{
+		printf("Cannot save file: %s\n", tagfile.cString());
+	}
+
+	report("Number of frames: %d\n", scene->m_numFrames);
+	report("Scene length: %0.2f\n", scene->m_sceneLength);
+	report("Root node name: %s\n", scene->m_rootNode->m_name.cString());
+
+	delete currentRootContainer;
+
+	if (saved)
+	{
+		const double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::string sizes;
+		reportSceneSizes(sceneIndex, tagfile, buffer.getSize(), sizes);
+		addManifestScene(sceneIndex, tagfile, "Scene Data", saveSeconds, sizes);
+	}
+}
+
+void FbxToHkxConverter::reportSceneSizes(int sceneIndex, const char* title, hkLong fileBytes, std::string& sizesOut) const
+{
+	if (m_options.m_reportSizes)
+	{
+		SceneSizeReport sizeReport(m_scenes[sceneIndex], fileBytes);
+		sizeReport.print(title);
+		sizesOut = sizeReport.getJson();
+	}
+}
+
+void FbxToHkxConverter::addManifestScene(int sceneIndex, const char* file, const char* variant, double saveSeconds, const std::string& sizes)
+{
+	if (!m_options.m_manifest)
+	{
+		return;
+	}
+
+	const hkxScene* scene = m_scenes[sceneIndex];
+
+	ConversionManifest::Scene entry;
+	entry.m_file = file;
+	entry.m_variant = variant;
+	entry.m_stack = scene->m_rootNode->m_name.cString();
+	entry.m_numFrames = scene->m_numFrames;
+	entry.m_length = scene->m_sceneLength;
+	entry.m_numBones = m_numBones;
+	entry.m_numMeshes = scene->m_meshes.getSize();
+	for (int meshIndex = 0; meshIndex < scene->m_meshes.getSize(); meshIndex++)
+	{
+		const hkxMesh* mesh = scene->m_meshes[meshIndex];
+		for (int sectionIndex = 0; sectionIndex < mesh->m_sections.getSize(); sectionIndex++)
 		{
-			printf("Cannot save file: %s\n", tagfile.cString());
+			const hkxMeshSection* section = mesh->m_sections[sectionIndex];
+			entry.m_numSections++;
+			entry.m_numVertices += section->m_vertexBuffer ? section->m_vertexBuffer->getNumVertices() : 0;
+			entry.m_numTriangles += section->getNumTriangles();
 		}
+	}
+	entry.m_convertSeconds = m_sceneConvertSeconds[sceneIndex];
+	entry.m_saveSeconds = saveSeconds;
+	entry.m_sizes = sizes;
+
+	m_options.m_manifest->addScene(entry);
+}
+
+// Writes every scene into one root level container, one named variant per scene. Materials and textures are shared
+// between the scenes by pointer, so they are serialized only once. Meshes and skin bindings are not: each stack that
+// converts geometry (see Options::m_animationOnlyStacks) has its own. A manifest listing the variant names (one per
+// line, in scene order) is written next to the tag file so downstream tools can pick individual stacks.
+void FbxToHkxConverter::saveScenesToContainer(const char* path, const char* name)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ConversionProfiler::Scope saveScope(m_options.m_profiler, "saveScenesToContainer", "phase", name);
+
+	hkRootLevelContainer* rootContainer = new hkRootLevelContainer();
+	rootContainer->m_namedVariants.setSize(m_scenes.getSize());
+
+	std::vector<std::string> variantNames;
+	getSceneVariantNames(variantNames);
+
+	hkStringBuf manifest;
+	for (int sceneIndex = 0; sceneIndex < m_scenes.getSize(); sceneIndex++)
+	{
+		// The variant name buffer is copied by the named variant
+		rootContainer->m_namedVariants[sceneIndex].set(variantNames[sceneIndex].c_str(), m_scenes[sceneIndex], &hkxSceneClass);
+		manifest.appendJoin(variantNames[sceneIndex].c_str(), "\n");
+	}
+
+	PrintLine();
+
+	hkStringBuf tagfile = name;
+	tagfile.append(".hkt");
+
+	hkArray<char> buffer;
+	hkArrayStreamWriter bufferWriter(&buffer, hkArrayStreamWriter::ARRAY_BORROW);
+	const bool saved = hkSerializeUtil::save(
+			rootContainer,
+			hkRootLevelContainerClass,
+			&bufferWriter,
+			hkSerializeUtil::SAVE_TEXT_FORMAT) == HK_SUCCESS &&
+		saveOutputFile(path, tagfile, buffer.begin(), buffer.getSize());
+	if (saved)
+	{
+		report("Saved tag file: %s\n", tagfile.cString());
+	}
+	else
+	{
+		printf("Cannot save file: %s\n", tagfile.cString());
+	}
+
+	hkStringBuf manifestfile = name;
+	manifestfile.append(".scenes.txt");
+
+	const bool manifestSaved = saveOutputFile(path, manifestfile, manifest.cString(), manifest.getLength());
+	if (manifestSaved)
+	{
+		report("Saved scene manifest: %s\n", manifestfile.cString());
+	}
+	else
+	{
+		printf("Cannot save file: %s\n", manifestfile.cString());
+	}
+
+	for (int sceneIndex = 0; sceneIndex < m_scenes.getSize(); sceneIndex++)
+	{
+		hkxScene *scene = m_scenes[sceneIndex];
+
+		PrintLine();
+		report("Scene variant: %s\n", rootContainer->m_namedVariants[sceneIndex].getName());
+		report("Number of frames: %d\n", scene->m_numFrames);
+		report("Scene length: %0.2f\n", scene->m_sceneLength);
+		report("Root node name: %s\n", scene->m_rootNode->m_name.cString());
+	}
 
-		printf("Number of frames: %d\n", scene->m_numFrames);
-		printf("Scene length: %0.2f\n", scene->m_sceneLength);
-		printf("Root node name: %s\n", scene->m_rootNode->m_name.cString());
+	// All scenes share the container, each is listed with the time it took to save all of them and the container size
+	const double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	for (int sceneIndex = 0; sceneIndex < m_scenes.getSize() && saved; sceneIndex++)
+	{
+		const char* variantName = rootContainer->m_namedVariants[sceneIndex].getName();
 
-		delete currentRootContainer;
+		std::string sizes;
+		reportSceneSizes(sceneIndex, variantName, buffer.getSize(), sizes);
+		addManifestScene(sceneIndex, tagfile, variantName, saveSeconds, sizes);
 	}
+	if (manifestSaved && m_options.m_manifest)
+	{
+		m_options.m_manifest->addFile(manifestfile);
+	}
+
+	delete rootContainer;
 }
 
 // This method is templated on the implementation of hctMayaSceneExporter/hctMaxSceneExporter::createScene()
-bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, const char* hkxExtraData_path)
+bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, ExportDataIndex* exportData)
 {
 	clear();
 
+	HK_ASSERT(0x0, m_options.m_fbxSdkManager);
+
 	m_curFbxScene = fbxScene;
+	m_sceneSource = new FbxSceneSource(fbxScene);
+	m_exportData = exportData;
+	setOutputBasis(*m_sceneSource);
 	m_rootNode = m_curFbxScene->GetRootNode();
+	m_asset = m_curFbxScene->GetSceneInfo()->Original_FileName.Get();
 
 	m_modeller = "FBX";
 	hkStringBuf application = fbxScene->GetSceneInfo()->Original_ApplicationName.Get();
@@ -163,9 +513,12 @@ bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, const cha
 	}
 
 	hkArray<FbxNode*> boneNodes;
-	findChildren(m_rootNode, boneNodes, FbxNodeAttribute::eSkeleton);
+	{
+		ConversionProfiler::Scope findScope(m_options.m_profiler, "findChildren", "phase");
+		findChildren(m_rootNode, boneNodes, FbxNodeAttribute::eSkeleton);
+	}
 	m_numBones = boneNodes.getSize();
-	printf("Bones: %d\n", m_numBones);
+	report("Bones: %d\n", m_numBones);
 
 	
 	const int poseCount = m_curFbxScene->GetPoseCount();
@@ -175,7 +528,7 @@ bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, const cha
 		printf("Pose Elements: %d\n", m_pose->GetCount());		
 	}
 
-	m_numAnimStacks = m_curFbxScene->GetSrcObjectCount<FbxAnimStack>();
+	m_numAnimStacks = m_options.m_exportAnimations ? m_curFbxScene->GetSrcObjectCount<FbxAnimStack>() : 0;
 	if (m_numAnimStacks > 0)
 	{
 		const FbxAnimStack* lAnimStack = m_curFbxScene->GetSrcObject<FbxAnimStack>(0);
@@ -184,29 +537,93 @@ bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, const cha
 		m_startTime = animTimeSpan.GetStart();
 	}
 	
+	if (m_options.m_manifest)
+	{
+		m_options.m_manifest->setCounts(m_numBones, m_numAnimStacks);
+	}
+
 	if (noTakes)
 	{
 		if (m_numAnimStacks > 0)
 		{
 			printf("'-noTakes' option set, only exporting first animation.\n");
-			createSceneStack(0, hkxExtraData_path);
+			createSceneStack(0, true);
 		}
 		else
 		{
 			printf("'-noTakes' option set and no animation present, only exporting static geometry.\n");
-			createSceneStack(-1, hkxExtraData_path);
+			createSceneStack(-1, true);
 		}
 	}
 	else
 	{
-		printf("Animation stacks: %d\n", m_numAnimStacks);
-		createSceneStack(-1, hkxExtraData_path);
+		report("Animation stacks: %d\n", m_numAnimStacks);
+		createSceneStack(-1, true);
 
 		for (int animStackIndex = 0;
 			animStackIndex < m_numAnimStacks && m_numBones > 0;
 			animStackIndex++)
 		{
-			createSceneStack(animStackIndex, hkxExtraData_path);
+			createSceneStack(animStackIndex, !m_options.m_animationOnlyStacks);
+		}
+	}
+
+	if (m_options.m_objectStore)
+	{
+		printf("Object cache: %d hit(s), %d miss(es)\n", m_options.m_objectStore->getNumHits(), m_options.m_objectStore->getNumMisses());
+	}
+
+	return true;
+}
+
+bool FbxToHkxConverter::createScenes(const SceneSource& source, const char* modeller, const char* asset, bool noTakes, ExportDataIndex* exportData)
+{
+	clear();
+
+	m_curFbxScene = NULL;
+	m_exportData = exportData;
+	m_modeller = modeller;
+	m_asset = asset;
+	printf("Modeller: %s\n", m_modeller.cString());
+	setOutputBasis(source);
+
+	m_numBones = 0;
+	for (int node = 0; node < source.getNumNodes(); node++)
+	{
+		m_numBones += (source.getNodeType(node) == SceneSource::NODE_SKELETON) ? 1 : 0;
+	}
+	report("Bones: %d\n", m_numBones);
+
+	m_numAnimStacks = m_options.m_exportAnimations ? source.getNumStacks() : 0;
+
+	if (m_options.m_manifest)
+	{
+		m_options.m_manifest->setCounts(m_numBones, m_numAnimStacks);
+	}
+
+	if (noTakes)
+	{
+		if (m_numAnimStacks > 0)
+		{
+			printf("'-noTakes' option set, only exporting first animation.\n");
+			createSourceSceneStack(source, 0, true);
+		}
+		else
+		{
+			printf("'-noTakes' option set and no animation present, only exporting static geometry.\n");
+			createSourceSceneStack(source, -1, true);
+		}
+	}
+	else
+	{
+		report("Animation stacks: %d\n", m_numAnimStacks);
+		createSourceSceneStack(source, -1, true);
+
+		for (int stackIndex = 0;
+			stackIndex < m_numAnimStacks && m_numBones > 0;
+			stackIndex++)
+		{
+			createSourceSceneStack(source, stackIndex, !m_options.m_animationOnlyStacks);
 		}
 	}
 
@@ -214,12 +631,17 @@ bool FbxToHkxConverter::createScenes(FbxScene* fbxScene, bool noTakes, const cha
 }
 
 // This method is templated on the implementation of hctMayaSceneExporter/hctMaxSceneExporter::createScene()
-bool FbxToHkxConverter::createSceneStack(int animStackIndex, const char* hkxExtraData_path)
+bool FbxToHkxConverter::createSceneStack(int animStackIndex, bool geometry)
 {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_convertGeometry = geometry;
+	const char* stackName = (animStackIndex >= 0) ? m_curFbxScene->GetSrcObject<FbxAnimStack>(animStackIndex)->GetName() : "ROOT_NODE";
+	ConversionMemoryStats::Scope memoryScope(m_options.m_memoryStats, "scene", stackName);
+
 	hkxScene *scene = new hkxScene;
 
 	scene->m_modeller.set(m_modeller.cString());
-	scene->m_asset = m_curFbxScene->GetSceneInfo()->Original_FileName.Get();
+	scene->m_asset = m_asset.cString();
 
 	if (m_rootNode) 
 	{
@@ -269,16 +691,148 @@ bool FbxToHkxConverter::createSceneStack(int animStackIndex, const char* hkxExtr
 		// Setup (identity) keyframes(s) for the 'static' root node
 		rootNode->m_keyFrames.setSize( scene->m_numFrames > 1 ? 2 : 1, hkMatrix4::getIdentity() );
 
-		addNodesRecursive(scene, m_rootNode, scene->m_rootNode, currentAnimStackIndex, hkxExtraData_path);
+		addNodesRecursive(scene, m_rootNode, scene->m_rootNode, currentAnimStackIndex);
+		attachRigidMeshes(scene);
 	}
 
-	m_scenes.pushBack(scene);
+	addConvertedScene(scene, start);
+	return true;
+}
+
+bool FbxToHkxConverter::createSourceSceneStack(const SceneSource& source, int stackIndex, bool geometry)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_convertGeometry = geometry;
 
+	SceneSource::Stack stack;
+	const bool rigPass = (stackIndex == -1);
+	const int currentStackIndex = (rigPass && m_numAnimStacks > 0) ? 0 : stackIndex;
+	if (currentStackIndex >= 0)
+	{
+		source.getStack(currentStackIndex, stack);
+	}
+
+	ConversionMemoryStats::Scope memoryScope(m_options.m_memoryStats, "scene", rigPass ? "ROOT_NODE" : stack.m_name.c_str());
+
+	hkxScene *scene = new hkxScene;
+
+	scene->m_modeller.set(m_modeller.cString());
+	scene->m_asset = m_asset.cString();
+
+	hkxNode* rootNode = new hkxNode;
+	if (rigPass)
+	{
+		rootNode->m_name = "ROOT_NODE";
+		scene->m_sceneLength = 0.f;
+		scene->m_numFrames = 1;
+		printf("Converting nodes for root...\n");
+	}
+	else
+	{
+		rootNode->m_name = stack.m_name.c_str();
+		scene->m_sceneLength = static_cast<hkReal>(stack.m_stop - stack.m_start);
+		scene->m_numFrames = static_cast<hkUint32>(stack.m_numFrames);
+		printf("Converting nodes for [%s]...\n", rootNode->m_name.cString());
+	}
+
+	scene->m_rootNode = rootNode;
+	rootNode->removeReference();
+
+	// Setup (identity) keyframes(s) for the 'static' root node
+	rootNode->m_keyFrames.setSize( scene->m_numFrames > 1 ? 2 : 1, hkMatrix4::getIdentity() );
+
+	addSourceNodesRecursive(source, scene, 0, rootNode, currentStackIndex);
+	attachRigidMeshes(scene);
+
+	addConvertedScene(scene, start);
 	return true;
 }
 
+void FbxToHkxConverter::addConvertedScene(hkxScene* scene, const std::chrono::steady_clock::time_point& start)
+{
+	m_scenes.pushBack(scene);
+
+	// Timed up to here, saving the scene below has its own scope
+	const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	m_sceneConvertSeconds.pushBack(std::chrono::duration<double>(end - start).count());
+	if (m_options.m_profiler)
+	{
+		m_options.m_profiler->addEvent("createSceneStack", "phase", scene->m_rootNode ? scene->m_rootNode->m_name.cString() : "", start, end);
+	}
+
+	if (m_outputPath.getLength() > 0 && !m_options.m_singleContainer)
+	{
+		saveScenes(m_outputPath, m_outputName);
+	}
+}
+
+// If the node name starts with collision_, a hkxAttributeGroup called hkClothCollidable is added to it, with two
+// hkxAttribute children: collidableShapeType and heightfieldResolution
+static void addCollidableAttributeGroup(hkxNode* node)
+{
+	if (strncmp(node->m_name.cString(), "collision_", 10) == 0) {
+		printf("Adding collision hkxAttributeGroup to %s\n", node->m_name.cString());
+    
+		// Create hkxAttributeGroup named "hkClothCollidable"
+		hkxAttributeGroup* clothCollidable = new hkxAttributeGroup();
+		clothCollidable->m_name = "hkClothCollidable";
+    
+		// Create first attribute "collidableShapeType"
+		hkxAttribute* shapeTypeAttr = new hkxAttribute();
+		shapeTypeAttr->m_name = "collidableShapeType";
+    
+		// Set value based on collision type
+		hkxSparselyAnimatedString* animatedStringData = new hkxSparselyAnimatedString();
+		shapeTypeAttr->m_value = animatedStringData;
+    
+		const char* nodeName = node->m_name.cString();
+		bool recognizedType = true;
+
+		if (strncmp(nodeName, "collision_sphere", 16) == 0) {
+			animatedStringData->m_strings.expandOne() = "Sphere";
+		}
+		else if (strncmp(nodeName, "collision_plane", 15) == 0) {
+			animatedStringData->m_strings.expandOne() = "Plane";
+		}
+		else if (strncmp(nodeName, "collision_capsule", 17) == 0) {
+			animatedStringData->m_strings.expandOne() = "Capsule";
+		}
+		else if (strncmp(nodeName, "collision_convexgeom", 20) == 0) {
+			animatedStringData->m_strings.expandOne() = "Convex Geometry";
+		}
+		else if (strncmp(nodeName, "collision_convexheight", 22) == 0) {
+			animatedStringData->m_strings.expandOne() = "Convex Heightfield";
+		}
+		else {
+			// Default to "Capsule" but warn about unrecognized type
+			animatedStringData->m_strings.expandOne() = "Capsule";
+			printf("Warning: Unrecognized collision type in '%s' (defaulting to 'Capsule')\n", nodeName);
+		}
+		animatedStringData->m_times.expandOne() = 0.f; // not size
+		animatedStringData->removeReference();
+
+		// Create second attribute "heightfieldResolution"
+		hkxAttribute* resolutionAttr = new hkxAttribute();
+		resolutionAttr->m_name = "heightfieldResolution";
+		// Set value as needed
+		hkxSparselyAnimatedInt* animatedData = new hkxSparselyAnimatedInt();
+		animatedData->m_ints.expandOne() = (hkInt32) 128; // maybe we can up this at cost of performance? can't edit in 3dsmax exporter
+		animatedData->m_times.expandOne() = 0.f; // not size
+		animatedData->removeReference();
+        
+		// Add attributes to the group
+		clothCollidable->m_attributes.pushBack(*shapeTypeAttr);
+		clothCollidable->m_attributes.pushBack(*resolutionAttr);
+        
+		// Add the group to the node
+		node->m_attributeGroups.expandBy(1);
+		node->m_attributeGroups.pushBack(*clothCollidable);
+		printf("Done adding collision to %s\r\n",node->m_name.cString());
+	}
+}
+
 // This method is templated on the implementation of hctMayaSceneExporter::createHkxNodes()
-void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkxNode* node, int animStackIndex, const char* hkxExtraData_path)
+void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkxNode* node, int animStackIndex)
 {
 	for (int childIndex = 0; childIndex < fbxNode->GetChildCount(); childIndex++)
 	{
@@ -312,15 +866,15 @@ void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkx
 			case FbxNodeAttribute::eMesh:
 				{
 					// Generate hkxMesh and all its dependent data (ie: hkxSkinBinding, hkxMeshSection, hkxMaterial)
-					if (m_options.m_exportMeshes)
+					if (m_options.m_exportMeshes && m_convertGeometry)
 					{
-						addMesh(scene, fbxChildNode, newChildNode, hkxExtraData_path);
+						addMesh(scene, fbxChildNode, newChildNode);
 					}
 					break;
 				}
 			case FbxNodeAttribute::eNurbsCurve:
 				{
-					if (m_options.m_exportSplines)
+					if (m_options.m_exportSplines && m_convertGeometry)
 					{
 						addSpline(scene, fbxChildNode, newChildNode);
 					}
@@ -329,7 +883,7 @@ void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkx
 			case FbxNodeAttribute::eCamera:
 				{
 					// Generate hkxCamera
-					if (m_options.m_exportCameras)
+					if (m_options.m_exportCameras && m_convertGeometry)
 					{
 						addCamera(scene, fbxChildNode, newChildNode);
 					}
@@ -338,7 +892,7 @@ void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkx
 			case FbxNodeAttribute::eLight:
 				{
 					// Generate hkxLight
-					if (m_options.m_exportLights)
+					if (m_options.m_exportLights && m_convertGeometry)
 					{
 						addLight(scene, fbxChildNode, newChildNode);
 					}
@@ -358,120 +912,128 @@ void FbxToHkxConverter::addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkx
 		// Extract this node's animation data and bind transform
 		extractKeyFramesAndAnnotations(scene, fbxChildNode, newChildNode, animStackIndex);
 
+		// The weights are animation, they are sampled in every scene even if the mesh is not converted into it
+		if (m_options.m_exportVertexAnimations && fbxNodeAtttrib && fbxNodeAtttrib->GetAttributeType() == FbxNodeAttribute::eMesh)
+		{
+			addBlendShapeWeights(scene, animStackIndex, fbxChildNode, newChildNode);
+		}
+
 		if (m_options.m_exportAttributes)
 		{
 			addSampledNodeAttributeGroups(scene, animStackIndex, fbxChildNode, newChildNode);
 		}
 
-		// check here if node name starts with collision_
-		// if thats the case, first add a hkxAttributeGroup to this node called hkClothCollidable, with two hkxAttribute children; collidableShapeType and heightfieldResolution
-		if (strncmp(newChildNode->m_name.cString(), "collision_", 10) == 0) {
-			printf("Adding collision hkxAttributeGroup to %s\n", newChildNode->m_name.cString());
-    
-			// Create hkxAttributeGroup named "hkClothCollidable"
-			hkxAttributeGroup* clothCollidable = new hkxAttributeGroup();
-			clothCollidable->m_name = "hkClothCollidable";
-    
-			// Create first attribute "collidableShapeType"
-			hkxAttribute* shapeTypeAttr = new hkxAttribute();
-			shapeTypeAttr->m_name = "collidableShapeType";
-    
-			// Set value based on collision type
-			hkxSparselyAnimatedString* animatedStringData = new hkxSparselyAnimatedString();
-			shapeTypeAttr->m_value = animatedStringData;
-    
-			const char* nodeName = newChildNode->m_name.cString();
-			bool recognizedType = true;
-
-			if (strncmp(nodeName, "collision_sphere", 16) == 0) {
-				animatedStringData->m_strings.expandOne() = "Sphere";
-			}
-			else if (strncmp(nodeName, "collision_plane", 15) == 0) {
-				animatedStringData->m_strings.expandOne() = "Plane";
-			}
-			else if (strncmp(nodeName, "collision_capsule", 17) == 0) {
-				animatedStringData->m_strings.expandOne() = "Capsule";
-			}
-			else if (strncmp(nodeName, "collision_convexgeom", 20) == 0) {
-				animatedStringData->m_strings.expandOne() = "Convex Geometry";
-			}
-			else if (strncmp(nodeName, "collision_convexheight", 22) == 0) {
-				animatedStringData->m_strings.expandOne() = "Convex Heightfield";
-			}
-			else {
-				// Default to "Capsule" but warn about unrecognized type
-				animatedStringData->m_strings.expandOne() = "Capsule";
-				printf("Warning: Unrecognized collision type in '%s' (defaulting to 'Capsule')\n", nodeName);
-			}
-			animatedStringData->m_times.expandOne() = 0.f; // not size
-			animatedStringData->removeReference();
-
-			// Create second attribute "heightfieldResolution"
-			hkxAttribute* resolutionAttr = new hkxAttribute();
-			resolutionAttr->m_name = "heightfieldResolution";
-			// Set value as needed
-			hkxSparselyAnimatedInt* animatedData = new hkxSparselyAnimatedInt();
-			animatedData->m_ints.expandOne() = (hkInt32) 128; // maybe we can up this at cost of performance? can't edit in 3dsmax exporter
-			animatedData->m_times.expandOne() = 0.f; // not size
-			animatedData->removeReference();
-        
-			// Add attributes to the group
-			clothCollidable->m_attributes.pushBack(*shapeTypeAttr);
-			clothCollidable->m_attributes.pushBack(*resolutionAttr);
-        
-			// Add the group to the node
-			newChildNode->m_attributeGroups.expandBy(1);
-			newChildNode->m_attributeGroups.pushBack(*clothCollidable);
-			printf("Done adding collision to %s\r\n",newChildNode->m_name.cString());
-		}
-		// done with collision shenanigans
+		addCollidableAttributeGroup(newChildNode);
 
 		GetCustomVisionData(fbxChildNode, newChildNode->m_userProperties);
 
-		addNodesRecursive(scene, fbxChildNode, newChildNode, animStackIndex, hkxExtraData_path);
+		addNodesRecursive(scene, fbxChildNode, newChildNode, animStackIndex);
 		newChildNode->removeReference();
 	}
 }
 
-static void extractKeyTimes(FbxNode* fbxChildNode, FbxAnimLayer* fbxAnimLayer, const char* channel, hkxNode* node, hkReal startTime, hkReal endTime)
+void FbxToHkxConverter::addSourceNodesRecursive(const SceneSource& source, hkxScene *scene, int sourceNode, hkxNode* node, int stackIndex)
 {
-	HK_ASSERT(0x0, startTime <= endTime || endTime < 0.f);
-	startTime = hkMath::max2(startTime, 0.f);
-	FbxAnimCurve* lAnimCurve = fbxChildNode->LclTranslation.GetCurve(fbxAnimLayer, channel);
-	if (lAnimCurve)
+	for (int childIndex = 0; childIndex < source.getNumChildren(sourceNode); childIndex++)
 	{
-		int lKeyCount = lAnimCurve->KeyGetCount();
-		hkReal lKeyTime;
+		const int sourceChildNode = source.getChild(sourceNode, childIndex);
+
+		hkxNode* newChildNode = new hkxNode();
+		newChildNode->m_name = source.getNodeName(sourceChildNode);
+		node->m_children.pushBack(newChildNode);
 
-		// Store keyframe times in seconds(from [0, endTime])
-		for(int lCount = 0; lCount < lKeyCount; lCount++)
+		switch (source.getNodeType(sourceChildNode))
 		{
-			lKeyTime = hkMath::max2((hkReal)lAnimCurve->KeyGetTime(lCount).GetSecondDouble(), 0.f);
-			if (lKeyTime >= startTime && (lKeyTime <= endTime || endTime < 0.f))
+		case SceneSource::NODE_MESH:
 			{
-				if (node->m_linearKeyFrameHints.indexOf(lKeyTime) < 0)
+				if (m_options.m_exportMeshes && m_convertGeometry)
 				{
-					node->m_linearKeyFrameHints.pushBack(lKeyTime - startTime);
+					addSourceMesh(source, scene, sourceChildNode, newChildNode);
 				}
+				break;
 			}
-			else // handle case of [EXP-2436], where no keys in the range but range is affected by keys outside, so have to mark at start and end
+		case SceneSource::NODE_SKELETON:
 			{
-				if ((lKeyTime < startTime) &&(node->m_linearKeyFrameHints.indexOf(0.f) < 0))
-				{
-					node->m_linearKeyFrameHints.pushBack(0.f);
-				}
-				else if (endTime >= 0.f &&(lKeyTime - startTime > endTime) &&(node->m_linearKeyFrameHints.indexOf(endTime - startTime) < 0))
-				{
-					node->m_linearKeyFrameHints.pushBack(endTime - startTime);
-				}
+				newChildNode->m_bone = true;
+				break;
 			}
+		default:
+			break;
+		}
+
+		{
+			ConversionProfiler::Scope nodeScope(m_options.m_profiler, "extractKeyFrames", "node", newChildNode->m_name.cString());
+			setSampledKeyFrames(source, sourceChildNode, stackIndex, scene->m_sceneLength != 0, newChildNode);
+		}
+
+		addCollidableAttributeGroup(newChildNode);
+
+		addSourceNodesRecursive(source, scene, sourceChildNode, newChildNode, stackIndex);
+		newChildNode->removeReference();
+	}
+}
+
+void FbxToHkxConverter::attachRigidMeshes(hkxScene *scene)
+{
+	for (size_t meshIndex = 0; meshIndex < m_rigidMeshes.size(); ++meshIndex)
+	{
+		const RigidMesh& rigidMesh = m_rigidMeshes[meshIndex];
+		hkxNode* boneNode = scene->findNodeByName(rigidMesh.m_boneName.c_str());
+		if (!boneNode)
+		{
+			// The mesh stays in the scene's mesh list
+			printf("Warning: bone %s of rigid mesh %s is not in the scene\r\n", rigidMesh.m_boneName.c_str(), rigidMesh.m_nodeName.c_str());
+			continue;
+		}
+
+		// The vertices are in the space of the bone, the node doesn't move relative to it
+		hkxNode* newChildNode = new hkxNode();
+		newChildNode->m_name = rigidMesh.m_nodeName.c_str();
+		newChildNode->m_object = rigidMesh.m_mesh;
+		newChildNode->m_keyFrames.setSize( scene->m_numFrames > 1 ? 2 : 1, hkMatrix4::getIdentity() );
+		boneNode->m_children.pushBack(newChildNode);
+		newChildNode->removeReference();
+	}
+	m_rigidMeshes.clear();
+}
+
+void FbxToHkxConverter::setSampledKeyFrames(const SceneSource& source, int sourceNode, int stackIndex, bool animated, hkxNode* node)
+{
+	HK_ASSERT(0x0, node->m_keyFrames.getSize() == 0);
+
+	// Static nodes get the pose at the start (1 key, 2 in animated scene data), animated ones a key per frame
+	std::vector<double> keyFrames;
+	sampleKeyFrames(source, sourceNode, stackIndex, animated, keyFrames);
+
+	const int numKeys = (int)keyFrames.size() / 16;
+	node->m_keyFrames.setSize(numKeys);
+	for (int keyIndex = 0; keyIndex < numKeys; keyIndex++)
+	{
+		if (m_changeBasis)
+		{
+			changeBasis(m_outputBasis, m_outputBasisInverse, &keyFrames[keyIndex * 16]);
+		}
+		convertSourceMatrixToMatrix4(&keyFrames[keyIndex * 16], node->m_keyFrames[keyIndex]);
+	}
+
+	// Extract all times of actual keyframes for the current node... this can be used by Vision
+	if (m_options.m_storeKeyframeSamplePoints && numKeys > 2 && stackIndex >= 0)
+	{
+		std::vector<float> hints;
+		collectKeyTimeHints(source, sourceNode, stackIndex, hints);
+
+		node->m_linearKeyFrameHints.setSize((int)hints.size());
+		for (int hintIndex = 0; hintIndex < (int)hints.size(); hintIndex++)
+		{
+			node->m_linearKeyFrameHints[hintIndex] = hints[hintIndex];
 		}
 	}
 }
 
 void FbxToHkxConverter::extractKeyFramesAndAnnotations(hkxScene *scene, FbxNode* fbxChildNode, hkxNode* newChildNode, int animStackIndex)
 {
-	FbxAMatrix bindPoseMatrix;
+	ConversionProfiler::Scope nodeScope(m_options.m_profiler, "extractKeyFramesAndAnnotations", "node", fbxChildNode->GetName());
+
 	FbxAnimStack* lAnimStack = NULL;
 	int numAnimLayers = 0;
 	FbxTimeSpan animTimeSpan;
@@ -483,116 +1045,77 @@ void FbxToHkxConverter::extractKeyFramesAndAnnotations(hkxScene *scene, FbxNode*
 		animTimeSpan = lAnimStack->GetLocalTimeSpan();
 	}
 
-	// Find the time offset (in the "time space" of the FBX file) of the first animation frame
-	FbxTime timePerFrame; timePerFrame.SetTime(0, 0, 0, 1, 0, m_curFbxScene->GetGlobalSettings().GetTimeMode());
-	const FbxTime startTime = animTimeSpan.GetStart();
-	const FbxTime endTime = animTimeSpan.GetStop();
-
-	const hkReal startTimeSeconds = static_cast<hkReal>(startTime.GetSecondDouble());
-	const hkReal endTimeSeconds = static_cast<hkReal>(endTime.GetSecondDouble());
-
-	int numFrames = 0;
-	bool staticNode = true;
-
-	if (scene->m_sceneLength == 0)
+	// Sampling is skipped if the node's curves in this stack are unchanged since a cached conversion
+	const bool cacheKeyFrames = (m_options.m_objectStore != HK_NULL && lAnimStack != NULL && scene->m_sceneLength != 0);
+	hkUint64 keyFrameCacheKey = 0;
+	if (cacheKeyFrames)
 	{
-		bindPoseMatrix = fbxChildNode->EvaluateLocalTransform(startTime);
+		keyFrameCacheKey = computeKeyFrameCacheKey(fbxChildNode, lAnimStack);
+		if (loadCachedKeyFrames(keyFrameCacheKey, newChildNode))
+		{
+			return;
+		}
 	}
-	else
-	{
-		hkArray<hkStringOld> annotationStrings;
-		hkArray<hkReal> annotationTimes;
 
-		HK_ASSERT(0x0, newChildNode->m_keyFrames.getSize() == 0);
+	const bool animated = (scene->m_sceneLength != 0);
+	setSampledKeyFrames(*m_sceneSource, m_sceneSource->getNodeIndex(fbxChildNode), animStackIndex, animated, newChildNode);
 
-		// Sample each animation frame
-		for (FbxTime time = startTime, priorSampleTime = endTime;
-			 time < endTime;
-			 priorSampleTime = time, time += timePerFrame, ++numFrames)
-		{
-			FbxAMatrix frameMatrix = fbxChildNode->EvaluateLocalTransform(time);
-			staticNode = staticNode && (frameMatrix == bindPoseMatrix);
-
-			hkMatrix4 mat;
+	// Extract all annotation strings of the frames using the deprecated pipeline (new annotations are extracted when
+	// sampling attributes)
+	if (animated && m_options.m_exportAnnotations && numAnimLayers > 0)
+	{
+		FbxTime timePerFrame; timePerFrame.SetTime(0, 0, 0, 1, 0, m_curFbxScene->GetGlobalSettings().GetTimeMode());
+		const FbxTime startTime = animTimeSpan.GetStart();
+		const FbxTime endTime = animTimeSpan.GetStop();
+		FbxAnimLayer* lAnimLayer = lAnimStack->GetMember<FbxAnimLayer>(0);
 
-			// Extract this frame's transform
-			convertFbxXMatrixToMatrix4(frameMatrix, mat);
-			newChildNode->m_keyFrames.pushBack(mat);
+		for (FbxProperty prop = fbxChildNode->GetFirstProperty(); prop.IsValid(); prop = fbxChildNode->GetNextProperty(prop))
+		{
+			FbxString propName  = prop.GetName();
+			FbxDataType lDataType = prop.GetPropertyDataType();
+			if (lDataType.GetType() != eFbxEnum || !hkString::beginsWithCase(propName.Buffer(), "HK"))
+			{
+				continue;
+			}
 
-			// Extract all annotation strings for this frame using the deprecated
-			// pipeline (new annotations are extracted when sampling attributes)
-			if (m_options.m_exportAnnotations && numAnimLayers > 0)
+			FbxAnimCurve* lAnimCurve = prop.GetCurve(lAnimLayer);
+			for (FbxTime time = startTime, priorSampleTime = endTime;
+				 time < endTime;
+				 priorSampleTime = time, time += timePerFrame)
 			{
-				FbxProperty prop = fbxChildNode->GetFirstProperty();
-				while(prop.IsValid())
+				int currentKeyIndex;
+				const int keyIndex = (int)lAnimCurve->KeyFind(time, &currentKeyIndex);
+				const int priorKeyIndex = (int) lAnimCurve->KeyFind(priorSampleTime);
+
+				// Only store annotations on frames where they're explicitly keyframed, or if this is the first keyframe 
+				if (priorKeyIndex != keyIndex)
 				{
-					FbxString propName  = prop.GetName();
-					FbxDataType lDataType = prop.GetPropertyDataType();
-					if (lDataType.GetType() == eFbxEnum && hkString::beginsWithCase(propName.Buffer(), "HK"))
-					{
-						FbxAnimLayer* lAnimLayer = lAnimStack->GetMember<FbxAnimLayer>(0);
-						FbxAnimCurve* lAnimCurve = prop.GetCurve(lAnimLayer);
-
-						int currentKeyIndex;
-						const int keyIndex = (int)lAnimCurve->KeyFind(time, &currentKeyIndex);
-						const int priorKeyIndex = (int) lAnimCurve->KeyFind(priorSampleTime);
-
-						// Only store annotations on frames where they're explicitly keyframed, or if this is the first keyframe 
-						if (priorKeyIndex != keyIndex)
-						{
-							const int currentEnumValueIndex = keyIndex < 0 ? (int) lAnimCurve->Evaluate(priorSampleTime) : (int) lAnimCurve->Evaluate(time);
-							HK_ASSERT(0x0, currentEnumValueIndex < prop.GetEnumCount());
-							const char* enumValue = prop.GetEnumValue(currentEnumValueIndex);
-							hkxNode::AnnotationData& annotation = newChildNode->m_annotations.expandOne();
-							annotation.m_time = (hkReal) (time - startTime).GetSecondDouble();
-
-							hkStringBuf description(propName.Buffer(), enumValue);
-							annotation.m_description = description;
-						}
-					}
-					prop = fbxChildNode->GetNextProperty(prop);
+					const int currentEnumValueIndex = keyIndex < 0 ? (int) lAnimCurve->Evaluate(priorSampleTime) : (int) lAnimCurve->Evaluate(time);
+					HK_ASSERT(0x0, currentEnumValueIndex < prop.GetEnumCount());
+					const char* enumValue = prop.GetEnumValue(currentEnumValueIndex);
+					hkxNode::AnnotationData& annotation = newChildNode->m_annotations.expandOne();
+					annotation.m_time = (hkReal) (time - startTime).GetSecondDouble();
+
+					hkStringBuf description(propName.Buffer(), enumValue);
+					annotation.m_description = description;
 				}
 			}
 		}
-	}
-
-	// Replace animation key data for static nodes with just 1 or 2 frames of bind pose data
-	if (staticNode)
-	{
-		// Static nodes in animated scene data are exported with two keys
-		const bool exportTwoFramesForStaticNodes = (numFrames > 1);
 
-		// replace transform
-		newChildNode->m_keyFrames.setSize(exportTwoFramesForStaticNodes ? 2: 1);
-		newChildNode->m_keyFrames.optimizeCapacity(0, true);
-
-		// convert the bind pose transform to Havok format
-		convertFbxXMatrixToMatrix4(bindPoseMatrix, newChildNode->m_keyFrames[0]);
-
-		if (exportTwoFramesForStaticNodes)
+		// The annotations were found property by property, they are stored in time order
+		hkArray<hkxNode::AnnotationData>& annotations = newChildNode->m_annotations;
+		for (int i = 1; i < annotations.getSize(); ++i)
 		{
-			newChildNode->m_keyFrames[1] = newChildNode->m_keyFrames[0];
+			for (int j = i; j > 0 && annotations[j].m_time < annotations[j - 1].m_time; --j)
+			{
+				hkAlgorithm::swap(annotations[j], annotations[j - 1]);
+			}
 		}
 	}
 
-	// Extract all times of actual keyframes for the current node... this can be used by Vision
-	if ( m_options.m_storeKeyframeSamplePoints &&
-		 newChildNode->m_keyFrames.getSize() > 2 &&
-		 numAnimLayers > 0 )
+	if (cacheKeyFrames)
 	{
-		FbxAnimLayer* lAnimLayer = lAnimStack->GetMember<FbxAnimLayer>(0);
-
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_TRANSLATION, newChildNode, startTimeSeconds, endTimeSeconds);
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_ROTATION, newChildNode, startTimeSeconds, endTimeSeconds);
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_SCALING, newChildNode, startTimeSeconds, endTimeSeconds);
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_COMPONENT_X, newChildNode, startTimeSeconds, endTimeSeconds);
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_COMPONENT_Y, newChildNode, startTimeSeconds, endTimeSeconds);
-		extractKeyTimes(fbxChildNode, lAnimLayer, FBXSDK_CURVENODE_COMPONENT_Z, newChildNode, startTimeSeconds, endTimeSeconds);
-
-		if (newChildNode->m_linearKeyFrameHints.getSize() > 1)
-		{
-			hkSort(newChildNode->m_linearKeyFrameHints.begin(), newChildNode->m_linearKeyFrameHints.getSize());
-		}
+		storeCachedKeyFrames(keyFrameCacheKey, newChildNode);
 	}
 }
 
@@ -21,6 +21,22 @@
 #include <Common/Base/Container/PointerMap/hkPointerMap.h>
 #include <Common/Base/Container/String/Deprecated/hkStringOld.h>
 
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+class ExportDataIndex;
+class ConversionObjectStore;
+class ConversionManifest;
+class ConversionProfiler;
+class ConversionMemoryStats;
+class hkxMeshSection;
+class FbxSceneSource;
+class SceneSource;
+struct SceneMesh;
+struct SceneMaterial;
+
 class FbxToHkxConverter
 {
 public:
@@ -36,10 +52,45 @@ public:
 		bool		m_exportCameras;
 		bool		m_exportSplines;
 		bool		m_exportVertexTangents;
+		// Convert the blend shapes of meshes (sparse quantized targets, see addBlendShapes()) and sample the weights of
+		// their channels
 		bool		m_exportVertexAnimations;
+		// Largest bone palette of a skinned section, larger ones are split into sections (by triangles) that each get
+		// a palette in hkxMeshSection::m_boneMatrixMap, mapping their blend indices to the bones of the skin binding.
+		// 0 only splits skins of more bones than the 8 bit blend indices address (256). Otherwise at least
+		// MIN_SKIN_BONE_PALETTE (ScenePipeline.h), smaller palettes can't hold every triangle.
+		int			m_maxSkinBones;
+		// Triangles of skinned meshes whose vertices all follow one bone are moved into a mesh of their own, in the
+		// space of the bone and without blend weights, under a child node of the bone ("<mesh>_<bone>_rigid")
+		bool		m_extractRigidSections;
+		// Convert the animation stacks, otherwise only the static scene
+		bool		m_exportAnimations;
+		// The scenes of the animation stacks only hold the node transforms, bones, attributes and annotations. Meshes,
+		// splines, cameras and lights are only converted into the rig scene (or the single scene with noTakes).
+		bool		m_animationOnlyStacks;
+		// Length of an output unit in meters, 0 keeps the unit of the source. The axes are always converted to the
+		// 3ds Max axis system (Z up), from the axis system of the source.
+		double		m_unitMeters;
+		// Let the FBX SDK extract embedded media to a .fbm folder next to the input, textures are only referenced by filename
+		bool		m_extractEmbeddedMedia;
 		bool		m_visibleOnly;
 		bool		m_selectedOnly;
 		bool		m_storeKeyframeSamplePoints;
+		// Save all scenes as named variants of a single container instead of one file per scene
+		bool		m_singleContainer;
+		// If set, converted mesh sections and sampled keyframes are cached here and reused on later runs
+		ConversionObjectStore* m_objectStore;
+		// If set, called with every result line (see getReport()) as soon as it is reported
+		void (*m_reportFunction)(const char* line, void* userData);
+		void* m_reportUserData;
+		// If set, every saved scene is recorded here
+		ConversionManifest* m_manifest;
+		// If set, the conversion phases and the work on each node are timed
+		ConversionProfiler* m_profiler;
+		// If set, the peak memory use of each scene and mesh is tracked
+		ConversionMemoryStats* m_memoryStats;
+		// Print the size breakdown of every saved scene and add it to the manifest (see SceneSizeReport.h)
+		bool		m_reportSizes;
 
 		Options(FbxManager* fbxSdkManager);
 	};
@@ -47,8 +98,24 @@ public:
 	FbxToHkxConverter(const Options& options);
 	~FbxToHkxConverter();
 	
-	bool createScenes(FbxScene* fbxScene, bool noTakes, const char* hkxExtraData_path);
+	// exportData (optional) supplies the vertex selection sets and float channels added to meshes
+	bool createScenes(FbxScene* fbxScene, bool noTakes, ExportDataIndex* exportData);
+	// Converts a scene read through a SceneSource (see SceneSource.h) instead of the FBX SDK: the node tree, meshes
+	// with their materials, skins and user channels, and the keyframes of every stack. Cameras, lights, splines,
+	// attributes and annotations are only converted from an FbxScene. Options::m_fbxSdkManager may be NULL.
+	bool createScenes(const SceneSource& source, const char* modeller, const char* asset, bool noTakes, ExportDataIndex* exportData);
 	void saveScenes(const char *path, const char *name);
+	// If called before createScenes(), each scene is saved as soon as it has been converted instead of waiting for
+	// saveScenes() (except in single container mode), so consumers of the outputs can start on the first scenes early
+	void setOutput(const char *path, const char *name);
+
+	// The lines of the console output that describe the conversion result (bone and stack counts, saved files and
+	// scene lengths), in the order they were printed
+	const char* getReport() const { return m_report.cString(); }
+	int getNumScenes() const { return m_scenes.getSize(); }
+	const hkxScene* getScene(int sceneIndex) const { return m_scenes[sceneIndex]; }
+	// Names of the files written by saveScenes(), relative to the output path
+	const hkArray<hkStringPtr>& getSavedFiles() const { return m_savedFiles; }
 
 private:
 
@@ -72,14 +139,28 @@ private:
 		matrix.setCols(c0,c1,c2,c3);
 	}
 
+	// A matrix of a SceneSource (four columns of four values)
+	static void convertSourceMatrixToMatrix4(const double* sourceMatrix, hkMatrix4& matrix)
+	{
+		hkVector4 c0; c0.set((float)sourceMatrix[0],(float)sourceMatrix[1],(float)sourceMatrix[2],(float)sourceMatrix[3]);
+		hkVector4 c1; c1.set((float)sourceMatrix[4],(float)sourceMatrix[5],(float)sourceMatrix[6],(float)sourceMatrix[7]);
+		hkVector4 c2; c2.set((float)sourceMatrix[8],(float)sourceMatrix[9],(float)sourceMatrix[10],(float)sourceMatrix[11]);
+		hkVector4 c3; c3.set((float)sourceMatrix[12],(float)sourceMatrix[13],(float)sourceMatrix[14],(float)sourceMatrix[15]);
+
+		matrix.setCols(c0,c1,c2,c3);
+	}
+
+	// Fills the buffers of a mesh section from the given triangles of the mesh (see ScenePipeline.h). With a bone
+	// palette the blend indices are positions in it. With a rigid transform the vertices are transformed by it and
+	// the skin streams are left out.
 	static void fillBuffers(
-		FbxMesh* pMesh,
-		FbxNode* originalNode,
+		const SceneMesh& sceneMesh,
 		hkxVertexBuffer* newVB,
 		hkxIndexBuffer* newIB,
-		const hkArray<float>& skinControlPointWeights,
-		const hkArray<int>& skinIndicesToClusters,
-		const hkArray<int>& polyIndices);
+		const int* polyIndices,
+		int numPolys,
+		const std::vector<int>* bonePalette,
+		const double* rigidTransform = HK_NULL);
 	static void findChildren(FbxNode* root, hkArray<FbxNode*>& children, FbxNodeAttribute::EType type);
 
 	// Get the global position of the node for the current pose.
@@ -95,9 +176,54 @@ private:
 
 	void clear();
 
-	bool createSceneStack(int animStackIndex, const char* hkxExtraData_path);
-	void addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkxNode* node, int animStackIndex, const char* hkxExtraData_path);	
-	void addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* node, const char* hkxExtraData_path);
+	// Computes the conversion from the coordinate system of the source to the output (see computeOutputBasis())
+	void setOutputBasis(const SceneSource& source);
+	// Applies the output basis to a transform (basis * matrix * inverse), a point or a direction
+	void toOutputBasis(hkMatrix4& matrixInOut) const;
+	void toOutputBasis(hkVector4& vectorInOut, bool direction) const;
+
+	void report(const char* format, ...);
+
+	// Variant names of all the scenes, also the suffixes of their files when each scene is saved on its own
+	void getSceneVariantNames(std::vector<std::string>& namesOut) const;
+	void saveScene(int sceneIndex, const char *path, const char *name);
+	void saveScenesToContainer(const char *path, const char *name);
+	void addManifestScene(int sceneIndex, const char *file, const char *variant, double saveSeconds, const std::string& sizes);
+	void reportSceneSizes(int sceneIndex, const char *title, hkLong fileBytes, std::string& sizesOut) const;
+	bool saveOutputFile(const char *path, const char *filename, const void* data, int size);
+
+	// geometry: convert meshes, splines, cameras and lights (see Options::m_animationOnlyStacks)
+	bool createSceneStack(int animStackIndex, bool geometry);
+	// Adds a converted scene, and saves it if the output was set
+	void addConvertedScene(hkxScene* scene, const std::chrono::steady_clock::time_point& start);
+	void addNodesRecursive(hkxScene *scene, FbxNode* fbxNode, hkxNode* node, int animStackIndex);	
+	void addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* node);
+	// Triangles of a material of a skinned mesh that follow one bone (see Options::m_extractRigidSections), converted
+	// once the skin binding is known. Holds a reference to the material.
+	struct RigidSection
+	{
+		int m_bone;
+		hkxMaterial* m_material;
+		std::vector<int> m_triangles;
+	};
+	// Creates the sections of the triangles of a material, several with their own bone palettes if the skin has to be
+	// split (see Options::m_maxSkinBones). Appends them with their triangles. Rigid triangles are appended to
+	// rigidSectionsOut instead if they are extracted.
+	void addMeshSections(const char* meshName, const SceneMesh& sceneMesh, const hkArray<int>& triangles, hkxMaterial* material,
+		hkArray<hkxMeshSection*>& sectionsOut, hkArray< hkArray<int> >& sectionTrianglesOut, std::vector<RigidSection>& rigidSectionsOut);
+	// Creates a mesh of the rigid sections of each bone, in the space of the bone at the bind pose of the skin, and
+	// releases the sections. The meshes are added to the scene and attached to their bones by attachRigidMeshes().
+	void addRigidMeshes(hkxScene *scene, const char* meshName, const SceneMesh& sceneMesh, std::vector<RigidSection>& rigidSections, const hkxSkinBinding* skin);
+	// Adds a node for each rigid mesh under its bone, once the node tree of the scene is complete
+	void attachRigidMeshes(hkxScene *scene);
+	// Adds the vertex selection sets and float channels of the export data to the sections of the mesh
+	void addUserChannels(const char* meshName, hkxMesh* newMesh);
+	// Adds the morph targets of the mesh as sparse quantized user channels of its sections, sectionTriangles are the
+	// triangles of sceneMesh in each section
+	void addBlendShapes(const char* meshName, const SceneMesh& sceneMesh, const hkArray< hkArray<int> >& sectionTriangles, hkxMesh* newMesh);
+	// Samples the blend shape channel weights of the mesh of the node in the stack into an "hkBlendShapeWeights"
+	// attribute group, one animated float per channel
+	void addBlendShapeWeights(hkxScene *scene, int animStackIndex, FbxNode* meshNode, hkxNode* node);
 	void addCamera(hkxScene *scene, FbxNode* cameraNode, hkxNode* node);
 	void addLight(hkxScene *scene, FbxNode* lightNode, hkxNode* node);
 	void addSpline(hkxScene *scene, FbxNode* splineNode, hkxNode* node);
@@ -105,6 +231,22 @@ private:
 	void getMaterialsInMesh(FbxMesh* pMesh, hkArray<FbxSurfaceMaterial*>& materialsOut);
 
 	void extractKeyFramesAndAnnotations(hkxScene *scene, FbxNode* fbxChildNode, hkxNode* newChildNode, int animStackIndex);
+	void setSampledKeyFrames(const SceneSource& source, int sourceNode, int stackIndex, bool animated, hkxNode* node);
+
+	// Conversion from a SceneSource
+	bool createSourceSceneStack(const SceneSource& source, int stackIndex, bool geometry);
+	void addSourceNodesRecursive(const SceneSource& source, hkxScene *scene, int sourceNode, hkxNode* node, int stackIndex);
+	void addSourceMesh(const SceneSource& source, hkxScene *scene, int sourceNode, hkxNode* node);
+	// A NULL material creates the dummy material
+	hkxMaterial* createSourceMaterial(const SceneMaterial* material, const SceneMesh& sceneMesh, hkxScene* scene);
+
+	// Object cache (FbxToHkxConverter_Cache.cpp)
+	hkUint64 computeMeshCacheKey(FbxNode* meshNode, FbxMesh* mesh, bool flipped) const;
+	bool loadCachedMeshSections(hkUint64 key, FbxNode* meshNode, FbxMesh* mesh, hkxScene* scene, hkArray<hkxMeshSection*>& sectionsOut, FbxSkin*& skinOut);
+	void storeCachedMeshSections(hkUint64 key, FbxNode* meshNode, const hkArray<hkxMeshSection*>& sections, const hkArray<FbxSurfaceMaterial*>& sectionMaterials, bool skinned);
+	hkUint64 computeKeyFrameCacheKey(FbxNode* fbxNode, FbxAnimStack* animStack) const;
+	bool loadCachedKeyFrames(hkUint64 key, hkxNode* node);
+	void storeCachedKeyFrames(hkUint64 key, const hkxNode* node);
 
 	// Convert an FBX texture into a Havok texture type. This might return the cached result from a prior conversion.
 	hkReferencedObject* convertTexture(
@@ -146,17 +288,48 @@ private:
 
 	hkArray<hkxScene*> m_scenes;
 	FbxScene *m_curFbxScene;
+	// The meshes and node transforms of m_curFbxScene are read through this
+	FbxSceneSource *m_sceneSource;
 	FbxPose *m_pose;
 	hkStringBuf m_modeller;
+	hkStringBuf m_asset;
 	int m_numAnimStacks;
+	// Whether the scene being converted gets meshes, splines, cameras and lights
+	bool m_convertGeometry;
+	// The axis and unit conversion of the source, applied to the keyframes, meshes, bind poses, cameras, lights and
+	// splines as they are converted. m_changeBasis is false if it is the identity.
+	double m_outputBasis[16];
+	double m_outputBasisInverse[16];
+	double m_outputScale;
+	bool m_changeBasis;
 	int m_numBones;
 	FbxTime m_startTime;
 	FbxNode *m_rootNode;
+	ExportDataIndex *m_exportData;
+	hkStringBuf m_report;
+	hkArray<hkStringPtr> m_savedFiles;
+	hkStringBuf m_outputPath;
+	hkStringBuf m_outputName;
+	int m_numSavedScenes;
+	// Seconds spent converting each scene
+	hkArray<double> m_sceneConvertSeconds;
+
+	// The rigid meshes of the scene being converted that still have to be attached to their bones
+	struct RigidMesh
+	{
+		std::string m_boneName;
+		std::string m_nodeName;
+		hkxMesh* m_mesh;
+	};
+	std::vector<RigidMesh> m_rigidMeshes;
 
 	// A cache of converted FBX -> Havok textures
 	hkPointerMap<FbxTexture*, hkRefVariant*> m_convertedTextures;
 	// A cache of converted FBX -> Havok materials
 	hkPointerMap<FbxSurfaceMaterial*, hkxMaterial*> m_convertedMaterials;
+	// The materials converted from a SceneSource, by SceneMaterial::m_id, and the material of meshes without any
+	std::map<long long, hkxMaterial*> m_convertedSourceMaterials;
+	hkxMaterial* m_defaultSourceMaterial;
 };
 
 #endif
@@ -76,11 +76,12 @@ void FbxToHkxConverter::addSampledNodeAttributeGroups(hkxScene *scene, int animS
 		hkxMesh* mesh = HK_NULL;
 		const hkClass* classType = ((hkxNode*)hkx_attributeHolder)->m_object.getClass();
 
-		if(classType->equals(&hkxMeshClass))
+		// There is no object if the mesh is not converted into this scene (animation only stacks)
+		if(classType && classType->equals(&hkxMeshClass))
 		{
 			mesh = (hkxMesh*) ((hkxNode*)hkx_attributeHolder)->m_object.val();
 		}
-		else if(classType->equals(&hkxSkinBindingClass))
+		else if(classType && classType->equals(&hkxSkinBindingClass))
 		{
 			hkxSkinBinding* skinBinding = (hkxSkinBinding*) ((hkxNode*)hkx_attributeHolder)->m_object.val();
 			mesh = skinBinding->m_mesh;
@@ -104,6 +105,46 @@ void FbxToHkxConverter::addSampledNodeAttributeGroups(hkxScene *scene, int animS
 	}
 }
 
+void FbxToHkxConverter::addBlendShapeWeights(hkxScene *scene, int animStackIndex, FbxNode* meshNode, hkxNode* node)
+{
+	FbxMesh* mesh = meshNode->GetMesh();
+	const int numBlendShapes = mesh ? mesh->GetDeformerCount(FbxDeformer::eBlendShape) : 0;
+	if (numBlendShapes == 0)
+	{
+		return;
+	}
+
+	hkxAttributeGroup& group = node->m_attributeGroups.expandOne();
+	group.m_name = "hkBlendShapeWeights";
+
+	for (int blendShapeIndex = 0; blendShapeIndex < numBlendShapes; ++blendShapeIndex)
+	{
+		FbxBlendShape* blendShape = (FbxBlendShape*)mesh->GetDeformer(blendShapeIndex, FbxDeformer::eBlendShape);
+		for (int channelIndex = 0; channelIndex < blendShape->GetBlendShapeChannelCount(); ++channelIndex)
+		{
+			FbxBlendShapeChannel* channel = blendShape->GetBlendShapeChannel(channelIndex);
+
+			hkxAttribute hkxAttr;
+			FbxProperty weightProperty = channel->DeformPercent;
+			if (!createAndSampleAttribute(scene, animStackIndex, weightProperty, hkxAttr))
+			{
+				continue;
+			}
+
+			// DeformPercent is a percentage, the weights are 0 to 1 like the full weights of the targets. Without an
+			// animation stack there is one constant weight.
+			hkxAnimatedFloat* weights = (hkxAnimatedFloat*)hkxAttr.m_value.val();
+			for (int frame = 0; frame < weights->m_floats.getSize(); ++frame)
+			{
+				weights->m_floats[frame] *= 0.01f;
+			}
+
+			hkxAttr.m_name = channel->GetName();
+			group.m_attributes.pushBack(hkxAttr);
+		}
+	}
+}
+
 bool FbxToHkxConverter::createAndSampleAttribute(hkxScene *scene, int animStackIndex, FbxProperty& prop, hkxAttribute& hkx_attribute)
 {
 	hkx_attribute.m_name = HK_NULL;
@@ -130,7 +171,9 @@ bool FbxToHkxConverter::createAndSampleAttribute(hkxScene *scene, int animStackI
 	FbxDataType type = prop.GetPropertyDataType();
 	EFbxType dataType = type.GetType();
 
-	FbxTimeSpan animTimeSpan = lAnimStack->GetLocalTimeSpan();
+	// Without an animation stack (a scene without takes, animStackIndex -1) every attribute is a single key of its
+	// static value and the time span is never sampled
+	FbxTimeSpan animTimeSpan = lAnimStack ? lAnimStack->GetLocalTimeSpan() : FbxTimeSpan();
 	FbxTime timePerFrame; timePerFrame.SetTime(0, 0, 0, 1, 0, m_curFbxScene->GetGlobalSettings().GetTimeMode());
 
 	// Since the end time is assumed to be inclusive, sample up to one frame beyond it
@@ -0,0 +1,576 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "FbxToHkxConverter.h"
+#include "ConversionCache.h"
+
+// Fine-grained cache of the expensive per-object conversion steps. Triangulated and filled mesh sections are keyed
+// by the geometry layers of the FbxMesh, sampled keyframes by the node's transform properties and animation curves
+// in the stack. Both are stored in the content-addressed object store, so unchanged props and takes are restored
+// instead of converted again.
+
+#include <Common/SceneData/Mesh/hkxMesh.h>
+#include <Common/SceneData/Mesh/hkxMeshSection.h>
+#include <Common/Serialize/Util/hkSerializeUtil.h>
+#include <Common/Base/System/Io/Writer/Array/hkArrayStreamWriter.h>
+
+#include <string.h>
+#include <vector>
+
+// Bump when the layout of a cached object changes
+enum
+{
+	MESH_CACHE_MAGIC = 0x4853454D,		// "MESH"
+	KEYFRAME_CACHE_MAGIC = 0x5359454B,	// "KEYS"
+	OBJECT_CACHE_VERSION = 1
+};
+
+//-------
+
+template<typename T>
+static void hashLayerElementArray(ContentHasher& hasher, FbxLayerElementArrayTemplate<T>& elementArray)
+{
+	const int count = elementArray.GetCount();
+	hasher.addInt(count);
+	if (count > 0)
+	{
+		T* data = elementArray.GetLocked(FbxLayerElementArray::eReadLock);
+		if (data)
+		{
+			hasher.addBytes(data, sizeof(T) * count);
+			elementArray.Release(&data);
+		}
+	}
+}
+
+template<typename T>
+static void hashLayerElement(ContentHasher& hasher, FbxLayerElementTemplate<T>* element)
+{
+	if (element == NULL)
+	{
+		hasher.addInt(-1);
+		return;
+	}
+
+	hasher.addInt(element->GetMappingMode());
+	hasher.addInt(element->GetReferenceMode());
+	hashLayerElementArray(hasher, element->GetDirectArray());
+	if (element->GetReferenceMode() != FbxLayerElement::eDirect)
+	{
+		hashLayerElementArray(hasher, element->GetIndexArray());
+	}
+}
+
+// FbxDouble3 or FbxVector4, only the first three components are used
+template<typename T>
+static void hashDouble3(ContentHasher& hasher, const T& value)
+{
+	hasher.addDouble(value[0]);
+	hasher.addDouble(value[1]);
+	hasher.addDouble(value[2]);
+}
+
+static void hashAnimCurve(ContentHasher& hasher, FbxAnimCurve* curve)
+{
+	if (curve == NULL)
+	{
+		hasher.addInt(-1);
+		return;
+	}
+
+	struct Key
+	{
+		FbxLongLong m_time;
+		float m_value;
+		float m_leftDerivative;
+		float m_rightDerivative;
+		int m_interpolation;
+		int m_tangentMode;
+	};
+
+	const int numKeys = curve->KeyGetCount();
+	std::vector<Key> keys(numKeys);
+	if (numKeys > 0)
+	{
+		// Zero the padding so it doesn't end up in the key
+		memset(&keys[0], 0, sizeof(Key) * numKeys);
+	}
+	for (int keyIndex = 0; keyIndex < numKeys; keyIndex++)
+	{
+		Key& key = keys[keyIndex];
+		key.m_time = curve->KeyGetTime(keyIndex).Get();
+		key.m_value = curve->KeyGetValue(keyIndex);
+		key.m_leftDerivative = curve->KeyGetLeftDerivative(keyIndex);
+		key.m_rightDerivative = curve->KeyGetRightDerivative(keyIndex);
+		key.m_interpolation = curve->KeyGetInterpolation(keyIndex);
+		key.m_tangentMode = curve->KeyGetTangentMode(keyIndex);
+	}
+
+	hasher.addInt(numKeys);
+	hasher.addBytes(keys.empty() ? NULL : &keys[0], sizeof(Key) * keys.size());
+	hasher.addInt(curve->GetPreExtrapolation());
+	hasher.addInt(curve->GetPostExtrapolation());
+}
+
+// Bounds checked reader of a cached object
+class CachedObjectReader
+{
+public:
+
+	CachedObjectReader(const std::vector<char>& data) : m_data(data), m_offset(0), m_valid(true) {}
+
+	const void* read(size_t size)
+	{
+		if (!m_valid || size > m_data.size() - m_offset)
+		{
+			m_valid = false;
+			return HK_NULL;
+		}
+		const void* result = &m_data[0] + m_offset;
+		m_offset += size;
+		return result;
+	}
+
+	template<typename T>
+	T readValue()
+	{
+		T value = T();
+		const void* data = read(sizeof(T));
+		if (data)
+		{
+			memcpy(&value, data, sizeof(T));
+		}
+		return value;
+	}
+
+	bool isValid() const { return m_valid; }
+	bool isAtEnd() const { return m_offset == m_data.size(); }
+
+private:
+
+	const std::vector<char>& m_data;
+	size_t m_offset;
+	bool m_valid;
+};
+
+template<typename T>
+static void appendCachedValue(std::vector<char>& data, const T& value)
+{
+	const char* bytes = reinterpret_cast<const char*>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+//-------
+
+hkUint64 FbxToHkxConverter::computeMeshCacheKey(FbxNode* meshNode, FbxMesh* mesh, bool flipped) const
+{
+	ContentHasher hasher;
+	hasher.addInt(MESH_CACHE_MAGIC);
+	hasher.addInt(OBJECT_CACHE_VERSION);
+	hasher.addString(FBXIMPORTER_VERSION);
+	hasher.addInt(flipped);
+	hasher.addInt(m_options.m_exportVertexTangents);
+	hasher.addInt(m_options.m_maxSkinBones);
+	hasher.addBytes(m_outputBasis, sizeof(m_outputBasis));
+	hasher.addInt(mesh->IsTriangleMesh());
+
+	hasher.addInt(mesh->GetControlPointsCount());
+	hasher.addBytes(mesh->GetControlPoints(), sizeof(FbxVector4) * mesh->GetControlPointsCount());
+
+	const int polygonCount = mesh->GetPolygonCount();
+	std::vector<int> polygonSizes(polygonCount);
+	for (int polygonIndex = 0; polygonIndex < polygonCount; polygonIndex++)
+	{
+		polygonSizes[polygonIndex] = mesh->GetPolygonSize(polygonIndex);
+	}
+	hasher.addInt(polygonCount);
+	hasher.addBytes(polygonSizes.empty() ? NULL : &polygonSizes[0], sizeof(int) * polygonSizes.size());
+	hasher.addBytes(mesh->GetPolygonVertices(), sizeof(int) * mesh->GetPolygonVertexCount());
+
+	hashLayerElement(hasher, mesh->GetElementNormal(0));
+	hashLayerElement(hasher, mesh->GetElementVertexColor(0));
+
+	FbxStringList uvSetNames;
+	mesh->GetUVSetNames(uvSetNames);
+	hasher.addInt(uvSetNames.GetCount());
+	for (int uvSetIndex = 0; uvSetIndex < uvSetNames.GetCount(); uvSetIndex++)
+	{
+		hasher.addString(uvSetNames[uvSetIndex].Buffer());
+		hashLayerElement(hasher, mesh->GetElementUV(uvSetNames[uvSetIndex].Buffer()));
+	}
+	hasher.addInt(mesh->GetElementUVCount());
+
+	// Only the polygon to material mapping, the materials themselves are converted on every run
+	const FbxGeometryElementMaterial* elementMaterial = mesh->GetElementMaterial(0);
+	hasher.addInt(elementMaterial ? elementMaterial->GetMappingMode() : -1);
+	hasher.addInt(meshNode->GetMaterialCount());
+
+	hashDouble3(hasher, meshNode->GetGeometricTranslation(FbxNode::eSourcePivot));
+	hashDouble3(hasher, meshNode->GetGeometricRotation(FbxNode::eSourcePivot));
+	hashDouble3(hasher, meshNode->GetGeometricScaling(FbxNode::eSourcePivot));
+
+	// Skin weights end up in the vertex buffer
+	FbxSkin* skin = (FbxSkin*)mesh->GetDeformer(0, FbxDeformer::eSkin);
+	hasher.addInt(skin ? skin->GetClusterCount() : -1);
+	for (int clusterIndex = 0; skin && clusterIndex < skin->GetClusterCount(); clusterIndex++)
+	{
+		FbxCluster* cluster = skin->GetCluster(clusterIndex);
+		const int indexCount = cluster->GetControlPointIndicesCount();
+		hasher.addInt(indexCount);
+		hasher.addBytes(cluster->GetControlPointIndices(), sizeof(int) * indexCount);
+		hasher.addBytes(cluster->GetControlPointWeights(), sizeof(double) * indexCount);
+	}
+
+	return hasher.getKey();
+}
+
+// Layout: magic, version, number of sections, skinned flag, one material index per section (into the materials of
+// the mesh node, -1 for the default material), then a binary tag file of an hkxMesh holding the section buffers.
+bool FbxToHkxConverter::loadCachedMeshSections(hkUint64 key, FbxNode* meshNode, FbxMesh* mesh, hkxScene* scene, hkArray<hkxMeshSection*>& sectionsOut, FbxSkin*& skinOut)
+{
+	std::vector<char> data;
+	if (!m_options.m_objectStore->load(key, data))
+	{
+		return false;
+	}
+
+	CachedObjectReader reader(data);
+	const hkUint32 magic = reader.readValue<hkUint32>();
+	const hkUint32 version = reader.readValue<hkUint32>();
+	const hkUint32 numSections = reader.readValue<hkUint32>();
+	const hkUint32 skinned = reader.readValue<hkUint32>();
+	if (!reader.isValid() || magic != MESH_CACHE_MAGIC || version != OBJECT_CACHE_VERSION)
+	{
+		return false;
+	}
+
+	hkArray<int> materialIndices;
+	for (hkUint32 sectionIndex = 0; sectionIndex < numSections && reader.isValid(); sectionIndex++)
+	{
+		const int materialIndex = reader.readValue<hkInt32>();
+		if (materialIndex >= meshNode->GetMaterialCount())
+		{
+			return false;
+		}
+		materialIndices.pushBack(materialIndex);
+	}
+
+	const hkUint32 tagSize = reader.readValue<hkUint32>();
+	const void* tagData = reader.read(tagSize);
+	if (!reader.isValid() || !reader.isAtEnd())
+	{
+		return false;
+	}
+
+	FbxSkin* skin = HK_NULL;
+	if (skinned)
+	{
+		skin = (FbxSkin*)mesh->GetDeformer(0, FbxDeformer::eSkin);
+		if (skin == HK_NULL)
+		{
+			return false;
+		}
+	}
+
+	hkxMesh* cachedMesh = hkSerializeUtil::loadObject<hkxMesh>(tagData, (int)tagSize);
+	if (cachedMesh == HK_NULL)
+	{
+		return false;
+	}
+	if (cachedMesh->m_sections.getSize() != (int)numSections)
+	{
+		cachedMesh->removeReference();
+		return false;
+	}
+
+	for (int sectionIndex = 0; sectionIndex < materialIndices.getSize(); sectionIndex++)
+	{
+		hkxMaterial* sectMat = HK_NULL;
+		if (m_options.m_exportMaterials)
+		{
+			FbxSurfaceMaterial* material = materialIndices[sectionIndex] >= 0 ? meshNode->GetMaterial(materialIndices[sectionIndex]) : NULL;
+			sectMat = createMaterial(material, mesh, scene);
+		}
+
+		const hkxMeshSection* cachedSection = cachedMesh->m_sections[sectionIndex];
+
+		hkxMeshSection* newSection = new hkxMeshSection();
+		newSection->m_material = sectMat;
+		newSection->m_vertexBuffer = cachedSection->m_vertexBuffer;
+		newSection->m_indexBuffers.setSize(1);
+		newSection->m_indexBuffers[0] = cachedSection->m_indexBuffers[0];
+		newSection->m_boneMatrixMap = cachedSection->m_boneMatrixMap;
+		sectionsOut.pushBack(newSection);
+
+		if (sectMat)
+		{
+			sectMat->removeReference();
+		}
+	}
+
+	cachedMesh->removeReference();
+	skinOut = skin;
+	return true;
+}
+
+void FbxToHkxConverter::storeCachedMeshSections(hkUint64 key, FbxNode* meshNode, const hkArray<hkxMeshSection*>& sections, const hkArray<FbxSurfaceMaterial*>& sectionMaterials, bool skinned)
+{
+	std::vector<char> data;
+	appendCachedValue<hkUint32>(data, MESH_CACHE_MAGIC);
+	appendCachedValue<hkUint32>(data, OBJECT_CACHE_VERSION);
+	appendCachedValue<hkUint32>(data, sections.getSize());
+	appendCachedValue<hkUint32>(data, skinned ? 1 : 0);
+
+	for (int sectionIndex = 0; sectionIndex < sections.getSize(); sectionIndex++)
+	{
+		int materialIndex = -1;
+		if (sectionMaterials[sectionIndex])
+		{
+			for (int nodeMaterialIndex = 0; nodeMaterialIndex < meshNode->GetMaterialCount() && materialIndex < 0; nodeMaterialIndex++)
+			{
+				if (meshNode->GetMaterial(nodeMaterialIndex) == sectionMaterials[sectionIndex])
+				{
+					materialIndex = nodeMaterialIndex;
+				}
+			}
+
+			// The material can't be found again on a later run
+			if (materialIndex < 0)
+			{
+				return;
+			}
+		}
+		appendCachedValue<hkInt32>(data, materialIndex);
+	}
+
+	// Only the buffers and bone palettes are stored, materials and user channels are added on every run
+	hkxMesh* cachedMesh = new hkxMesh();
+	cachedMesh->m_sections.setSize(sections.getSize());
+	for (int sectionIndex = 0; sectionIndex < sections.getSize(); sectionIndex++)
+	{
+		hkxMeshSection* cachedSection = new hkxMeshSection();
+		cachedSection->m_vertexBuffer = sections[sectionIndex]->m_vertexBuffer;
+		cachedSection->m_indexBuffers.setSize(1);
+		cachedSection->m_indexBuffers[0] = sections[sectionIndex]->m_indexBuffers[0];
+		cachedSection->m_boneMatrixMap = sections[sectionIndex]->m_boneMatrixMap;
+		cachedMesh->m_sections[sectionIndex] = cachedSection;
+		cachedSection->removeReference();
+	}
+
+	hkArray<char> tagData;
+	hkArrayStreamWriter tagWriter(&tagData, hkArrayStreamWriter::ARRAY_BORROW);
+	const hkResult result = hkSerializeUtil::save(cachedMesh, hkxMeshClass, &tagWriter);
+	cachedMesh->removeReference();
+
+	if (result == HK_SUCCESS)
+	{
+		appendCachedValue<hkUint32>(data, tagData.getSize());
+		data.insert(data.end(), tagData.begin(), tagData.end());
+		m_options.m_objectStore->store(key, &data[0], data.size());
+	}
+}
+
+//-------
+
+hkUint64 FbxToHkxConverter::computeKeyFrameCacheKey(FbxNode* fbxNode, FbxAnimStack* animStack) const
+{
+	ContentHasher hasher;
+	hasher.addInt(KEYFRAME_CACHE_MAGIC);
+	hasher.addInt(OBJECT_CACHE_VERSION);
+	hasher.addString(FBXIMPORTER_VERSION);
+	hasher.addInt(m_options.m_exportAnnotations);
+	hasher.addInt(m_options.m_storeKeyframeSamplePoints);
+	hasher.addBytes(m_outputBasis, sizeof(m_outputBasis));
+
+	const FbxTimeSpan animTimeSpan = animStack->GetLocalTimeSpan();
+	const FbxLongLong start = animTimeSpan.GetStart().Get();
+	const FbxLongLong stop = animTimeSpan.GetStop().Get();
+	hasher.addBytes(&start, sizeof(start));
+	hasher.addBytes(&stop, sizeof(stop));
+	hasher.addInt(m_curFbxScene->GetGlobalSettings().GetTimeMode());
+
+	// Static values of everything that goes into the local transform
+	hashDouble3(hasher, fbxNode->LclTranslation.Get());
+	hashDouble3(hasher, fbxNode->LclRotation.Get());
+	hashDouble3(hasher, fbxNode->LclScaling.Get());
+	hashDouble3(hasher, fbxNode->RotationOffset.Get());
+	hashDouble3(hasher, fbxNode->RotationPivot.Get());
+	hashDouble3(hasher, fbxNode->ScalingOffset.Get());
+	hashDouble3(hasher, fbxNode->ScalingPivot.Get());
+	hashDouble3(hasher, fbxNode->PreRotation.Get());
+	hashDouble3(hasher, fbxNode->PostRotation.Get());
+	hasher.addInt(fbxNode->RotationOrder.Get());
+	hasher.addInt(fbxNode->InheritType.Get());
+	hasher.addInt(fbxNode->RotationActive.Get());
+
+	// Annotations are looked up by enum value
+	for (FbxProperty prop = fbxNode->GetFirstProperty(); prop.IsValid(); prop = fbxNode->GetNextProperty(prop))
+	{
+		if (prop.GetPropertyDataType().GetType() == eFbxEnum && hkString::beginsWithCase(prop.GetName().Buffer(), "HK"))
+		{
+			hasher.addString(prop.GetName().Buffer());
+			for (int enumIndex = 0; enumIndex < prop.GetEnumCount(); enumIndex++)
+			{
+				hasher.addString(prop.GetEnumValue(enumIndex));
+			}
+		}
+	}
+
+	// Every animated property of the node, in every layer of the stack
+	const int numAnimLayers = animStack->GetMemberCount<FbxAnimLayer>();
+	hasher.addInt(numAnimLayers);
+	for (int layerIndex = 0; layerIndex < numAnimLayers; layerIndex++)
+	{
+		FbxAnimLayer* animLayer = animStack->GetMember<FbxAnimLayer>(layerIndex);
+		hasher.addDouble(animLayer->Weight.Get());
+		hasher.addInt(animLayer->BlendMode.Get());
+
+		for (FbxProperty prop = fbxNode->GetFirstProperty(); prop.IsValid(); prop = fbxNode->GetNextProperty(prop))
+		{
+			FbxAnimCurveNode* curveNode = prop.GetCurveNode(animLayer);
+			if (curveNode == NULL)
+			{
+				continue;
+			}
+
+			hasher.addString(prop.GetName().Buffer());
+			for (unsigned int channel = 0; channel < curveNode->GetChannelsCount(); channel++)
+			{
+				const int curveCount = curveNode->GetCurveCount(channel);
+				hasher.addInt(curveCount);
+				for (int curveIndex = 0; curveIndex < curveCount; curveIndex++)
+				{
+					hashAnimCurve(hasher, curveNode->GetCurve(channel, curveIndex));
+				}
+			}
+		}
+	}
+
+	return hasher.getKey();
+}
+
+// Layout: magic, version, number of keyframes, hints and annotations, then the column major keyframe matrices,
+// the keyframe hints and the annotations (time, description length, description)
+bool FbxToHkxConverter::loadCachedKeyFrames(hkUint64 key, hkxNode* node)
+{
+	std::vector<char> data;
+	if (!m_options.m_objectStore->load(key, data))
+	{
+		return false;
+	}
+
+	CachedObjectReader reader(data);
+	const hkUint32 magic = reader.readValue<hkUint32>();
+	const hkUint32 version = reader.readValue<hkUint32>();
+	const hkUint32 numKeyFrames = reader.readValue<hkUint32>();
+	const hkUint32 numHints = reader.readValue<hkUint32>();
+	const hkUint32 numAnnotations = reader.readValue<hkUint32>();
+	if (!reader.isValid() || magic != KEYFRAME_CACHE_MAGIC || version != OBJECT_CACHE_VERSION)
+	{
+		return false;
+	}
+
+	const hkFloat32* keyFrames = static_cast<const hkFloat32*>(reader.read(sizeof(hkFloat32) * 16 * (size_t)numKeyFrames));
+	const hkFloat32* hints = static_cast<const hkFloat32*>(reader.read(sizeof(hkFloat32) * (size_t)numHints));
+	if (!reader.isValid())
+	{
+		return false;
+	}
+
+	hkArray<hkxNode::AnnotationData> annotations;
+	for (hkUint32 annotationIndex = 0; annotationIndex < numAnnotations && reader.isValid(); annotationIndex++)
+	{
+		const hkFloat32 time = reader.readValue<hkFloat32>();
+		const hkUint32 length = reader.readValue<hkUint32>();
+		const char* description = static_cast<const char*>(reader.read(length));
+		if (description)
+		{
+			hkxNode::AnnotationData& annotation = annotations.expandOne();
+			annotation.m_time = time;
+			annotation.m_description = hkStringBuf(description, (int)length);
+		}
+	}
+	if (!reader.isValid() || !reader.isAtEnd())
+	{
+		return false;
+	}
+
+	node->m_keyFrames.setSize(numKeyFrames);
+	for (hkUint32 keyIndex = 0; keyIndex < numKeyFrames; keyIndex++)
+	{
+		hkFloat32 matrix[16];
+		memcpy(matrix, keyFrames + keyIndex * 16, sizeof(matrix));
+		node->m_keyFrames[keyIndex].set4x4ColumnMajor(matrix);
+	}
+
+	node->m_linearKeyFrameHints.setSize(numHints);
+	for (hkUint32 hintIndex = 0; hintIndex < numHints; hintIndex++)
+	{
+		hkFloat32 hint;
+		memcpy(&hint, hints + hintIndex, sizeof(hint));
+		node->m_linearKeyFrameHints[hintIndex] = hint;
+	}
+
+	node->m_annotations.clear();
+	for (int annotationIndex = 0; annotationIndex < annotations.getSize(); annotationIndex++)
+	{
+		node->m_annotations.pushBack(annotations[annotationIndex]);
+	}
+	return true;
+}
+
+void FbxToHkxConverter::storeCachedKeyFrames(hkUint64 key, const hkxNode* node)
+{
+	std::vector<char> data;
+	appendCachedValue<hkUint32>(data, KEYFRAME_CACHE_MAGIC);
+	appendCachedValue<hkUint32>(data, OBJECT_CACHE_VERSION);
+	appendCachedValue<hkUint32>(data, node->m_keyFrames.getSize());
+	appendCachedValue<hkUint32>(data, node->m_linearKeyFrameHints.getSize());
+	appendCachedValue<hkUint32>(data, node->m_annotations.getSize());
+
+	for (int keyIndex = 0; keyIndex < node->m_keyFrames.getSize(); keyIndex++)
+	{
+		hkFloat32 matrix[16];
+		node->m_keyFrames[keyIndex].get4x4ColumnMajor(matrix);
+		data.insert(data.end(), reinterpret_cast<const char*>(matrix), reinterpret_cast<const char*>(matrix + 16));
+	}
+
+	for (int hintIndex = 0; hintIndex < node->m_linearKeyFrameHints.getSize(); hintIndex++)
+	{
+		appendCachedValue<hkFloat32>(data, node->m_linearKeyFrameHints[hintIndex]);
+	}
+
+	for (int annotationIndex = 0; annotationIndex < node->m_annotations.getSize(); annotationIndex++)
+	{
+		const hkxNode::AnnotationData& annotation = node->m_annotations[annotationIndex];
+		const char* description = annotation.m_description.cString() ? annotation.m_description.cString() : "";
+		const hkUint32 length = (hkUint32)strlen(description);
+
+		appendCachedValue<hkFloat32>(data, annotation.m_time);
+		appendCachedValue<hkUint32>(data, length);
+		data.insert(data.end(), description, description + length);
+	}
+
+	m_options.m_objectStore->store(key, &data[0], data.size());
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -7,21 +7,21 @@
  */
 
 #include "FbxToHkxConverter.h"
+#include "ExportData.h"
+#include "ConversionProfiler.h"
+#include "ConversionMemoryStats.h"
+#include "FbxSceneSource.h"
+#include "ScenePipeline.h"
 #include <Common/SceneData/Scene/hkxSceneUtils.h>
 #include <Common/SceneData/Skin/hkxSkinUtils.h>
 #include <Common/SceneData/Mesh/hkxMeshSectionUtil.h>
 #include <Common/SceneData/Mesh/Channels/hkxVertexSelectionChannel.h>
 #include <Common/SceneData/Mesh/Channels/hkxVertexFloatDataChannel.h>
-#include <windows.h>
-#include <iostream>
-#include <fstream>
+#include <Common/SceneData/Mesh/Channels/hkxVertexIntDataChannel.h>
 #include <vector>
 #include <string>
-#include <sstream>
-#include <Windows.h>
-#include <string>
+#include <algorithm>
 #include <cctype>
-#include <unordered_set>
 
 template <class T>
 void convertPropertyToVector4(const FbxPropertyT<T> &property, hkVector4 &vec, float z = 0.0f)
@@ -80,6 +80,10 @@ void FbxToHkxConverter::addSpline(hkxScene *scene, FbxNode* splineNode, hkxNode*
 		controlpoint.m_tangentOut.set((float)cvPtR[0], (float)cvPtR[1], (float)cvPtR[2]);
 		controlpoint.m_inType = hkxSpline::CUSTOM;
 		controlpoint.m_outType = hkxSpline::CUSTOM;
+
+		toOutputBasis(controlpoint.m_tangentIn, false);
+		toOutputBasis(controlpoint.m_position, false);
+		toOutputBasis(controlpoint.m_tangentOut, false);
 	}
 
 	node->m_object = newSpline;
@@ -100,6 +104,9 @@ void FbxToHkxConverter::addCamera(hkxScene *scene, FbxNode* cameraNode, hkxNode*
 	newCamera->m_up.set((hkReal)up[0],(hkReal)up[1],(hkReal)up[2]);
 	FbxDouble3 focus = cameraAttrib->InterestPosition.Get();
 	newCamera->m_focus.set((hkReal)focus[0],(hkReal)focus[1],(hkReal)focus[2]);
+	toOutputBasis(newCamera->m_from, false);
+	toOutputBasis(newCamera->m_up, true);
+	toOutputBasis(newCamera->m_focus, false);
 
 	const hkReal degreesToRadians  = HK_REAL_PI / 180.0f;
 	newCamera->m_fov =(hkReal)cameraAttrib->FieldOfViewY.Get()* degreesToRadians;
@@ -127,6 +134,8 @@ void FbxToHkxConverter::addLight(hkxScene *scene, FbxNode* lightNode, hkxNode* n
 	// FBX lights point along their node's negative Y axis
 	const FbxVector4& negLightDir = lightTransform.GetRow(1);
 	newLight->m_direction.set((hkReal)-negLightDir[0],(hkReal)-negLightDir[1],(hkReal)-negLightDir[2]);
+	toOutputBasis(newLight->m_position, false);
+	toOutputBasis(newLight->m_direction, true);
 
 	const FbxDouble3 color = lightAttrib->Color.Get();
 	newLight->m_color = elementsToARGB(color[0], color[1], color[2], 1.0); 
@@ -206,458 +215,172 @@ static hkxMaterial* createDefaultMaterial(const char* name)
 	return mat;
 }
 
-#include <windows.h>
-#include <string>
-#include <vector>
-#include <stdio.h> // for printf
-
-std::vector<std::string> getSelectionFilesForMesh(const std::string& input_path, const std::string& meshName)
-{
-	std::vector<std::string> result;
-	std::string searchPath = input_path;
-
-
-    if (!searchPath.empty() && searchPath.back() != '\\' && searchPath.back() != '/')
-        searchPath += '\\';
-
-	searchPath += "selectionsets";
-
-	if (!searchPath.empty() && searchPath.back() != '\\' && searchPath.back() != '/')
-        searchPath += '\\';
-
-    searchPath += meshName;
-	searchPath += "_";
-	searchPath += "*.txt";
-
-	printf("searching for %s\r\n", searchPath);
-
-    WIN32_FIND_DATAA findData;
-    HANDLE hFind = FindFirstFileA(searchPath.c_str(), &findData);
-
-    if (hFind == INVALID_HANDLE_VALUE)
-    {
-        DWORD error = GetLastError();
-		if (error == 2 || error == 3){
-			printf("Extra export/mesh data not found, there will be no hkxSelectionSets (Error code: %d, file not found)\n", error);
-		} else {
-			printf("Extra export/mesh data not found, there will be no hkxSelectionSets. (Unknown error code: %d)\n", error);
-		}
-        return result;
-    }
-
-
-
-    do
-    {
-        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-        {
-            std::string fileName = findData.cFileName;
-            printf("Found file with extra mesh data: %s\n", fileName.c_str());
-			result.push_back(fileName);
-			/*
-            // Create the expected prefix (meshName + underscore)
-            std::string targetPrefix = meshName + "_";
-            
-            if (fileName.size() >= targetPrefix.size() &&
-                fileName.compare(0, targetPrefix.size(), targetPrefix) == 0)
-            {
-                printf("Match found: %s\n", fileName.c_str());
-                result.push_back(fileName);
-            }
-			*/
-        }
-    } while (FindNextFileA(hFind, &findData));
-
-    FindClose(hFind);
-    printf("Total matching files found: %d\n", result.size());
-    return result;
-}
-
-std::vector<std::string> getFloatDataFilesForMesh(const std::string& input_path, const std::string& meshName)
+// The set of vertex indices referenced by a mesh section's index buffer. User channel entries are validated
+// against it with a range check when the indices cover [0, n) without gaps (always the case for the triangle
+// lists written by fillBuffers), and with a bitmap lookup otherwise.
+class SectionVertexIndexSet
 {
-	
-	std::vector<std::string> result;
-	std::string searchPath = input_path;;
-
-    if (!searchPath.empty() && searchPath.back() != '\\' && searchPath.back() != '/')
-        searchPath += '\\';
-
-	searchPath += "floatchannels";
-
-	if (!searchPath.empty() && searchPath.back() != '\\' && searchPath.back() != '/')
-        searchPath += '\\';
-
-    searchPath += meshName;
-	searchPath += "_";
-	searchPath += "*.txt";
-
-	printf("searching for %s\r\n", searchPath);
-
-    WIN32_FIND_DATAA findData;
-    HANDLE hFind = FindFirstFileA(searchPath.c_str(), &findData);
-
-    if (hFind == INVALID_HANDLE_VALUE)
-    {
-        DWORD error = GetLastError();
-		if (error == 2 || error == 3){
-			printf("Extra export/mesh data not found, there will be no hkxFloatDataChannels (Error code: %d, file not found)\n", error);
-		} else {
-			printf("Extra export/mesh data not found, there will be no hkxFloatDataChannels. (Unknown error code: %d)\n", error);
-		}
-        return result;
-    }
-
-
-
-    do
-    {
-        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-        {
-            std::string fileName = findData.cFileName;
-            printf("Found file with extra mesh data: %s\n", fileName.c_str());
-			result.push_back(fileName);
-			/*
-            // Create the expected prefix (meshName + underscore)
-            std::string targetPrefix = meshName + "_";
-            
-            if (fileName.size() >= targetPrefix.size() &&
-                fileName.compare(0, targetPrefix.size(), targetPrefix) == 0)
-            {
-                printf("Match found: %s\n", fileName.c_str());
-                result.push_back(fileName);
-            }
-			*/
-        }
-    } while (FindNextFileA(hFind, &findData));
-
-    FindClose(hFind);
-    printf("Total matching files found: %d\n", result.size());
-    return result;
-}
-
-std::vector<int> addUVindex(const std::string& fullFilePath)
-{
-    std::vector<int> uvIndices;
-    std::ifstream file(fullFilePath.c_str());
-
-    if (!file.is_open()) {
-        printf("Failed to open file: %s\n", fullFilePath.c_str());
-        return uvIndices;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-
-		if (line == "# UV Indices per selected vertex") {
-			continue;  // Skip header line
-		}
+public:
 
-        std::istringstream iss(line);
-        std::string token;
+	// Number of invalid entries listed in error messages
+	enum { MAX_REPORTED_INVALID = 8 };
 
-        while (iss >> token) {
-            if (!token.empty() && token[token.length() - 1] == ':') continue;
-
-            std::stringstream conv(token);
-            int uvIndex;
-            if (conv >> uvIndex) {
-                uvIndices.push_back(uvIndex);
-            } else {
-                printf("Invalid number: %s\n", token.c_str());
-            }
-        }
-    }
-
-    file.close();
-    return uvIndices;
-}
-
-std::vector<float> addFloatChannel(const std::string& fullFilePath)
-{
-    std::vector<float> floatChannel;
-    std::ifstream file(fullFilePath.c_str());
-
-    if (!file.is_open()) {
-        printf("Failed to open file: %s\n", fullFilePath.c_str());
-        return floatChannel;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-
-        std::istringstream iss(line);
-        std::string token;
-
-        while (iss >> token) {
-            if (!token.empty()) continue;
-
-            std::stringstream conv(token);
-            float floatValue;
-            if (conv >> floatValue) {
-                floatChannel.push_back(floatValue);
-            } else {
-                printf("Invalid number: %s\n", token.c_str());
-            }
-        }
-    }
-
-    file.close();
-    return floatChannel;
-}
-
-void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* node, const char* hkxExtraData_path)
-{
-	const char* meshName = meshNode->GetName();
-	printf("Processing mesh %s\r\n", meshName);
-	
-	int n_hkxvertexselectionsets;
-	int n_hkxfloatdatachannels;
-	std::string extraDataFolder = hkxExtraData_path;
-	std::vector<std::string> fileNames;
-	std::vector<std::vector<int>> hkxSelectionGroups;
-	std::vector<std::vector<float>> hkxFloatDataChannels;
-	std::vector<std::string> hkxUserChannelNames;
-	std::string hkxUserChannelName;
+	explicit SectionVertexIndexSet(const hkxIndexBuffer& indexBuffer)
+	{
+		const hkUint32* indices = indexBuffer.m_indices32.begin();
+		const int numIndices = indexBuffer.m_indices32.getSize();
 
-	if (!strncmp(meshName, "collision_", 10) == 0)  // "collision_" is 10 chars long
-	{ 
-		//massage the extra data path
-		if (extraDataFolder.empty()) //if no folder then set to current dir, fbximporter.exe probably in same dir as fbx
+		hkUint32 maxIndex = 0;
+		for (int i = 0; i < numIndices; ++i)
 		{
-			extraDataFolder = "."; 
-		} 
-
-		std::vector<std::string> result;
-		std::string searchPath;
-
-		if (extraDataFolder.length() >= std::string("/export_data").length() && extraDataFolder.compare(extraDataFolder.length() - std::string("/export_data").length(), std::string("/export_data").length(), "/export_data") == 0) {
-			searchPath = extraDataFolder;
-		} else {
-			searchPath = extraDataFolder + "/export_data";
+			maxIndex = hkMath::max2(maxIndex, indices[i]);
 		}
+		m_limit = numIndices > 0 ? int(maxIndex) + 1 : 0;
 
-		if (!searchPath.empty() && searchPath.back() != '\\' && searchPath.back() != '/')
-			searchPath += '\\';
-
-
-		fileNames = getSelectionFilesForMesh(searchPath, meshName);
-		// Only add stuff to the hkxselection groups if there were any files
-		if (!fileNames.empty()) 
+		m_bits.setSize((m_limit + 31) >> 5, 0);
+		int numSet = 0;
+		for (int i = 0; i < numIndices; ++i)
 		{
-			std::string basePath = searchPath + "selectionsets\\";
-
-			for (size_t i = 0; i < fileNames.size(); ++i) {
-				std::vector<int> selectGroup = addUVindex(basePath + fileNames[i]);
-
-				printf("Parsed %d indices from %s\n", (int)selectGroup.size(), fileNames[i].c_str());
-				
-				// <meshname>_groupname.txt = groupname
-				size_t startPos = strlen(meshName)+1;
-
-				size_t endPos = fileNames[i].rfind(".txt");
-				hkxUserChannelName = fileNames[i].substr(startPos, endPos - startPos);
-
-				hkxSelectionGroups.push_back(selectGroup);
-				hkxUserChannelNames.push_back(hkxUserChannelName);
-			}
+			const hkUint32 mask = 1u << (indices[i] & 31);
+			hkUint32& word = m_bits[indices[i] >> 5];
+			numSet += (word & mask) ? 0 : 1;
+			word |= mask;
 		}
 
-		n_hkxvertexselectionsets = hkxSelectionGroups.size();
-		printf("Done adding %i hkxSelectionGroups\r\n", n_hkxvertexselectionsets);
-
-		fileNames.clear();
-		fileNames = getFloatDataFilesForMesh(searchPath, meshName);
-
-		if (!fileNames.empty()) 
+		m_dense = (numSet == m_limit);
+		if (m_dense)
 		{
-			std::string basePath = searchPath + "floatchannels\\";
-
-			for (size_t i = 0; i < fileNames.size(); ++i) {
-
-				std::vector<float> floatChannelGroup = addFloatChannel(basePath + fileNames[i]);
-
-				printf("Parsed %d indices from %s\n", (int)floatChannelGroup.size()-1, fileNames[i].c_str()); // minus one since first number is the enum for type (float / distance / angle)
-				
-				// <meshname>_groupname.txt = groupname
-				size_t startPos = strlen(meshName)+1;
-
-				size_t endPos = fileNames[i].rfind(".txt");
-				hkxUserChannelName = fileNames[i].substr(startPos, endPos - startPos);
-
-				hkxFloatDataChannels.push_back(floatChannelGroup);
-				hkxUserChannelNames.push_back(hkxUserChannelName);
-			}
+			m_bits.clearAndDeallocate();
 		}
-		n_hkxfloatdatachannels = hkxFloatDataChannels.size();
-		printf("Done adding %i hkxFloatDataChannels\r\n", n_hkxfloatdatachannels);
 	}
 
-	FbxMesh* originalMesh = meshNode->GetMesh();
-	FbxMesh* triMesh = NULL;
-
-	if (!originalMesh->IsTriangleMesh())
-	{
-			FbxGeometryConverter lGeometryConverter(m_options.m_fbxSdkManager);
-			triMesh = static_cast<FbxMesh*>( lGeometryConverter.Triangulate(meshNode->GetNodeAttribute(), false) );
-	}
-	else
+	HK_FORCE_INLINE bool contains(int index) const
 	{
-		triMesh = originalMesh;
+		return hkUint32(index) < hkUint32(m_limit) &&
+			(m_dense || (m_bits[index >> 5] & (1u << (index & 31))) != 0);
 	}
 
-	hkxMesh* newMesh = HK_NULL;
-	hkxSkinBinding* newSkin = HK_NULL;
-
-
-	// Get materials
-	hkArray<FbxSurfaceMaterial*> matIds;
-	getMaterialsInMesh(triMesh, matIds);
-
-	// Each matId maps to a mesh section.
-	hkArray<hkxMeshSection*> exportedSections;
-	exportedSections.reserve( matIds.getSize() );
-
+	// Appends the valid entries of indices to validOut. Returns the number of invalid entries, the first
+	// MAX_REPORTED_INVALID of which are stored in firstInvalidOut.
+	int filterIndices(const int* indices, int numIndices, hkArray<hkInt32>& validOut, hkArray<int>& firstInvalidOut) const
+	{
+		// Branch free range check over the whole channel, the common case is that everything is valid
+		int numOutOfRange = 0;
+		for (int i = 0; i < numIndices; ++i)
+		{
+			numOutOfRange += (hkUint32(indices[i]) >= hkUint32(m_limit)) ? 1 : 0;
+		}
 
-	// Get skinning info
-	const int lSkinCount = triMesh->GetDeformerCount(FbxDeformer::eSkin);
-	FbxSkin *skin = (FbxSkin *)triMesh->GetDeformer(0, FbxDeformer::eSkin);
+		if (m_dense && numOutOfRange == 0)
+		{
+			validOut.append(indices, numIndices);
+			return 0;
+		}
 
-	hkArray<float> skinControlPointWeights;
-	hkArray<int> skinIndicesToClusters;
-	{
-		if (lSkinCount>0)
+		validOut.reserve(validOut.getSize() + numIndices - numOutOfRange);
+		int numInvalid = 0;
+		for (int i = 0; i < numIndices; ++i)
 		{
-			const int skinDataCount = triMesh->GetControlPointsCount()*4;
-			skinControlPointWeights.setSize(skinDataCount,0.0f);
-			skinIndicesToClusters.setSize(skinDataCount,-1);
-	
-			const int lClusterCount = skin->GetClusterCount();
-			for (int curClusterIndex=0; curClusterIndex < lClusterCount; ++curClusterIndex)
+			if (contains(indices[i]))
 			{
-				FbxCluster* lCluster = skin->GetCluster(curClusterIndex);
-				const int lIndexCount = lCluster->GetControlPointIndicesCount();
-				int* lIndices = lCluster->GetControlPointIndices();
-				double* lWeights = lCluster->GetControlPointWeights();
-	
-				for (int k = 0; k < lIndexCount; k++)
-				{
-					const int controlPointIndexFour = lIndices[k] * 4;
-					for(int i = controlPointIndexFour; i < controlPointIndexFour + 4; ++i)
-					{
-						if (skinIndicesToClusters[i] < 0)
-						{
-							skinIndicesToClusters[i] = curClusterIndex;
-							skinControlPointWeights[i] =(float)lWeights[k];
-							break;
-						}
-					}
-				}
+				validOut.pushBackUnchecked(indices[i]);
 			}
-		}
-	
-		// Zero unused indices
-		for (int i = 0; i <skinIndicesToClusters.getSize(); ++i)
-		{
-			if (skinIndicesToClusters[i] < 0)
+			else if (numInvalid++ < MAX_REPORTED_INVALID)
 			{
-				skinIndicesToClusters[i] = 0;
+				firstInvalidOut.pushBack(indices[i]);
 			}
 		}
+		return numInvalid;
 	}
 
-	// FbxGeometryElementMaterial maps polygons to materials. We currently do not support
-	// mapping a polygon to multiple materials so we only consider the first mapping.
-	const FbxGeometryElementMaterial* elemMat = triMesh->GetElementMaterial(0);
-	FbxLayerElement::EMappingMode mode;
-	if (elemMat)
-	{
-		mode = elemMat->GetMappingMode();
-	}
-	else
+	// Per vertex channels have one value per vertex, i.e. value i is valid if vertex i is referenced. Appends the
+	// valid values to validOut and returns the number of invalid ones, storing the first few vertex indices.
+	int filterPerVertexValues(const float* values, int numValues, hkArray<hkFloat32>& validOut, hkArray<int>& firstInvalidOut) const
 	{
-		// If there is no material mapping we create a dummy material and map everything to it.
-		mode = FbxLayerElement::eAllSame;
-		// If there is no material mapping there also shouldn't be any materials.
-		// Nevertheless we check this just to be sure.
-		if (matIds.isEmpty())
+		if (m_dense)
 		{
-			// Our dummy material needed for the mesh section has no matching counterpart on the fbx side.
-			matIds.pushBack(NULL);
-		}
-	}
-	if (mode == FbxLayerElement::eByPolygon)
-		printf("eByPolygon, multiple materials is NOT SUPPORTED, everything is assigned to the first material.\r\n");
-	
-
-	// Create subsection for each material
-	const int materialCount = matIds.getSize();
-	for (int curMat = 0; curMat < materialCount; ++curMat)
-	{
-		hkArray<int> materialIndices;
-		materialIndices.reserve(triMesh->GetPolygonCount());
-		if (mode == FbxLayerElement::eAllSame)
-		{
-			// The material is used for all triangles. To be able to use the same code in this case
-			// we just write all indices into the array.
-			const int polygonCount = triMesh->GetPolygonCount();
-			for (int i = 0; i < polygonCount; ++i)
+			const int numValid = hkMath::min2(numValues, m_limit);
+			validOut.append(values, numValid);
+			for (int i = numValid; i < numValues && i - numValid < MAX_REPORTED_INVALID; ++i)
 			{
-				materialIndices.pushBack(i);
+				firstInvalidOut.pushBack(i);
 			}
+			return numValues - numValid;
 		}
-		else if (mode == FbxLayerElement::eByPolygon)
-		{
 
-			const int polygonCount = triMesh->GetPolygonCount();
-			for (int i = 0; i < polygonCount; ++i)
+		validOut.reserve(validOut.getSize() + numValues);
+		int numInvalid = 0;
+		for (int i = 0; i < numValues; ++i)
+		{
+			if (contains(i))
 			{
-				materialIndices.pushBack(i);
+				validOut.pushBackUnchecked(values[i]);
 			}
-			if (curMat > 0)
-				continue; // this might be shaky, just skip ahead if there is more than one material on the mesh (all polys added to first one as if it was the only one)
-
-			/*
-			FbxLayerElementArrayTemplate<int>& indexArray = elemMat->GetIndexArray();
-			const int indexCount = indexArray.GetCount();
-			for (int i = 0; i < indexCount; ++i)
+			else if (numInvalid++ < MAX_REPORTED_INVALID)
 			{
-				if (indexArray[i] == curMat)
-				{
-					materialIndices.pushBack(i);
-				}
+				firstInvalidOut.pushBack(i);
 			}
-			*/
-		}
-		else
-		{
-			HK_WARN(0x0, "Unsupported material mapping mode. This material will be ignored.");
-			continue;
 		}
+		return numInvalid;
+	}
 
-		if (materialIndices.getSize() == 0)
-		{
-			// The material is not used in the mesh. Nothing is lost in this case so we just skip it.
-			continue;
-		}
+private:
 
-		hkxMaterial* sectMat = HK_NULL;
-		if (m_options.m_exportMaterials)
+	// Referenced indices are all in [0, m_limit)
+	int m_limit;
+	// Every index in [0, m_limit) is referenced, m_bits is unused
+	bool m_dense;
+	hkArray<hkUint32> m_bits;
+};
+
+static void reportInvalidVertexIndices(const char* channelType, const char* channelName, int numInvalid, int numTotal, const hkArray<int>& firstInvalid)
+{
+	hkStringBuf invalidList;
+	for (int i = 0; i < firstInvalid.getSize(); ++i)
+	{
+		invalidList.appendPrintf(i ? ", %d" : "%d", firstInvalid[i]);
+	}
+	if (numInvalid > firstInvalid.getSize())
+	{
+		invalidList.append(", ...");
+	}
+
+	printf("Error: %d of %d vertex indices in %s %s are invalid (not found in index buffer), skipped: %s\n",
+		numInvalid, numTotal, channelType, channelName, invalidList.cString());
+}
+
+void FbxToHkxConverter::addUserChannels(const char* meshName, hkxMesh* newMesh)
+{
+	int n_hkxvertexselectionsets = 0;
+	int n_hkxfloatdatachannels = 0;
+	ExportDataMeshView userChannels;
+
+	if (!strncmp(meshName, "collision_", 10) == 0 && m_exportData)  // "collision_" is 10 chars long
+	{ 
+		// The export_data folder was indexed once up front, this is just a lookup of the (possibly already loaded) files
+		if (m_exportData->getMeshChannels(meshName, userChannels))
 		{
-			sectMat = createMaterial(matIds[curMat], triMesh, scene);
+			for (size_t i = 0; i < userChannels.m_selectionSets.size(); ++i)
+			{
+				printf("Parsed %d indices for selection set %s\n", userChannels.m_selectionSets[i].m_channel->getCount(), userChannels.m_selectionSets[i].m_name.c_str());
+			}
+			for (size_t i = 0; i < userChannels.m_floatChannels.size(); ++i)
+			{
+				printf("Parsed %d values for float channel %s\n", userChannels.m_floatChannels[i].m_channel->getCount(), userChannels.m_floatChannels[i].m_name.c_str());
+			}
 		}
 
+		n_hkxvertexselectionsets = (int)userChannels.m_selectionSets.size();
+		printf("Done adding %i hkxSelectionGroups\r\n", n_hkxvertexselectionsets);
 
-		// Vertex buffer
-		hkxVertexBuffer* newVB = new hkxVertexBuffer();
-		hkxIndexBuffer* newIB = new hkxIndexBuffer();
-		fillBuffers(triMesh, meshNode, newVB, newIB, skinControlPointWeights, skinIndicesToClusters, materialIndices);
-
-		hkxMeshSection* newSection = new hkxMeshSection();
-		newSection->m_material = sectMat;
-		newSection->m_vertexBuffer = newVB;
-		newSection->m_indexBuffers.setSize(1);
-		newSection->m_indexBuffers[0] = newIB;
+		n_hkxfloatdatachannels = (int)userChannels.m_floatChannels.size();
+		printf("Done adding %i hkxFloatDataChannels\r\n", n_hkxfloatdatachannels);
+	}
 
+	for (int sectionIndex = 0; sectionIndex < newMesh->m_sections.getSize(); ++sectionIndex)
+	{
+		hkxMeshSection* newSection = newMesh->m_sections[sectionIndex];
+		hkxIndexBuffer* newIB = newSection->m_indexBuffers[0];
 
 		// *************************************ADDING HKXVERTEXSELECTIONSETS HERE*************************************
 		// Loop over all extra vertex groups and add hkxVertexSelectionSets for them here
@@ -672,14 +395,10 @@ void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* nod
 		{ 
 			if (n_hkxvertexselectionsets > 0 || n_hkxfloatdatachannels > 0)
 			{
-				std::vector<int> tmpIndexBufferHolder; //temp holder for the indicies in this section
-
-				for (auto it = newIB->m_indices32.begin(); it != newIB->m_indices32.end(); ++it) {
-					tmpIndexBufferHolder.push_back(*it);
-				}
-				std::unordered_set<int> validIndices(tmpIndexBufferHolder.begin(), tmpIndexBufferHolder.end());
+				// Built once per section, the user channels are validated against it
+				const SectionVertexIndexSet validIndices(*newIB);
 
-				printf("size of indexbuffer holder: %i\r\n",tmpIndexBufferHolder.size());
+				printf("size of indexbuffer holder: %i\r\n", newIB->m_indices32.getSize());
 			
 				int curUserChannelSize = newSection->m_userChannels.getSize();
 				newSection->m_userChannels.setSize(curUserChannelSize + n_hkxfloatdatachannels + n_hkxvertexselectionsets);
@@ -696,17 +415,12 @@ void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* nod
 					{
 						//init the vectors
 						arrSelChannel[i] = new hkxVertexSelectionChannel();
-						for (int hkxSelectionGroupidx = 0; hkxSelectionGroupidx < hkxSelectionGroups[i].size(); hkxSelectionGroupidx++)
+						const ExportDataChannel& selectionSet = *userChannels.m_selectionSets[i].m_channel;
+						hkArray<int> firstInvalid;
+						const int numInvalid = validIndices.filterIndices(selectionSet.getIndices(), selectionSet.getCount(), arrSelChannel[i]->m_selectedVertices, firstInvalid);
+						if (numInvalid > 0)
 						{
-							int vertexIndex = hkxSelectionGroups[i][hkxSelectionGroupidx];
-
-							if (validIndices.find(vertexIndex) == validIndices.end())
-							{
-								printf("Error: Vertex index %d is invalid (in selection set %s). Not found in index buffer.\n", vertexIndex, hkxUserChannelNames[hkxSelectionGroupidx+curUserChannelSize]);
-								continue;
-							}
-
-							arrSelChannel[i]->m_selectedVertices.pushBack(hkxSelectionGroups[i][hkxSelectionGroupidx]);
+							reportInvalidVertexIndices("selection set", userChannels.m_selectionSets[i].m_name.c_str(), numInvalid, selectionSet.getCount(), firstInvalid);
 						}
 						newSection->m_userChannels[curUserChannelSize+i] = arrSelChannel[i];
 						printf("Added vertexSelectionset with %i entries\r\n", arrSelChannel[i]->m_selectedVertices.getSize());
@@ -721,8 +435,11 @@ void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* nod
 						//init the vectors
 						arrFloatDataChannel[i] = new hkxVertexFloatDataChannel();
 
-						// the first entry in floatdatachannel is the enum for data type (FLOAT/DISTANCE/ANGLE)
-						float enumSwitch = hkxFloatDataChannels[i][0];
+						const ExportDataChannel& floatChannel = *userChannels.m_floatChannels[i].m_channel;
+						const float* perVertexFloats = floatChannel.getFloats();
+
+						// The data type (FLOAT/DISTANCE/ANGLE) was read from the channel header, or the first entry of a text file
+						int enumSwitch = floatChannel.m_floatDimensions;
 						if (enumSwitch == 0)
 							arrFloatDataChannel[i]->m_dimensions = hkxVertexFloatDataChannel::FLOAT;
 						else if (enumSwitch == 1)
@@ -732,17 +449,12 @@ void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* nod
 						else
 							printf("Error: invalid value for hkxVertexFloatDataChannel enum datatype: %d, valid values are 0.0, 1.0, 2.0 \r\n", enumSwitch);
 
-						hkxFloatDataChannels[i].erase(hkxFloatDataChannels[i].begin()); // pop first element so indices are aligned without weird adjustments
-
-						for (int hkxFloatDataChannelidx = 0; hkxFloatDataChannelidx < hkxFloatDataChannels[i].size(); hkxFloatDataChannelidx++)
+						// floatdatachannels have one value for each index in the indexbuffer, i.e. just check them all
+						hkArray<int> firstInvalid;
+						const int numInvalid = validIndices.filterPerVertexValues(perVertexFloats, floatChannel.getCount(), arrFloatDataChannel[i]->m_perVertexFloats, firstInvalid);
+						if (numInvalid > 0)
 						{
-							// floatdatachannels have one value for each index in the indexbuffer, i.e. just check them all
-							if (validIndices.find(hkxFloatDataChannelidx) == validIndices.end())
-							{
-								printf("Error: Vertex index %d is invalid. Not found in index buffer.\n", hkxFloatDataChannelidx);
-								continue;
-							}
-							arrFloatDataChannel[i]->m_perVertexFloats.pushBack(hkxFloatDataChannels[i][hkxFloatDataChannelidx]);
+							reportInvalidVertexIndices("float channel", userChannels.m_floatChannels[i].m_name.c_str(), numInvalid, floatChannel.getCount(), firstInvalid);
 						}
 						newSection->m_userChannels[curUserChannelSize+n_hkxvertexselectionsets+i] = arrFloatDataChannel[i];
 						printf("Added FloatDataChannel of type %i, with %i entries\r\n", arrFloatDataChannel[i]->m_dimensions, arrFloatDataChannel[i]->m_perVertexFloats.getSize());
@@ -752,474 +464,897 @@ void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* nod
 			
 		}
 		// *************************************DONE ADDING HKXVERTEXSELECTIONSETS*************************************
-		exportedSections.pushBack(newSection);
-		if (sectMat)
-		{
-			sectMat->removeReference();
-		}
-		newVB->removeReference();
-		newIB->removeReference();
-	}
-
-	// Create new mesh
-	newMesh = new hkxMesh();
-	newMesh->m_sections.setSize(exportedSections.getSize());
-	for(int cs = 0; cs < newMesh->m_sections.getSize(); ++cs)
-	{
-		newMesh->m_sections[cs] = exportedSections[cs];
-		exportedSections[cs]->removeReference();
-	}
-
-	// Add skin bindings
-	if (lSkinCount > 0)
-	{
-		newSkin = new hkxSkinBinding();
-		newSkin->m_mesh = newMesh;
-
-		const int lClusterCount = skin->GetClusterCount();
-		newSkin->m_bindPose.setSize(lClusterCount);
-		newSkin->m_nodeNames.setSize(lClusterCount);
-
-		// Extract bind pose transforms & bone names
-		for(int curClusterIndex = 0; curClusterIndex < lClusterCount; ++curClusterIndex)
-		{
-			FbxCluster* lCluster = skin->GetCluster(curClusterIndex);
-
-			newSkin->m_nodeNames[curClusterIndex] = lCluster->GetLink()->GetName();
-
-			const FbxAMatrix lMatrix = getGlobalPosition(lCluster->GetLink(), m_startTime, m_pose, NULL);			
-			convertFbxXMatrixToMatrix4(lMatrix, newSkin->m_bindPose[curClusterIndex]);
-		}
-
-		// Extract the world transform of the original, skinned mesh
-		{
-			FbxAMatrix lMatrix = meshNode->EvaluateGlobalTransform();
-			convertFbxXMatrixToMatrix4(lMatrix, newSkin->m_initSkinTransform);
-		}
 	}
 
-
-
-
 	// Loop over all extra vertex groups and add userinfochannels for them
 	// again, skip for collision meshes
 	if (!strncmp(meshName, "collision_", 10) == 0)  // "collision_" is 10 chars long
 	{ 
-		for (int curUserChannelIdx = 0; curUserChannelIdx < hkxUserChannelNames.size(); curUserChannelIdx++)
+		for (int curUserChannelIdx = 0; curUserChannelIdx < userChannels.getNumChannels(); curUserChannelIdx++)
 		{
 			
 			// Add a hkxMesh::UserChannelInfo for each hkxertexselection set we created earlier, in the same order
 			hkxMesh::UserChannelInfo* newUCI = new hkxMesh::UserChannelInfo();
-			newUCI->m_name = hkxUserChannelNames[curUserChannelIdx].c_str();
 			if (curUserChannelIdx < n_hkxvertexselectionsets)
 			{
+				const std::string& channelName = userChannels.m_selectionSets[curUserChannelIdx].m_name;
+				newUCI->m_name = channelName.c_str();
 				newUCI->m_className="hkxVertexSelectionChannel";
-				printf("Adding hkxVertexSelectionChannel: %s\r\n",  hkxUserChannelNames[curUserChannelIdx].c_str());
+				printf("Adding hkxVertexSelectionChannel: %s\r\n",  channelName.c_str());
 			}
 			else
 			{
+				const std::string& channelName = userChannels.m_floatChannels[curUserChannelIdx - n_hkxvertexselectionsets].m_name;
+				newUCI->m_name = channelName.c_str();
 				newUCI->m_className="hkxVertexFloatDataChannel";
-				printf("Adding hkxVertexFloatDataChannel: %s\r\n",  hkxUserChannelNames[curUserChannelIdx].c_str());
+				printf("Adding hkxVertexFloatDataChannel: %s\r\n",  channelName.c_str());
 			}
 			newMesh->m_userChannelInfos.pushBack(newUCI);
 			newUCI->removeReference();
 		}
 	}
+}
 
-	if (m_options.m_exportVertexTangents)
-	{
-		hkxMeshSectionUtil::computeTangents(newMesh, true, originalMesh->GetName());
-	}
+static void addFloatAttribute(hkxAttributeGroup& group, const char* name, float value)
+{
+	hkxAnimatedFloat* animatedData = new hkxAnimatedFloat();
+	animatedData->m_floats.pushBack(value);
+
+	hkxAttribute& attribute = group.m_attributes.expandOne();
+	attribute.m_name = name;
+	attribute.m_value = animatedData;
+	animatedData->removeReference();
+}
 
+// Two user channels per morph target, in every section (empty if the target does not move it): an
+// hkxVertexSelectionChannel with the vertices that move, and an hkxVertexIntDataChannel with three ints per selected
+// vertex holding the quantized position x, y, z and normal x, y, z offsets as pairs of shorts (the first one in the
+// low half). The info of the int channel has an "hkBlendShape" attribute group with the blend shape channel, the
+// full weight of the target and the scales of the offsets (see SceneBlendShapeDeltas).
+void FbxToHkxConverter::addBlendShapes(const char* meshName, const SceneMesh& sceneMesh, const hkArray< hkArray<int> >& sectionTriangles, hkxMesh* newMesh)
+{
+	ConversionProfiler::Scope blendShapeScope(m_options.m_profiler, "blendShapes", "mesh", meshName);
 
-	if (newMesh)
+	int numDeltas = 0;
+	const int numShapes = (int)sceneMesh.m_blendShapes.size();
+	for (int shapeIndex = 0; shapeIndex < numShapes; ++shapeIndex)
 	{
-		if (newSkin)
+		const SceneBlendShape& shape = sceneMesh.m_blendShapes[shapeIndex];
+
+		SceneBlendShapeDeltas deltas;
+		for (int sectionIndex = 0; sectionIndex < newMesh->m_sections.getSize(); ++sectionIndex)
 		{
-			node->m_object = newSkin;
+			const hkArray<int>& triangles = sectionTriangles[sectionIndex];
+			buildBlendShapeDeltas(sceneMesh, shape, triangles.begin(), triangles.getSize(), deltas);
 
-			scene->m_meshes.pushBack(newMesh);
-			scene->m_skinBindings.pushBack(newSkin);
-			newMesh->removeReference();
-			newSkin->removeReference();
+			const int numVertices = (int)deltas.m_vertices.size();
+			hkxVertexSelectionChannel* selectionChannel = new hkxVertexSelectionChannel();
+			if (numVertices > 0)
+			{
+				selectionChannel->m_selectedVertices.append(&deltas.m_vertices[0], numVertices);
+			}
+
+			hkxVertexIntDataChannel* deltaChannel = new hkxVertexIntDataChannel();
+			deltaChannel->m_perVertexInts.setSize(numVertices * 3);
+			for (int v = 0; v < numVertices; ++v)
+			{
+				const short* position = &deltas.m_positions[v * 3];
+				const short normal[3] = {
+					deltas.m_normals.empty() ? short(0) : deltas.m_normals[v * 3],
+					deltas.m_normals.empty() ? short(0) : deltas.m_normals[v * 3 + 1],
+					deltas.m_normals.empty() ? short(0) : deltas.m_normals[v * 3 + 2] };
+
+				hkInt32* packed = &deltaChannel->m_perVertexInts[v * 3];
+				packed[0] = hkInt32(hkUint16(position[0]) | (hkUint32(hkUint16(position[1])) << 16));
+				packed[1] = hkInt32(hkUint16(position[2]) | (hkUint32(hkUint16(normal[0])) << 16));
+				packed[2] = hkInt32(hkUint16(normal[1]) | (hkUint32(hkUint16(normal[2])) << 16));
+			}
+			numDeltas += numVertices;
+
+			hkxMeshSection* section = newMesh->m_sections[sectionIndex];
+			section->m_userChannels.pushBack(selectionChannel);
+			section->m_userChannels.pushBack(deltaChannel);
+			selectionChannel->removeReference();
+			deltaChannel->removeReference();
 		}
-		else
-		{
-			node->m_object = newMesh;
 
-			scene->m_meshes.pushBack(newMesh);
-			newMesh->removeReference();
+		hkxMesh::UserChannelInfo* selectionInfo = new hkxMesh::UserChannelInfo();
+		selectionInfo->m_name = shape.m_name.c_str();
+		selectionInfo->m_className = "hkxVertexSelectionChannel";
+		newMesh->m_userChannelInfos.pushBack(selectionInfo);
+		selectionInfo->removeReference();
+
+		hkStringBuf deltaName(shape.m_name.c_str(), ".deltas");
+		hkxMesh::UserChannelInfo* deltaInfo = new hkxMesh::UserChannelInfo();
+		deltaInfo->m_name = deltaName.cString();
+		deltaInfo->m_className = "hkxVertexIntDataChannel";
+
+		hkxAttributeGroup& group = deltaInfo->m_attributeGroups.expandOne();
+		group.m_name = "hkBlendShape";
+		{
+			hkxSparselyAnimatedString* channelName = new hkxSparselyAnimatedString();
+			channelName->m_strings.pushBack(shape.m_channelName.c_str());
+			channelName->m_times.pushBack(0.f);
+
+			hkxAttribute& attribute = group.m_attributes.expandOne();
+			attribute.m_name = "channel";
+			attribute.m_value = channelName;
+			channelName->removeReference();
 		}
+		addFloatAttribute(group, "fullWeight", shape.m_fullWeight);
+		addFloatAttribute(group, "positionScale", deltas.m_positionScale);
+		addFloatAttribute(group, "normalScale", deltas.m_normalScale);
+
+		newMesh->m_userChannelInfos.pushBack(deltaInfo);
+		deltaInfo->removeReference();
 	}
+
+	printf("Added %d blend shape targets with %d vertex offsets\r\n", numShapes, numDeltas);
 }
 
-static bool isNodeFlipped(const FbxNode* node)
+void FbxToHkxConverter::addMesh(hkxScene *scene, FbxNode* meshNode, hkxNode* node)
 {
-	if (node == NULL)
-		return false;
+	const char* meshName = meshNode->GetName();
+	printf("Processing mesh %s\r\n", meshName);
 
-	FbxDouble3 scaling = node->LclScaling.Get();
-	bool flipped = (scaling[0] * scaling[1] * scaling[2]) < 0;
-	return flipped != isNodeFlipped(node->GetParent());
-}
+	ConversionProfiler::Scope nodeScope(m_options.m_profiler, "addMesh", "node", meshName);
+	ConversionMemoryStats::Scope memoryScope(m_options.m_memoryStats, "mesh", meshName);
+	
+	FbxMesh* originalMesh = meshNode->GetMesh();
 
-void FbxToHkxConverter::fillBuffers(
-	FbxMesh* pMesh,
-	FbxNode* originalNode,
-	hkxVertexBuffer* newVB,
-	hkxIndexBuffer* newIB,
-	const hkArray<float>& skinControlPointWeights,
-	const hkArray<int>& skinIndicesToClusters,
-	const hkArray<int>& polyIndices)
-{
-	const int lPolygonCount = polyIndices.getSize();
-	// Vertex buffer
+	hkxMesh* newMesh = HK_NULL;
+	hkxSkinBinding* newSkin = HK_NULL;
+
+	// Each matId maps to a mesh section.
+	hkArray<hkxMeshSection*> exportedSections;
+	FbxSkin *skin = HK_NULL;
+
+	// The morph targets are built from the mesh that was read, and the triangles of each section
+	const bool exportBlendShapes = m_options.m_exportVertexAnimations && originalMesh->GetDeformerCount(FbxDeformer::eBlendShape) > 0;
+	SceneMesh sceneMesh;
+	hkArray< hkArray<int> > sectionTriangles;
+	std::vector<RigidSection> rigidSections;
+
+	// Triangulating and filling the buffers is skipped if the geometry is unchanged since a cached conversion. Meshes
+	// with morph targets are not cached, as the targets need the mesh, nor skins whose rigid sections are extracted.
+	const bool extractRigidSections = m_options.m_extractRigidSections && originalMesh->GetDeformerCount(FbxDeformer::eSkin) > 0;
+	const bool useCache = m_options.m_objectStore && !exportBlendShapes && !extractRigidSections;
+	hkUint64 meshCacheKey = 0;
+	bool sectionsFromCache = false;
+	if (useCache)
 	{
-		hkxVertexDescription desiredVertDesc;
+		meshCacheKey = computeMeshCacheKey(meshNode, originalMesh, FbxSceneSource::isNodeFlipped(meshNode));
+		sectionsFromCache = loadCachedMeshSections(meshCacheKey, meshNode, originalMesh, scene, exportedSections, skin);
+	}
 
-		desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_POSITION, hkxVertexDescription::HKX_DT_FLOAT, 3)); 
+	if (!sectionsFromCache)
+	{
+		FbxMesh* triMesh = NULL;
 
-		if (pMesh->GetElementNormal(0)!=NULL)
+		if (!originalMesh->IsTriangleMesh())
 		{
-			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_NORMAL, hkxVertexDescription::HKX_DT_FLOAT, 3));
+				ConversionProfiler::Scope triangulateScope(m_options.m_profiler, "triangulate", "mesh", meshName);
+				FbxGeometryConverter lGeometryConverter(m_options.m_fbxSdkManager);
+				triMesh = static_cast<FbxMesh*>( lGeometryConverter.Triangulate(meshNode->GetNodeAttribute(), false) );
 		}
-
-		if (pMesh->GetElementVertexColor(0)!=NULL)
+		else
 		{
-			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_COLOR, hkxVertexDescription::HKX_DT_UINT32, 1));
+			triMesh = originalMesh;
 		}
 
-		FbxStringList uvSetNameList;
-		pMesh->GetUVSetNames(uvSetNameList);
-		for (int c = 0, numUVs = pMesh->GetElementUVCount(); c < numUVs; ++c)
+		// Get materials
+		hkArray<FbxSurfaceMaterial*> matIds;
+		getMaterialsInMesh(triMesh, matIds);
+
+		exportedSections.reserve( matIds.getSize() );
+		hkArray<FbxSurfaceMaterial*> sectionMaterials;
+
+
+		// Get skinning info
+		const int lSkinCount = triMesh->GetDeformerCount(FbxDeformer::eSkin);
+		skin = (FbxSkin *)triMesh->GetDeformer(0, FbxDeformer::eSkin);
+
+		// Positions, layers, skin influences and morph targets as flat arrays, shared by all sections
 		{
-			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_TEXCOORD, hkxVertexDescription::HKX_DT_FLOAT, 2, uvSetNameList[c].Buffer()));
+			ConversionProfiler::Scope skinScope(m_options.m_profiler, "readMesh", "mesh", meshName);
+			m_sceneSource->readMesh(meshNode, triMesh, sceneMesh, exportBlendShapes);
 		}
-
-		if (skinControlPointWeights.getSize()>0 && skinIndicesToClusters.getSize()>0)
+		if (m_changeBasis)
 		{
-			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_BLENDWEIGHTS, hkxVertexDescription::HKX_DT_UINT8, 4));
-			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_BLENDINDICES, hkxVertexDescription::HKX_DT_UINT8, 4)); 
+			transformSceneMesh(m_outputBasis, m_outputBasisInverse, sceneMesh);
 		}
 
-		FbxAMatrix geometricTransform;
+		// FbxGeometryElementMaterial maps polygons to materials. We currently do not support
+		// mapping a polygon to multiple materials so we only consider the first mapping.
+		const FbxGeometryElementMaterial* elemMat = triMesh->GetElementMaterial(0);
+		FbxLayerElement::EMappingMode mode;
+		if (elemMat)
 		{
-			FbxNode* meshNode = originalNode;
-			FbxVector4 T = meshNode->GetGeometricTranslation(FbxNode::eSourcePivot);
-			FbxVector4 R = meshNode->GetGeometricRotation(FbxNode::eSourcePivot);
-			FbxVector4 S = meshNode->GetGeometricScaling(FbxNode::eSourcePivot);
-			geometricTransform.SetTRS(T,R,S);
+			mode = elemMat->GetMappingMode();
 		}
-		
-		// XXX be safe, set the maximum possible vertex num... assuming triangle lists
-		const int numVertices = lPolygonCount*3; 
-		newVB->setNumVertices(numVertices, desiredVertDesc);
+		else
+		{
+			// If there is no material mapping we create a dummy material and map everything to it.
+			mode = FbxLayerElement::eAllSame;
+			// If there is no material mapping there also shouldn't be any materials.
+			// Nevertheless we check this just to be sure.
+			if (matIds.isEmpty())
+			{
+				// Our dummy material needed for the mesh section has no matching counterpart on the fbx side.
+				matIds.pushBack(NULL);
+			}
+		}
+		if (mode == FbxLayerElement::eByPolygon)
+			printf("eByPolygon, multiple materials is NOT SUPPORTED, everything is assigned to the first material.\r\n");
+	
 
-		const hkxVertexDescription& vertDesc = newVB->getVertexDesc();
-		const hkxVertexDescription::ElementDecl* posDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_POSITION, 0);
-		const hkxVertexDescription::ElementDecl* normDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_NORMAL, 0);
-		const hkxVertexDescription::ElementDecl* colorDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_COLOR, 0);
-		const hkxVertexDescription::ElementDecl* weightsDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_BLENDWEIGHTS, 0);
-		const hkxVertexDescription::ElementDecl* indicesDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_BLENDINDICES, 0);
+		// Create subsection for each material
+		const int materialCount = matIds.getSize();
+		for (int curMat = 0; curMat < materialCount; ++curMat)
+		{
+			hkArray<int> materialIndices;
+			materialIndices.reserve(triMesh->GetPolygonCount());
+			if (mode == FbxLayerElement::eAllSame)
+			{
+				// The material is used for all triangles. To be able to use the same code in this case
+				// we just write all indices into the array.
+				const int polygonCount = triMesh->GetPolygonCount();
+				for (int i = 0; i < polygonCount; ++i)
+				{
+					materialIndices.pushBack(i);
+				}
+			}
+			else if (mode == FbxLayerElement::eByPolygon)
+			{
+
+				const int polygonCount = triMesh->GetPolygonCount();
+				for (int i = 0; i < polygonCount; ++i)
+				{
+					materialIndices.pushBack(i);
+				}
+				if (curMat > 0)
+					continue; // this might be shaky, just skip ahead if there is more than one material on the mesh (all polys added to first one as if it was the only one)
+
+				/*
+				FbxLayerElementArrayTemplate<int>& indexArray = elemMat->GetIndexArray();
+				const int indexCount = indexArray.GetCount();
+				for (int i = 0; i < indexCount; ++i)
+				{
+					if (indexArray[i] == curMat)
+					{
+						materialIndices.pushBack(i);
+					}
+				}
+				*/
+			}
+			else
+			{
+				HK_WARN(0x0, "Unsupported material mapping mode. This material will be ignored.");
+				continue;
+			}
+
+			if (materialIndices.getSize() == 0)
+			{
+				// The material is not used in the mesh. Nothing is lost in this case so we just skip it.
+				continue;
+			}
+
+			hkxMaterial* sectMat = HK_NULL;
+			if (m_options.m_exportMaterials)
+			{
+				sectMat = createMaterial(matIds[curMat], triMesh, scene);
+			}
+
+			const int firstSection = exportedSections.getSize();
+			addMeshSections(meshName, sceneMesh, materialIndices, sectMat, exportedSections, sectionTriangles, rigidSections);
+			for (int sectionIndex = firstSection; sectionIndex < exportedSections.getSize(); ++sectionIndex)
+			{
+				sectionMaterials.pushBack(matIds[curMat]);
+			}
+			if (sectMat)
+			{
+				sectMat->removeReference();
+			}
+		}
+
+		if (useCache)
+		{
+			storeCachedMeshSections(meshCacheKey, meshNode, exportedSections, sectionMaterials, lSkinCount > 0);
+		}
+	}
+
+	// Create new mesh
+	newMesh = new hkxMesh();
+	newMesh->m_sections.setSize(exportedSections.getSize());
+	for(int cs = 0; cs < newMesh->m_sections.getSize(); ++cs)
+	{
+		newMesh->m_sections[cs] = exportedSections[cs];
+		exportedSections[cs]->removeReference();
+	}
+
+	addUserChannels(meshName, newMesh);
+
+	if (exportBlendShapes && !sceneMesh.m_blendShapes.empty())
+	{
+		addBlendShapes(meshName, sceneMesh, sectionTriangles, newMesh);
+	}
+
+	// Add skin bindings
+	if (skin)
+	{
+		ConversionProfiler::Scope skinScope(m_options.m_profiler, "skin", "mesh", meshName);
+
+		newSkin = new hkxSkinBinding();
+		newSkin->m_mesh = newMesh;
+
+		const int lClusterCount = skin->GetClusterCount();
+		newSkin->m_bindPose.setSize(lClusterCount);
+		newSkin->m_nodeNames.setSize(lClusterCount);
+
+		// Extract bind pose transforms & bone names
+		for(int curClusterIndex = 0; curClusterIndex < lClusterCount; ++curClusterIndex)
+		{
+			FbxCluster* lCluster = skin->GetCluster(curClusterIndex);
+
+			newSkin->m_nodeNames[curClusterIndex] = lCluster->GetLink()->GetName();
+
+			const FbxAMatrix lMatrix = getGlobalPosition(lCluster->GetLink(), m_startTime, m_pose, NULL);			
+			convertFbxXMatrixToMatrix4(lMatrix, newSkin->m_bindPose[curClusterIndex]);
+			toOutputBasis(newSkin->m_bindPose[curClusterIndex]);
+		}
+
+		// Extract the world transform of the original, skinned mesh
+		{
+			FbxAMatrix lMatrix = meshNode->EvaluateGlobalTransform();
+			convertFbxXMatrixToMatrix4(lMatrix, newSkin->m_initSkinTransform);
+			toOutputBasis(newSkin->m_initSkinTransform);
+		}
+	}
+
+	if (!rigidSections.empty())
+	{
+		HK_ASSERT(0x0, newSkin);
+		addRigidMeshes(scene, meshName, sceneMesh, rigidSections, newSkin);
+	}
+
+
+	if (m_options.m_exportVertexTangents)
+	{
+		ConversionProfiler::Scope tangentScope(m_options.m_profiler, "tangents", "mesh", meshName);
+		hkxMeshSectionUtil::computeTangents(newMesh, true, originalMesh->GetName());
+	}
+
+
+	if (newMesh->m_sections.isEmpty())
+	{
+		// Every triangle went to a rigid mesh
+		if (newSkin)
+		{
+			newSkin->removeReference();
+		}
+		newMesh->removeReference();
+	}
+	else
+	{
+		if (newSkin)
+		{
+			node->m_object = newSkin;
 
-		const int posStride = posDecl? posDecl->m_byteStride : 0;
-		const int normStride = normDecl? normDecl->m_byteStride : 0;
-		const int colorStride = colorDecl? colorDecl->m_byteStride : 0;
-		const int weightsStride = weightsDecl? weightsDecl->m_byteStride : 0;
-		const int indicesStride = indicesDecl? indicesDecl->m_byteStride : 0;
+			scene->m_meshes.pushBack(newMesh);
+			scene->m_skinBindings.pushBack(newSkin);
+			newMesh->removeReference();
+			newSkin->removeReference();
+		}
+		else
+		{
+			node->m_object = newMesh;
+
+			scene->m_meshes.pushBack(newMesh);
+			newMesh->removeReference();
+		}
+	}
+}
 
-		char* posBuf = static_cast<char*>(posDecl? newVB->getVertexDataPtr(*posDecl): HK_NULL);
-		char* normBuf = static_cast<char*>(normDecl? newVB->getVertexDataPtr(*normDecl): HK_NULL);
-		char* colorBuf = static_cast<char*>(colorDecl? newVB->getVertexDataPtr(*colorDecl): HK_NULL);
-		char* weightsBuf = static_cast<char*>(weightsDecl? newVB->getVertexDataPtr(*weightsDecl): HK_NULL);
-		char* indicesBuf = static_cast<char*>(indicesDecl? newVB->getVertexDataPtr(*indicesDecl): HK_NULL);
+void FbxToHkxConverter::addSourceMesh(const SceneSource& source, hkxScene *scene, int sourceNode, hkxNode* node)
+{
+	const char* meshName = source.getNodeName(sourceNode);
+	printf("Processing mesh %s\r\n", meshName);
 
-		const int maxNumUVs = (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE_MAX - (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE0;
-		hkArray<int>::Temp textureCoordinateArrayPositions(maxNumUVs);
-		textureCoordinateArrayPositions.setSize(maxNumUVs);
-		hkString::memSet4(textureCoordinateArrayPositions.begin(), 0, textureCoordinateArrayPositions.getSize());
+	ConversionProfiler::Scope nodeScope(m_options.m_profiler, "addMesh", "node", meshName);
+	ConversionMemoryStats::Scope memoryScope(m_options.m_memoryStats, "mesh", meshName);
 
-		FbxVector4* lControlPoints = pMesh->GetControlPoints();
-		int vertexId = 0;
+	SceneMesh sceneMesh;
+	{
+		ConversionProfiler::Scope readScope(m_options.m_profiler, "readMesh", "mesh", meshName);
+		if (!source.getMesh(sourceNode, sceneMesh))
+		{
+			return;
+		}
+	}
+	// The stored bind poses are converted with the mesh
+	if (m_changeBasis)
+	{
+		transformSceneMesh(m_outputBasis, m_outputBasisInverse, sceneMesh);
+	}
 
-		
-		for (int polyIdx = 0; polyIdx < lPolygonCount; polyIdx++)
+	// Each material maps to a mesh section, triangles with an unknown material go to the first one
+	const int numMaterials = hkMath::max2((int)sceneMesh.m_materials.size(), 1);
+	const int numTriangles = sceneMesh.getNumTriangles();
+	hkArray< hkArray<int> > materialTriangles;
+	materialTriangles.setSize(numMaterials);
+	for (int triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		int material = sceneMesh.m_triangleMaterials.empty() ? 0 : sceneMesh.m_triangleMaterials[triangle];
+		if (material < 0 || material >= numMaterials)
 		{
-			// Indirection from the polyIndices for the current material to the mesh's polygon list.
-			int i = polyIndices[polyIdx];
+			material = 0;
+		}
+		materialTriangles[material].pushBack(triangle);
+	}
+
+	hkArray<hkxMeshSection*> exportedSections;
+	hkArray< hkArray<int> > sectionTriangles;
+	std::vector<RigidSection> rigidSections;
+	for (int curMat = 0; curMat < numMaterials; ++curMat)
+	{
+		if (materialTriangles[curMat].getSize() == 0)
+		{
+			// The material is not used in the mesh
+			continue;
+		}
+
+		hkxMaterial* sectMat = HK_NULL;
+		if (m_options.m_exportMaterials)
+		{
+			sectMat = createSourceMaterial(sceneMesh.m_materials.empty() ? HK_NULL : &sceneMesh.m_materials[curMat], sceneMesh, scene);
+		}
+
+		addMeshSections(meshName, sceneMesh, materialTriangles[curMat], sectMat, exportedSections, sectionTriangles, rigidSections);
+		if (sectMat)
+		{
+			sectMat->removeReference();
+		}
+	}
+
+	hkxMesh* newMesh = new hkxMesh();
+	newMesh->m_sections.setSize(exportedSections.getSize());
+	for (int sectionIndex = 0; sectionIndex < exportedSections.getSize(); ++sectionIndex)
+	{
+		newMesh->m_sections[sectionIndex] = exportedSections[sectionIndex];
+		exportedSections[sectionIndex]->removeReference();
+	}
+
+	addUserChannels(meshName, newMesh);
+
+	// Sources have no blend shape channel weights, only the targets are converted
+	if (m_options.m_exportVertexAnimations && !sceneMesh.m_blendShapes.empty())
+	{
+		addBlendShapes(meshName, sceneMesh, sectionTriangles, newMesh);
+	}
+
+	// Add skin bindings
+	hkxSkinBinding* newSkin = HK_NULL;
+	if (sceneMesh.isSkinned())
+	{
+		ConversionProfiler::Scope skinScope(m_options.m_profiler, "skin", "mesh", meshName);
 
-			const int lPolygonSize = pMesh->GetPolygonSize(i);
-			HK_ASSERT(0x0,lPolygonSize==3);
+		newSkin = new hkxSkinBinding();
+		newSkin->m_mesh = newMesh;
+
+		const int numClusters = (int)sceneMesh.m_clusterNodes.size();
+		newSkin->m_bindPose.setSize(numClusters);
+		newSkin->m_nodeNames.setSize(numClusters);
 
-			for (int j = 0; j < lPolygonSize; j++)
+		// Bind pose transforms & bone names, bones without a stored bind pose are taken at time 0
+		for (int clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+		{
+			const int boneNode = sceneMesh.m_clusterNodes[clusterIndex];
+			newSkin->m_nodeNames[clusterIndex] = (boneNode >= 0) ? source.getNodeName(boneNode) : "";
+
+			double bindPose[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+			if ((int)sceneMesh.m_clusterBindPoses.size() == numClusters * 16)
 			{
-				vertexId = i * 3 + j;
-				const int lControlPointIndex = pMesh->GetPolygonVertex(i, j);
-				
-				if (posBuf)
-				{
-					FbxVector4 fbxPos = lControlPoints[lControlPointIndex];
-					fbxPos = geometricTransform.MultT(fbxPos);
-
-					float* _pos = (float*)(posBuf);
-					_pos[0] = (float)fbxPos[0];
-					_pos[1] = (float)fbxPos[1];
-					_pos[2] = (float)fbxPos[2];
-					_pos[3] = 0;
-					posBuf += posStride;
-				}
+				hkString::memCpy(bindPose, &sceneMesh.m_clusterBindPoses[clusterIndex * 16], sizeof(bindPose));
+			}
+			else if (boneNode >= 0)
+			{
+				evaluateGlobalTransform(source, boneNode, -1, 0, bindPose);
+				changeBasis(m_outputBasis, m_outputBasisInverse, bindPose);
+			}
+			convertSourceMatrixToMatrix4(bindPose, newSkin->m_bindPose[clusterIndex]);
+		}
 
-				if (normBuf)
-				{
-					FbxVector4 fbxNormal;
-					FbxGeometryElementNormal* leNormal = pMesh->GetElementNormal(0);
+		// The world transform of the original, skinned mesh
+		double skinTransform[16];
+		evaluateGlobalTransform(source, sourceNode, -1, 0, skinTransform);
+		changeBasis(m_outputBasis, m_outputBasisInverse, skinTransform);
+		convertSourceMatrixToMatrix4(skinTransform, newSkin->m_initSkinTransform);
+	}
 
-					const FbxGeometryElement::EMappingMode mappingMode = leNormal->GetMappingMode();
+	if (!rigidSections.empty())
+	{
+		HK_ASSERT(0x0, newSkin);
+		addRigidMeshes(scene, meshName, sceneMesh, rigidSections, newSkin);
+	}
 
-					if (mappingMode == FbxGeometryElement::eByPolygonVertex)
-					{
-						switch(leNormal->GetReferenceMode())
-						{
-						case FbxGeometryElement::eDirect:
-							fbxNormal = leNormal->GetDirectArray().GetAt(vertexId);
-							break;
-						case FbxGeometryElement::eIndexToDirect:
-							{
-								int id = leNormal->GetIndexArray().GetAt(vertexId);
-								fbxNormal = leNormal->GetDirectArray().GetAt(id);
-							}
-							break;
-						default:
-							// Other reference modes not shown here!
-							break;
-						}
-					}
-					else if (mappingMode == FbxGeometryElement::eByControlPoint)
-					{
-						switch(leNormal->GetReferenceMode())
-						{
-						case FbxGeometryElement::eDirect:
-							fbxNormal = leNormal->GetDirectArray().GetAt(lControlPointIndex);
-							break;
-						case FbxGeometryElement::eIndexToDirect:
-							{
-								int id = leNormal->GetIndexArray().GetAt(lControlPointIndex);
-								fbxNormal = leNormal->GetDirectArray().GetAt(id);
-							}
-							break;
-						default:
-							// Other reference modes not shown here!
-							break;
-						}
-					}
+	if (m_options.m_exportVertexTangents)
+	{
+		ConversionProfiler::Scope tangentScope(m_options.m_profiler, "tangents", "mesh", meshName);
+		hkxMeshSectionUtil::computeTangents(newMesh, true, meshName);
+	}
 
-					float* _normal =(float*)(normBuf);
-					_normal[0] = (float)fbxNormal[0];
-					_normal[1] = (float)fbxNormal[1];
-					_normal[2] = (float)fbxNormal[2];
-					_normal[3] = 0;
-					normBuf += normStride;
-				}
+	if (newMesh->m_sections.isEmpty())
+	{
+		// Every triangle went to a rigid mesh
+		if (newSkin)
+		{
+			newSkin->removeReference();
+		}
+		newMesh->removeReference();
+	}
+	else if (newSkin)
+	{
+		node->m_object = newSkin;
 
-				FbxStringList lUVSetNameList;
-				pMesh->GetUVSetNames(lUVSetNameList);
+		scene->m_meshes.pushBack(newMesh);
+		scene->m_skinBindings.pushBack(newSkin);
+		newMesh->removeReference();
+		newSkin->removeReference();
+	}
+	else
+	{
+		node->m_object = newMesh;
 
-				// Tex coord UV channels
-				for(int t = 0, numUVs = hkMath::min2(lUVSetNameList.GetCount(), maxNumUVs); t < numUVs; ++t)
-				{
-					const char* lUVSetName = lUVSetNameList.GetStringAt(t);
-					const FbxGeometryElementUV* leUV = pMesh->GetElementUV(lUVSetName);
-					const hkxVertexDescription::ElementDecl* texDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_TEXCOORD, t);
-					HK_ASSERT(0x0, leUV && texDecl);
-
-					const int texCoordStride = texDecl->m_byteStride;
-					char* texCoordBuf = static_cast<char*>(newVB->getVertexDataPtr(*texDecl));
-					FbxVector2 fbxUV;
- 
-					switch (leUV->GetMappingMode())
-					{
-					case FbxGeometryElement::eByControlPoint:
-						switch(leUV->GetReferenceMode())
-						{
-						case FbxGeometryElement::eDirect:
-							fbxUV = leUV->GetDirectArray().GetAt(lControlPointIndex);
-							break;
-						case FbxGeometryElement::eIndexToDirect:
-							{
-								int id = leUV->GetIndexArray().GetAt(lControlPointIndex);
-								fbxUV = leUV->GetDirectArray().GetAt(id);
-							}
-							break;
-						default:
-							// Other reference modes not shown here!
-							break;
-						}
-						break;
- 
-					case FbxGeometryElement::eByPolygonVertex:
-						{
-							// UV indices are monotonously increasing with each vertex in each polygon.
-							int lTextureUVIndex = i * 3 + j; // All polygons have 3 vertices.
-							switch(leUV->GetReferenceMode())
-							{
-							case FbxGeometryElement::eDirect:
-								{
-									fbxUV = leUV->GetDirectArray().GetAt(lTextureUVIndex);
-								}
-							case FbxGeometryElement::eIndexToDirect:
-								{
-									int id = leUV->GetIndexArray().GetAt(lTextureUVIndex);
-									fbxUV = leUV->GetDirectArray().GetAt(id);
-								}
-								break;
-							default:
-								// Other reference modes not shown here!
-								break;
-							}
-						}
-						break;
- 
-					case FbxGeometryElement::eByPolygon: // Doesn't make much sense for UVs
-					case FbxGeometryElement::eAllSame:   // Doesn't make much sense for UVs
-					case FbxGeometryElement::eNone:       // Doesn't make much sense for UVs
-						break;
-					}
+		scene->m_meshes.pushBack(newMesh);
+		newMesh->removeReference();
+	}
+}
 
-					float* _uv =(float*)(texCoordBuf + textureCoordinateArrayPositions[t]);
-					_uv[0] = (float)fbxUV[0];
-					_uv[1] = (float)fbxUV[1];
-					textureCoordinateArrayPositions[t] += texCoordStride;
-				}
+void FbxToHkxConverter::addMeshSections(
+	const char* meshName,
+	const SceneMesh& sceneMesh,
+	const hkArray<int>& triangles,
+	hkxMaterial* material,
+	hkArray<hkxMeshSection*>& sectionsOut,
+	hkArray< hkArray<int> >& sectionTrianglesOut,
+	std::vector<RigidSection>& rigidSectionsOut)
+{
+	// Rigid triangles go to meshes of their own, the rest is skinned as usual
+	std::vector<int> skinnedTriangles(triangles.begin(), triangles.end());
+	if (m_options.m_extractRigidSections && sceneMesh.isSkinned())
+	{
+		ConversionProfiler::Scope rigidScope(m_options.m_profiler, "extractRigid", "mesh", meshName);
+		std::vector<SceneRigidPart> rigidParts;
+		extractRigidTriangles(sceneMesh, triangles.begin(), triangles.getSize(), skinnedTriangles, rigidParts);
+		for (size_t partIndex = 0; partIndex < rigidParts.size(); ++partIndex)
+		{
+			rigidSectionsOut.push_back(RigidSection());
+			RigidSection& rigidSection = rigidSectionsOut.back();
+			rigidSection.m_bone = rigidParts[partIndex].m_bone;
+			rigidSection.m_material = material;
+			rigidSection.m_triangles.swap(rigidParts[partIndex].m_triangles);
+			if (material)
+			{
+				material->addReference();
+			}
+		}
+		if (!rigidParts.empty())
+		{
+			printf("Extracted %d of %d triangles rigidly bound to %d bones\r\n", triangles.getSize() - (int)skinnedTriangles.size(), triangles.getSize(), (int)rigidParts.size());
+		}
+		if (skinnedTriangles.empty())
+		{
+			return;
+		}
+	}
 
-				if (colorBuf)
-				{
-					FbxGeometryElementVertexColor* leVtxc = pMesh->GetElementVertexColor(0);
-					FbxColor fbxColor;
- 
-					if (leVtxc != NULL)
-					{
-						switch(leVtxc->GetMappingMode())
-						{
-						case FbxGeometryElement::eByControlPoint:
-							switch(leVtxc->GetReferenceMode())
-							{
-							case FbxGeometryElement::eDirect:
-								fbxColor = leVtxc->GetDirectArray().GetAt(lControlPointIndex);
-								break;
-							case FbxGeometryElement::eIndexToDirect:
-								{
-									int id = leVtxc->GetIndexArray().GetAt(lControlPointIndex);
-									fbxColor = leVtxc->GetDirectArray().GetAt(id);
-								}
-								break;
-							default:
-								// Other reference modes not shown here!
-								break;
-							}
-							break;
-	 
-						case FbxGeometryElement::eByPolygonVertex:
-							{
-								switch(leVtxc->GetReferenceMode())
-								{
-								case FbxGeometryElement::eDirect:
-									fbxColor = leVtxc->GetDirectArray().GetAt(vertexId);
-									break;
-								case FbxGeometryElement::eIndexToDirect:
-									{
-										int id = leVtxc->GetIndexArray().GetAt(vertexId);
-										fbxColor = leVtxc->GetDirectArray().GetAt(id);
-									}
-									break;
-								default:
-									// Other reference modes not shown here!
-									break;
-								}
-							}
-							break;
-	 
-						case FbxGeometryElement::eByPolygon: // Doesn't make much sense for UVs
-						case FbxGeometryElement::eAllSame:   // Doesn't make much sense for UVs
-						case FbxGeometryElement::eNone:      // Doesn't make much sense for UVs
-							break;
-						}
-					}
+	// Blend indices are 8 bit, larger skins are always split
+	const int maxIndexedBones = 256;
+	int numClusters = 0;
+	for (size_t influence = 0; influence < sceneMesh.m_skinClusters.size(); ++influence)
+	{
+		numClusters = hkMath::max2(numClusters, sceneMesh.m_skinClusters[influence] + 1);
+	}
+	int maxBones = 0;
+	if (sceneMesh.isSkinned() && (m_options.m_maxSkinBones > 0 || numClusters > maxIndexedBones))
+	{
+		maxBones = (m_options.m_maxSkinBones > 0) ? hkMath::min2(m_options.m_maxSkinBones, maxIndexedBones) : maxIndexedBones;
+	}
 
-					// Vertex color
-					unsigned color = elementsToARGB(fbxColor.mRed, fbxColor.mGreen, fbxColor.mBlue, fbxColor.mAlpha); 
+	std::vector<SceneSkinPartition> partitions;
+	if (maxBones > 0)
+	{
+		ConversionProfiler::Scope partitionScope(m_options.m_profiler, "partitionSkin", "mesh", meshName);
+		partitionSkinnedTriangles(sceneMesh, &skinnedTriangles[0], (int)skinnedTriangles.size(), maxBones, partitions);
+		printf("Split %d triangles into %d sections of up to %d bones\r\n", (int)skinnedTriangles.size(), (int)partitions.size(), maxBones);
+	}
 
-					hkUint32* _color = (hkUint32*)(colorBuf);
-					*_color = color;
+	const int numSections = (maxBones > 0) ? (int)partitions.size() : 1;
+	for (int sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+	{
+		const std::vector<int>& sectionTriangleList = (maxBones > 0) ? partitions[sectionIndex].m_triangles : skinnedTriangles;
+		const int* sectionTriangles = &sectionTriangleList[0];
+		const int numSectionTriangles = (int)sectionTriangleList.size();
+		const std::vector<int>* bonePalette = (maxBones > 0) ? &partitions[sectionIndex].m_bones : HK_NULL;
 
-					colorBuf += colorStride;
-				}
+		// Vertex buffer
+		hkxVertexBuffer* newVB = new hkxVertexBuffer();
+		hkxIndexBuffer* newIB = new hkxIndexBuffer();
+		{
+			ConversionProfiler::Scope fillScope(m_options.m_profiler, "fillBuffers", "mesh", meshName);
+			fillBuffers(sceneMesh, newVB, newIB, sectionTriangles, numSectionTriangles, bonePalette);
+		}
+
+		hkxMeshSection* newSection = new hkxMeshSection();
+		newSection->m_material = material;
+		newSection->m_vertexBuffer = newVB;
+		newSection->m_indexBuffers.setSize(1);
+		newSection->m_indexBuffers[0] = newIB;
+
+		// The palette maps the blend indices of the index buffer to the bones of the skin binding
+		if (bonePalette)
+		{
+			if ((int)bonePalette->size() > maxBones)
+			{
+				printf("Warning: a triangle of %s is influenced by %d bones, more than the limit of %d\r\n", meshName, (int)bonePalette->size(), maxBones);
+			}
+
+			hkMeshBoneIndexMapping& mapping = newSection->m_boneMatrixMap.expandOne();
+			mapping.m_mapping.setSize((int)bonePalette->size());
+			for (int paletteIndex = 0; paletteIndex < mapping.m_mapping.getSize(); ++paletteIndex)
+			{
+				mapping.m_mapping[paletteIndex] = (hkInt16)(*bonePalette)[paletteIndex];
+			}
+		}
+
+		sectionsOut.pushBack(newSection);
+		sectionTrianglesOut.expandOne().append(sectionTriangles, numSectionTriangles);
+		newVB->removeReference();
+		newIB->removeReference();
+	}
+}
+
+void FbxToHkxConverter::addRigidMeshes(hkxScene *scene, const char* meshName, const SceneMesh& sceneMesh, std::vector<RigidSection>& rigidSections, const hkxSkinBinding* skin)
+{
+	ConversionProfiler::Scope rigidScope(m_options.m_profiler, "rigidMeshes", "mesh", meshName);
+
+	hkFloat32 elements[16];
+	double skinTransform[16];
+	skin->m_initSkinTransform.get4x4ColumnMajor(elements);
+	for (int element = 0; element < 16; ++element)
+	{
+		skinTransform[element] = elements[element];
+	}
+
+	// One mesh per bone, with a section for each material of its triangles
+	std::vector<bool> sectionAdded(rigidSections.size(), false);
+	for (size_t firstSection = 0; firstSection < rigidSections.size(); ++firstSection)
+	{
+		if (sectionAdded[firstSection])
+		{
+			continue;
+		}
+		const int bone = rigidSections[firstSection].m_bone;
+		const char* boneName = skin->m_nodeNames[bone].cString();
+
+		// Mesh space to bone space at the bind pose: inverse(bone bind pose) * skin transform
+		double bindPose[16];
+		skin->m_bindPose[bone].get4x4ColumnMajor(elements);
+		for (int element = 0; element < 16; ++element)
+		{
+			bindPose[element] = elements[element];
+		}
+		double bindPoseInverse[16];
+		if (!boneName || !invertAffineTransform(bindPose, bindPoseInverse))
+		{
+			// Left out rather than skinned, the triangles of the skin have already been split
+			printf("Warning: bone %d of %s has no name or a singular bind pose, its rigid triangles are not converted\r\n", bone, meshName);
+			continue;
+		}
+		double boneFromMesh[16];
+		multiplyMatrices(bindPoseInverse, skinTransform, boneFromMesh);
+
+		hkxMesh* newMesh = new hkxMesh();
+		for (size_t sectionIndex = firstSection; sectionIndex < rigidSections.size(); ++sectionIndex)
+		{
+			const RigidSection& rigidSection = rigidSections[sectionIndex];
+			if (rigidSection.m_bone != bone)
+			{
+				continue;
+			}
+			sectionAdded[sectionIndex] = true;
+
+			hkxVertexBuffer* newVB = new hkxVertexBuffer();
+			hkxIndexBuffer* newIB = new hkxIndexBuffer();
+			fillBuffers(sceneMesh, newVB, newIB, &rigidSection.m_triangles[0], (int)rigidSection.m_triangles.size(), HK_NULL, boneFromMesh);
+
+			hkxMeshSection* newSection = new hkxMeshSection();
+			newSection->m_material = rigidSection.m_material;
+			newSection->m_vertexBuffer = newVB;
+			newSection->m_indexBuffers.setSize(1);
+			newSection->m_indexBuffers[0] = newIB;
+			newMesh->m_sections.pushBack(newSection);
+			newSection->removeReference();
+			newVB->removeReference();
+			newIB->removeReference();
+		}
 
-				if (weightsBuf && indicesBuf)
+		hkStringBuf nodeName;
+		nodeName.printf("%s_%s_rigid", meshName, boneName);
+
+		if (m_options.m_exportVertexTangents)
+		{
+			hkxMeshSectionUtil::computeTangents(newMesh, true, nodeName.cString());
+		}
+
+		scene->m_meshes.pushBack(newMesh);
+		newMesh->removeReference();
+
+		RigidMesh rigidMesh;
+		rigidMesh.m_boneName = boneName;
+		rigidMesh.m_nodeName = nodeName.cString();
+		rigidMesh.m_mesh = newMesh;
+		m_rigidMeshes.push_back(rigidMesh);
+	}
+
+	for (size_t sectionIndex = 0; sectionIndex < rigidSections.size(); ++sectionIndex)
+	{
+		if (rigidSections[sectionIndex].m_material)
+		{
+			rigidSections[sectionIndex].m_material->removeReference();
+		}
+	}
+	rigidSections.clear();
+}
+
+void FbxToHkxConverter::fillBuffers(
+	const SceneMesh& sceneMesh,
+	hkxVertexBuffer* newVB,
+	hkxIndexBuffer* newIB,
+	const int* polyIndices,
+	int numPolys,
+	const std::vector<int>* bonePalette,
+	const double* rigidTransform)
+{
+	const int maxNumUVs = (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE_MAX - (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE0;
+
+	SceneVertexBuffers buffers;
+	buildTriangleListBuffers(sceneMesh, polyIndices, numPolys, maxNumUVs, buffers, bonePalette);
+
+	// Rigid sections are not skinned, their bone moves them
+	if (rigidTransform)
+	{
+		transformVertexBuffers(rigidTransform, buffers);
+		buffers.m_skinIndices.clear();
+		buffers.m_skinWeights.clear();
+	}
+
+	// Vertex buffer
+	{
+		hkxVertexDescription desiredVertDesc;
+
+		desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_POSITION, hkxVertexDescription::HKX_DT_FLOAT, 3)); 
+
+		if (!buffers.m_normals.empty())
+		{
+			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_NORMAL, hkxVertexDescription::HKX_DT_FLOAT, 3));
+		}
+
+		if (!buffers.m_colors.empty())
+		{
+			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_COLOR, hkxVertexDescription::HKX_DT_UINT32, 1));
+		}
+
+		const int numUVs = (int)buffers.m_uvSets.size();
+		for (int c = 0; c < numUVs; ++c)
+		{
+			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_TEXCOORD, hkxVertexDescription::HKX_DT_FLOAT, 2, sceneMesh.m_uvSetNames[c].c_str()));
+		}
+
+		if (!buffers.m_skinIndices.empty())
+		{
+			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_BLENDWEIGHTS, hkxVertexDescription::HKX_DT_UINT8, 4));
+			desiredVertDesc.m_decls.pushBack(hkxVertexDescription::ElementDecl(hkxVertexDescription::HKX_DU_BLENDINDICES, hkxVertexDescription::HKX_DT_UINT8, 4)); 
+		}
+
+		const int numVertices = buffers.m_numVertices;
+		newVB->setNumVertices(numVertices, desiredVertDesc);
+
+		const hkxVertexDescription& vertDesc = newVB->getVertexDesc();
+		const hkxVertexDescription::ElementDecl* posDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_POSITION, 0);
+		const hkxVertexDescription::ElementDecl* normDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_NORMAL, 0);
+		const hkxVertexDescription::ElementDecl* colorDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_COLOR, 0);
+		const hkxVertexDescription::ElementDecl* weightsDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_BLENDWEIGHTS, 0);
+		const hkxVertexDescription::ElementDecl* indicesDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_BLENDINDICES, 0);
+
+		if (posDecl)
+		{
+			char* posBuf = static_cast<char*>(newVB->getVertexDataPtr(*posDecl));
+			for (int v = 0; v < numVertices; ++v, posBuf += posDecl->m_byteStride)
+			{
+				float* _pos = (float*)(posBuf);
+				_pos[0] = buffers.m_positions[v * 3];
+				_pos[1] = buffers.m_positions[v * 3 + 1];
+				_pos[2] = buffers.m_positions[v * 3 + 2];
+				_pos[3] = 0;
+			}
+		}
+
+		if (normDecl)
+		{
+			char* normBuf = static_cast<char*>(newVB->getVertexDataPtr(*normDecl));
+			for (int v = 0; v < numVertices; ++v, normBuf += normDecl->m_byteStride)
+			{
+				float* _normal = (float*)(normBuf);
+				_normal[0] = buffers.m_normals[v * 3];
+				_normal[1] = buffers.m_normals[v * 3 + 1];
+				_normal[2] = buffers.m_normals[v * 3 + 2];
+				_normal[3] = 0;
+			}
+		}
+
+		// Tex coord UV channels
+		for (int t = 0; t < numUVs; ++t)
+		{
+			const hkxVertexDescription::ElementDecl* texDecl = vertDesc.getElementDecl(hkxVertexDescription::HKX_DU_TEXCOORD, t);
+			HK_ASSERT(0x0, texDecl);
+
+			char* texCoordBuf = static_cast<char*>(newVB->getVertexDataPtr(*texDecl));
+			const std::vector<float>& uvs = buffers.m_uvSets[t];
+			for (int v = 0; v < numVertices; ++v, texCoordBuf += texDecl->m_byteStride)
+			{
+				float* _uv = (float*)(texCoordBuf);
+				_uv[0] = uvs[v * 2];
+				_uv[1] = uvs[v * 2 + 1];
+			}
+		}
+
+		if (colorDecl)
+		{
+			char* colorBuf = static_cast<char*>(newVB->getVertexDataPtr(*colorDecl));
+			for (int v = 0; v < numVertices; ++v, colorBuf += colorDecl->m_byteStride)
+			{
+				*(hkUint32*)(colorBuf) = buffers.m_colors[v];
+			}
+		}
+
+		if (weightsDecl && indicesDecl)
+		{
+			char* weightsBuf = static_cast<char*>(newVB->getVertexDataPtr(*weightsDecl));
+			char* indicesBuf = static_cast<char*>(newVB->getVertexDataPtr(*indicesDecl));
+			for (int v = 0; v < numVertices; ++v, weightsBuf += weightsDecl->m_byteStride, indicesBuf += indicesDecl->m_byteStride)
+			{
+				// Add skin indices
+				*(hkUint32*)(indicesBuf) = buffers.m_skinIndices[v];
+
+				// Add skin weights
+				hkReal tempWeights[4];
+				for (int i = 0; i < 4; i++)
 				{
-					const int controlPointFour = lControlPointIndex * 4;
-					
-					// Add skin indices
-					{
-						unsigned int compressedI =  unsigned int(skinIndicesToClusters[controlPointFour]  )<< 24 | 
-													unsigned int(skinIndicesToClusters[controlPointFour+1])<< 16 | 
-													unsigned int(skinIndicesToClusters[controlPointFour+2])<< 8  | 
-													unsigned int(skinIndicesToClusters[controlPointFour+3]);
+					tempWeights[i] = buffers.m_skinWeights[v * 4 + i];
+				}
 
-						hkUint32* curIndexBuf =(hkUint32*)(indicesBuf);
-						*curIndexBuf = compressedI;
-					}
-					
-					// Add skin weights
-					{
-						unsigned int compressedW = 0;
-						{
-							hkReal tempWeights[4];
-							for(int i=0; i<4; i++)
-							{
-								tempWeights[i] = skinControlPointWeights[controlPointFour+i];
-							}
-	
-							hkUint8 tempQWeights[4];
-							hkxSkinUtils::quantizeWeights(tempWeights, tempQWeights);
-	
-							compressedW =	unsigned int(tempQWeights[0])<< 24 |
+				hkUint8 tempQWeights[4];
+				hkxSkinUtils::quantizeWeights(tempWeights, tempQWeights);
+
+				*(hkUint32*)(weightsBuf) =	unsigned int(tempQWeights[0])<< 24 |
 											unsigned int(tempQWeights[1])<< 16 | 
 											unsigned int(tempQWeights[2])<< 8  | 
 											unsigned int(tempQWeights[3]);
-						}
-
-						hkUint32* _w =(hkUint32*)(weightsBuf);
-						*_w = compressedW;
-					}					
-
-					weightsBuf += weightsStride;
-					indicesBuf += indicesStride;
-				}				
-	
-				vertexId++;
-			} // For polygonSize
-		} // For polygonCount
+			}
+		}
 	}
 
 	// Index buffer... assumes triangle list for now
 	{
 		newIB->m_indexType = hkxIndexBuffer::INDEX_TYPE_TRI_LIST;
 		newIB->m_vertexBaseOffset = 0;
-		newIB->m_length = lPolygonCount * 3;
+		newIB->m_length = (hkUint32)buffers.m_indices.size();
 		newIB->m_indices32.setSize(newIB->m_length);
-
-		hkUint32* curIndex = newIB->m_indices32.begin();
-		for (int polygonIndex = 0, vertexId = 0; polygonIndex < lPolygonCount; polygonIndex++)
-		{
-			for (int vertexIndex = 0; vertexIndex < 3; vertexIndex++)
-			{
-				*curIndex = vertexId++;
-				curIndex++;
-			}
-		}
+		hkString::memCpy(newIB->m_indices32.begin(), &buffers.m_indices[0], newIB->m_length * sizeof(hkUint32));
 
 		// Mirrored meshes need to have their faces flipped (EXP-2773)
-		if (isNodeFlipped(originalNode))
+		if (sceneMesh.m_flipped)
 		{
 			hkxSceneUtils::flipWinding(*newIB);
 		}
@@ -1420,6 +1555,101 @@ hkxMaterial* FbxToHkxConverter::createMaterial(FbxSurfaceMaterial* lMaterial, Fb
 	return mat;
 }
 
+hkxMaterial* FbxToHkxConverter::createSourceMaterial(const SceneMaterial* material, const SceneMesh& sceneMesh, hkxScene* scene)
+{
+	// Test whether this material has already been created. Names don't identify materials, glTF materials are often
+	// unnamed.
+	hkxMaterial* existingMat = HK_NULL;
+	if (!material)
+	{
+		existingMat = m_defaultSourceMaterial;
+	}
+	else if (material->m_id >= 0)
+	{
+		std::map<long long, hkxMaterial*>::iterator iterator = m_convertedSourceMaterials.find(material->m_id);
+		existingMat = (iterator != m_convertedSourceMaterials.end()) ? iterator->second : HK_NULL;
+	}
+	if (existingMat)
+	{
+		existingMat->addReference();
+		return existingMat;
+	}
+
+	hkxMaterial* mat = createDefaultMaterial(material ? material->m_name.c_str() : "Dummy");
+	if (!material)
+	{
+		m_defaultSourceMaterial = mat;
+	}
+	else if (material->m_id >= 0)
+	{
+		m_convertedSourceMaterials[material->m_id] = mat;
+	}
+
+	if (material)
+	{
+		mat->m_ambientColor.set(material->m_ambient[0], material->m_ambient[1], material->m_ambient[2], material->m_ambient[3]);
+		mat->m_diffuseColor.set(material->m_diffuse[0], material->m_diffuse[1], material->m_diffuse[2], material->m_diffuse[3]);
+		mat->m_specularColor.set(material->m_specular[0], material->m_specular[1], material->m_specular[2], material->m_specular[3]);
+		mat->m_emissiveColor.set(material->m_emissive[0], material->m_emissive[1], material->m_emissive[2], material->m_emissive[3]);
+		mat->m_specularExponent = material->m_specularExponent;
+		mat->m_specularMultiplier = material->m_specularMultiplier;
+
+		static const hkxMaterial::TextureType textureTypes[] =
+		{
+			hkxMaterial::TEX_DIFFUSE, hkxMaterial::TEX_SPECULAR, hkxMaterial::TEX_EMISSIVE, hkxMaterial::TEX_BUMP,
+			hkxMaterial::TEX_DISPLACEMENT, hkxMaterial::TEX_NORMAL, hkxMaterial::TEX_REFLECTION, hkxMaterial::TEX_OPACITY
+		};
+
+		for (size_t textureIndex = 0; textureIndex < material->m_textures.size(); ++textureIndex)
+		{
+			const SceneTexture& texture = material->m_textures[textureIndex];
+
+			// Fall back to the 0th UV set in case it can't be found
+			const int maxNumUVs = (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE_MAX - (int) hkxMaterial::PROPERTY_MTL_UV_ID_STAGE0;
+			int uvSetIndex = (int)(std::find(sceneMesh.m_uvSetNames.begin(), sceneMesh.m_uvSetNames.end(), texture.m_uvSetName) - sceneMesh.m_uvSetNames.begin());
+			if (uvSetIndex >= (int)sceneMesh.m_uvSetNames.size() || uvSetIndex >= maxNumUVs)
+			{
+				uvSetIndex = 0;
+			}
+
+			hkxMaterial::TextureStage& stage = mat->m_stages.expandOne();
+			if (texture.m_data)
+			{
+				// Embedded images are stored in the scene
+				hkxTextureInplace* textureInplace = new hkxTextureInplace;
+				textureInplace->m_name = texture.m_name.c_str();
+				textureInplace->m_originalFilename = texture.m_fileName.c_str();
+				hkString::strNcpy(textureInplace->m_fileType, texture.m_fileType.c_str(), sizeof(textureInplace->m_fileType));
+				textureInplace->m_data.append(texture.m_data, (int)texture.m_dataSize);
+				scene->m_inplaceTextures.pushBack(textureInplace);
+
+				stage.m_texture = textureInplace;
+				textureInplace->removeReference();
+			}
+			else
+			{
+				hkxTextureFile* textureFile = new hkxTextureFile;
+				textureFile->m_name = texture.m_name.c_str();
+				textureFile->m_originalFilename = textureFile->m_filename = texture.m_fileName.c_str();
+				scene->m_externalTextures.pushBack(textureFile);
+
+				stage.m_texture = textureFile;
+				textureFile->removeReference();
+			}
+			stage.m_usageHint = textureTypes[texture.m_usage];
+			stage.m_tcoordChannel = uvSetIndex;
+		}
+
+		if (material->m_transparent)
+		{
+			mat->m_transparency = hkxMaterial::transp_alpha;
+		}
+	}
+
+	scene->m_materials.pushBack(mat);
+	return mat;
+}
+
 /*
  * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
  * 
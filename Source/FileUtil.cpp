@@ -0,0 +1,349 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool isSeparator(char c)
+{
+#ifdef _WIN32
+	return c == '/' || c == '\\';
+#else
+	return c == '/';
+#endif
+}
+
+static size_t findLastSeparator(const std::string& path)
+{
+	for (size_t index = path.size(); index > 0; index--)
+	{
+		if (isSeparator(path[index - 1]))
+		{
+			return index - 1;
+		}
+	}
+	return std::string::npos;
+}
+
+#ifdef _WIN32
+
+bool isDirectory(const char* path)
+{
+	const DWORD attributes = GetFileAttributesA(path);
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
+
+// Calls the function with the name of every entry of the folder except "." and "..", and whether it is a folder
+template<typename Function>
+static bool forEachEntry(const char* folder, Function function)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA(joinPath(folder, "*").c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return GetLastError() == ERROR_FILE_NOT_FOUND;
+	}
+	do
+	{
+		if (strcmp(findData.cFileName, ".") != 0 && strcmp(findData.cFileName, "..") != 0)
+		{
+			function(findData.cFileName, (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+		}
+	}
+	while (FindNextFileA(find, &findData));
+	FindClose(find);
+	return true;
+}
+
+static bool createDirectory(const char* path)
+{
+	return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+static bool removeEmptyDirectory(const char* path)
+{
+	return RemoveDirectoryA(path) != 0;
+}
+
+static bool removeFile(const char* path)
+{
+	return DeleteFileA(path) != 0;
+}
+
+static bool pathExists(const char* path)
+{
+	return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+bool renamePath(const char* from, const char* to)
+{
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool copyFile(const char* from, const char* to)
+{
+	return CopyFileA(from, to, FALSE) != 0;
+}
+
+std::string getTempDirectory()
+{
+	char path[MAX_PATH + 1];
+	const DWORD length = GetTempPathA(sizeof(path), path);
+	std::string folder = (length > 0 && length < sizeof(path)) ? std::string(path, length) : std::string(".");
+	while (folder.size() > 1 && isSeparator(folder[folder.size() - 1]))
+	{
+		folder.erase(folder.size() - 1);
+	}
+	return folder;
+}
+
+bool isAbsolutePath(const std::string& path)
+{
+	return (!path.empty() && isSeparator(path[0])) || (path.size() > 2 && path[1] == ':' && isSeparator(path[2]));
+}
+
+#else
+
+bool isDirectory(const char* path)
+{
+	struct stat info;
+	return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// Calls the function with the name of every entry of the folder except "." and "..", and whether it is a folder
+template<typename Function>
+static bool forEachEntry(const char* folder, Function function)
+{
+	DIR* directory = opendir(folder);
+	if (!directory)
+	{
+		return false;
+	}
+	while (const dirent* entry = readdir(directory))
+	{
+		if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+		{
+			// Symbolic links to folders are not followed, they are removed rather than their contents
+			struct stat info;
+			const bool folderEntry = lstat(joinPath(folder, entry->d_name).c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+			function(entry->d_name, folderEntry);
+		}
+	}
+	closedir(directory);
+	return true;
+}
+
+static bool createDirectory(const char* path)
+{
+	return mkdir(path, 0777) == 0 || errno == EEXIST;
+}
+
+static bool removeEmptyDirectory(const char* path)
+{
+	return rmdir(path) == 0;
+}
+
+static bool removeFile(const char* path)
+{
+	return unlink(path) == 0;
+}
+
+static bool pathExists(const char* path)
+{
+	struct stat info;
+	return lstat(path, &info) == 0;
+}
+
+bool renamePath(const char* from, const char* to)
+{
+	return rename(from, to) == 0;
+}
+
+bool copyFile(const char* from, const char* to)
+{
+	FILE* input = fopen(from, "rb");
+	if (!input)
+	{
+		return false;
+	}
+	FILE* output = fopen(to, "wb");
+	if (!output)
+	{
+		fclose(input);
+		return false;
+	}
+
+	char buffer[64 * 1024];
+	bool success = true;
+	size_t size;
+	while (success && (size = fread(buffer, 1, sizeof(buffer), input)) > 0)
+	{
+		success = fwrite(buffer, 1, size, output) == size;
+	}
+	success = success && !ferror(input);
+	fclose(input);
+	success = (fclose(output) == 0) && success;
+	return success;
+}
+
+std::string getTempDirectory()
+{
+	const char* folder = getenv("TMPDIR");
+	std::string path = (folder && folder[0]) ? folder : "/tmp";
+	while (path.size() > 1 && isSeparator(path[path.size() - 1]))
+	{
+		path.erase(path.size() - 1);
+	}
+	return path;
+}
+
+bool isAbsolutePath(const std::string& path)
+{
+	return !path.empty() && isSeparator(path[0]);
+}
+
+#endif
+
+struct FileNameCollector
+{
+	explicit FileNameCollector(std::vector<std::string>& names) : m_names(names) {}
+
+	void operator()(const char* name, bool folder)
+	{
+		if (!folder)
+		{
+			m_names.push_back(name);
+		}
+	}
+
+	std::vector<std::string>& m_names;
+};
+
+bool listFiles(const char* folder, std::vector<std::string>& namesOut)
+{
+	namesOut.clear();
+	if (!forEachEntry(folder, FileNameCollector(namesOut)))
+	{
+		return false;
+	}
+
+	// The order of the entries is unspecified
+	std::sort(namesOut.begin(), namesOut.end());
+	return true;
+}
+
+bool createDirectories(const char* path)
+{
+	const std::string folder(path);
+	if (folder.empty() || isDirectory(path))
+	{
+		return !folder.empty();
+	}
+
+	// The parents first, a drive or the root is never created
+	const size_t separator = findLastSeparator(folder);
+	if (separator != std::string::npos && separator > 0 && folder[separator - 1] != ':')
+	{
+		createDirectories(folder.substr(0, separator).c_str());
+	}
+	return createDirectory(path) && isDirectory(path);
+}
+
+struct EntryRemover
+{
+	explicit EntryRemover(const char* folder) : m_folder(folder) {}
+
+	void operator()(const char* name, bool /*folder*/)
+	{
+		removeAll(joinPath(m_folder, name).c_str());
+	}
+
+	const char* m_folder;
+};
+
+bool removeAll(const char* path)
+{
+	if (isDirectory(path))
+	{
+		forEachEntry(path, EntryRemover(path));
+		removeEmptyDirectory(path);
+	}
+	else
+	{
+		removeFile(path);
+	}
+	return !pathExists(path);
+}
+
+std::string joinPath(const std::string& folder, const std::string& name)
+{
+	if (folder.empty() || isSeparator(folder[folder.size() - 1]))
+	{
+		return folder + name;
+	}
+	return folder + "/" + name;
+}
+
+std::string getFileName(const std::string& path)
+{
+	const size_t separator = findLastSeparator(path);
+	return (separator == std::string::npos) ? path : path.substr(separator + 1);
+}
+
+std::string getParentPath(const std::string& path)
+{
+	const size_t separator = findLastSeparator(path);
+	if (separator == std::string::npos)
+	{
+		return std::string();
+	}
+	// The root keeps its separator
+	return path.substr(0, (separator == 0) ? 1 : separator);
+}
+
+std::string getStem(const std::string& path)
+{
+	const std::string name = getFileName(path);
+	const size_t dot = name.rfind('.');
+	return (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+}
+
+std::string getExtension(const std::string& path)
+{
+	const std::string name = getFileName(path);
+	const size_t dot = name.rfind('.');
+	return (dot == std::string::npos || dot == 0) ? std::string() : name.substr(dot);
+}
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
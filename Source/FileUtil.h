@@ -0,0 +1,65 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_FILEUTIL
+#define HK_FBXTOHKX_FILEUTIL
+
+#include <string>
+#include <vector>
+
+// File system helpers on the Win32 and POSIX file APIs, for the folders of caches, batches and sidecars. Paths are
+// built with '/', on Windows '\' is accepted as a separator too.
+
+bool isDirectory(const char* path);
+
+// Names (not paths) of the regular files in a folder, sorted. Returns false if the folder cannot be read.
+bool listFiles(const char* folder, std::vector<std::string>& namesOut);
+
+// Creates a folder and its missing parents. Returns true if the folder exists afterwards.
+bool createDirectories(const char* path);
+
+// Deletes a file, or a folder with everything in it. Returns true if nothing is left.
+bool removeAll(const char* path);
+
+// Renames a file or folder. A file replaces an existing file, a folder fails if the target exists.
+bool renamePath(const char* from, const char* to);
+
+// Copies a file, replacing an existing one
+bool copyFile(const char* from, const char* to);
+
+// The folder for temporary files, without a trailing separator
+std::string getTempDirectory();
+
+// folder/name, folder may be empty
+std::string joinPath(const std::string& folder, const std::string& name);
+// The part after the last separator, e.g. "a.fbx" for "in/a.fbx"
+std::string getFileName(const std::string& path);
+// The part before the last separator, e.g. "in" for "in/a.fbx" and "in/b" for "in/b/"
+std::string getParentPath(const std::string& path);
+// The file name without its extension, e.g. "a" for "in/a.fbx"
+std::string getStem(const std::string& path);
+// The extension of the file name including the dot, e.g. ".fbx", empty if it has none
+std::string getExtension(const std::string& path);
+bool isAbsolutePath(const std::string& path);
+
+#endif
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,964 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "GltfSceneSource.h"
+
+#ifdef FBXTOHKX_WITH_CGLTF
+
+#define CGLTF_IMPLEMENTATION
+#include <cgltf.h>
+
+#include "ScenePipeline.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	long long getChannelKey(int node, int stack)
+	{
+		return ((long long)stack << 32) | (unsigned int)node;
+	}
+
+	const char* describeResult(cgltf_result result)
+	{
+		switch (result)
+		{
+		case cgltf_result_data_too_short: return "the file is truncated";
+		case cgltf_result_unknown_format: return "not a glTF or GLB file";
+		case cgltf_result_invalid_json: return "invalid JSON";
+		case cgltf_result_invalid_gltf: return "invalid glTF";
+		case cgltf_result_invalid_options: return "invalid options";
+		case cgltf_result_file_not_found: return "file not found";
+		case cgltf_result_io_error: return "I/O error";
+		case cgltf_result_out_of_memory: return "out of memory";
+		case cgltf_result_legacy_gltf: return "glTF 1.0 is not supported";
+		default: return "unknown error";
+		}
+	}
+
+	const cgltf_accessor* findAttribute(const cgltf_primitive& primitive, cgltf_attribute_type type, int index)
+	{
+		for (cgltf_size attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++)
+		{
+			const cgltf_attribute& attribute = primitive.attributes[attributeIndex];
+			if (attribute.type == type && attribute.index == index)
+			{
+				return attribute.data;
+			}
+		}
+		return NULL;
+	}
+
+	bool isTriangleList(const cgltf_primitive& primitive)
+	{
+		return primitive.type == cgltf_primitive_type_triangles && findAttribute(primitive, cgltf_attribute_type_position, 0) != NULL;
+	}
+
+	double getDeterminant(const double* matrix)
+	{
+		return matrix[0] * (matrix[5] * matrix[10] - matrix[9] * matrix[6]) -
+			matrix[4] * (matrix[1] * matrix[10] - matrix[9] * matrix[2]) +
+			matrix[8] * (matrix[1] * matrix[6] - matrix[5] * matrix[2]);
+	}
+
+	// Inverse of a matrix whose last row is 0, 0, 0, 1
+	void invertAffine(const float* matrix, double* inverseOut)
+	{
+		double m[16];
+		std::copy(matrix, matrix + 16, m);
+
+		const double determinant = getDeterminant(m);
+		const double scale = (determinant != 0.0) ? 1.0 / determinant : 0.0;
+
+		inverseOut[0] = (m[5] * m[10] - m[9] * m[6]) * scale;
+		inverseOut[1] = (m[9] * m[2] - m[1] * m[10]) * scale;
+		inverseOut[2] = (m[1] * m[6] - m[5] * m[2]) * scale;
+		inverseOut[4] = (m[8] * m[6] - m[4] * m[10]) * scale;
+		inverseOut[5] = (m[0] * m[10] - m[8] * m[2]) * scale;
+		inverseOut[6] = (m[4] * m[2] - m[0] * m[6]) * scale;
+		inverseOut[8] = (m[4] * m[9] - m[8] * m[5]) * scale;
+		inverseOut[9] = (m[8] * m[1] - m[0] * m[9]) * scale;
+		inverseOut[10] = (m[0] * m[5] - m[4] * m[1]) * scale;
+		inverseOut[3] = inverseOut[7] = inverseOut[11] = 0.0;
+
+		for (int row = 0; row < 3; row++)
+		{
+			inverseOut[12 + row] = -(inverseOut[row] * m[12] + inverseOut[4 + row] * m[13] + inverseOut[8 + row] * m[14]);
+		}
+		inverseOut[15] = 1.0;
+	}
+
+	// Translation * rotation (quaternion x, y, z, w) * scale
+	void composeTransform(const float* translation, const float* rotation, const float* scale, double* matrixOut)
+	{
+		const double x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+
+		const double rotationMatrix[9] =
+		{
+			1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+			2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+			2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)
+		};
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				matrixOut[column * 4 + row] = rotationMatrix[column * 3 + row] * scale[column];
+			}
+			matrixOut[column * 4 + 3] = 0.0;
+			matrixOut[12 + column] = translation[column];
+		}
+		matrixOut[15] = 1.0;
+	}
+
+	void slerp(const float* a, const float* b, float t, float* resultOut)
+	{
+		float cosAngle = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		const float sign = (cosAngle < 0.f) ? -1.f : 1.f;
+		cosAngle *= sign;
+
+		float weightA = 1.f - t;
+		float weightB = t;
+		if (cosAngle < 0.9995f)
+		{
+			const float angle = acosf(cosAngle);
+			const float sinAngle = sinf(angle);
+			weightA = sinf((1.f - t) * angle) / sinAngle;
+			weightB = sinf(t * angle) / sinAngle;
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			resultOut[i] = weightA * a[i] + sign * weightB * b[i];
+		}
+	}
+
+	// A value of a key, cubic spline samplers store an in tangent, the value and an out tangent per key
+	enum KeyPart { IN_TANGENT, VALUE, OUT_TANGENT };
+
+	void readKey(const cgltf_animation_sampler* sampler, cgltf_size key, KeyPart part, int numComponents, float* valueOut)
+	{
+		const bool cubic = (sampler->interpolation == cgltf_interpolation_type_cubic_spline);
+		cgltf_accessor_read_float(sampler->output, cubic ? key * 3 + part : key, valueOut, numComponents);
+	}
+
+	float readKeyTime(const cgltf_animation_sampler* sampler, cgltf_size key)
+	{
+		float time = 0.f;
+		cgltf_accessor_read_float(sampler->input, key, &time, 1);
+		return time;
+	}
+
+	// Interpolates the sampler at the time, values before the first and after the last key are held
+	void sampleChannel(const cgltf_animation_sampler* sampler, int numComponents, bool rotation, float time, float* valueOut)
+	{
+		const cgltf_size numKeys = sampler->input->count;
+		if (numKeys == 0)
+		{
+			return;
+		}
+		if (numKeys == 1 || time <= readKeyTime(sampler, 0))
+		{
+			readKey(sampler, 0, VALUE, numComponents, valueOut);
+			return;
+		}
+		if (time >= readKeyTime(sampler, numKeys - 1))
+		{
+			readKey(sampler, numKeys - 1, VALUE, numComponents, valueOut);
+			return;
+		}
+
+		// The last key at or before the time
+		cgltf_size first = 0;
+		cgltf_size last = numKeys - 1;
+		while (last - first > 1)
+		{
+			const cgltf_size middle = (first + last) / 2;
+			if (readKeyTime(sampler, middle) <= time)
+			{
+				first = middle;
+			}
+			else
+			{
+				last = middle;
+			}
+		}
+
+		const float startTime = readKeyTime(sampler, first);
+		const float duration = readKeyTime(sampler, last) - startTime;
+		const float t = (duration > 0.f) ? (time - startTime) / duration : 0.f;
+
+		float a[4];
+		float b[4];
+		readKey(sampler, first, VALUE, numComponents, a);
+		switch (sampler->interpolation)
+		{
+		case cgltf_interpolation_type_step:
+			std::copy(a, a + numComponents, valueOut);
+			return;
+
+		case cgltf_interpolation_type_cubic_spline:
+			{
+				float outTangent[4];
+				float inTangent[4];
+				readKey(sampler, first, OUT_TANGENT, numComponents, outTangent);
+				readKey(sampler, last, VALUE, numComponents, b);
+				readKey(sampler, last, IN_TANGENT, numComponents, inTangent);
+
+				const float t2 = t * t;
+				const float t3 = t2 * t;
+				for (int i = 0; i < numComponents; i++)
+				{
+					valueOut[i] = (2 * t3 - 3 * t2 + 1) * a[i] + (t3 - 2 * t2 + t) * duration * outTangent[i] +
+						(-2 * t3 + 3 * t2) * b[i] + (t3 - t2) * duration * inTangent[i];
+				}
+				break;
+			}
+
+		default:
+			readKey(sampler, last, VALUE, numComponents, b);
+			if (rotation)
+			{
+				slerp(a, b, t, valueOut);
+			}
+			else
+			{
+				for (int i = 0; i < numComponents; i++)
+				{
+					valueOut[i] = a[i] + (b[i] - a[i]) * t;
+				}
+			}
+			break;
+		}
+
+		if (rotation)
+		{
+			const float length = sqrtf(valueOut[0] * valueOut[0] + valueOut[1] * valueOut[1] + valueOut[2] * valueOut[2] + valueOut[3] * valueOut[3]);
+			for (int i = 0; length > 0.f && i < 4; i++)
+			{
+				valueOut[i] /= length;
+			}
+		}
+	}
+
+	SceneSource::Stack getAnimationStack(const cgltf_animation& animation, int stack)
+	{
+		SceneSource::Stack stackOut;
+		if (animation.name && animation.name[0])
+		{
+			stackOut.m_name = animation.name;
+		}
+		else
+		{
+			char name[32];
+			sprintf(name, "animation%d", stack);
+			stackOut.m_name = name;
+		}
+
+		// The range of the key times of all samplers
+		double start = 0.0;
+		double stop = 0.0;
+		bool hasKeys = false;
+		for (cgltf_size samplerIndex = 0; samplerIndex < animation.samplers_count; samplerIndex++)
+		{
+			const cgltf_animation_sampler& sampler = animation.samplers[samplerIndex];
+			const cgltf_size numKeys = sampler.input->count;
+			if (numKeys == 0)
+			{
+				continue;
+			}
+			const double first = readKeyTime(&sampler, 0);
+			const double last = readKeyTime(&sampler, numKeys - 1);
+			start = hasKeys ? std::min(start, first) : first;
+			stop = hasKeys ? std::max(stop, last) : last;
+			hasKeys = true;
+		}
+
+		stackOut.m_start = start;
+		stackOut.m_stop = stop;
+		const double frames = (stop - start) * GltfSceneSource::FRAMES_PER_SECOND;
+		stackOut.m_numFrames = (frames > 0.0) ? (int)ceil(frames - 1e-6) : 0;
+		return stackOut;
+	}
+
+	std::string getFileType(const cgltf_image* image)
+	{
+		const char* mimeType = image->mime_type ? image->mime_type : "";
+		if (strcmp(mimeType, "image/jpeg") == 0)
+		{
+			return "JPG";
+		}
+		if (strcmp(mimeType, "image/png") == 0)
+		{
+			return "PNG";
+		}
+
+		std::string fileType;
+		const char* extension = image->uri ? strrchr(image->uri, '.') : NULL;
+		for (const char* c = extension ? extension + 1 : ""; *c && fileType.size() < 3; c++)
+		{
+			fileType += (char)toupper((unsigned char)*c);
+		}
+		return fileType;
+	}
+
+	std::string decodeUri(const char* uri)
+	{
+		std::vector<char> decoded(uri, uri + strlen(uri) + 1);
+		cgltf_decode_uri(&decoded[0]);
+		return &decoded[0];
+	}
+}
+
+GltfSceneSource::GltfSceneSource() :
+	m_data(NULL)
+{
+}
+
+GltfSceneSource::~GltfSceneSource()
+{
+	// The buffers are released with the data, before they are unmapped
+	if (m_data)
+	{
+		cgltf_free(m_data);
+	}
+	for (size_t fileIndex = 0; fileIndex < m_bufferFiles.size(); fileIndex++)
+	{
+		delete m_bufferFiles[fileIndex];
+	}
+}
+
+SceneSource* GltfSceneSource::load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData, size_t fileSize)
+{
+	GltfSceneSource* source = new GltfSceneSource();
+
+	if (fileData == NULL)
+	{
+		if (!source->m_file.open(filename, MappedFile::ACCESS_RANDOM))
+		{
+			errorOut = "cannot open the file";
+			delete source;
+			return NULL;
+		}
+		fileData = source->m_file.getData();
+		fileSize = source->m_file.getSize();
+	}
+
+	const char* separator = std::max(strrchr(filename, '/'), strrchr(filename, '\\'));
+	source->m_directory.assign(filename, separator ? separator + 1 - filename : 0);
+
+	// A GLB keeps its binary chunk in the mapping, the JSON is parsed in place
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+	cgltf_result result = cgltf_parse(&options, fileData, fileSize, &source->m_data);
+	if (result == cgltf_result_success && !source->loadBuffers(errorOut))
+	{
+		delete source;
+		return NULL;
+	}
+	if (result == cgltf_result_success)
+	{
+		result = cgltf_validate(source->m_data);
+	}
+	if (result != cgltf_result_success)
+	{
+		errorOut = describeResult(result);
+		delete source;
+		return NULL;
+	}
+
+	const cgltf_data* data = source->m_data;
+	source->m_nodeIndices.resize(data->nodes_count, -1);
+
+	source->m_nodes.push_back(NULL);
+	source->m_names.push_back("RootNode");
+	source->m_parents.push_back(-1);
+	source->m_children.push_back(std::vector<int>());
+	source->m_joints.push_back(false);
+
+	const cgltf_scene* scene = data->scene ? data->scene : (data->scenes_count > 0 ? &data->scenes[0] : NULL);
+	if (scene)
+	{
+		for (cgltf_size nodeIndex = 0; nodeIndex < scene->nodes_count; nodeIndex++)
+		{
+			source->addNodesRecursive(scene->nodes[nodeIndex], 0);
+		}
+	}
+	else
+	{
+		// Without scenes every node without a parent is a top level node
+		for (cgltf_size nodeIndex = 0; nodeIndex < data->nodes_count; nodeIndex++)
+		{
+			if (data->nodes[nodeIndex].parent == NULL)
+			{
+				source->addNodesRecursive(&data->nodes[nodeIndex], 0);
+			}
+		}
+	}
+
+	for (cgltf_size skinIndex = 0; skinIndex < data->skins_count; skinIndex++)
+	{
+		const cgltf_skin& skin = data->skins[skinIndex];
+		for (cgltf_size jointIndex = 0; jointIndex < skin.joints_count; jointIndex++)
+		{
+			const int node = source->getNodeIndex(skin.joints[jointIndex]);
+			if (node > 0)
+			{
+				source->m_joints[node] = true;
+			}
+		}
+	}
+
+	for (cgltf_size animationIndex = 0; animationIndex < data->animations_count; animationIndex++)
+	{
+		const cgltf_animation& animation = data->animations[animationIndex];
+		for (cgltf_size channelIndex = 0; channelIndex < animation.channels_count; channelIndex++)
+		{
+			const cgltf_animation_channel& channel = animation.channels[channelIndex];
+			const int node = source->getNodeIndex(channel.target_node);
+			if (node > 0 && channel.target_path != cgltf_animation_path_type_weights)
+			{
+				source->m_channels[getChannelKey(node, (int)animationIndex)].push_back(&channel);
+			}
+		}
+
+		source->m_stacks.push_back(getAnimationStack(animation, (int)animationIndex));
+	}
+
+	applicationOut = data->asset.generator ? data->asset.generator : "";
+	return source;
+}
+
+bool GltfSceneSource::loadBuffers(std::string& errorOut)
+{
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+
+	for (cgltf_size bufferIndex = 0; bufferIndex < m_data->buffers_count; bufferIndex++)
+	{
+		cgltf_buffer& buffer = m_data->buffers[bufferIndex];
+		if (buffer.data)
+		{
+			continue;
+		}
+
+		if (buffer.uri == NULL)
+		{
+			// The binary chunk of a GLB
+			if (bufferIndex == 0 && m_data->bin && m_data->bin_size >= buffer.size)
+			{
+				buffer.data = const_cast<void*>(m_data->bin);
+				buffer.data_free_method = cgltf_data_free_method_none;
+				continue;
+			}
+			errorOut = "a buffer has no data";
+			return false;
+		}
+
+		if (strncmp(buffer.uri, "data:", 5) == 0)
+		{
+			const char* base64 = strstr(buffer.uri, ";base64,");
+			if (!base64 || cgltf_load_buffer_base64(&options, buffer.size, base64 + 8, &buffer.data) != cgltf_result_success)
+			{
+				errorOut = "cannot decode a data URI buffer";
+				return false;
+			}
+			buffer.data_free_method = cgltf_data_free_method_memory_free;
+			continue;
+		}
+
+		if (strstr(buffer.uri, "://"))
+		{
+			errorOut = std::string("remote buffers are not supported: ") + buffer.uri;
+			return false;
+		}
+
+		const std::string path = m_directory + decodeUri(buffer.uri);
+		MappedFile* file = new MappedFile();
+		m_bufferFiles.push_back(file);
+		if (!file->open(path.c_str(), MappedFile::ACCESS_RANDOM) || file->getSize() < buffer.size)
+		{
+			errorOut = "cannot read the buffer " + path;
+			return false;
+		}
+		buffer.data = const_cast<unsigned char*>(file->getData());
+		buffer.data_free_method = cgltf_data_free_method_none;
+	}
+	return true;
+}
+
+void GltfSceneSource::addNodesRecursive(const cgltf_node* node, int parent)
+{
+	const int nodeIndex = (int)m_nodes.size();
+	m_nodeIndices[node - m_data->nodes] = nodeIndex;
+
+	m_nodes.push_back(node);
+	if (node->name && node->name[0])
+	{
+		m_names.push_back(node->name);
+	}
+	else
+	{
+		char name[32];
+		sprintf(name, "node%d", (int)(node - m_data->nodes));
+		m_names.push_back(name);
+	}
+	m_parents.push_back(parent);
+	m_children.push_back(std::vector<int>());
+	m_joints.push_back(false);
+	m_children[parent].push_back(nodeIndex);
+
+	for (cgltf_size childIndex = 0; childIndex < node->children_count; childIndex++)
+	{
+		addNodesRecursive(node->children[childIndex], nodeIndex);
+	}
+}
+
+int GltfSceneSource::getNodeIndex(const cgltf_node* node) const
+{
+	return node ? m_nodeIndices[node - m_data->nodes] : -1;
+}
+
+const std::vector<const cgltf_animation_channel*>* GltfSceneSource::getChannels(int node, int stack) const
+{
+	std::map<long long, std::vector<const cgltf_animation_channel*> >::const_iterator it = m_channels.find(getChannelKey(node, stack));
+	return (it != m_channels.end()) ? &it->second : NULL;
+}
+
+int GltfSceneSource::getNumNodes() const
+{
+	return (int)m_nodes.size();
+}
+
+int GltfSceneSource::getParent(int node) const
+{
+	return m_parents[node];
+}
+
+int GltfSceneSource::getNumChildren(int node) const
+{
+	return (int)m_children[node].size();
+}
+
+int GltfSceneSource::getChild(int node, int childIndex) const
+{
+	return m_children[node][childIndex];
+}
+
+const char* GltfSceneSource::getNodeName(int node) const
+{
+	return m_names[node].c_str();
+}
+
+void GltfSceneSource::getCoordinateSystem(CoordinateSystem& systemOut) const
+{
+	// glTF is Y up with the front facing +Z, in meters
+	systemOut.m_right = AXIS_POSITIVE_X;
+	systemOut.m_up = AXIS_POSITIVE_Y;
+	systemOut.m_front = AXIS_POSITIVE_Z;
+	systemOut.m_unitMeters = 1.0;
+}
+
+SceneSource::NodeType GltfSceneSource::getNodeType(int node) const
+{
+	const cgltf_node* gltfNode = m_nodes[node];
+	if (gltfNode == NULL)
+	{
+		return NODE_NULL;
+	}
+	if (gltfNode->mesh)
+	{
+		return NODE_MESH;
+	}
+	if (m_joints[node])
+	{
+		return NODE_SKELETON;
+	}
+	if (gltfNode->camera)
+	{
+		return NODE_CAMERA;
+	}
+	if (gltfNode->light)
+	{
+		return NODE_LIGHT;
+	}
+	return NODE_NULL;
+}
+
+bool GltfSceneSource::getMesh(int node, SceneMesh& meshOut) const
+{
+	const cgltf_node* gltfNode = m_nodes[node];
+	const cgltf_mesh* mesh = gltfNode ? gltfNode->mesh : NULL;
+	if (mesh == NULL)
+	{
+		return false;
+	}
+
+	meshOut = SceneMesh();
+
+	double meshTransform[16];
+	evaluateGlobalTransform(*this, node, -1, 0, meshTransform);
+	meshOut.m_flipped = (getDeterminant(meshTransform) < 0.0);
+
+	// The layers of any primitive, primitives without them get the defaults
+	bool hasNormals = false;
+	bool hasColors = false;
+	int numUvSets = 0;
+	for (cgltf_size primitiveIndex = 0; primitiveIndex < mesh->primitives_count; primitiveIndex++)
+	{
+		const cgltf_primitive& primitive = mesh->primitives[primitiveIndex];
+		if (!isTriangleList(primitive))
+		{
+			continue;
+		}
+		hasNormals = hasNormals || findAttribute(primitive, cgltf_attribute_type_normal, 0);
+		hasColors = hasColors || findAttribute(primitive, cgltf_attribute_type_color, 0);
+		for (cgltf_size attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++)
+		{
+			if (primitive.attributes[attributeIndex].type == cgltf_attribute_type_texcoord)
+			{
+				numUvSets = std::max(numUvSets, primitive.attributes[attributeIndex].index + 1);
+			}
+		}
+	}
+
+	meshOut.m_uvSetNames.resize(numUvSets);
+	meshOut.m_uvSets.resize(numUvSets);
+	for (int uvSetIndex = 0; uvSetIndex < numUvSets; uvSetIndex++)
+	{
+		char uvSetName[32];
+		sprintf(uvSetName, "TEXCOORD_%d", uvSetIndex);
+		meshOut.m_uvSetNames[uvSetIndex] = uvSetName;
+	}
+
+	const cgltf_skin* skin = gltfNode->skin;
+	std::vector<const cgltf_material*> materials;
+
+	for (cgltf_size primitiveIndex = 0; primitiveIndex < mesh->primitives_count; primitiveIndex++)
+	{
+		const cgltf_primitive& primitive = mesh->primitives[primitiveIndex];
+		if (!isTriangleList(primitive))
+		{
+			continue;
+		}
+
+		// The vertices of the primitive are its control points
+		const cgltf_accessor* positions = findAttribute(primitive, cgltf_attribute_type_position, 0);
+		const int firstControlPoint = meshOut.getNumControlPoints();
+		const int numVertices = (int)positions->count;
+		meshOut.m_positions.resize((firstControlPoint + numVertices) * 3);
+		for (int vertex = 0; vertex < numVertices; vertex++)
+		{
+			cgltf_accessor_read_float(positions, vertex, &meshOut.m_positions[(firstControlPoint + vertex) * 3], 3);
+		}
+
+		if (skin)
+		{
+			const cgltf_accessor* joints = findAttribute(primitive, cgltf_attribute_type_joints, 0);
+			const cgltf_accessor* weights = findAttribute(primitive, cgltf_attribute_type_weights, 0);
+
+			meshOut.m_skinClusters.resize((firstControlPoint + numVertices) * 4, 0);
+			meshOut.m_skinWeights.resize((firstControlPoint + numVertices) * 4, 0.f);
+			for (int vertex = 0; joints && weights && vertex < numVertices; vertex++)
+			{
+				cgltf_uint vertexJoints[4] = { 0, 0, 0, 0 };
+				cgltf_accessor_read_uint(joints, vertex, vertexJoints, 4);
+				cgltf_accessor_read_float(weights, vertex, &meshOut.m_skinWeights[(firstControlPoint + vertex) * 4], 4);
+				for (int i = 0; i < 4; i++)
+				{
+					meshOut.m_skinClusters[(firstControlPoint + vertex) * 4 + i] = (int)vertexJoints[i];
+				}
+			}
+		}
+
+		// Per corner layers
+		const cgltf_accessor* indices = primitive.indices;
+		const int numCorners = (int)((indices ? indices->count : positions->count) / 3 * 3);
+		const int firstCorner = (int)meshOut.m_triangles.size();
+		meshOut.m_triangles.resize(firstCorner + numCorners);
+
+		const cgltf_accessor* normals = findAttribute(primitive, cgltf_attribute_type_normal, 0);
+		const cgltf_accessor* colors = findAttribute(primitive, cgltf_attribute_type_color, 0);
+		if (hasNormals)
+		{
+			meshOut.m_normals.resize((firstCorner + numCorners) * 3, 0.f);
+		}
+		if (hasColors)
+		{
+			meshOut.m_colors.resize((firstCorner + numCorners) * 4, 1.f);
+		}
+		for (int uvSetIndex = 0; uvSetIndex < numUvSets; uvSetIndex++)
+		{
+			meshOut.m_uvSets[uvSetIndex].resize((firstCorner + numCorners) * 2, 0.f);
+		}
+
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			const cgltf_size vertex = indices ? cgltf_accessor_read_index(indices, corner) : (cgltf_size)corner;
+			const int meshCorner = firstCorner + corner;
+			meshOut.m_triangles[meshCorner] = firstControlPoint + (int)vertex;
+
+			if (normals)
+			{
+				cgltf_accessor_read_float(normals, vertex, &meshOut.m_normals[meshCorner * 3], 3);
+			}
+			if (colors)
+			{
+				// RGB colors keep the alpha of 1
+				cgltf_accessor_read_float(colors, vertex, &meshOut.m_colors[meshCorner * 4], 4);
+			}
+			for (int uvSetIndex = 0; uvSetIndex < numUvSets; uvSetIndex++)
+			{
+				const cgltf_accessor* uvs = findAttribute(primitive, cgltf_attribute_type_texcoord, uvSetIndex);
+				if (uvs)
+				{
+					float* uv = &meshOut.m_uvSets[uvSetIndex][meshCorner * 2];
+					cgltf_accessor_read_float(uvs, vertex, uv, 2);
+					// glTF UVs start at the top of the image
+					uv[1] = 1.f - uv[1];
+				}
+			}
+		}
+
+		const int material = (int)(std::find(materials.begin(), materials.end(), primitive.material) - materials.begin());
+		if (material == (int)materials.size())
+		{
+			materials.push_back(primitive.material);
+		}
+		meshOut.m_triangleMaterials.insert(meshOut.m_triangleMaterials.end(), numCorners / 3, material);
+	}
+
+	if (skin)
+	{
+		// Bind poses as the transforms of the joints in the space of the mesh, placed where the mesh is
+		const int numClusters = (int)skin->joints_count;
+		meshOut.m_clusterNodes.resize(numClusters);
+		meshOut.m_clusterBindPoses.resize(numClusters * 16);
+		for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+		{
+			meshOut.m_clusterNodes[clusterIndex] = getNodeIndex(skin->joints[clusterIndex]);
+
+			float inverseBindMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+			if (skin->inverse_bind_matrices)
+			{
+				cgltf_accessor_read_float(skin->inverse_bind_matrices, clusterIndex, inverseBindMatrix, 16);
+			}
+			double bindMatrix[16];
+			invertAffine(inverseBindMatrix, bindMatrix);
+			multiplyMatrices(meshTransform, bindMatrix, &meshOut.m_clusterBindPoses[clusterIndex * 16]);
+		}
+	}
+
+	for (size_t materialIndex = 0; materialIndex < materials.size(); materialIndex++)
+	{
+		meshOut.m_materials.push_back(SceneMaterial());
+		SceneMaterial& materialOut = meshOut.m_materials.back();
+
+		// The primitives without a material share the default material, numbered after the materials of the file
+		const cgltf_material* material = materials[materialIndex];
+		materialOut.m_id = material ? (long long)(material - m_data->materials) : (long long)m_data->materials_count;
+		if (material == NULL)
+		{
+			materialOut.m_name = "Default";
+			continue;
+		}
+
+		// Material names must be unique in the conversion
+		if (material->name && material->name[0])
+		{
+			materialOut.m_name = material->name;
+		}
+		else
+		{
+			char name[32];
+			sprintf(name, "material%d", (int)(material - m_data->materials));
+			materialOut.m_name = name;
+		}
+
+		const cgltf_texture_view* textureViews[3] = { NULL, &material->normal_texture, &material->emissive_texture };
+		if (material->has_pbr_metallic_roughness)
+		{
+			std::copy(material->pbr_metallic_roughness.base_color_factor, material->pbr_metallic_roughness.base_color_factor + 4, materialOut.m_diffuse);
+			textureViews[0] = &material->pbr_metallic_roughness.base_color_texture;
+		}
+		else if (material->has_pbr_specular_glossiness)
+		{
+			std::copy(material->pbr_specular_glossiness.diffuse_factor, material->pbr_specular_glossiness.diffuse_factor + 4, materialOut.m_diffuse);
+			std::copy(material->pbr_specular_glossiness.specular_factor, material->pbr_specular_glossiness.specular_factor + 3, materialOut.m_specular);
+			materialOut.m_specularMultiplier = material->pbr_specular_glossiness.glossiness_factor;
+			textureViews[0] = &material->pbr_specular_glossiness.diffuse_texture;
+		}
+		std::copy(material->emissive_factor, material->emissive_factor + 3, materialOut.m_emissive);
+		materialOut.m_transparent = (material->alpha_mode == cgltf_alpha_mode_blend);
+
+		static const SceneTexture::Usage usages[3] = { SceneTexture::DIFFUSE, SceneTexture::NORMAL, SceneTexture::EMISSIVE };
+		for (int textureIndex = 0; textureIndex < 3; textureIndex++)
+		{
+			const cgltf_texture* texture = textureViews[textureIndex] ? textureViews[textureIndex]->texture : NULL;
+			const cgltf_image* image = texture ? texture->image : NULL;
+			if (image == NULL || (image->uri && strncmp(image->uri, "data:", 5) == 0))
+			{
+				continue;
+			}
+
+			SceneTexture sceneTexture;
+			sceneTexture.m_usage = usages[textureIndex];
+			sceneTexture.m_name = image->name ? image->name : (texture->name ? texture->name : "");
+			sceneTexture.m_uvSetName = meshOut.m_uvSetNames.empty() ? "" : meshOut.m_uvSetNames[std::min(textureViews[textureIndex]->texcoord, numUvSets - 1)];
+			if (image->uri)
+			{
+				sceneTexture.m_fileName = m_directory + decodeUri(image->uri);
+			}
+			else if (image->buffer_view && image->buffer_view->buffer->data)
+			{
+				// Embedded in the binary chunk, used in place
+				sceneTexture.m_fileName = sceneTexture.m_name;
+				sceneTexture.m_data = static_cast<const unsigned char*>(image->buffer_view->buffer->data) + image->buffer_view->offset;
+				sceneTexture.m_dataSize = image->buffer_view->size;
+				sceneTexture.m_fileType = getFileType(image);
+			}
+			else
+			{
+				continue;
+			}
+			materialOut.m_textures.push_back(sceneTexture);
+		}
+	}
+
+	return true;
+}
+
+int GltfSceneSource::getNumStacks() const
+{
+	return (int)m_data->animations_count;
+}
+
+void GltfSceneSource::getStack(int stack, Stack& stackOut) const
+{
+	stackOut = m_stacks[stack];
+}
+
+bool GltfSceneSource::getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const
+{
+	const cgltf_animation_path_type path = (channel <= TRANSLATION_Z) ? cgltf_animation_path_type_translation :
+		(channel >= SCALING_X) ? cgltf_animation_path_type_scale : cgltf_animation_path_type_rotation;
+	const std::vector<const cgltf_animation_channel*>* channels = getChannels(node, stack);
+	if (channels == NULL || path == cgltf_animation_path_type_rotation)
+	{
+		return false;
+	}
+
+	for (size_t channelIndex = 0; channelIndex < channels->size(); channelIndex++)
+	{
+		const cgltf_animation_channel* gltfChannel = (*channels)[channelIndex];
+		if (gltfChannel->target_path != path)
+		{
+			continue;
+		}
+
+		const cgltf_animation_sampler* sampler = gltfChannel->sampler;
+		const cgltf_size numKeys = sampler->input->count;
+		curveOut.m_times.resize(numKeys);
+		curveOut.m_values.resize(numKeys);
+		for (cgltf_size keyIndex = 0; keyIndex < numKeys; keyIndex++)
+		{
+			float value[3];
+			readKey(sampler, keyIndex, VALUE, 3, value);
+			curveOut.m_times[keyIndex] = readKeyTime(sampler, keyIndex);
+			curveOut.m_values[keyIndex] = value[channel % 3];
+		}
+		return true;
+	}
+	return false;
+}
+
+void GltfSceneSource::evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const
+{
+	const cgltf_node* gltfNode = m_nodes[node];
+	if (gltfNode == NULL)
+	{
+		std::fill(matrixOut, matrixOut + 16, 0.0);
+		matrixOut[0] = matrixOut[5] = matrixOut[10] = matrixOut[15] = 1.0;
+		return;
+	}
+
+	const std::vector<const cgltf_animation_channel*>* channels = (stack >= 0) ? getChannels(node, stack) : NULL;
+	if (gltfNode->has_matrix && channels == NULL)
+	{
+		std::copy(gltfNode->matrix, gltfNode->matrix + 16, matrixOut);
+	}
+	else
+	{
+		float translation[3] = { 0.f, 0.f, 0.f };
+		float rotation[4] = { 0.f, 0.f, 0.f, 1.f };
+		float scale[3] = { 1.f, 1.f, 1.f };
+		if (gltfNode->has_translation)
+		{
+			std::copy(gltfNode->translation, gltfNode->translation + 3, translation);
+		}
+		if (gltfNode->has_rotation)
+		{
+			std::copy(gltfNode->rotation, gltfNode->rotation + 4, rotation);
+		}
+		if (gltfNode->has_scale)
+		{
+			std::copy(gltfNode->scale, gltfNode->scale + 3, scale);
+		}
+
+		if (channels)
+		{
+			const float time = (float)(m_stacks[stack].m_start + (double)frame / FRAMES_PER_SECOND);
+
+			for (size_t channelIndex = 0; channelIndex < channels->size(); channelIndex++)
+			{
+				const cgltf_animation_channel* channel = (*channels)[channelIndex];
+				switch (channel->target_path)
+				{
+				case cgltf_animation_path_type_translation: sampleChannel(channel->sampler, 3, false, time, translation); break;
+				case cgltf_animation_path_type_rotation: sampleChannel(channel->sampler, 4, true, time, rotation); break;
+				case cgltf_animation_path_type_scale: sampleChannel(channel->sampler, 3, false, time, scale); break;
+				default: break;
+				}
+			}
+		}
+
+		composeTransform(translation, rotation, scale, matrixOut);
+	}
+}
+
+#else
+
+SceneSource* GltfSceneSource::load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData, size_t fileSize)
+{
+	errorOut = "FBXImporter was built without cgltf (see GltfSceneSource.h)";
+	return NULL;
+}
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,111 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_GLTFSCENESOURCE
+#define HK_FBXTOHKX_GLTFSCENESOURCE
+
+#include "SceneSource.h"
+#include "MappedFile.h"
+
+#include <map>
+
+struct cgltf_data;
+struct cgltf_node;
+struct cgltf_animation_channel;
+
+// SceneSource of a glTF 2.0 file (.gltf with its buffers, or .glb), parsed with cgltf (https://github.com/jkuhlmann/cgltf).
+// glTF and GLB inputs are converted through this instead of an FBX export of them.
+//
+// The file and its external buffers are memory mapped. The binary chunk of a GLB and the mapped buffers are used in
+// place: accessors are read straight from the mapping, nothing is copied but the JSON strings. Only data: URIs are
+// decoded into memory.
+//
+// cgltf is not part of this repository. To build with it, add cgltf.h to the include path and define
+// FBXTOHKX_WITH_CGLTF; without it load() reports that the loader is not available.
+//
+// The nodes of the default scene are the children of a root node added as node 0. The transforms are as in the file
+// (Y up, meters), the converter changes them to its output like for FBX files. Skin joints are skeleton nodes, each
+// animation is a stack sampled at FRAMES_PER_SECOND. Meshes merge the triangle primitives of the glTF mesh, one
+// material each; points, lines, strips and fans are skipped.
+class GltfSceneSource : public SceneSource
+{
+public:
+
+	// glTF animations have no frame rate of their own
+	static const int FRAMES_PER_SECOND = 30;
+
+	// Returns NULL (and the reason in errorOut) if the file cannot be loaded. applicationOut receives the generator of
+	// the file. If fileData is given it holds the contents of the file (used in place, it must outlive the source), which
+	// is not read then. External buffers are still looked up next to the file.
+	static SceneSource* load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData = NULL, size_t fileSize = 0);
+
+	~GltfSceneSource();
+
+	// SceneSource
+	virtual int getNumNodes() const;
+	virtual int getParent(int node) const;
+	virtual int getNumChildren(int node) const;
+	virtual int getChild(int node, int childIndex) const;
+	virtual const char* getNodeName(int node) const;
+	virtual NodeType getNodeType(int node) const;
+	virtual void getCoordinateSystem(CoordinateSystem& systemOut) const;
+	virtual bool getMesh(int node, SceneMesh& meshOut) const;
+	virtual int getNumStacks() const;
+	virtual void getStack(int stack, Stack& stackOut) const;
+	// Rotations are quaternions in glTF, they have no Euler angle curves
+	virtual bool getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const;
+	virtual void evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const;
+
+private:
+
+	GltfSceneSource();
+	GltfSceneSource(const GltfSceneSource&);
+	GltfSceneSource& operator=(const GltfSceneSource&);
+
+	bool loadBuffers(std::string& errorOut);
+	void addNodesRecursive(const cgltf_node* node, int parent);
+	int getNodeIndex(const cgltf_node* node) const;
+	const std::vector<const cgltf_animation_channel*>* getChannels(int node, int stack) const;
+
+	MappedFile m_file;
+	// Directory of the file, external buffers and images are relative to it
+	std::string m_directory;
+	std::vector<MappedFile*> m_bufferFiles;
+	cgltf_data* m_data;
+
+	// By node index, the root (node 0) has no glTF node
+	std::vector<const cgltf_node*> m_nodes;
+	std::vector<std::string> m_names;
+	std::vector<int> m_parents;
+	std::vector<std::vector<int> > m_children;
+	std::vector<bool> m_joints;
+	// Node index of each glTF node (-1 if it is not in the scene), in the order of the file
+	std::vector<int> m_nodeIndices;
+	std::vector<Stack> m_stacks;
+	// Animation channels of each stack and node
+	std::map<long long, std::vector<const cgltf_animation_channel*> > m_channels;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,176 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "ImportOptions.h"
+#include "JsonUtil.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string.h>
+
+struct ImportOptionName
+{
+	const char* m_name;
+	bool FbxToHkxConverter::Options::* m_flag;
+};
+
+static const ImportOptionName s_importOptionNames[] =
+{
+	{ "meshes", &FbxToHkxConverter::Options::m_exportMeshes },
+	{ "materials", &FbxToHkxConverter::Options::m_exportMaterials },
+	{ "attributes", &FbxToHkxConverter::Options::m_exportAttributes },
+	{ "annotations", &FbxToHkxConverter::Options::m_exportAnnotations },
+	{ "lights", &FbxToHkxConverter::Options::m_exportLights },
+	{ "cameras", &FbxToHkxConverter::Options::m_exportCameras },
+	{ "splines", &FbxToHkxConverter::Options::m_exportSplines },
+	{ "tangents", &FbxToHkxConverter::Options::m_exportVertexTangents },
+	{ "vertexAnimations", &FbxToHkxConverter::Options::m_exportVertexAnimations },
+	{ "animations", &FbxToHkxConverter::Options::m_exportAnimations },
+	{ "embeddedMedia", &FbxToHkxConverter::Options::m_extractEmbeddedMedia },
+	{ "animationOnlyStacks", &FbxToHkxConverter::Options::m_animationOnlyStacks },
+	{ "visibleOnly", &FbxToHkxConverter::Options::m_visibleOnly },
+	{ "selectedOnly", &FbxToHkxConverter::Options::m_selectedOnly },
+	{ "rigidSections", &FbxToHkxConverter::Options::m_extractRigidSections },
+};
+
+static bool setImportOption(const std::string& name, const std::string& value, FbxToHkxConverter::Options& optionsInOut, std::string& errorOut)
+{
+	bool flag;
+	if (value == "1" || value == "true")
+	{
+		flag = true;
+	}
+	else if (value == "0" || value == "false")
+	{
+		flag = false;
+	}
+	else
+	{
+		errorOut = "invalid value for " + name + ": " + value;
+		return false;
+	}
+
+	for (int nameIndex = 0; nameIndex < (int)HK_COUNT_OF(s_importOptionNames); nameIndex++)
+	{
+		if (name == s_importOptionNames[nameIndex].m_name)
+		{
+			optionsInOut.*s_importOptionNames[nameIndex].m_flag = flag;
+			return true;
+		}
+	}
+
+	errorOut = "unknown import option: " + name;
+	return false;
+}
+
+bool setImportOptions(const char* list, FbxToHkxConverter::Options& optionsInOut, std::string& errorOut)
+{
+	std::stringstream stream(list);
+	std::string entry;
+	while (std::getline(stream, entry, ','))
+	{
+		const size_t first = entry.find_first_not_of(" \t");
+		if (first == std::string::npos)
+		{
+			continue;
+		}
+		const size_t last = entry.find_last_not_of(" \t");
+		entry = entry.substr(first, last - first + 1);
+
+		const size_t separator = entry.find('=');
+		if (separator == std::string::npos)
+		{
+			errorOut = "expected name=value: " + entry;
+			return false;
+		}
+		if (!setImportOption(entry.substr(0, separator), entry.substr(separator + 1), optionsInOut, errorOut))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool loadImportProfile(const char* filename, FbxToHkxConverter::Options& optionsInOut, std::string& errorOut)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		errorOut = std::string("cannot read ") + filename;
+		return false;
+	}
+	std::stringstream text;
+	text << file.rdbuf();
+
+	std::map<std::string, std::string> values;
+	if (!parseJsonObject(text.str().c_str(), values, &errorOut))
+	{
+		return false;
+	}
+
+	for (std::map<std::string, std::string>::const_iterator it = values.begin(); it != values.end(); ++it)
+	{
+		if (!setImportOption(it->first, it->second, optionsInOut, errorOut))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void copyImportOptions(const FbxToHkxConverter::Options& from, FbxToHkxConverter::Options& to)
+{
+	for (int nameIndex = 0; nameIndex < (int)HK_COUNT_OF(s_importOptionNames); nameIndex++)
+	{
+		to.*s_importOptionNames[nameIndex].m_flag = from.*s_importOptionNames[nameIndex].m_flag;
+	}
+}
+
+int getImportOptionBits(const FbxToHkxConverter::Options& options)
+{
+	int bits = 0;
+	for (int nameIndex = 0; nameIndex < (int)HK_COUNT_OF(s_importOptionNames); nameIndex++)
+	{
+		bits |= (options.*s_importOptionNames[nameIndex].m_flag) ? (1 << nameIndex) : 0;
+	}
+	return bits;
+}
+
+void applyImportOptions(const FbxToHkxConverter::Options& options, FbxIOSettings* ioSettings)
+{
+	const bool materials = options.m_exportMeshes && options.m_exportMaterials;
+	ioSettings->SetBoolProp(IMP_FBX_MATERIAL, materials);
+	ioSettings->SetBoolProp(IMP_FBX_TEXTURE, materials);
+	// Skin clusters
+	ioSettings->SetBoolProp(IMP_FBX_LINK, options.m_exportMeshes);
+	ioSettings->SetBoolProp(IMP_FBX_SHAPE, options.m_exportMeshes && options.m_exportVertexAnimations);
+	ioSettings->SetBoolProp(IMP_FBX_ANIMATION, options.m_exportAnimations);
+	ioSettings->SetBoolProp(IMP_FBX_EXTRACT_EMBEDDED_DATA, options.m_extractEmbeddedMedia);
+
+	ioSettings->SetBoolProp(IMP_FBX_CHARACTER, false);
+	ioSettings->SetBoolProp(IMP_FBX_CONSTRAINT, false);
+	ioSettings->SetBoolProp(IMP_FBX_GOBO, false);
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
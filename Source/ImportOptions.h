@@ -0,0 +1,57 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_IMPORTOPTIONS
+#define HK_FBXTOHKX_IMPORTOPTIONS
+
+#include "FbxToHkxConverter.h"
+
+#include <string>
+
+// Names for the content flags of FbxToHkxConverter::Options, as used on the command line (--import), in import
+// profile files (--importProfile) and in conversion server requests ("import"):
+//   meshes, materials, attributes, annotations, lights, cameras, splines, tangents, vertexAnimations, animations,
+//   embeddedMedia, animationOnlyStacks, visibleOnly, selectedOnly, rigidSections
+//
+// Besides selecting what the converter emits, the flags are pushed down into the FbxIOSettings of the importer so
+// content that is skipped is never parsed or allocated by the FBX SDK.
+
+// Sets the flags of a comma separated list of name=value pairs (value 0/1 or false/true), e.g. "lights=0,cameras=0"
+bool setImportOptions(const char* list, FbxToHkxConverter::Options& optionsInOut, std::string& errorOut);
+
+// Sets the flags of an import profile, a JSON object of names and booleans, e.g. {"lights": false, "cameras": false}
+bool loadImportProfile(const char* filename, FbxToHkxConverter::Options& optionsInOut, std::string& errorOut);
+
+// Copies the content flags only, not the manager, caches and reporting of the options
+void copyImportOptions(const FbxToHkxConverter::Options& from, FbxToHkxConverter::Options& to);
+
+// One bit per content flag, for cache keys
+int getImportOptionBits(const FbxToHkxConverter::Options& options);
+
+// Disables the import of content the options don't convert. Cameras and lights are always imported (the SDK
+// settings have no switch for them), characters, constraints and gobos are never converted and never imported.
+void applyImportOptions(const FbxToHkxConverter::Options& options, FbxIOSettings* ioSettings);
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,235 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#include "JsonUtil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+
+void appendJsonString(std::string& out, const char* str)
+{
+	out += '"';
+	for (const char* c = str ? str : ""; *c; ++c)
+	{
+		switch (*c)
+		{
+		case '"':	out += "\\\""; break;
+		case '\\':	out += "\\\\"; break;
+		case '\n':	out += "\\n"; break;
+		case '\r':	out += "\\r"; break;
+		case '\t':	out += "\\t"; break;
+		default:
+			if ((unsigned char)*c < 0x20)
+			{
+				char escaped[8];
+				sprintf(escaped, "\\u%04x", (unsigned char)*c);
+				out += escaped;
+			}
+			else
+			{
+				out += *c;
+			}
+			break;
+		}
+	}
+	out += '"';
+}
+
+//-------
+
+static void skipJsonWhitespace(const char*& c)
+{
+	while (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+	{
+		++c;
+	}
+}
+
+static void appendUtf8(std::string& out, unsigned int codePoint)
+{
+	if (codePoint < 0x80)
+	{
+		out += (char)codePoint;
+	}
+	else if (codePoint < 0x800)
+	{
+		out += (char)(0xC0 | (codePoint >> 6));
+		out += (char)(0x80 | (codePoint & 0x3F));
+	}
+	else
+	{
+		out += (char)(0xE0 | (codePoint >> 12));
+		out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+		out += (char)(0x80 | (codePoint & 0x3F));
+	}
+}
+
+static bool parseJsonString(const char*& c, std::string& out)
+{
+	if (*c != '"')
+	{
+		return false;
+	}
+	++c;
+
+	out.clear();
+	while (*c != '"')
+	{
+		if (*c == '\0')
+		{
+			return false;
+		}
+		if (*c != '\\')
+		{
+			out += *c++;
+			continue;
+		}
+
+		++c;
+		switch (*c)
+		{
+		case '"':	out += '"'; break;
+		case '\\':	out += '\\'; break;
+		case '/':	out += '/'; break;
+		case 'b':	out += '\b'; break;
+		case 'f':	out += '\f'; break;
+		case 'n':	out += '\n'; break;
+		case 'r':	out += '\r'; break;
+		case 't':	out += '\t'; break;
+		case 'u':
+			{
+				char hex[5] = { 0 };
+				for (int i = 0; i < 4; ++i)
+				{
+					if (!isxdigit((unsigned char)c[1 + i]))
+					{
+						return false;
+					}
+					hex[i] = c[1 + i];
+				}
+				// Surrogate pairs are not combined, paths and names outside the BMP are not expected
+				appendUtf8(out, (unsigned int)strtoul(hex, NULL, 16));
+				c += 4;
+			}
+			break;
+		default:
+			return false;
+		}
+		++c;
+	}
+	++c;
+	return true;
+}
+
+static bool parseJsonLiteral(const char*& c, std::string& out)
+{
+	const char* start = c;
+	while (*c == '-' || *c == '+' || *c == '.' || isalnum((unsigned char)*c))
+	{
+		++c;
+	}
+	out.assign(start, c - start);
+
+	if (out == "true" || out == "false" || out == "null")
+	{
+		return true;
+	}
+	char* end = NULL;
+	strtod(out.c_str(), &end);
+	return !out.empty() && end && *end == '\0';
+}
+
+bool parseJsonObject(const char* text, std::map<std::string, std::string>& valuesOut, std::string* errorOut)
+{
+	const char* c = text;
+	valuesOut.clear();
+
+	skipJsonWhitespace(c);
+	if (*c++ != '{')
+	{
+		if (errorOut) *errorOut = "expected '{'";
+		return false;
+	}
+
+	skipJsonWhitespace(c);
+	if (*c == '}')
+	{
+		++c;
+	}
+	else
+	{
+		for (;;)
+		{
+			std::string key;
+			std::string value;
+
+			skipJsonWhitespace(c);
+			if (!parseJsonString(c, key))
+			{
+				if (errorOut) *errorOut = "expected a string key";
+				return false;
+			}
+
+			skipJsonWhitespace(c);
+			if (*c++ != ':')
+			{
+				if (errorOut) *errorOut = "expected ':' after " + key;
+				return false;
+			}
+
+			skipJsonWhitespace(c);
+			const bool parsed = (*c == '"') ? parseJsonString(c, value) : parseJsonLiteral(c, value);
+			if (!parsed)
+			{
+				if (errorOut) *errorOut = "invalid value for " + key;
+				return false;
+			}
+			valuesOut[key] = value;
+
+			skipJsonWhitespace(c);
+			if (*c == ',')
+			{
+				++c;
+				continue;
+			}
+			if (*c == '}')
+			{
+				++c;
+				break;
+			}
+			if (errorOut) *errorOut = "expected ',' or '}' after " + key;
+			return false;
+		}
+	}
+
+	skipJsonWhitespace(c);
+	if (*c != '\0')
+	{
+		if (errorOut) *errorOut = "unexpected trailing characters";
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,40 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_JSONUTIL
+#define HK_FBXTOHKX_JSONUTIL
+
+#include <map>
+#include <string>
+
+// Minimal JSON support for the tool's own protocols and reports, no general purpose DOM
+
+// Appends the string as a quoted JSON string
+void appendJsonString(std::string& out, const char* str);
+
+// Parses a flat JSON object ({"key": value, ...}). Strings are unescaped, numbers, true, false and null are kept
+// as their literal text. Nested objects and arrays are rejected.
+bool parseJsonObject(const char* text, std::map<std::string, std::string>& valuesOut, std::string* errorOut = NULL);
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
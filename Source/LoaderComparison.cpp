@@ -0,0 +1,284 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "LoaderComparison.h"
+
+#include <Common/SceneData/Scene/hkxScene.h>
+#include <Common/SceneData/Graph/hkxNode.h>
+#include <Common/SceneData/Mesh/hkxMesh.h>
+#include <Common/SceneData/Mesh/hkxMeshSection.h>
+#include <Common/SceneData/Skin/hkxSkinBinding.h>
+#include <Common/Base/Reflection/hkClass.h>
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+	const int MAX_PRINTED_DIFFERENCES = 20;
+
+	double toMegabytes(double bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	const hkxMesh* getNodeMesh(const hkxNode* node)
+	{
+		const hkClass* objectClass = node->m_object.getClass();
+		if (objectClass == &hkxMeshClass)
+		{
+			return static_cast<const hkxMesh*>(node->m_object.val());
+		}
+		if (objectClass == &hkxSkinBindingClass)
+		{
+			return static_cast<const hkxSkinBinding*>(node->m_object.val())->m_mesh;
+		}
+		return HK_NULL;
+	}
+
+	struct MeshExtent
+	{
+		MeshExtent() : m_numVertices(0), m_numTriangles(0)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				m_min[i] = DBL_MAX;
+				m_max[i] = -DBL_MAX;
+			}
+		}
+
+		void addMesh(const hkxMesh* mesh)
+		{
+			for (int sectionIndex = 0; sectionIndex < mesh->m_sections.getSize(); sectionIndex++)
+			{
+				const hkxMeshSection* section = mesh->m_sections[sectionIndex];
+				m_numTriangles += (int)section->getNumTriangles();
+
+				hkxVertexBuffer* vertexBuffer = section->m_vertexBuffer;
+				const hkxVertexDescription::ElementDecl* posDecl = vertexBuffer->getVertexDesc().getElementDecl(hkxVertexDescription::HKX_DU_POSITION, 0);
+				if (!posDecl)
+				{
+					continue;
+				}
+
+				const int numVertices = vertexBuffer->getNumVertices();
+				m_numVertices += numVertices;
+
+				const char* posBuf = static_cast<const char*>(vertexBuffer->getVertexDataPtr(*posDecl));
+				for (int v = 0; v < numVertices; ++v, posBuf += posDecl->m_byteStride)
+				{
+					const float* pos = (const float*)(posBuf);
+					for (int i = 0; i < 3; i++)
+					{
+						m_min[i] = std::min(m_min[i], (double)pos[i]);
+						m_max[i] = std::max(m_max[i], (double)pos[i]);
+					}
+				}
+			}
+		}
+
+		int m_numVertices;
+		int m_numTriangles;
+		double m_min[3];
+		double m_max[3];
+	};
+}
+
+LoaderComparison::LoaderComparison(double tolerance) :
+	m_tolerance(tolerance), m_numNodes(0), m_numMeshes(0), m_maxKeyFrameError(0.0), m_maxBoundsError(0.0)
+{
+}
+
+void LoaderComparison::addDifference(const std::string& difference)
+{
+	m_differences.push_back(difference);
+}
+
+bool LoaderComparison::isClose(double reference, double candidate) const
+{
+	return fabs(reference - candidate) <= m_tolerance * std::max(1.0, fabs(reference));
+}
+
+void LoaderComparison::compareScenes(const hkxScene* reference, const hkxScene* candidate)
+{
+	std::string path = reference->m_rootNode->m_name ? reference->m_rootNode->m_name.cString() : "";
+	compareNodes(reference->m_rootNode, candidate->m_rootNode, path);
+}
+
+void LoaderComparison::compareNodes(const hkxNode* reference, const hkxNode* candidate, const std::string& path)
+{
+	m_numNodes++;
+
+	const int numKeyFrames = reference->m_keyFrames.getSize();
+	if (candidate->m_keyFrames.getSize() != numKeyFrames)
+	{
+		char difference[64];
+		sprintf(difference, ": %d keyframes instead of %d", candidate->m_keyFrames.getSize(), numKeyFrames);
+		addDifference(path + difference);
+	}
+	else
+	{
+		int firstMismatch = -1;
+		for (int frame = 0; frame < numKeyFrames; frame++)
+		{
+			const hkMatrix4& referenceFrame = reference->m_keyFrames[frame];
+			const hkMatrix4& candidateFrame = candidate->m_keyFrames[frame];
+			for (int row = 0; row < 4; row++)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					const double referenceValue = referenceFrame(row, column);
+					const double candidateValue = candidateFrame(row, column);
+					m_maxKeyFrameError = std::max(m_maxKeyFrameError, fabs(referenceValue - candidateValue));
+					if (firstMismatch < 0 && !isClose(referenceValue, candidateValue))
+					{
+						firstMismatch = frame;
+					}
+				}
+			}
+		}
+
+		if (firstMismatch >= 0)
+		{
+			char difference[64];
+			sprintf(difference, ": keyframe %d differs", firstMismatch);
+			addDifference(path + difference);
+		}
+	}
+
+	compareMeshes(reference, candidate, path);
+
+	// Children are matched by name, the loaders may order them differently
+	for (int childIndex = 0; childIndex < reference->m_children.getSize(); childIndex++)
+	{
+		const hkxNode* referenceChild = reference->m_children[childIndex];
+		const char* childName = referenceChild->m_name ? referenceChild->m_name.cString() : "";
+
+		const hkxNode* candidateChild = HK_NULL;
+		for (int candidateIndex = 0; candidateIndex < candidate->m_children.getSize() && !candidateChild; candidateIndex++)
+		{
+			const hkxNode* child = candidate->m_children[candidateIndex];
+			if (hkString::strCmp(child->m_name ? child->m_name.cString() : "", childName) == 0)
+			{
+				candidateChild = child;
+			}
+		}
+
+		const std::string childPath = path + "/" + childName;
+		if (candidateChild)
+		{
+			compareNodes(referenceChild, candidateChild, childPath);
+		}
+		else
+		{
+			addDifference(childPath + ": missing");
+		}
+	}
+
+	if (candidate->m_children.getSize() > reference->m_children.getSize())
+	{
+		char difference[64];
+		sprintf(difference, ": %d children instead of %d", candidate->m_children.getSize(), reference->m_children.getSize());
+		addDifference(path + difference);
+	}
+}
+
+void LoaderComparison::compareMeshes(const hkxNode* reference, const hkxNode* candidate, const std::string& path)
+{
+	const hkxMesh* referenceMesh = getNodeMesh(reference);
+	const hkxMesh* candidateMesh = getNodeMesh(candidate);
+	if (!referenceMesh && !candidateMesh)
+	{
+		return;
+	}
+	if (!referenceMesh || !candidateMesh)
+	{
+		addDifference(path + (referenceMesh ? ": mesh missing" : ": unexpected mesh"));
+		return;
+	}
+
+	m_numMeshes++;
+
+	MeshExtent referenceExtent;
+	referenceExtent.addMesh(referenceMesh);
+	MeshExtent candidateExtent;
+	candidateExtent.addMesh(candidateMesh);
+
+	if (referenceExtent.m_numVertices != candidateExtent.m_numVertices || referenceExtent.m_numTriangles != candidateExtent.m_numTriangles)
+	{
+		char difference[128];
+		sprintf(difference, ": %d vertices and %d triangles instead of %d and %d", candidateExtent.m_numVertices, candidateExtent.m_numTriangles,
+			referenceExtent.m_numVertices, referenceExtent.m_numTriangles);
+		addDifference(path + difference);
+	}
+
+	if (referenceExtent.m_numVertices == 0 || candidateExtent.m_numVertices == 0)
+	{
+		return;
+	}
+
+	bool boundsMatch = true;
+	for (int i = 0; i < 3; i++)
+	{
+		m_maxBoundsError = std::max(m_maxBoundsError, fabs(referenceExtent.m_min[i] - candidateExtent.m_min[i]));
+		m_maxBoundsError = std::max(m_maxBoundsError, fabs(referenceExtent.m_max[i] - candidateExtent.m_max[i]));
+		boundsMatch = boundsMatch && isClose(referenceExtent.m_min[i], candidateExtent.m_min[i]) && isClose(referenceExtent.m_max[i], candidateExtent.m_max[i]);
+	}
+
+	if (!boundsMatch)
+	{
+		addDifference(path + ": mesh bounds differ");
+	}
+}
+
+void LoaderComparison::print(const char* referenceName, const Measurement& reference, const char* candidateName, const Measurement& candidate) const
+{
+	printf("Compared %d nodes and %d meshes: max keyframe error %g, max mesh bounds error %g (tolerance %g)\n",
+		m_numNodes, m_numMeshes, m_maxKeyFrameError, m_maxBoundsError, m_tolerance);
+
+	const int numPrinted = std::min((int)m_differences.size(), MAX_PRINTED_DIFFERENCES);
+	for (int differenceIndex = 0; differenceIndex < numPrinted; differenceIndex++)
+	{
+		printf("  %s\n", m_differences[differenceIndex].c_str());
+	}
+	if ((int)m_differences.size() > numPrinted)
+	{
+		printf("  ... and %d more differences\n", (int)m_differences.size() - numPrinted);
+	}
+
+	printf("%-8s load %8.3f s  convert %8.3f s  load RSS %8.1f MB  peak RSS growth %8.1f MB\n", referenceName,
+		reference.m_loadSeconds, reference.m_convertSeconds, toMegabytes((double)reference.m_loadRss), toMegabytes((double)reference.m_peakRss));
+	printf("%-8s load %8.3f s  convert %8.3f s  load RSS %8.1f MB  peak RSS growth %8.1f MB\n", candidateName,
+		candidate.m_loadSeconds, candidate.m_convertSeconds, toMegabytes((double)candidate.m_loadRss), toMegabytes((double)candidate.m_peakRss));
+
+	if (candidate.m_loadSeconds > 0.0)
+	{
+		printf("%s loads %0.2fx faster than %s\n", candidateName, reference.m_loadSeconds / candidate.m_loadSeconds, referenceName);
+	}
+
+	printf("Loaders %s\n", m_differences.empty() ? "match" : "differ");
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
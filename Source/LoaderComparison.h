@@ -0,0 +1,84 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_LOADERCOMPARISON
+#define HK_FBXTOHKX_LOADERCOMPARISON
+
+#include <Common/Base/hkBase.h>
+
+#include <string>
+#include <vector>
+
+class hkxScene;
+class hkxNode;
+
+// Checks that two loaders of the same file (--compareLoaders: the FBX SDK and ufbx) produce the same converted
+// scenes. The node trees must match by name, the sampled keyframes of each node must agree within the tolerance,
+// and each mesh must have the same number of vertices and triangles with the same bounds. Vertex order and section
+// layout may differ, the loaders triangulate and number polygon vertices independently.
+//
+// Values count as equal if they differ by at most the tolerance, relative to their magnitude when it is above 1.
+class LoaderComparison
+{
+public:
+
+	// Cost of one loader
+	struct Measurement
+	{
+		Measurement() : m_loadSeconds(0.0), m_convertSeconds(0.0), m_loadRss(0), m_peakRss(0) {}
+
+		double m_loadSeconds;
+		double m_convertSeconds;
+		// Process RSS held after loading the file, compared to before
+		size_t m_loadRss;
+		// Growth of the peak process RSS while loading and converting
+		size_t m_peakRss;
+	};
+
+	explicit LoaderComparison(double tolerance);
+
+	void compareScenes(const hkxScene* reference, const hkxScene* candidate);
+	void addDifference(const std::string& difference);
+
+	bool hasDifferences() const { return !m_differences.empty(); }
+
+	// Prints the differences (the first few of them), the largest errors and the cost of both loaders
+	void print(const char* referenceName, const Measurement& reference, const char* candidateName, const Measurement& candidate) const;
+
+private:
+
+	void compareNodes(const hkxNode* reference, const hkxNode* candidate, const std::string& path);
+	void compareMeshes(const hkxNode* reference, const hkxNode* candidate, const std::string& path);
+	bool isClose(double reference, double candidate) const;
+
+	double m_tolerance;
+	int m_numNodes;
+	int m_numMeshes;
+	double m_maxKeyFrameError;
+	double m_maxBoundsError;
+	std::vector<std::string> m_differences;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
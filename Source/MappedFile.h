@@ -0,0 +1,67 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_MAPPEDFILE
+#define HK_FBXTOHKX_MAPPEDFILE
+
+#include <stddef.h>
+
+// A file mapped read-only into memory, so readers can work on its bytes in place instead of copying them out with
+// buffered reads. The mapping is released when the object is destroyed or another file is opened.
+class MappedFile
+{
+public:
+
+	enum Access
+	{
+		// The pages are read in no particular order, e.g. accessors spread over a binary buffer
+		ACCESS_RANDOM,
+		// The file is read front to back once, the OS may read ahead aggressively and drop pages behind the reader
+		ACCESS_SEQUENTIAL
+	};
+
+	MappedFile();
+	~MappedFile();
+
+	// Returns false if the file cannot be opened or mapped. An empty file maps to no data.
+	bool open(const char* filename, Access access = ACCESS_RANDOM);
+	void close();
+
+	const unsigned char* getData() const { return m_data; }
+	size_t getSize() const { return m_size; }
+
+private:
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const unsigned char* m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_mapping;
+#endif
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,226 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "MemorySceneSource.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+	long long getCurveKey(int node, int stack, SceneSource::Channel channel)
+	{
+		return ((long long)node << 32) | ((long long)(stack & 0xffffff) << 8) | (long long)channel;
+	}
+
+	float evaluateCurve(const SceneCurve& curve, double time)
+	{
+		if (curve.m_times.empty())
+		{
+			return 0.f;
+		}
+		if (time <= curve.m_times.front())
+		{
+			return curve.m_values.front();
+		}
+		if (time >= curve.m_times.back())
+		{
+			return curve.m_values.back();
+		}
+
+		const size_t next = std::upper_bound(curve.m_times.begin(), curve.m_times.end(), time) - curve.m_times.begin();
+		const double t0 = curve.m_times[next - 1];
+		const double t1 = curve.m_times[next];
+		const double blend = (t1 > t0) ? (time - t0) / (t1 - t0) : 0.0;
+		return (float)(curve.m_values[next - 1] + (curve.m_values[next] - curve.m_values[next - 1]) * blend);
+	}
+}
+
+MemorySceneSource::MemorySceneSource(double frameRate) :
+	m_frameRate(frameRate)
+{
+	addNode(-1, "RootNode", NODE_NULL);
+}
+
+int MemorySceneSource::addNode(int parent, const char* name, NodeType type)
+{
+	Node node;
+	node.m_name = name;
+	node.m_type = type;
+	node.m_parent = parent;
+	for (int channel = 0; channel < NUM_CHANNELS; channel++)
+	{
+		node.m_channels[channel] = (channel >= SCALING_X) ? 1.f : 0.f;
+	}
+
+	const int nodeIndex = (int)m_nodes.size();
+	m_nodes.push_back(node);
+	if (parent >= 0)
+	{
+		m_nodes[parent].m_children.push_back(nodeIndex);
+	}
+	return nodeIndex;
+}
+
+void MemorySceneSource::setLocalTransform(int node, const float translation[3], const float rotation[3], const float scaling[3])
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		m_nodes[node].m_channels[TRANSLATION_X + axis] = translation[axis];
+		m_nodes[node].m_channels[ROTATION_X + axis] = rotation[axis];
+		m_nodes[node].m_channels[SCALING_X + axis] = scaling[axis];
+	}
+}
+
+SceneMesh& MemorySceneSource::editMesh(int node)
+{
+	return m_nodes[node].m_mesh;
+}
+
+int MemorySceneSource::addStack(const char* name, double start, double stop)
+{
+	Stack stack;
+	stack.m_name = name;
+	stack.m_start = start;
+	stack.m_stop = stop;
+	stack.m_numFrames = (stop > start) ? (int)ceil((stop - start) * m_frameRate - 1e-6) : 0;
+	m_stacks.push_back(stack);
+	return (int)m_stacks.size() - 1;
+}
+
+void MemorySceneSource::setCurve(int node, int stack, Channel channel, const SceneCurve& curve)
+{
+	m_curves[getCurveKey(node, stack, channel)] = curve;
+}
+
+int MemorySceneSource::getNumNodes() const
+{
+	return (int)m_nodes.size();
+}
+
+int MemorySceneSource::getParent(int node) const
+{
+	return m_nodes[node].m_parent;
+}
+
+int MemorySceneSource::getNumChildren(int node) const
+{
+	return (int)m_nodes[node].m_children.size();
+}
+
+int MemorySceneSource::getChild(int node, int childIndex) const
+{
+	return m_nodes[node].m_children[childIndex];
+}
+
+const char* MemorySceneSource::getNodeName(int node) const
+{
+	return m_nodes[node].m_name.c_str();
+}
+
+SceneSource::NodeType MemorySceneSource::getNodeType(int node) const
+{
+	return m_nodes[node].m_type;
+}
+
+void MemorySceneSource::getCoordinateSystem(CoordinateSystem& systemOut) const
+{
+	systemOut = m_coordinateSystem;
+}
+
+bool MemorySceneSource::getMesh(int node, SceneMesh& meshOut) const
+{
+	if (m_nodes[node].m_mesh.m_triangles.empty())
+	{
+		return false;
+	}
+	meshOut = m_nodes[node].m_mesh;
+	return true;
+}
+
+int MemorySceneSource::getNumStacks() const
+{
+	return (int)m_stacks.size();
+}
+
+void MemorySceneSource::getStack(int stack, Stack& stackOut) const
+{
+	stackOut = m_stacks[stack];
+}
+
+const SceneCurve* MemorySceneSource::findCurve(int node, int stack, Channel channel) const
+{
+	std::map<long long, SceneCurve>::const_iterator it = m_curves.find(getCurveKey(node, stack, channel));
+	return (it != m_curves.end()) ? &it->second : NULL;
+}
+
+bool MemorySceneSource::getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const
+{
+	const SceneCurve* curve = findCurve(node, stack, channel);
+	if (!curve)
+	{
+		return false;
+	}
+	curveOut = *curve;
+	return true;
+}
+
+// Stack -1 is evaluated at time 0 of the first stack, like the rig pose of an FBX scene
+void MemorySceneSource::evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const
+{
+	const int curveStack = (stack >= 0) ? stack : (m_stacks.empty() ? -1 : 0);
+	const double time = (stack >= 0) ? m_stacks[stack].m_start + frame / m_frameRate : 0.0;
+
+	double channels[NUM_CHANNELS];
+	for (int channel = 0; channel < NUM_CHANNELS; channel++)
+	{
+		const SceneCurve* curve = (curveStack >= 0) ? findCurve(node, curveStack, (Channel)channel) : NULL;
+		channels[channel] = curve ? evaluateCurve(*curve, time) : m_nodes[node].m_channels[channel];
+	}
+
+	const double degreesToRadians = 3.14159265358979323846 / 180.0;
+	const double cx = cos(channels[ROTATION_X] * degreesToRadians), sx = sin(channels[ROTATION_X] * degreesToRadians);
+	const double cy = cos(channels[ROTATION_Y] * degreesToRadians), sy = sin(channels[ROTATION_Y] * degreesToRadians);
+	const double cz = cos(channels[ROTATION_Z] * degreesToRadians), sz = sin(channels[ROTATION_Z] * degreesToRadians);
+
+	// Columns of Rz * Ry * Rx, each scaled by the scaling of its axis
+	const double rotation[3][3] =
+	{
+		{ cy * cz, cy * sz, -sy },
+		{ sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy },
+		{ cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy }
+	};
+
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			matrixOut[column * 4 + row] = rotation[column][row] * channels[SCALING_X + column];
+		}
+		matrixOut[column * 4 + 3] = 0.0;
+		matrixOut[12 + column] = channels[TRANSLATION_X + column];
+	}
+	matrixOut[15] = 1.0;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,91 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_MEMORYSCENESOURCE
+#define HK_FBXTOHKX_MEMORYSCENESOURCE
+
+#include "SceneSource.h"
+
+#include <map>
+
+// A scene built in memory, for running the pipelines of ScenePipeline.h on synthetic scenes without the FBX SDK.
+// Local transforms are translation * rotation * scaling, with the Euler rotation applied X first, then Y, then Z
+// (the FBX default rotation order). Curves are interpolated linearly and hold their first and last values outside
+// of their keys; channels without a curve keep the value set with setLocalTransform().
+class MemorySceneSource : public SceneSource
+{
+public:
+
+	// Creates the root node, node 0
+	explicit MemorySceneSource(double frameRate = 30.0);
+
+	int addNode(int parent, const char* name, NodeType type);
+	void setLocalTransform(int node, const float translation[3], const float rotation[3], const float scaling[3]);
+	// The mesh of the node, to be filled in by the caller (getMesh() returns it once it has triangles)
+	SceneMesh& editMesh(int node);
+
+	// Defaults to the output coordinate system
+	void setCoordinateSystem(const CoordinateSystem& system) { m_coordinateSystem = system; }
+
+	int addStack(const char* name, double start, double stop);
+	void setCurve(int node, int stack, Channel channel, const SceneCurve& curve);
+
+	// SceneSource
+	virtual int getNumNodes() const;
+	virtual int getParent(int node) const;
+	virtual int getNumChildren(int node) const;
+	virtual int getChild(int node, int childIndex) const;
+	virtual const char* getNodeName(int node) const;
+	virtual NodeType getNodeType(int node) const;
+	virtual void getCoordinateSystem(CoordinateSystem& systemOut) const;
+	virtual bool getMesh(int node, SceneMesh& meshOut) const;
+	virtual int getNumStacks() const;
+	virtual void getStack(int stack, Stack& stackOut) const;
+	virtual bool getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const;
+	virtual void evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const;
+
+private:
+
+	struct Node
+	{
+		std::string m_name;
+		NodeType m_type;
+		int m_parent;
+		std::vector<int> m_children;
+		float m_channels[NUM_CHANNELS];
+		SceneMesh m_mesh;
+	};
+
+	const SceneCurve* findCurve(int node, int stack, Channel channel) const;
+
+	double m_frameRate;
+	CoordinateSystem m_coordinateSystem;
+	std::vector<Node> m_nodes;
+	std::vector<Stack> m_stacks;
+	// Keyed by node, stack and channel
+	std::map<long long, SceneCurve> m_curves;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
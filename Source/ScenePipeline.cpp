@@ -0,0 +1,633 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "ScenePipeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	unsigned int packColor(const float* rgba)
+	{
+		return (static_cast<unsigned int>(static_cast<unsigned char>(rgba[3] * 255.0f)) << 24) |
+			(static_cast<unsigned int>(static_cast<unsigned char>(rgba[0] * 255.0f)) << 16) |
+			(static_cast<unsigned int>(static_cast<unsigned char>(rgba[1] * 255.0f)) << 8) |
+			(static_cast<unsigned int>(static_cast<unsigned char>(rgba[2] * 255.0f)));
+	}
+
+	void getAxisVector(SceneSource::Axis axis, double vectorOut[3])
+	{
+		vectorOut[0] = vectorOut[1] = vectorOut[2] = 0.0;
+		vectorOut[axis / 2] = (axis % 2) ? -1.0 : 1.0;
+	}
+
+	void transformVector(const double* matrix, float* vector)
+	{
+		const double x = vector[0], y = vector[1], z = vector[2];
+		for (int row = 0; row < 3; row++)
+		{
+			vector[row] = (float)(matrix[row] * x + matrix[4 + row] * y + matrix[8 + row] * z);
+		}
+	}
+
+	// Maps the largest component to the 16 bit range
+	float getQuantizationScale(const std::vector<float>& values)
+	{
+		float maxValue = 0.f;
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			maxValue = std::max(maxValue, std::fabs(values[i]));
+		}
+		return maxValue / 32767.f;
+	}
+
+	// Rounds value / scale to a short, returns true if it is not zero
+	bool quantizeDelta(const float* delta, float scale, short* quantizedOut)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			const float quantized = (scale > 0.f) ? std::floor(delta[i] / scale + 0.5f) : 0.f;
+			quantizedOut[i] = (short)std::max(-32767.f, std::min(32767.f, quantized));
+		}
+		return quantizedOut[0] != 0 || quantizedOut[1] != 0 || quantizedOut[2] != 0;
+	}
+
+	// One more than the largest skin cluster index of the influences
+	int getNumClusters(const SceneMesh& mesh)
+	{
+		int numClusters = 0;
+		for (size_t influence = 0; influence < mesh.m_skinClusters.size(); influence++)
+		{
+			numClusters = std::max(numClusters, mesh.m_skinClusters[influence] + 1);
+		}
+		return numClusters;
+	}
+
+	bool isIdentity(const double* matrix)
+	{
+		for (int element = 0; element < 16; element++)
+		{
+			if (matrix[element] != ((element % 5 == 0) ? 1.0 : 0.0))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void addKeyTimeHints(const SceneCurve& curve, float startTime, float endTime, std::vector<float>& hints)
+	{
+		startTime = std::max(startTime, 0.f);
+
+		for (size_t keyIndex = 0; keyIndex < curve.m_times.size(); keyIndex++)
+		{
+			const float keyTime = std::max((float)curve.m_times[keyIndex], 0.f);
+			if (keyTime >= startTime && (keyTime <= endTime || endTime < 0.f))
+			{
+				if (std::find(hints.begin(), hints.end(), keyTime) == hints.end())
+				{
+					hints.push_back(keyTime - startTime);
+				}
+			}
+			// No keys in the range but keys outside of it affect it, so the start and end are marked [EXP-2436]
+			else if ((keyTime < startTime) && std::find(hints.begin(), hints.end(), 0.f) == hints.end())
+			{
+				hints.push_back(0.f);
+			}
+			else if (endTime >= 0.f && (keyTime - startTime > endTime) && std::find(hints.begin(), hints.end(), endTime - startTime) == hints.end())
+			{
+				hints.push_back(endTime - startTime);
+			}
+		}
+	}
+}
+
+void buildTriangleListBuffers(const SceneMesh& mesh, const int* triangles, int numTriangles, int maxUvSets, SceneVertexBuffers& buffersOut,
+	const std::vector<int>* bonePalette)
+{
+	const int numVertices = numTriangles * 3;
+	const int numUvSets = std::min((int)mesh.m_uvSets.size(), maxUvSets);
+
+	// The palette index of each cluster
+	std::vector<int> paletteIndices;
+	if (bonePalette && mesh.isSkinned())
+	{
+		paletteIndices.resize(getNumClusters(mesh), 0);
+		for (size_t paletteIndex = 0; paletteIndex < bonePalette->size(); paletteIndex++)
+		{
+			paletteIndices[(*bonePalette)[paletteIndex]] = (int)paletteIndex;
+		}
+	}
+
+	buffersOut.m_numVertices = numVertices;
+	buffersOut.m_positions.resize(numVertices * 3);
+	buffersOut.m_normals.resize(mesh.m_normals.empty() ? 0 : numVertices * 3);
+	buffersOut.m_colors.resize(mesh.m_colors.empty() ? 0 : numVertices);
+	buffersOut.m_uvSets.resize(numUvSets);
+	for (int uvSetIndex = 0; uvSetIndex < numUvSets; uvSetIndex++)
+	{
+		buffersOut.m_uvSets[uvSetIndex].resize(numVertices * 2);
+	}
+	buffersOut.m_skinIndices.resize(mesh.isSkinned() ? numVertices : 0);
+	buffersOut.m_skinWeights.resize(mesh.isSkinned() ? numVertices * 4 : 0);
+	buffersOut.m_indices.resize(numVertices);
+
+	for (int triangleIndex = 0, vertex = 0; triangleIndex < numTriangles; triangleIndex++)
+	{
+		const int triangle = triangles[triangleIndex];
+
+		for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++, vertex++)
+		{
+			const int corner = triangle * 3 + cornerIndex;
+			const int controlPoint = mesh.m_triangles[corner];
+
+			std::copy(&mesh.m_positions[controlPoint * 3], &mesh.m_positions[controlPoint * 3] + 3, &buffersOut.m_positions[vertex * 3]);
+
+			if (!mesh.m_normals.empty())
+			{
+				std::copy(&mesh.m_normals[corner * 3], &mesh.m_normals[corner * 3] + 3, &buffersOut.m_normals[vertex * 3]);
+			}
+
+			if (!mesh.m_colors.empty())
+			{
+				buffersOut.m_colors[vertex] = packColor(&mesh.m_colors[corner * 4]);
+			}
+
+			for (int uvSetIndex = 0; uvSetIndex < numUvSets; uvSetIndex++)
+			{
+				buffersOut.m_uvSets[uvSetIndex][vertex * 2] = mesh.m_uvSets[uvSetIndex][corner * 2];
+				buffersOut.m_uvSets[uvSetIndex][vertex * 2 + 1] = mesh.m_uvSets[uvSetIndex][corner * 2 + 1];
+			}
+
+			if (mesh.isSkinned())
+			{
+				int clusters[4];
+				for (int i = 0; i < 4; i++)
+				{
+					const int cluster = mesh.m_skinClusters[controlPoint * 4 + i];
+					clusters[i] = paletteIndices.empty() ? cluster : paletteIndices[cluster];
+				}
+				buffersOut.m_skinIndices[vertex] =
+					(unsigned int)clusters[0] << 24 |
+					(unsigned int)clusters[1] << 16 |
+					(unsigned int)clusters[2] << 8 |
+					(unsigned int)clusters[3];
+				std::copy(&mesh.m_skinWeights[controlPoint * 4], &mesh.m_skinWeights[controlPoint * 4] + 4, &buffersOut.m_skinWeights[vertex * 4]);
+			}
+
+			buffersOut.m_indices[vertex] = vertex;
+		}
+	}
+}
+
+void partitionSkinnedTriangles(const SceneMesh& mesh, const int* triangles, int numTriangles, int maxBones, std::vector<SceneSkinPartition>& partitionsOut)
+{
+	partitionsOut.clear();
+
+	// The palette index of each cluster in each partition, -1 if it is not in the palette
+	const int numClusters = getNumClusters(mesh);
+	std::vector<std::vector<int> > paletteIndices;
+
+	for (int triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+	{
+		const int triangle = triangles[triangleIndex];
+
+		// The clusters influencing the corners, at most four each
+		int bones[12];
+		int numBones = 0;
+		for (int corner = triangle * 3; corner < triangle * 3 + 3; corner++)
+		{
+			const int controlPoint = mesh.m_triangles[corner];
+			for (int influence = controlPoint * 4; influence < controlPoint * 4 + 4; influence++)
+			{
+				const int cluster = mesh.m_skinClusters[influence];
+				if (mesh.m_skinWeights[influence] > 0.f && std::find(bones, bones + numBones, cluster) == bones + numBones)
+				{
+					bones[numBones++] = cluster;
+				}
+			}
+		}
+
+		size_t partition = 0;
+		for (; partition < partitionsOut.size(); partition++)
+		{
+			int numNewBones = 0;
+			for (int bone = 0; bone < numBones; bone++)
+			{
+				numNewBones += (paletteIndices[partition][bones[bone]] < 0) ? 1 : 0;
+			}
+			if ((int)partitionsOut[partition].m_bones.size() + numNewBones <= maxBones)
+			{
+				break;
+			}
+		}
+		if (partition == partitionsOut.size())
+		{
+			partitionsOut.push_back(SceneSkinPartition());
+			paletteIndices.push_back(std::vector<int>(numClusters, -1));
+		}
+
+		SceneSkinPartition& partitionOut = partitionsOut[partition];
+		partitionOut.m_triangles.push_back(triangle);
+		for (int bone = 0; bone < numBones; bone++)
+		{
+			int& paletteIndex = paletteIndices[partition][bones[bone]];
+			if (paletteIndex < 0)
+			{
+				paletteIndex = (int)partitionOut.m_bones.size();
+				partitionOut.m_bones.push_back(bones[bone]);
+			}
+		}
+	}
+}
+
+void extractRigidTriangles(const SceneMesh& mesh, const int* triangles, int numTriangles, std::vector<int>& skinnedTrianglesOut, std::vector<SceneRigidPart>& rigidPartsOut)
+{
+	skinnedTrianglesOut.clear();
+	rigidPartsOut.clear();
+
+	// Less than half of the smallest 8 bit blend weight may go to other clusters
+	const float maxOtherWeight = 0.5f / 255.f;
+
+	// The cluster each control point is bound to, -1 if it is blended or moved by a morph target
+	const int numControlPoints = mesh.getNumControlPoints();
+	std::vector<int> controlPointBones(numControlPoints, -1);
+	for (int controlPoint = 0; controlPoint < numControlPoints; controlPoint++)
+	{
+		const float* weights = &mesh.m_skinWeights[controlPoint * 4];
+		const int heaviest = (int)(std::max_element(weights, weights + 4) - weights);
+		const float totalWeight = weights[0] + weights[1] + weights[2] + weights[3];
+		if (totalWeight > 0.f && totalWeight - weights[heaviest] <= maxOtherWeight * totalWeight)
+		{
+			controlPointBones[controlPoint] = mesh.m_skinClusters[controlPoint * 4 + heaviest];
+		}
+	}
+	for (size_t shapeIndex = 0; shapeIndex < mesh.m_blendShapes.size(); shapeIndex++)
+	{
+		const SceneBlendShape& shape = mesh.m_blendShapes[shapeIndex];
+		for (size_t point = 0; point < shape.m_controlPoints.size(); point++)
+		{
+			controlPointBones[shape.m_controlPoints[point]] = -1;
+		}
+		for (size_t corner = 0; corner * 3 < shape.m_normalDeltas.size(); corner++)
+		{
+			const float* delta = &shape.m_normalDeltas[corner * 3];
+			if (delta[0] != 0.f || delta[1] != 0.f || delta[2] != 0.f)
+			{
+				controlPointBones[mesh.m_triangles[corner]] = -1;
+			}
+		}
+	}
+
+	// The part of each cluster, -1 until it has a triangle
+	std::vector<int> boneParts(getNumClusters(mesh), -1);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+	{
+		const int triangle = triangles[triangleIndex];
+		const int bone = controlPointBones[mesh.m_triangles[triangle * 3]];
+		if (bone < 0 || controlPointBones[mesh.m_triangles[triangle * 3 + 1]] != bone || controlPointBones[mesh.m_triangles[triangle * 3 + 2]] != bone)
+		{
+			skinnedTrianglesOut.push_back(triangle);
+			continue;
+		}
+
+		if (boneParts[bone] < 0)
+		{
+			boneParts[bone] = (int)rigidPartsOut.size();
+			rigidPartsOut.push_back(SceneRigidPart());
+			rigidPartsOut.back().m_bone = bone;
+		}
+		rigidPartsOut[boneParts[bone]].m_triangles.push_back(triangle);
+	}
+}
+
+bool invertAffineTransform(const double matrix[16], double inverseOut[16])
+{
+	// The inverse of the 3x3 part is its adjugate over the determinant
+	const double* m = matrix;
+	const double determinant =
+		m[0] * (m[5] * m[10] - m[9] * m[6]) -
+		m[4] * (m[1] * m[10] - m[9] * m[2]) +
+		m[8] * (m[1] * m[6] - m[5] * m[2]);
+	if (determinant == 0.0)
+	{
+		return false;
+	}
+
+	double* inverse = inverseOut;
+	inverse[0] = (m[5] * m[10] - m[9] * m[6]) / determinant;
+	inverse[1] = (m[9] * m[2] - m[1] * m[10]) / determinant;
+	inverse[2] = (m[1] * m[6] - m[5] * m[2]) / determinant;
+	inverse[4] = (m[8] * m[6] - m[4] * m[10]) / determinant;
+	inverse[5] = (m[0] * m[10] - m[8] * m[2]) / determinant;
+	inverse[6] = (m[4] * m[2] - m[0] * m[6]) / determinant;
+	inverse[8] = (m[4] * m[9] - m[8] * m[5]) / determinant;
+	inverse[9] = (m[8] * m[1] - m[0] * m[9]) / determinant;
+	inverse[10] = (m[0] * m[5] - m[4] * m[1]) / determinant;
+	inverse[3] = inverse[7] = inverse[11] = 0.0;
+
+	// The translation is undone after the rotation and scale
+	for (int row = 0; row < 3; row++)
+	{
+		inverse[12 + row] = -(inverse[row] * m[12] + inverse[4 + row] * m[13] + inverse[8 + row] * m[14]);
+	}
+	inverse[15] = 1.0;
+	return true;
+}
+
+void transformVertexBuffers(const double transform[16], SceneVertexBuffers& buffersInOut)
+{
+	for (size_t position = 0; position < buffersInOut.m_positions.size(); position += 3)
+	{
+		transformVector(transform, &buffersInOut.m_positions[position]);
+		for (int row = 0; row < 3; row++)
+		{
+			buffersInOut.m_positions[position + row] += (float)transform[12 + row];
+		}
+	}
+
+	if (buffersInOut.m_normals.empty())
+	{
+		return;
+	}
+	double inverse[16];
+	if (!invertAffineTransform(transform, inverse))
+	{
+		return;
+	}
+	double inverseTranspose[16];
+	for (int row = 0; row < 4; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			inverseTranspose[column * 4 + row] = inverse[row * 4 + column];
+		}
+	}
+	for (size_t normal = 0; normal < buffersInOut.m_normals.size(); normal += 3)
+	{
+		float* vector = &buffersInOut.m_normals[normal];
+		transformVector(inverseTranspose, vector);
+		const float length = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+		if (length > 0.f)
+		{
+			vector[0] /= length;
+			vector[1] /= length;
+			vector[2] /= length;
+		}
+	}
+}
+
+void buildBlendShapeDeltas(const SceneMesh& mesh, const SceneBlendShape& shape, const int* triangles, int numTriangles, SceneBlendShapeDeltas& deltasOut)
+{
+	deltasOut = SceneBlendShapeDeltas();
+	deltasOut.m_positionScale = getQuantizationScale(shape.m_positionDeltas);
+	deltasOut.m_normalScale = getQuantizationScale(shape.m_normalDeltas);
+
+	// The position offset of each control point that moves, -1 for the others
+	const int numControlPoints = mesh.getNumControlPoints();
+	std::vector<int> controlPointDeltas(numControlPoints, -1);
+	for (size_t deltaIndex = 0; deltaIndex < shape.m_controlPoints.size(); deltaIndex++)
+	{
+		const int controlPoint = shape.m_controlPoints[deltaIndex];
+		if (controlPoint >= 0 && controlPoint < numControlPoints)
+		{
+			controlPointDeltas[controlPoint] = (int)deltaIndex;
+		}
+	}
+
+	const bool hasNormals = !shape.m_normalDeltas.empty();
+	const float zero[3] = { 0.f, 0.f, 0.f };
+
+	for (int triangleIndex = 0, vertex = 0; triangleIndex < numTriangles; triangleIndex++)
+	{
+		const int triangle = triangles[triangleIndex];
+
+		for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++, vertex++)
+		{
+			const int corner = triangle * 3 + cornerIndex;
+			const int deltaIndex = controlPointDeltas[mesh.m_triangles[corner]];
+
+			short position[3];
+			short normal[3];
+			const bool moves = quantizeDelta((deltaIndex >= 0) ? &shape.m_positionDeltas[deltaIndex * 3] : zero, deltasOut.m_positionScale, position);
+			const bool turns = quantizeDelta(hasNormals ? &shape.m_normalDeltas[corner * 3] : zero, deltasOut.m_normalScale, normal);
+			if (!moves && !turns)
+			{
+				continue;
+			}
+
+			deltasOut.m_vertices.push_back(vertex);
+			deltasOut.m_positions.insert(deltasOut.m_positions.end(), position, position + 3);
+			if (hasNormals)
+			{
+				deltasOut.m_normals.insert(deltasOut.m_normals.end(), normal, normal + 3);
+			}
+		}
+	}
+}
+
+int sampleKeyFrames(const SceneSource& source, int node, int stack, bool animated, std::vector<double>& keyFramesOut)
+{
+	keyFramesOut.clear();
+
+	// Without animation the node keeps its pose at the start, an animated node that never leaves the identity is
+	// stored as the identity
+	double staticMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	bool staticNode = true;
+	int numFrames = 0;
+
+	if (!animated)
+	{
+		source.evaluateLocalTransform(node, stack, 0, staticMatrix);
+	}
+	else
+	{
+		SceneSource::Stack stackInfo;
+		source.getStack(stack, stackInfo);
+
+		numFrames = stackInfo.m_numFrames;
+		keyFramesOut.resize(numFrames * 16);
+		for (int frame = 0; frame < numFrames; frame++)
+		{
+			double* matrix = &keyFramesOut[frame * 16];
+			source.evaluateLocalTransform(node, stack, frame, matrix);
+			staticNode = staticNode && isIdentity(matrix);
+		}
+	}
+
+	if (staticNode)
+	{
+		const int numKeys = (numFrames > 1) ? 2 : 1;
+		keyFramesOut.resize(numKeys * 16);
+		for (int key = 0; key < numKeys; key++)
+		{
+			std::copy(staticMatrix, staticMatrix + 16, &keyFramesOut[key * 16]);
+		}
+	}
+
+	return numFrames;
+}
+
+void multiplyMatrices(const double* a, const double* b, double* productOut)
+{
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			double sum = 0.0;
+			for (int k = 0; k < 4; k++)
+			{
+				sum += a[k * 4 + row] * b[column * 4 + k];
+			}
+			productOut[column * 4 + row] = sum;
+		}
+	}
+}
+
+void evaluateGlobalTransform(const SceneSource& source, int node, int stack, int frame, double matrixOut[16])
+{
+	source.evaluateLocalTransform(node, stack, frame, matrixOut);
+
+	for (int parent = source.getParent(node); parent >= 0; parent = source.getParent(parent))
+	{
+		double parentMatrix[16];
+		source.evaluateLocalTransform(parent, stack, frame, parentMatrix);
+
+		double product[16];
+		multiplyMatrices(parentMatrix, matrixOut, product);
+		std::copy(product, product + 16, matrixOut);
+	}
+}
+
+bool computeOutputBasis(const SceneSource::CoordinateSystem& system, double scale, double basisOut[16], double inverseOut[16])
+{
+	const SceneSource::Axis sourceAxes[3] = { system.m_right, system.m_up, system.m_front };
+	const SceneSource::CoordinateSystem output;
+	const SceneSource::Axis outputAxes[3] = { output.m_right, output.m_up, output.m_front };
+
+	// The source axes must be three different axes, otherwise the scene is taken to be in the output axes
+	const bool valid = (sourceAxes[0] / 2 != sourceAxes[1] / 2) && (sourceAxes[0] / 2 != sourceAxes[2] / 2) && (sourceAxes[1] / 2 != sourceAxes[2] / 2);
+
+	// The sum of outputAxis * sourceAxis^T maps each source axis onto its output axis, the inverse is the transpose
+	std::fill(basisOut, basisOut + 16, 0.0);
+	std::fill(inverseOut, inverseOut + 16, 0.0);
+	for (int axisIndex = 0; axisIndex < 3; axisIndex++)
+	{
+		double sourceAxis[3];
+		double outputAxis[3];
+		getAxisVector(valid ? sourceAxes[axisIndex] : outputAxes[axisIndex], sourceAxis);
+		getAxisVector(outputAxes[axisIndex], outputAxis);
+
+		for (int row = 0; row < 3; row++)
+		{
+			for (int column = 0; column < 3; column++)
+			{
+				basisOut[column * 4 + row] += outputAxis[row] * sourceAxis[column] * scale;
+				inverseOut[row * 4 + column] += outputAxis[row] * sourceAxis[column] / scale;
+			}
+		}
+	}
+	basisOut[15] = inverseOut[15] = 1.0;
+
+	return valid;
+}
+
+void changeBasis(const double basis[16], const double inverse[16], double matrixInOut[16])
+{
+	double product[16];
+	multiplyMatrices(basis, matrixInOut, product);
+	multiplyMatrices(product, inverse, matrixInOut);
+}
+
+void transformSceneMesh(const double basis[16], const double inverse[16], SceneMesh& meshInOut)
+{
+	for (size_t position = 0; position < meshInOut.m_positions.size(); position += 3)
+	{
+		transformVector(basis, &meshInOut.m_positions[position]);
+	}
+
+	// The basis is a scaled rotation or reflection, normals only need the rotation
+	const double scale = std::sqrt(basis[0] * basis[0] + basis[1] * basis[1] + basis[2] * basis[2]);
+	double rotation[16];
+	for (int element = 0; element < 16; element++)
+	{
+		rotation[element] = basis[element] / scale;
+	}
+	for (size_t normal = 0; normal < meshInOut.m_normals.size(); normal += 3)
+	{
+		transformVector(rotation, &meshInOut.m_normals[normal]);
+	}
+
+	// Position offsets are vectors, they are scaled like the positions
+	for (size_t shapeIndex = 0; shapeIndex < meshInOut.m_blendShapes.size(); shapeIndex++)
+	{
+		SceneBlendShape& shape = meshInOut.m_blendShapes[shapeIndex];
+		for (size_t delta = 0; delta < shape.m_positionDeltas.size(); delta += 3)
+		{
+			transformVector(basis, &shape.m_positionDeltas[delta]);
+		}
+		for (size_t delta = 0; delta < shape.m_normalDeltas.size(); delta += 3)
+		{
+			transformVector(rotation, &shape.m_normalDeltas[delta]);
+		}
+	}
+
+	for (size_t bindPose = 0; bindPose < meshInOut.m_clusterBindPoses.size(); bindPose += 16)
+	{
+		changeBasis(basis, inverse, &meshInOut.m_clusterBindPoses[bindPose]);
+	}
+
+	// A reflection turns the triangles over
+	const double determinant =
+		rotation[0] * (rotation[5] * rotation[10] - rotation[9] * rotation[6]) -
+		rotation[4] * (rotation[1] * rotation[10] - rotation[9] * rotation[2]) +
+		rotation[8] * (rotation[1] * rotation[6] - rotation[5] * rotation[2]);
+	if (determinant < 0.0)
+	{
+		meshInOut.m_flipped = !meshInOut.m_flipped;
+	}
+}
+
+// Only the translation keys are used, the rotation and scaling keys never contributed hints
+void collectKeyTimeHints(const SceneSource& source, int node, int stack, std::vector<float>& hintsOut)
+{
+	hintsOut.clear();
+
+	SceneSource::Stack stackInfo;
+	source.getStack(stack, stackInfo);
+
+	const SceneSource::Channel channels[] = { SceneSource::TRANSLATION_X, SceneSource::TRANSLATION_Y, SceneSource::TRANSLATION_Z };
+	for (int channelIndex = 0; channelIndex < 3; channelIndex++)
+	{
+		SceneCurve curve;
+		if (source.getCurve(node, stack, channels[channelIndex], curve))
+		{
+			addKeyTimeHints(curve, (float)stackInfo.m_start, (float)stackInfo.m_stop, hintsOut);
+		}
+	}
+
+	std::sort(hintsOut.begin(), hintsOut.end());
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,150 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_SCENEPIPELINE
+#define HK_FBXTOHKX_SCENEPIPELINE
+
+#include "SceneSource.h"
+
+// The hot paths of the conversion that only depend on a SceneSource: filling the vertex streams of mesh sections,
+// sampling node keyframes and collecting key time hints. The converter copies the results into the Havok scene
+// objects; like SceneSource.h this file only uses the standard library.
+
+// Vertex streams of a triangle list with one vertex per triangle corner
+struct SceneVertexBuffers
+{
+	SceneVertexBuffers() : m_numVertices(0) {}
+
+	int m_numVertices;
+	// x, y, z per vertex
+	std::vector<float> m_positions;
+	// x, y, z per vertex, empty if the mesh has no normals
+	std::vector<float> m_normals;
+	// ARGB per vertex, empty if the mesh has no vertex colors
+	std::vector<unsigned int> m_colors;
+	// u, v per vertex for each UV set
+	std::vector<std::vector<float> > m_uvSets;
+	// The four skin cluster indices of each vertex packed from the high to the low byte, and their four weights.
+	// Empty if the mesh is not skinned.
+	std::vector<unsigned int> m_skinIndices;
+	std::vector<float> m_skinWeights;
+	// 0, 1, 2, ... in the order of the corners. Flipping the winding of mirrored meshes is left to the caller.
+	std::vector<unsigned int> m_indices;
+};
+
+// Triangles of a skinned mesh section and the skin clusters they are influenced by
+struct SceneSkinPartition
+{
+	std::vector<int> m_triangles;
+	// The bone palette: the cluster of each skin index of the partition's vertices
+	std::vector<int> m_bones;
+};
+
+// Fills the vertex streams of the given triangles of the mesh, at most maxUvSets UV sets are copied. If a bone palette
+// is given (SceneSkinPartition::m_bones), the skin indices are positions in it instead of clusters, and influences of
+// clusters not in it (which have no weight) get index 0.
+void buildTriangleListBuffers(const SceneMesh& mesh, const int* triangles, int numTriangles, int maxUvSets, SceneVertexBuffers& buffersOut,
+	const std::vector<int>* bonePalette = NULL);
+
+// Smallest bone palette every triangle fits into: four influences on each of its three vertices
+static const int MIN_SKIN_BONE_PALETTE = 12;
+
+// Splits the triangles of a skinned mesh so that each partition is influenced by at most maxBones skin clusters
+// (influences without weight are ignored). Each triangle goes to the first partition it fits into, in order, a
+// triangle influenced by more than maxBones clusters gets a partition of its own.
+void partitionSkinnedTriangles(const SceneMesh& mesh, const int* triangles, int numTriangles, int maxBones, std::vector<SceneSkinPartition>& partitionsOut);
+
+// Triangles of a skinned mesh whose control points all follow a single skin cluster
+struct SceneRigidPart
+{
+	int m_bone;
+	std::vector<int> m_triangles;
+};
+
+// Splits the triangles of a skinned mesh into the rigid ones, grouped by their cluster in the order the clusters are
+// first found, and the rest (in their order). A control point is rigid if one cluster has all of its weight, up to
+// what 8 bit blend weights can't tell apart. Control points moved by a morph target are never rigid, the target is
+// applied to the skinned mesh.
+void extractRigidTriangles(const SceneMesh& mesh, const int* triangles, int numTriangles, std::vector<int>& skinnedTrianglesOut, std::vector<SceneRigidPart>& rigidPartsOut);
+
+// The inverse of an affine transform (four columns, the last row 0, 0, 0, 1). Returns false if it is singular.
+bool invertAffineTransform(const double matrix[16], double inverseOut[16]);
+
+// Transforms the positions of vertex streams by an affine transform, and their normals by its inverse transpose
+// (renormalized)
+void transformVertexBuffers(const double transform[16], SceneVertexBuffers& buffersInOut);
+
+// The offsets of a morph target for the vertices of a mesh section filled by buildTriangleListBuffers(), quantized to
+// 16 bits per component: offset = value * scale. The scales map the largest offset of the whole target to the 16 bit
+// range, so they are the same for every section of the mesh.
+struct SceneBlendShapeDeltas
+{
+	SceneBlendShapeDeltas() : m_positionScale(0.f), m_normalScale(0.f) {}
+
+	// The section vertices that move, ascending
+	std::vector<int> m_vertices;
+	// x, y, z per vertex
+	std::vector<short> m_positions;
+	float m_positionScale;
+	// x, y, z per vertex, empty if the target has no normals
+	std::vector<short> m_normals;
+	float m_normalScale;
+};
+
+// Collects the offsets of a morph target for the vertices of the given triangles of the mesh (numbered like
+// buildTriangleListBuffers() numbers them). Vertices whose position and normal offsets quantize to zero are left out.
+void buildBlendShapeDeltas(const SceneMesh& mesh, const SceneBlendShape& shape, const int* triangles, int numTriangles, SceneBlendShapeDeltas& deltasOut);
+
+// Samples the local transform of a node at every frame of an animated stack (16 values per key, see
+// SceneSource::evaluateLocalTransform()), or takes the pose at the start of the stack (time 0 for stack -1) if it is
+// not animated. A node that is not animated, or whose transform is the identity at every frame, gets one key, or two
+// equal ones in an animated stack. Returns the number of sampled frames.
+int sampleKeyFrames(const SceneSource& source, int node, int stack, bool animated, std::vector<double>& keyFramesOut);
+
+// a * b, both stored as four columns
+void multiplyMatrices(const double* a, const double* b, double* productOut);
+
+// The global transform of a node at a frame of a stack: the product of the local transforms of the node and its
+// ancestors (see SceneSource::evaluateLocalTransform())
+void evaluateGlobalTransform(const SceneSource& source, int node, int stack, int frame, double matrixOut[16]);
+
+// The change of basis from the coordinate system of a source to the output coordinates (the default
+// SceneSource::CoordinateSystem, the 3ds Max axis system), scaled by the given ratio of the source unit to the output
+// unit. Transforms are converted as basis * transform * inverse, points and vectors as basis * point. Returns false if
+// the axes of the system are not three different axes, the basis then only scales.
+bool computeOutputBasis(const SceneSource::CoordinateSystem& system, double scale, double basisOut[16], double inverseOut[16]);
+
+// basis * matrix * inverse, for local and global transforms
+void changeBasis(const double basis[16], const double inverse[16], double matrixInOut[16]);
+
+// Converts the positions, normals, morph target offsets and skin bind poses of a mesh with an output basis, and flips its winding if the
+// basis is a reflection (a left-handed source)
+void transformSceneMesh(const double basis[16], const double inverse[16], SceneMesh& meshInOut);
+
+// Times of the translation keys of the node in the stack, relative to its start, sorted. Keys outside the stack add
+// its start or end, as they affect the range. These are stored as hkxNode::m_linearKeyFrameHints.
+void collectKeyTimeHints(const SceneSource& source, int node, int stack, std::vector<float>& hintsOut);
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,456 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "SceneSizeReport.h"
+#include "JsonUtil.h"
+
+#include <Common/SceneData/Scene/hkxScene.h>
+#include <Common/SceneData/Graph/hkxNode.h>
+#include <Common/SceneData/Mesh/hkxMesh.h>
+#include <Common/SceneData/Mesh/hkxMeshSection.h>
+#include <Common/SceneData/Mesh/Channels/hkxVertexSelectionChannel.h>
+#include <Common/SceneData/Mesh/Channels/hkxVertexFloatDataChannel.h>
+#include <Common/SceneData/Mesh/Channels/hkxVertexIntDataChannel.h>
+#include <Common/SceneData/Material/hkxMaterial.h>
+#include <Common/SceneData/Material/hkxTextureFile.h>
+#include <Common/SceneData/Material/hkxTextureInplace.h>
+#include <Common/SceneData/Skin/hkxSkinBinding.h>
+#include <Common/SceneData/Attributes/hkxAttributeGroup.h>
+#include <Common/SceneData/Attributes/hkxAnimatedFloat.h>
+#include <Common/SceneData/Attributes/hkxAnimatedVector.h>
+#include <Common/SceneData/Attributes/hkxAnimatedMatrix.h>
+#include <Common/SceneData/Attributes/hkxAnimatedQuaternion.h>
+#include <Common/SceneData/Attributes/hkxSparselyAnimatedBool.h>
+#include <Common/SceneData/Attributes/hkxSparselyAnimatedInt.h>
+#include <Common/SceneData/Attributes/hkxSparselyAnimatedEnum.h>
+#include <Common/SceneData/Attributes/hkxSparselyAnimatedString.h>
+#include <Common/Base/Reflection/hkClass.h>
+
+#include <stdio.h>
+
+namespace
+{
+	// Names used in the table and as JSON keys, in Category order
+	const char* s_categoryNames[SceneSizeReport::NUM_CATEGORIES] =
+	{
+		"keyframes",
+		"annotations",
+		"positions",
+		"normals",
+		"tangents",
+		"binormals",
+		"colors",
+		"texcoords",
+		"blendWeights",
+		"blendIndices",
+		"otherVertexData",
+		"indexBuffers",
+		"userChannels",
+		"skinBindings",
+		"materials",
+		"textures",
+		"attributes"
+	};
+
+	hkLong getStringBytes(const char* str)
+	{
+		return str ? hkString::strLen(str) + 1 : 0;
+	}
+
+	int getDataTypeBytes(hkxVertexDescription::DataType type)
+	{
+		switch (type)
+		{
+		case hkxVertexDescription::HKX_DT_UINT8: return 1;
+		case hkxVertexDescription::HKX_DT_INT16: return 2;
+		case hkxVertexDescription::HKX_DT_UINT32: return 4;
+		case hkxVertexDescription::HKX_DT_FLOAT: return 4;
+		default: return 0;
+		}
+	}
+
+	SceneSizeReport::Category getVertexCategory(hkxVertexDescription::DataUsage usage)
+	{
+		switch (usage)
+		{
+		case hkxVertexDescription::HKX_DU_POSITION: return SceneSizeReport::VERTEX_POSITIONS;
+		case hkxVertexDescription::HKX_DU_NORMAL: return SceneSizeReport::VERTEX_NORMALS;
+		case hkxVertexDescription::HKX_DU_TANGENT: return SceneSizeReport::VERTEX_TANGENTS;
+		case hkxVertexDescription::HKX_DU_BINORMAL: return SceneSizeReport::VERTEX_BINORMALS;
+		case hkxVertexDescription::HKX_DU_COLOR: return SceneSizeReport::VERTEX_COLORS;
+		case hkxVertexDescription::HKX_DU_TEXCOORD: return SceneSizeReport::VERTEX_TEXCOORDS;
+		case hkxVertexDescription::HKX_DU_BLENDWEIGHTS: return SceneSizeReport::VERTEX_BLEND_WEIGHTS;
+		case hkxVertexDescription::HKX_DU_BLENDINDICES: return SceneSizeReport::VERTEX_BLEND_INDICES;
+		default: return SceneSizeReport::VERTEX_OTHER;
+		}
+	}
+
+	// Bytes of the keys of an attribute value, the times of the sparsely animated types included
+	hkLong getAttributeValueBytes(const hkRefVariant& value)
+	{
+		const hkClass* valueClass = value.getClass();
+		if (!valueClass || !value.val())
+		{
+			return 0;
+		}
+
+		if (valueClass->equals(&hkxAnimatedFloatClass))
+		{
+			return ((const hkxAnimatedFloat*)value.val())->m_floats.getSize() * sizeof(hkFloat32);
+		}
+		if (valueClass->equals(&hkxAnimatedVectorClass))
+		{
+			return ((const hkxAnimatedVector*)value.val())->m_vectors.getSize() * sizeof(hkFloat32);
+		}
+		if (valueClass->equals(&hkxAnimatedMatrixClass))
+		{
+			return ((const hkxAnimatedMatrix*)value.val())->m_matrices.getSize() * sizeof(hkFloat32);
+		}
+		if (valueClass->equals(&hkxAnimatedQuaternionClass))
+		{
+			return ((const hkxAnimatedQuaternion*)value.val())->m_quaternions.getSize() * sizeof(hkFloat32);
+		}
+		if (valueClass->equals(&hkxSparselyAnimatedBoolClass))
+		{
+			const hkxSparselyAnimatedBool* data = (const hkxSparselyAnimatedBool*)value.val();
+			return data->m_bools.getSize() * sizeof(hkBool) + data->m_times.getSize() * sizeof(hkReal);
+		}
+		if (valueClass->equals(&hkxSparselyAnimatedIntClass) || valueClass->equals(&hkxSparselyAnimatedEnumClass))
+		{
+			const hkxSparselyAnimatedInt* data = (const hkxSparselyAnimatedInt*)value.val();
+			return data->m_ints.getSize() * sizeof(hkInt32) + data->m_times.getSize() * sizeof(hkReal);
+		}
+		if (valueClass->equals(&hkxSparselyAnimatedStringClass))
+		{
+			const hkxSparselyAnimatedString* data = (const hkxSparselyAnimatedString*)value.val();
+			hkLong bytes = data->m_times.getSize() * sizeof(hkReal);
+			for (int stringIndex = 0; stringIndex < data->m_strings.getSize(); stringIndex++)
+			{
+				bytes += getStringBytes(data->m_strings[stringIndex]);
+			}
+			return bytes;
+		}
+
+		return 0;
+	}
+}
+
+SceneSizeReport::SceneSizeReport(const hkxScene* scene, hkLong fileBytes) :
+	m_fileBytes(fileBytes), m_numNodes(0), m_numKeyFrames(0), m_numVertices(0), m_numIndices(0), m_largestAttributeBytes(0)
+{
+	for (int category = 0; category < NUM_CATEGORIES; category++)
+	{
+		m_bytes[category] = 0;
+	}
+
+	addNode(scene->m_rootNode);
+
+	for (int meshIndex = 0; meshIndex < scene->m_meshes.getSize(); meshIndex++)
+	{
+		addMesh(scene->m_meshes[meshIndex]);
+	}
+
+	for (int skinIndex = 0; skinIndex < scene->m_skinBindings.getSize(); skinIndex++)
+	{
+		const hkxSkinBinding* skin = scene->m_skinBindings[skinIndex];
+		if (visit(skin))
+		{
+			addMesh(skin->m_mesh);
+			m_bytes[SKIN_BINDINGS] += skin->m_bindPose.getSize() * sizeof(hkMatrix4) + sizeof(hkMatrix4);
+			for (int nameIndex = 0; nameIndex < skin->m_nodeNames.getSize(); nameIndex++)
+			{
+				m_bytes[SKIN_BINDINGS] += getStringBytes(skin->m_nodeNames[nameIndex]);
+			}
+		}
+	}
+
+	// Materials and textures not referenced by any section are still saved with the scene
+	for (int materialIndex = 0; materialIndex < scene->m_materials.getSize(); materialIndex++)
+	{
+		addMaterial(scene->m_materials[materialIndex]);
+	}
+	for (int textureIndex = 0; textureIndex < scene->m_externalTextures.getSize(); textureIndex++)
+	{
+		addTexture(scene->m_externalTextures[textureIndex], &hkxTextureFileClass);
+	}
+	for (int textureIndex = 0; textureIndex < scene->m_inplaceTextures.getSize(); textureIndex++)
+	{
+		addTexture(scene->m_inplaceTextures[textureIndex], &hkxTextureInplaceClass);
+	}
+}
+
+const char* SceneSizeReport::getCategoryName(Category category)
+{
+	return s_categoryNames[category];
+}
+
+hkLong SceneSizeReport::getTotalBytes() const
+{
+	hkLong total = 0;
+	for (int category = 0; category < NUM_CATEGORIES; category++)
+	{
+		total += m_bytes[category];
+	}
+	return total;
+}
+
+bool SceneSizeReport::visit(const void* object)
+{
+	if (!object || m_visited.hasKey(object))
+	{
+		return false;
+	}
+	m_visited.insert(object, 1);
+	return true;
+}
+
+void SceneSizeReport::addNode(const hkxNode* node)
+{
+	if (!visit(node))
+	{
+		return;
+	}
+
+	m_numNodes++;
+	m_numKeyFrames += node->m_keyFrames.getSize();
+	m_bytes[KEYFRAMES] += node->m_keyFrames.getSize() * sizeof(hkMatrix4) + node->m_linearKeyFrameHints.getSize() * sizeof(hkReal);
+
+	for (int annotationIndex = 0; annotationIndex < node->m_annotations.getSize(); annotationIndex++)
+	{
+		m_bytes[ANNOTATIONS] += sizeof(hkReal) + getStringBytes(node->m_annotations[annotationIndex].m_description);
+	}
+
+	addAttributes(node, node->m_name);
+
+	for (int childIndex = 0; childIndex < node->m_children.getSize(); childIndex++)
+	{
+		addNode(node->m_children[childIndex]);
+	}
+}
+
+void SceneSizeReport::addMesh(const hkxMesh* mesh)
+{
+	if (!visit(mesh))
+	{
+		return;
+	}
+
+	for (int sectionIndex = 0; sectionIndex < mesh->m_sections.getSize(); sectionIndex++)
+	{
+		const hkxMeshSection* section = mesh->m_sections[sectionIndex];
+
+		const hkxVertexBuffer* vertexBuffer = section->m_vertexBuffer;
+		if (visit(vertexBuffer))
+		{
+			const int numVertices = vertexBuffer->getNumVertices();
+			const hkxVertexDescription& vertexDesc = vertexBuffer->getVertexDesc();
+			m_numVertices += numVertices;
+			for (int declIndex = 0; declIndex < vertexDesc.m_decls.getSize(); declIndex++)
+			{
+				const hkxVertexDescription::ElementDecl& decl = vertexDesc.m_decls[declIndex];
+				m_bytes[getVertexCategory(decl.m_usage)] += (hkLong)numVertices * decl.m_numElements * getDataTypeBytes(decl.m_type);
+			}
+		}
+
+		for (int indexBufferIndex = 0; indexBufferIndex < section->m_indexBuffers.getSize(); indexBufferIndex++)
+		{
+			const hkxIndexBuffer* indexBuffer = section->m_indexBuffers[indexBufferIndex];
+			if (visit(indexBuffer))
+			{
+				m_numIndices += indexBuffer->m_indices16.getSize() + indexBuffer->m_indices32.getSize();
+				m_bytes[INDEX_BUFFERS] += indexBuffer->m_indices16.getSize() * sizeof(hkUint16) + indexBuffer->m_indices32.getSize() * sizeof(hkUint32);
+			}
+		}
+
+		for (int channelIndex = 0; channelIndex < section->m_userChannels.getSize(); channelIndex++)
+		{
+			const hkRefVariant& channel = section->m_userChannels[channelIndex];
+			const hkClass* channelClass = channel.getClass();
+			if (!channelClass || !visit(channel.val()))
+			{
+				continue;
+			}
+
+			if (channelClass->equals(&hkxVertexSelectionChannelClass))
+			{
+				m_bytes[USER_CHANNELS] += ((const hkxVertexSelectionChannel*)channel.val())->m_selectedVertices.getSize() * sizeof(hkInt32);
+			}
+			else if (channelClass->equals(&hkxVertexFloatDataChannelClass))
+			{
+				m_bytes[USER_CHANNELS] += ((const hkxVertexFloatDataChannel*)channel.val())->m_perVertexFloats.getSize() * sizeof(hkFloat32);
+			}
+			else if (channelClass->equals(&hkxVertexIntDataChannelClass))
+			{
+				m_bytes[USER_CHANNELS] += ((const hkxVertexIntDataChannel*)channel.val())->m_perVertexInts.getSize() * sizeof(hkInt32);
+			}
+		}
+
+		addMaterial(section->m_material);
+	}
+}
+
+void SceneSizeReport::addMaterial(const hkxMaterial* material)
+{
+	if (!visit(material))
+	{
+		return;
+	}
+
+	m_bytes[MATERIALS] += sizeof(hkxMaterial) + getStringBytes(material->m_name) + material->m_stages.getSize() * sizeof(hkxMaterial::TextureStage);
+
+	for (int stageIndex = 0; stageIndex < material->m_stages.getSize(); stageIndex++)
+	{
+		const hkRefVariant& texture = material->m_stages[stageIndex].m_texture;
+		addTexture(texture.val(), texture.getClass());
+	}
+
+	addAttributes(material, material->m_name);
+
+	for (int subMaterialIndex = 0; subMaterialIndex < material->m_subMaterials.getSize(); subMaterialIndex++)
+	{
+		addMaterial(material->m_subMaterials[subMaterialIndex]);
+	}
+}
+
+void SceneSizeReport::addTexture(const void* texture, const hkClass* textureClass)
+{
+	if (!textureClass || !visit(texture))
+	{
+		return;
+	}
+
+	if (textureClass->equals(&hkxTextureInplaceClass))
+	{
+		const hkxTextureInplace* inplace = (const hkxTextureInplace*)texture;
+		m_bytes[TEXTURES] += inplace->m_data.getSize() + getStringBytes(inplace->m_name) + getStringBytes(inplace->m_originalFilename);
+	}
+	else if (textureClass->equals(&hkxTextureFileClass))
+	{
+		const hkxTextureFile* file = (const hkxTextureFile*)texture;
+		m_bytes[TEXTURES] += getStringBytes(file->m_filename) + getStringBytes(file->m_name) + getStringBytes(file->m_originalFilename);
+	}
+}
+
+void SceneSizeReport::addAttributes(const hkxAttributeHolder* holder, const char* ownerName)
+{
+	for (int groupIndex = 0; groupIndex < holder->m_attributeGroups.getSize(); groupIndex++)
+	{
+		const hkxAttributeGroup& group = holder->m_attributeGroups[groupIndex];
+		for (int attributeIndex = 0; attributeIndex < group.m_attributes.getSize(); attributeIndex++)
+		{
+			const hkxAttribute& attribute = group.m_attributes[attributeIndex];
+			const hkLong bytes = getStringBytes(attribute.m_name) + getAttributeValueBytes(attribute.m_value);
+			m_bytes[ATTRIBUTES] += bytes;
+
+			if (bytes > m_largestAttributeBytes)
+			{
+				m_largestAttributeBytes = bytes;
+				m_largestAttribute = ownerName ? ownerName : "";
+				m_largestAttribute += "/";
+				m_largestAttribute += group.m_name ? group.m_name.cString() : "";
+				m_largestAttribute += "/";
+				m_largestAttribute += attribute.m_name ? attribute.m_name.cString() : "";
+			}
+		}
+	}
+}
+
+void SceneSizeReport::print(const char* title) const
+{
+	const hkLong total = getTotalBytes();
+
+	if (m_fileBytes > 0)
+	{
+		printf("Size of %s: %lld bytes of scene data, %lld bytes on disk\n", title, (long long)total, (long long)m_fileBytes);
+	}
+	else
+	{
+		printf("Size of %s: %lld bytes of scene data\n", title, (long long)total);
+	}
+
+	for (int category = 0; category < NUM_CATEGORIES; category++)
+	{
+		if (m_bytes[category] == 0)
+		{
+			continue;
+		}
+
+		printf("%12lld  %5.1f%%  %s", (long long)m_bytes[category], total > 0 ? 100.0 * m_bytes[category] / total : 0.0, s_categoryNames[category]);
+		if (category == KEYFRAMES)
+		{
+			printf(" (%d keys on %d nodes)", m_numKeyFrames, m_numNodes);
+		}
+		else if (category == VERTEX_POSITIONS)
+		{
+			printf(" (%d vertices)", m_numVertices);
+		}
+		else if (category == INDEX_BUFFERS)
+		{
+			printf(" (%d indices)", m_numIndices);
+		}
+		printf("\n");
+	}
+
+	if (m_largestAttributeBytes > 0)
+	{
+		printf("Largest attribute: %s (%lld bytes)\n", m_largestAttribute.c_str(), (long long)m_largestAttributeBytes);
+	}
+}
+
+std::string SceneSizeReport::getJson() const
+{
+	char number[32];
+	std::string json;
+
+	sprintf(number, "%lld", (long long)m_fileBytes);
+	json += "{\"fileBytes\": ";
+	json += number;
+
+	sprintf(number, "%lld", (long long)getTotalBytes());
+	json += ", \"totalBytes\": ";
+	json += number;
+
+	for (int category = 0; category < NUM_CATEGORIES; category++)
+	{
+		sprintf(number, "%lld", (long long)m_bytes[category]);
+		json += ", \"";
+		json += s_categoryNames[category];
+		json += "\": ";
+		json += number;
+	}
+
+	if (m_largestAttributeBytes > 0)
+	{
+		sprintf(number, "%lld", (long long)m_largestAttributeBytes);
+		json += ", \"largestAttribute\": {\"name\": ";
+		appendJsonString(json, m_largestAttribute.c_str());
+		json += ", \"bytes\": ";
+		json += number;
+		json += "}";
+	}
+
+	json += "}";
+	return json;
+}
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
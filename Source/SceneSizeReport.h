@@ -0,0 +1,109 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_SCENESIZEREPORT
+#define HK_FBXTOHKX_SCENESIZEREPORT
+
+#include <Common/Base/hkBase.h>
+#include <Common/Base/Container/PointerMap/hkPointerMap.h>
+
+#include <string>
+
+class hkxScene;
+class hkxNode;
+class hkxAttributeHolder;
+class hkxMaterial;
+class hkxMesh;
+class hkClass;
+
+// Breakdown of the bytes held by a converted hkxScene (--sizes), by what they are spent on: the sampled node
+// keyframes, each vertex attribute, the index buffers and so on. The numbers are the payload of the arrays and
+// strings reached from the scene, each object counted once even if several nodes or sections share it. They are
+// not the bytes of the tag file (a text format), which is reported alongside for comparison.
+class SceneSizeReport
+{
+public:
+
+	enum Category
+	{
+		KEYFRAMES,
+		ANNOTATIONS,
+		VERTEX_POSITIONS,
+		VERTEX_NORMALS,
+		VERTEX_TANGENTS,
+		VERTEX_BINORMALS,
+		VERTEX_COLORS,
+		VERTEX_TEXCOORDS,
+		VERTEX_BLEND_WEIGHTS,
+		VERTEX_BLEND_INDICES,
+		VERTEX_OTHER,
+		INDEX_BUFFERS,
+		USER_CHANNELS,
+		SKIN_BINDINGS,
+		MATERIALS,
+		TEXTURES,
+		ATTRIBUTES,
+		NUM_CATEGORIES
+	};
+
+	// fileBytes is the size of the tag file holding the scene, 0 if it is not known
+	SceneSizeReport(const hkxScene* scene, hkLong fileBytes);
+
+	static const char* getCategoryName(Category category);
+
+	hkLong getBytes(Category category) const { return m_bytes[category]; }
+	hkLong getTotalBytes() const;
+
+	// Prints one line per non-empty category with its share of the total, and the largest attribute
+	void print(const char* title) const;
+
+	// {"fileBytes": 123456, "totalBytes": 98765, "keyframes": 81920, ..., "largestAttribute": {"name": "...", "bytes": 4096}}
+	std::string getJson() const;
+
+private:
+
+	SceneSizeReport(const SceneSizeReport&);
+	SceneSizeReport& operator=(const SceneSizeReport&);
+
+	bool visit(const void* object);
+	void addNode(const hkxNode* node);
+	void addMesh(const hkxMesh* mesh);
+	void addMaterial(const hkxMaterial* material);
+	void addTexture(const void* texture, const hkClass* textureClass);
+	void addAttributes(const hkxAttributeHolder* holder, const char* ownerName);
+
+	hkLong m_bytes[NUM_CATEGORIES];
+	hkLong m_fileBytes;
+	int m_numNodes;
+	int m_numKeyFrames;
+	int m_numVertices;
+	int m_numIndices;
+	// Runaway attribute curves are the usual surprise, so the biggest one is named
+	std::string m_largestAttribute;
+	hkLong m_largestAttributeBytes;
+	hkPointerMap<const void*, int> m_visited;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,235 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#ifndef HK_FBXTOHKX_SCENESOURCE
+#define HK_FBXTOHKX_SCENESOURCE
+
+#include <string>
+#include <vector>
+
+// The parts of a source scene the mesh, skin and keyframe pipelines (ScenePipeline.h) read, as flat arrays. This
+// header and the in-memory implementation (MemorySceneSource.h) use only the standard library, so the pipelines build
+// and can be profiled without the FBX SDK or Havok. FbxSceneSource.h reads an FbxScene.
+
+// Keys of one animation curve, times in seconds
+struct SceneCurve
+{
+	std::vector<double> m_times;
+	std::vector<float> m_values;
+};
+
+// A file texture of a material
+struct SceneTexture
+{
+	enum Usage
+	{
+		DIFFUSE,
+		SPECULAR,
+		EMISSIVE,
+		BUMP,
+		DISPLACEMENT,
+		NORMAL,
+		REFLECTION,
+		OPACITY
+	};
+
+	SceneTexture() : m_usage(DIFFUSE), m_data(NULL), m_dataSize(0) {}
+
+	Usage m_usage;
+	std::string m_name;
+	std::string m_fileName;
+	// UV set of the mesh the texture is mapped with, the first one if empty or not found
+	std::string m_uvSetName;
+	// The encoded image if it is embedded in the source file (valid while the source exists), NULL for a file texture.
+	// m_fileType is its format as an upper case extension (PNG, JPG).
+	const unsigned char* m_data;
+	size_t m_dataSize;
+	std::string m_fileType;
+};
+
+// Colors are r, g, b, a. The alpha of the diffuse color is the opacity.
+struct SceneMaterial
+{
+	SceneMaterial() : m_id(-1), m_specularExponent(1.f), m_specularMultiplier(0.f), m_transparent(false)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			m_ambient[i] = m_emissive[i] = 0.f;
+			m_diffuse[i] = m_specular[i] = 1.f;
+		}
+	}
+
+	// Identifies the material in the source scene: materials of different meshes with the same id are the same one,
+	// whatever their names. -1 if the source can't tell, the material is then converted for every mesh section.
+	long long m_id;
+	std::string m_name;
+	float m_ambient[4];
+	float m_diffuse[4];
+	float m_specular[4];
+	float m_emissive[4];
+	float m_specularExponent;
+	float m_specularMultiplier;
+	// Set if the material is alpha blended
+	bool m_transparent;
+	std::vector<SceneTexture> m_textures;
+};
+
+// A morph target of a mesh, as the offsets from the mesh to the target. Only the control points that move are listed.
+struct SceneBlendShape
+{
+	SceneBlendShape() : m_fullWeight(1.f) {}
+
+	std::string m_name;
+	// The blend shape channel the target belongs to, and the channel weight (0 to 1) at which it is fully applied. A
+	// channel with in-between targets has one target per full weight.
+	std::string m_channelName;
+	float m_fullWeight;
+	// Control points that move, and the x, y, z offset of each of them
+	std::vector<int> m_controlPoints;
+	std::vector<float> m_positionDeltas;
+	// x, y, z normal offset per corner (like SceneMesh::m_normals), empty if the target has no normals
+	std::vector<float> m_normalDeltas;
+};
+
+// A triangulated mesh. The per corner arrays hold one entry (of the given number of floats) for each of the three
+// corners of each triangle, in triangle order, and are empty if the mesh has no such layer.
+struct SceneMesh
+{
+	SceneMesh() : m_flipped(false) {}
+
+	int getNumControlPoints() const { return (int)m_positions.size() / 3; }
+	int getNumTriangles() const { return (int)m_triangles.size() / 3; }
+	bool isSkinned() const { return !m_skinWeights.empty(); }
+
+	// x, y, z of each control point, in the space of the node (its geometric transform applied)
+	std::vector<float> m_positions;
+	// Three control point indices per triangle
+	std::vector<int> m_triangles;
+	// x, y, z per corner
+	std::vector<float> m_normals;
+	// r, g, b, a per corner
+	std::vector<float> m_colors;
+	// u, v per corner for each UV set
+	std::vector<std::string> m_uvSetNames;
+	std::vector<std::vector<float> > m_uvSets;
+	// Four influences per control point: skin cluster index and weight, unused ones are cluster 0 with weight 0
+	std::vector<int> m_skinClusters;
+	std::vector<float> m_skinWeights;
+	// Node of each skin cluster, and the global transform of that node when the mesh was bound (16 values per
+	// cluster, see SceneSource::evaluateLocalTransform())
+	std::vector<int> m_clusterNodes;
+	std::vector<double> m_clusterBindPoses;
+	// Materials of the mesh, and the index of the material of each triangle (empty if all use the first one)
+	std::vector<SceneMaterial> m_materials;
+	std::vector<int> m_triangleMaterials;
+	// Morph targets, in the order of their channels
+	std::vector<SceneBlendShape> m_blendShapes;
+	// Set if the node is mirrored (an odd number of negative scales up its hierarchy), so its winding is flipped
+	bool m_flipped;
+};
+
+class SceneSource
+{
+public:
+
+	enum NodeType
+	{
+		NODE_NULL,
+		NODE_SKELETON,
+		NODE_MESH,
+		NODE_CAMERA,
+		NODE_LIGHT,
+		NODE_SPLINE,
+		NODE_OTHER
+	};
+
+	// Components of the local transform, rotations are Euler angles in degrees
+	enum Channel
+	{
+		TRANSLATION_X, TRANSLATION_Y, TRANSLATION_Z,
+		ROTATION_X, ROTATION_Y, ROTATION_Z,
+		SCALING_X, SCALING_Y, SCALING_Z,
+		NUM_CHANNELS
+	};
+
+	// Signed coordinate axes
+	enum Axis
+	{
+		AXIS_POSITIVE_X, AXIS_NEGATIVE_X,
+		AXIS_POSITIVE_Y, AXIS_NEGATIVE_Y,
+		AXIS_POSITIVE_Z, AXIS_NEGATIVE_Z
+	};
+
+	// The axis system and unit of the scene coordinates, as stored in an FBX file: the axes pointing right, up and
+	// towards the viewer (front). Defaults to the 3ds Max axis system in centimeters, which is what the converter
+	// outputs (see computeOutputBasis() in ScenePipeline.h).
+	struct CoordinateSystem
+	{
+		CoordinateSystem() : m_right(AXIS_POSITIVE_X), m_up(AXIS_POSITIVE_Z), m_front(AXIS_NEGATIVE_Y), m_unitMeters(0.01) {}
+
+		Axis m_right;
+		Axis m_up;
+		Axis m_front;
+		// Length of a unit in meters
+		double m_unitMeters;
+	};
+
+	struct Stack
+	{
+		std::string m_name;
+		double m_start;
+		double m_stop;
+		// Frames sampled from the start (at the frame rate of the scene) before the stop
+		int m_numFrames;
+	};
+
+	virtual ~SceneSource() {}
+
+	// The node tree, node 0 is the root (its parent is -1)
+	virtual int getNumNodes() const = 0;
+	virtual int getParent(int node) const = 0;
+	virtual int getNumChildren(int node) const = 0;
+	virtual int getChild(int node, int childIndex) const = 0;
+	virtual const char* getNodeName(int node) const = 0;
+	virtual NodeType getNodeType(int node) const = 0;
+
+	// The transforms, meshes and bind poses are in this system, they are not converted by the source
+	virtual void getCoordinateSystem(CoordinateSystem& systemOut) const = 0;
+
+	// Returns false if the node has no mesh
+	virtual bool getMesh(int node, SceneMesh& meshOut) const = 0;
+
+	virtual int getNumStacks() const = 0;
+	virtual void getStack(int stack, Stack& stackOut) const = 0;
+
+	// Keys of a channel of the node's local transform in the stack, returns false if the channel is not animated
+	virtual bool getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const = 0;
+
+	// The local transform of the node at a frame of the stack, or at time 0 for stack -1. The matrix is stored as
+	// four columns of four values (translation in 12, 13 and 14), like hkMatrix4.
+	virtual void evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const = 0;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,425 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+
+#include "UfbxSceneSource.h"
+
+#ifdef FBXTOHKX_WITH_UFBX
+
+#include <ufbx.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	void copyMatrix(const ufbx_matrix& matrix, double* matrixOut)
+	{
+		// ufbx matrices are the first three rows of four columns
+		for (int column = 0; column < 4; column++)
+		{
+			matrixOut[column * 4] = matrix.cols[column].x;
+			matrixOut[column * 4 + 1] = matrix.cols[column].y;
+			matrixOut[column * 4 + 2] = matrix.cols[column].z;
+			matrixOut[column * 4 + 3] = (column == 3) ? 1.0 : 0.0;
+		}
+	}
+
+	std::string toString(const ufbx_string& string)
+	{
+		return std::string(string.data, string.length);
+	}
+
+	// True if an odd number of the node and its ancestors have a negative scale
+	bool isNodeFlipped(const ufbx_node* node)
+	{
+		bool flipped = false;
+		for (; node != NULL; node = node->parent)
+		{
+			const ufbx_vec3& scale = node->local_transform.scale;
+			flipped = (flipped != (scale.x * scale.y * scale.z < 0));
+		}
+		return flipped;
+	}
+
+	void readColor(const ufbx_material_map& map, float alpha, float* colorOut)
+	{
+		colorOut[0] = (float)map.value_vec3.x;
+		colorOut[1] = (float)map.value_vec3.y;
+		colorOut[2] = (float)map.value_vec3.z;
+		colorOut[3] = alpha;
+	}
+
+	void readTexture(const ufbx_material_map& map, SceneTexture::Usage usage, std::vector<SceneTexture>& texturesOut)
+	{
+		const ufbx_texture* texture = map.texture;
+		if (texture && texture->type == UFBX_TEXTURE_FILE)
+		{
+			SceneTexture sceneTexture;
+			sceneTexture.m_usage = usage;
+			sceneTexture.m_name = toString(texture->name);
+			sceneTexture.m_fileName = toString(texture->absolute_filename.length > 0 ? texture->absolute_filename : texture->filename);
+			sceneTexture.m_uvSetName = toString(texture->uv_set);
+			texturesOut.push_back(sceneTexture);
+		}
+	}
+
+	// The FBX Phong and Lambert properties, like FbxToHkxConverter::createMaterial()
+	void readMaterial(const ufbx_material* material, SceneMaterial& materialOut)
+	{
+		materialOut.m_id = material->typed_id;
+		materialOut.m_name = toString(material->name);
+
+		const ufbx_material_fbx_maps& fbx = material->fbx;
+		const float transparency = 1.0f - (float)fbx.transparency_factor.value_real;
+
+		readColor(fbx.ambient_color, 0.f, materialOut.m_ambient);
+		readColor(fbx.diffuse_color, transparency, materialOut.m_diffuse);
+		readColor(fbx.emission_color, 0.f, materialOut.m_emissive);
+		if (material->shader_type == UFBX_SHADER_FBX_PHONG)
+		{
+			readColor(fbx.specular_color, transparency, materialOut.m_specular);
+			materialOut.m_specularExponent = (float)fbx.specular_exponent.value_real;
+			materialOut.m_specularMultiplier = (float)fbx.specular_factor.value_real;
+		}
+
+		readTexture(fbx.diffuse_color, SceneTexture::DIFFUSE, materialOut.m_textures);
+		readTexture(fbx.specular_color, SceneTexture::SPECULAR, materialOut.m_textures);
+		readTexture(fbx.emission_color, SceneTexture::EMISSIVE, materialOut.m_textures);
+		readTexture(fbx.bump, SceneTexture::BUMP, materialOut.m_textures);
+		readTexture(fbx.displacement_factor, SceneTexture::DISPLACEMENT, materialOut.m_textures);
+		readTexture(fbx.normal_map, SceneTexture::NORMAL, materialOut.m_textures);
+		readTexture(fbx.reflection_color, SceneTexture::REFLECTION, materialOut.m_textures);
+		readTexture(fbx.transparency_factor, SceneTexture::OPACITY, materialOut.m_textures);
+
+		materialOut.m_transparent = fbx.transparency_factor.has_value;
+	}
+}
+
+SceneSource* UfbxSceneSource::load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData, size_t fileSize, bool skipGeometry)
+{
+	ufbx_load_opts options = {};
+	options.ignore_geometry = skipGeometry;
+	// The axes and units are converted by the converter (see getCoordinateSystem())
+
+	ufbx_error error;
+	ufbx_scene* scene = fileData ? ufbx_load_memory(fileData, fileSize, &options, &error) : ufbx_load_file(filename, &options, &error);
+	if (scene == NULL)
+	{
+		char description[1024];
+		ufbx_format_error(description, sizeof(description), &error);
+		errorOut = description;
+		return NULL;
+	}
+
+	applicationOut = toString(scene->metadata.original_application.name);
+	return new UfbxSceneSource(scene);
+}
+
+UfbxSceneSource::UfbxSceneSource(ufbx_scene* scene) :
+	m_scene(scene)
+{
+	m_nodeIndices.resize(m_scene->nodes.count, -1);
+	addNodesRecursive(m_scene->root_node);
+}
+
+UfbxSceneSource::~UfbxSceneSource()
+{
+	ufbx_free_scene(m_scene);
+}
+
+void UfbxSceneSource::addNodesRecursive(const ufbx_node* node)
+{
+	m_nodeIndices[node->typed_id] = (int)m_nodes.size();
+	m_nodes.push_back(node);
+
+	for (size_t childIndex = 0; childIndex < node->children.count; childIndex++)
+	{
+		addNodesRecursive(node->children.data[childIndex]);
+	}
+}
+
+int UfbxSceneSource::getNumNodes() const
+{
+	return (int)m_nodes.size();
+}
+
+int UfbxSceneSource::getParent(int node) const
+{
+	const ufbx_node* parent = m_nodes[node]->parent;
+	return parent ? m_nodeIndices[parent->typed_id] : -1;
+}
+
+int UfbxSceneSource::getNumChildren(int node) const
+{
+	return (int)m_nodes[node]->children.count;
+}
+
+int UfbxSceneSource::getChild(int node, int childIndex) const
+{
+	return m_nodeIndices[m_nodes[node]->children.data[childIndex]->typed_id];
+}
+
+const char* UfbxSceneSource::getNodeName(int node) const
+{
+	return m_nodes[node]->name.data;
+}
+
+void UfbxSceneSource::getCoordinateSystem(CoordinateSystem& systemOut) const
+{
+	// ufbx_coordinate_axis is in the order of SceneSource::Axis
+	const ufbx_coordinate_axes& axes = m_scene->settings.axes;
+	systemOut = CoordinateSystem();
+	if (axes.right != UFBX_COORDINATE_AXIS_UNKNOWN && axes.up != UFBX_COORDINATE_AXIS_UNKNOWN && axes.front != UFBX_COORDINATE_AXIS_UNKNOWN)
+	{
+		systemOut.m_right = (Axis)axes.right;
+		systemOut.m_up = (Axis)axes.up;
+		systemOut.m_front = (Axis)axes.front;
+	}
+	if (m_scene->settings.unit_meters > 0.0)
+	{
+		systemOut.m_unitMeters = m_scene->settings.unit_meters;
+	}
+}
+
+SceneSource::NodeType UfbxSceneSource::getNodeType(int node) const
+{
+	if (m_nodes[node]->attrib == NULL)
+	{
+		return NODE_NULL;
+	}
+
+	switch (m_nodes[node]->attrib_type)
+	{
+	case UFBX_ELEMENT_EMPTY: return NODE_NULL;
+	case UFBX_ELEMENT_BONE: return NODE_SKELETON;
+	case UFBX_ELEMENT_MESH: return NODE_MESH;
+	case UFBX_ELEMENT_CAMERA: return NODE_CAMERA;
+	case UFBX_ELEMENT_LIGHT: return NODE_LIGHT;
+	case UFBX_ELEMENT_NURBS_CURVE: return NODE_SPLINE;
+	default: return NODE_OTHER;
+	}
+}
+
+bool UfbxSceneSource::getMesh(int node, SceneMesh& meshOut) const
+{
+	const ufbx_node* meshNode = m_nodes[node];
+	const ufbx_mesh* mesh = meshNode->mesh;
+	if (mesh == NULL)
+	{
+		return false;
+	}
+
+	meshOut = SceneMesh();
+	meshOut.m_flipped = isNodeFlipped(meshNode);
+
+	// Positions with the geometric transform of the node applied
+	const int numControlPoints = (int)mesh->num_vertices;
+	meshOut.m_positions.resize(numControlPoints * 3);
+	for (int controlPoint = 0; controlPoint < numControlPoints; controlPoint++)
+	{
+		const ufbx_vec3 position = ufbx_transform_position(&meshNode->geometry_to_node, mesh->vertices.data[controlPoint]);
+		meshOut.m_positions[controlPoint * 3] = (float)position.x;
+		meshOut.m_positions[controlPoint * 3 + 1] = (float)position.y;
+		meshOut.m_positions[controlPoint * 3 + 2] = (float)position.z;
+	}
+
+	// Triangulate the faces, keeping the mesh index of each corner for the layers
+	std::vector<uint32_t> cornerIndices;
+	cornerIndices.reserve(mesh->num_triangles * 3);
+	std::vector<uint32_t> faceCorners(mesh->max_face_triangles * 3);
+	for (size_t faceIndex = 0; faceIndex < mesh->num_faces; faceIndex++)
+	{
+		const uint32_t numFaceTriangles = ufbx_triangulate_face(faceCorners.data(), faceCorners.size(), mesh, mesh->faces.data[faceIndex]);
+		cornerIndices.insert(cornerIndices.end(), faceCorners.begin(), faceCorners.begin() + numFaceTriangles * 3);
+		if (mesh->face_material.count > 0)
+		{
+			meshOut.m_triangleMaterials.insert(meshOut.m_triangleMaterials.end(), numFaceTriangles, (int)mesh->face_material.data[faceIndex]);
+		}
+	}
+
+	const int numCorners = (int)cornerIndices.size();
+	meshOut.m_triangles.resize(numCorners);
+	for (int corner = 0; corner < numCorners; corner++)
+	{
+		meshOut.m_triangles[corner] = (int)mesh->vertex_indices.data[cornerIndices[corner]];
+	}
+
+	if (mesh->vertex_normal.exists)
+	{
+		meshOut.m_normals.resize(numCorners * 3);
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			const ufbx_vec3 normal = ufbx_get_vertex_vec3(&mesh->vertex_normal, cornerIndices[corner]);
+			meshOut.m_normals[corner * 3] = (float)normal.x;
+			meshOut.m_normals[corner * 3 + 1] = (float)normal.y;
+			meshOut.m_normals[corner * 3 + 2] = (float)normal.z;
+		}
+	}
+
+	if (mesh->vertex_color.exists)
+	{
+		meshOut.m_colors.resize(numCorners * 4);
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			const ufbx_vec4 color = ufbx_get_vertex_vec4(&mesh->vertex_color, cornerIndices[corner]);
+			meshOut.m_colors[corner * 4] = (float)color.x;
+			meshOut.m_colors[corner * 4 + 1] = (float)color.y;
+			meshOut.m_colors[corner * 4 + 2] = (float)color.z;
+			meshOut.m_colors[corner * 4 + 3] = (float)color.w;
+		}
+	}
+
+	meshOut.m_uvSetNames.resize(mesh->uv_sets.count);
+	meshOut.m_uvSets.resize(mesh->uv_sets.count);
+	for (size_t uvSetIndex = 0; uvSetIndex < mesh->uv_sets.count; uvSetIndex++)
+	{
+		const ufbx_uv_set& uvSet = mesh->uv_sets.data[uvSetIndex];
+		meshOut.m_uvSetNames[uvSetIndex] = toString(uvSet.name);
+
+		std::vector<float>& uvs = meshOut.m_uvSets[uvSetIndex];
+		uvs.resize(numCorners * 2);
+		for (int corner = 0; corner < numCorners; corner++)
+		{
+			const ufbx_vec2 uv = ufbx_get_vertex_vec2(&uvSet.vertex_uv, cornerIndices[corner]);
+			uvs[corner * 2] = (float)uv.x;
+			uvs[corner * 2 + 1] = (float)uv.y;
+		}
+	}
+
+	// The first four clusters influencing a control point are kept
+	if (mesh->skin_deformers.count > 0)
+	{
+		const ufbx_skin_deformer* skin = mesh->skin_deformers.data[0];
+
+		meshOut.m_skinClusters.resize(numControlPoints * 4, -1);
+		meshOut.m_skinWeights.resize(numControlPoints * 4, 0.f);
+
+		const int numClusters = (int)skin->clusters.count;
+		meshOut.m_clusterNodes.resize(numClusters);
+		meshOut.m_clusterBindPoses.resize(numClusters * 16);
+		for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+		{
+			const ufbx_skin_cluster* cluster = skin->clusters.data[clusterIndex];
+			meshOut.m_clusterNodes[clusterIndex] = cluster->bone_node ? m_nodeIndices[cluster->bone_node->typed_id] : -1;
+			copyMatrix(cluster->bind_to_world, &meshOut.m_clusterBindPoses[clusterIndex * 16]);
+
+			for (size_t k = 0; k < cluster->vertices.count; k++)
+			{
+				const int controlPointFour = (int)cluster->vertices.data[k] * 4;
+				for (int i = controlPointFour; i < controlPointFour + 4; ++i)
+				{
+					if (meshOut.m_skinClusters[i] < 0)
+					{
+						meshOut.m_skinClusters[i] = clusterIndex;
+						meshOut.m_skinWeights[i] = (float)cluster->weights.data[k];
+						break;
+					}
+				}
+			}
+		}
+
+		// Zero unused indices
+		std::replace(meshOut.m_skinClusters.begin(), meshOut.m_skinClusters.end(), -1, 0);
+	}
+
+	for (size_t materialIndex = 0; materialIndex < meshNode->materials.count; materialIndex++)
+	{
+		meshOut.m_materials.push_back(SceneMaterial());
+		readMaterial(meshNode->materials.data[materialIndex], meshOut.m_materials.back());
+	}
+
+	return true;
+}
+
+int UfbxSceneSource::getNumStacks() const
+{
+	return (int)m_scene->anim_stacks.count;
+}
+
+void UfbxSceneSource::getStack(int stack, Stack& stackOut) const
+{
+	const ufbx_anim_stack* animStack = m_scene->anim_stacks.data[stack];
+
+	stackOut.m_name = toString(animStack->name);
+	stackOut.m_start = animStack->time_begin;
+	stackOut.m_stop = animStack->time_end;
+
+	const double frames = (animStack->time_end - animStack->time_begin) * m_scene->settings.frames_per_second;
+	stackOut.m_numFrames = (frames > 0.0) ? (int)ceil(frames - 1e-6) : 0;
+}
+
+bool UfbxSceneSource::getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const
+{
+	const ufbx_anim_stack* animStack = m_scene->anim_stacks.data[stack];
+	if (animStack->layers.count == 0)
+	{
+		return false;
+	}
+
+	static const char* properties[3] = { UFBX_Lcl_Translation, UFBX_Lcl_Rotation, UFBX_Lcl_Scaling };
+
+	const ufbx_anim_prop* prop = ufbx_find_anim_prop(animStack->layers.data[0], &m_nodes[node]->element, properties[channel / 3]);
+	const ufbx_anim_curve* curve = prop ? prop->anim_value->curves[channel % 3] : NULL;
+	if (curve == NULL)
+	{
+		return false;
+	}
+
+	const size_t numKeys = curve->keyframes.count;
+	curveOut.m_times.resize(numKeys);
+	curveOut.m_values.resize(numKeys);
+	for (size_t keyIndex = 0; keyIndex < numKeys; keyIndex++)
+	{
+		curveOut.m_times[keyIndex] = curve->keyframes.data[keyIndex].time;
+		curveOut.m_values[keyIndex] = (float)curve->keyframes.data[keyIndex].value;
+	}
+	return true;
+}
+
+void UfbxSceneSource::evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const
+{
+	const ufbx_anim* anim = m_scene->anim;
+	double time = 0.0;
+	if (stack >= 0)
+	{
+		const ufbx_anim_stack* animStack = m_scene->anim_stacks.data[stack];
+		anim = animStack->anim;
+		time = animStack->time_begin + frame / m_scene->settings.frames_per_second;
+	}
+
+	const ufbx_transform transform = ufbx_evaluate_transform(anim, m_nodes[node], time);
+	const ufbx_matrix matrix = ufbx_transform_to_matrix(&transform);
+	copyMatrix(matrix, matrixOut);
+}
+
+#else
+
+SceneSource* UfbxSceneSource::load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData, size_t fileSize, bool skipGeometry)
+{
+	errorOut = "FBXImporter was built without ufbx (see UfbxSceneSource.h)";
+	return NULL;
+}
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
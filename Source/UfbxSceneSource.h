@@ -0,0 +1,82 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+
+#ifndef HK_FBXTOHKX_UFBXSCENESOURCE
+#define HK_FBXTOHKX_UFBXSCENESOURCE
+
+#include "SceneSource.h"
+
+struct ufbx_scene;
+struct ufbx_node;
+
+// SceneSource of an FBX file parsed with ufbx (https://github.com/ufbx/ufbx) instead of the FBX SDK: --loader ufbx.
+// ufbx reads the file in one pass into flat arrays, which is faster and needs far less memory than importing an
+// FbxScene, and does not depend on an SDK build.
+//
+// ufbx is not part of this repository. To build with it, add ufbx.c to the project, ufbx.h to the include path and
+// define FBXTOHKX_WITH_UFBX; without it load() reports that the loader is not available.
+//
+// Like the SDK path the scene keeps the axis system and unit of the file, the converter changes them to its output
+// (see SceneSource::getCoordinateSystem()). The nodes are numbered depth first from the root node, transforms are
+// evaluated by ufbx (pivots and rotation orders included, constraints are not evaluated).
+class UfbxSceneSource : public SceneSource
+{
+public:
+
+	// Returns NULL (and the reason in errorOut) if the file cannot be loaded. applicationOut receives the name of the
+	// application that wrote the file. If fileData is given it holds the contents of the file, which is not read then.
+	// With skipGeometry the mesh nodes are loaded without their vertices and faces, getMesh() must not be called.
+	static SceneSource* load(const char* filename, std::string& applicationOut, std::string& errorOut, const void* fileData = NULL, size_t fileSize = 0, bool skipGeometry = false);
+
+	~UfbxSceneSource();
+
+	// SceneSource
+	virtual int getNumNodes() const;
+	virtual int getParent(int node) const;
+	virtual int getNumChildren(int node) const;
+	virtual int getChild(int node, int childIndex) const;
+	virtual const char* getNodeName(int node) const;
+	virtual NodeType getNodeType(int node) const;
+	virtual void getCoordinateSystem(CoordinateSystem& systemOut) const;
+	virtual bool getMesh(int node, SceneMesh& meshOut) const;
+	virtual int getNumStacks() const;
+	virtual void getStack(int stack, Stack& stackOut) const;
+	virtual bool getCurve(int node, int stack, Channel channel, SceneCurve& curveOut) const;
+	virtual void evaluateLocalTransform(int node, int stack, int frame, double matrixOut[16]) const;
+
+private:
+
+	explicit UfbxSceneSource(ufbx_scene* scene);
+	UfbxSceneSource(const UfbxSceneSource&);
+	UfbxSceneSource& operator=(const UfbxSceneSource&);
+
+	void addNodesRecursive(const ufbx_node* node);
+
+	ufbx_scene* m_scene;
+	std::vector<const ufbx_node*> m_nodes;
+	// Node index of each ufbx node, by its typed_id
+	std::vector<int> m_nodeIndices;
+};
+
+#endif
+
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -28,8 +28,31 @@
 #include <Common/SceneData/Mesh/hkxMesh.h>
 
 #include "FbxToHkxConverter.h"
+#include "ExportData.h"
+#include "ConversionCache.h"
+#include "ConversionManifest.h"
+#include "ConversionProfiler.h"
+#include "ConversionMemoryStats.h"
+#include "ConversionServer.h"
+#include "ConversionBenchmark.h"
+#include "FbxMemoryStream.h"
+#include "ImportOptions.h"
+#include "FileUtil.h"
+#include "UfbxSceneSource.h"
+#include "GltfSceneSource.h"
+#include "LoaderComparison.h"
+#include "ScenePipeline.h"
 
 #include <sys/stat.h> // for stat (check folder exist)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 static void HK_CALL havokErrorReport(const char* msg, void*)
 {
@@ -37,172 +60,952 @@ static void HK_CALL havokErrorReport(const char* msg, void*)
 	printf("%s\n", msg);
 }
 
-int main(int argc, char* argv[])
+// Creating and destroying managers registers and unregisters the SDK plugins, which is kept off the worker threads' way
+static std::mutex s_fbxManagerMutex;
+
+static FbxManager* createFbxManager()
 {
-	// initialize Havok internals
+	std::lock_guard<std::mutex> lock(s_fbxManagerMutex);
+	return FbxManager::Create();
+}
+
+static void destroyFbxManager(FbxManager* fbxSdkManager)
+{
+	std::lock_guard<std::mutex> lock(s_fbxManagerMutex);
+	fbxSdkManager->Destroy();
+}
+
+struct ConversionSettings
+{
+	bool m_noTakes;
+	bool m_singleContainer;
+	const char* m_exportDataFolder;
+	// Contents of the input file if it was received in memory (the input name then only names the outputs and locates
+	// the export data), NULL to read the file
+	const void* m_inputData;
+	size_t m_inputSize;
+	const char* m_cacheFolder;
+	// JSON manifest of the conversion results, may be NULL (in batch mode the folder receiving one per input file)
+	const char* m_manifestFile;
+	// Times the conversion phases, may be NULL
+	ConversionProfiler* m_profiler;
+	// Samples the memory use at each phase boundary, may be NULL
+	ConversionMemoryStats* m_memoryStats;
+	// Print the size breakdown of every saved scene and add it to the manifest
+	bool m_reportSizes;
+	// Load the file with ufbx instead of the FBX SDK
+	bool m_ufbxLoader;
+	// The content that is imported and converted (the flags listed in ImportOptions.h)
+	const FbxToHkxConverter::Options* m_importOptions;
+	// Length of an output unit in meters, 0 keeps the unit of the input
+	double m_unitMeters;
+	// Largest bone palette of a skinned mesh section, 0 only splits skins of more than 256 bones
+	int m_maxSkinBones;
+	// Receives the report lines of the conversion, may be NULL
+	void (*m_reportFunction)(const char* line, void* userData);
+	void* m_reportUserData;
+	// Manager of the calling worker thread that the files are imported into one after the other, NULL to create one
+	// per file
+	FbxManager* m_fbxSdkManager;
+};
+
+// A manager of the settings stays alive for the next file, only the scene imported into it is destroyed
+static void releaseLoadedScene(const ConversionSettings& settings, FbxManager* fbxSdkManager, FbxScene* fbxScene, SceneSource* sceneSource)
+{
+	if (fbxSdkManager && fbxSdkManager == settings.m_fbxSdkManager)
 	{
-		hkMemorySystem::FrameInfo frameInfo(0);
+		if (fbxScene)
+		{
+			fbxScene->Destroy();
+		}
+	}
+	else if (fbxSdkManager)
+	{
+		destroyFbxManager(fbxSdkManager);
+	}
+	delete sceneSource;
+}
 
-#ifdef _DEBUG
-		// (Use debug mem manager to detect mem leaks in Havok code)
-		hkMemoryRouter* memoryRouter = hkMemoryInitUtil::initChecking(hkMallocAllocator::m_defaultMallocAllocator, frameInfo);
-#else
-		hkMemoryRouter* memoryRouter = hkMemoryInitUtil::initFreeListLargeBlock(hkMallocAllocator::m_defaultMallocAllocator, frameInfo);
-#endif
+static void sampleMemory(const ConversionSettings& settings, const char* phase)
+{
+	if (settings.m_memoryStats)
+	{
+		settings.m_memoryStats->samplePhase(phase);
+	}
+}
 
-		hkBaseSystem::init( memoryRouter, havokErrorReport );
+// Imports the file with the FBX SDK into the manager of the settings, or a new one. Returns NULL if it cannot be
+// imported, otherwise the scene is owned by fbxSdkManagerOut (release it with releaseLoadedScene()).
+static FbxScene* importFbxScene(const ConversionSettings& settings, const char* filename, FbxManager*& fbxSdkManagerOut)
+{
+	FbxManager* fbxSdkManager = settings.m_fbxSdkManager ? settings.m_fbxSdkManager : createFbxManager();
+	if( !fbxSdkManager )
+	{
+		HK_WARN(0x5213afed, "Unable to create FBX Manager!\n");
+		return NULL;
+	}
 
-		hkError& errorhandler = hkError::getInstance();
-		errorhandler.enableAll();
+	// A reused manager keeps its IO settings, the import options below overwrite all the flags they touch
+	FbxIOSettings* fbxIoSettings = fbxSdkManager->GetIOSettings();
+	if (!fbxIoSettings)
+	{
+		fbxIoSettings = FbxIOSettings::Create(fbxSdkManager, IOSROOT);
+		fbxSdkManager->SetIOSettings(fbxIoSettings);
 	}
+	// Content that is not converted is skipped by the readers instead of being parsed and dropped
+	applyImportOptions(*settings.m_importOptions, fbxIoSettings);
 
-	bool noTakes = false;
-	const char* inputFile = NULL;
-	const char* outputFile = NULL;
-	const char* exportDataFolder = NULL;
-	// Parse command line
-	hkOptionParser parser("FBXImporter", "Converts an fbx file into a havok tagfile (.hkt)");
+	// The SDK reads the mapped file (or the buffer received in memory) instead of doing its own buffered reads
+	FbxMemoryStream stream(fbxSdkManager);
+	if (settings.m_inputData)
 	{
-		hkOptionParser::Option options[] = 
-		{
-			hkOptionParser::Option("t", "noTakes", "if set, the first animation take is stored in input.hkt and additional takes are ignored.", &noTakes, false),
-			hkOptionParser::Option("o", "output", "the absolute path to the output filename. If left unspecified, the input filename is used instead with a changed extension.", &outputFile),
-			hkOptionParser::Option("d", "data", "absolute path to folder with mesh-related export data (for hkxVertexSelectionSets). If left unspecified, the input file path is used instead with a changed extension.", &exportDataFolder)
-		};
+		stream.setBuffer(settings.m_inputData, settings.m_inputSize);
+	}
+	else if (!stream.openFile(filename))
+	{
+		HK_WARN(0x5216afed, "Failed to open " << filename << "! Please ensure the file exists\n");
+		releaseLoadedScene(settings, fbxSdkManager, NULL, NULL);
+		return NULL;
+	}
 
-		if (parser.setOptions(options, HK_COUNT_OF(options)))
+	FbxImporter* fbxImporter = FbxImporter::Create(fbxSdkManager,"");
+
+	if (!fbxImporter->Initialize(&stream, NULL, -1, fbxSdkManager->GetIOSettings()))
+	{
+		HK_WARN(0x5216afed, "Failed to initialize the importer! Please ensure file " << filename << " is an FBX file\n");
+		fbxImporter->Destroy();
+		releaseLoadedScene(settings, fbxSdkManager, NULL, NULL);
+		return NULL;
+	}
+
+	printf("creating fbxsdk manager... \r\n");
+	FbxScene* fbxScene = FbxScene::Create(fbxSdkManager,"tempScene");
+	if (!fbxScene)
+	{
+		HK_WARN(0x5216afed, "Failed to create the scene!\n");
+		fbxImporter->Destroy();
+		releaseLoadedScene(settings, fbxSdkManager, NULL, NULL);
+		return NULL;
+	}
+
+	{
+		ConversionProfiler::Scope importScope(settings.m_profiler, "FbxImporter::Import", "phase", filename);
+		fbxImporter->Import(fbxScene);
+	}
+	fbxImporter->Destroy();
+	sampleMemory(settings, "import");
+
+	// The scene keeps the axis system and unit of the file, the converter changes them as it writes the output
+	// (FbxToHkxConverter::Options::m_unitMeters) instead of converting the whole scene up front
+	fbxSdkManagerOut = fbxSdkManager;
+	return fbxScene;
+}
+
+// glTF and GLB files are read with cgltf, FBX files with the FBX SDK or ufbx (--loader)
+static bool isGltfFile(const char* filename)
+{
+	const char* extension = strrchr(filename, '.');
+	return extension && (hkString::strCasecmp(extension, ".gltf") == 0 || hkString::strCasecmp(extension, ".glb") == 0);
+}
+
+// Loads a glTF file, or an FBX file with ufbx (--loader ufbx). Returns NULL if it cannot be loaded.
+static SceneSource* loadSceneSource(const ConversionSettings& settings, const char* filename, hkStringBuf& modellerOut)
+{
+	const bool gltf = isGltfFile(filename);
+
+	std::string application;
+	std::string error;
+	SceneSource* sceneSource;
+	{
+		ConversionProfiler::Scope importScope(settings.m_profiler, gltf ? "cgltf_parse" : "ufbx_load_file", "phase", filename);
+		sceneSource = gltf ?
+			GltfSceneSource::load(filename, application, error, settings.m_inputData, settings.m_inputSize) :
+			UfbxSceneSource::load(filename, application, error, settings.m_inputData, settings.m_inputSize, !settings.m_importOptions->m_exportMeshes);
+	}
+	if (!sceneSource)
+	{
+		HK_WARN(0x5216afed, "Failed to load " << filename << " with " << (gltf ? "cgltf" : "ufbx") << ": " << error.c_str() << "\n");
+		return NULL;
+	}
+	sampleMemory(settings, "import");
+
+	modellerOut = gltf ? "glTF" : "FBX";
+	if (!application.empty())
+	{
+		modellerOut += " [";
+		modellerOut += application.c_str();
+		modellerOut += "]";
+	}
+	return sceneSource;
+}
+
+// Loads one FBX (or glTF) file and saves it as HKX. Failures are reported as warnings so a batch can carry on with the next file.
+static int convertFbxFile(const ConversionSettings& settings, const char* inputFile, const char* outputFile)
+{
+	ConversionProfiler::Scope fileScope(settings.m_profiler, "convertFbxFile", "phase", inputFile);
+
+	hkStringBuf filename = inputFile;
+	filename.pathNormalize();
+
+	hkStringBuf path;
+	hkStringBuf name;
+	// Was an output filename provided?
+	if (outputFile != NULL)
+	{
+		path = outputFile;
+		path.pathNormalize();
+		name = path;
+		path.pathDirname();
+		name.pathBasename();
+	}
+	else
+	{
+		path = filename;
+		path.pathDirname();
+		name = filename;
+		name.pathBasename();
+	}
+
+	int extensionIndex = hkString::lastIndexOf(name, '.');
+	if (extensionIndex >= 0)
+		name.slice(0, extensionIndex);
+
+	// Without a manifest file the scene entries are still collected for the conversion cache
+	ConversionManifest manifest(settings.m_manifestFile ? settings.m_manifestFile : "", filename, path);
+
+	printf("setting up export_data path... \r\n");
+	hkStringBuf hkxExtraData_path;
+	if (settings.m_exportDataFolder != NULL)
+	{
+		//export data folder specified
+		hkxExtraData_path = settings.m_exportDataFolder;
+		hkxExtraData_path.pathNormalize();
+		struct stat info;
+		if (stat(hkxExtraData_path.cString(), &info) != 0)
 		{
-			parser.setArguments("input.fbx", "input FBX file that is converted to hkt.", hkOptionParser::ARGUMENTS_ONE, &inputFile, 1);
-			hkOptionParser::ParseResult result = parser.parse(argc, const_cast<const char**>(&argv[0]));
-			if (result != hkOptionParser::PARSE_SUCCESS)
-			{
-				return -1;
-			}
+			printf("Specified export folder \r\n");
 		}
-	}
-	
-	// Load FBX and save as HKX
+    
+		if (!(info.st_mode & S_IFDIR))
+		{
+			printf("-d specified but doesn't exist, or isn't a folder... \r\n");
+			HK_WARN(0x5216afed, "Failed to initialize mesh data path! Please ensure " << filename << " is a valid folder\n");
+			return -1;
+		}
+
+	} else 
 	{
-		hkStringBuf filename = inputFile;
-		filename.pathNormalize();
+		//NO export data folder specified
+		hkxExtraData_path = filename;
+		hkxExtraData_path.pathDirname();
+		// Check if the resulting path is empty (no directory component)
+		if (hkxExtraData_path[0] == '\0') {  // Explicit empty string check
+			hkxExtraData_path = ".";
+		}
 
-		FbxManager* fbxSdkManager = FbxManager::Create();
-		if( !fbxSdkManager )
+	}
+	// Index the export data once, it is loaded in the background while the FBX is imported
+	ExportDataIndex exportDataIndex;
+	exportDataIndex.build(hkxExtraData_path);
+
+	// The cache key covers everything the output depends on
+	ConversionCache cache(settings.m_cacheFolder ? settings.m_cacheFolder : "");
+	if (settings.m_cacheFolder != NULL)
+	{
+		if (settings.m_inputData)
 		{
-			HK_ERROR(0x5213afed, "Unable to create FBX Manager!\n");
+			cache.addBytes(settings.m_inputData, settings.m_inputSize);
+		}
+		else if (!cache.addFile(filename))
+		{
+			HK_WARN(0x5216afed, "Failed to read " << filename << "\n");
 			return -1;
 		}
+		// The remaining converter options are fixed defaults, covered by FBXIMPORTER_VERSION
+		cache.addInt(getImportOptionBits(*settings.m_importOptions));
+		cache.addInt(settings.m_noTakes);
+		cache.addInt(settings.m_singleContainer);
+		// The size breakdown is part of the cached manifest
+		cache.addInt(settings.m_reportSizes);
+		cache.addInt(settings.m_ufbxLoader);
+		cache.addDouble(settings.m_unitMeters);
+		cache.addInt(settings.m_maxSkinBones);
+		cache.addString(name);
 
-		FbxIOSettings* fbxIoSettings = FbxIOSettings::Create(fbxSdkManager, IOSROOT);
-		fbxSdkManager->SetIOSettings(fbxIoSettings);
+		const size_t exportDataPathLength = exportDataIndex.getPath().size();
+		for (int fileIndex = 0; fileIndex < exportDataIndex.getNumFiles(); fileIndex++)
+		{
+			// Only the path below the export data folder matters, channel names are derived from it
+			const std::string& exportDataFile = exportDataIndex.getFilePath(fileIndex);
+			cache.addString(exportDataFile.c_str() + std::min(exportDataPathLength, exportDataFile.size()));
+			cache.addFile(exportDataFile.c_str());
+		}
+
+		std::string cachedReport;
+		std::vector<std::string> cachedFiles;
+		std::string cachedManifest;
+		if (cache.restore(path, cachedReport, &cachedFiles, &cachedManifest))
+		{
+			printf("Output path: %s\n", path.cString());
+			printf("Restored conversion %016llx from cache\n", (unsigned long long)cache.getKey());
+			printf("%s", cachedReport.c_str());
+
+			if (settings.m_reportFunction != NULL)
+			{
+				size_t lineStart = 0;
+				while (lineStart < cachedReport.size())
+				{
+					const size_t lineEnd = std::min(cachedReport.find('\n', lineStart), cachedReport.size());
+					settings.m_reportFunction(cachedReport.substr(lineStart, lineEnd - lineStart).c_str(), settings.m_reportUserData);
+					lineStart = lineEnd + 1;
+				}
+			}
+
+			manifest.setCachedRecord(cachedManifest, cachedFiles);
+			manifest.finish("cached");
+
+			return 0;
+		}
+	}
 
-		FbxImporter* fbxImporter = FbxImporter::Create(fbxSdkManager,"");
+	exportDataIndex.prefetch(4);
 
-		if (!fbxImporter->Initialize(filename, -1, fbxSdkManager->GetIOSettings()))
+	FbxManager* fbxSdkManager = NULL;
+	FbxScene* fbxScene = NULL;
+	SceneSource* sceneSource = NULL;
+	hkStringBuf modeller;
+	if (settings.m_ufbxLoader || isGltfFile(filename))
+	{
+		sceneSource = loadSceneSource(settings, filename, modeller);
+		if (!sceneSource)
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		fbxScene = importFbxScene(settings, filename, fbxSdkManager);
+		if (!fbxScene)
 		{
-			HK_WARN(0x5216afed, "Failed to initialize the importer! Please ensure file " << filename << " exists\n");
-			fbxSdkManager->Destroy();
 			return -1;
 		}
-		printf("setting up export_data path... \r\n");
-		hkStringBuf hkxExtraData_path;
-		if (exportDataFolder != NULL)
+	}
+
+	// Unchanged meshes and takes of a changed file are restored from the object cache
+	hkStringBuf objectCachePath = settings.m_cacheFolder ? settings.m_cacheFolder : "";
+	objectCachePath.pathAppend("objects");
+	ConversionObjectStore objectStore(objectCachePath);
+
+	FbxToHkxConverter::Options options(fbxSdkManager);
+	copyImportOptions(*settings.m_importOptions, options);
+	options.m_unitMeters = settings.m_unitMeters;
+	options.m_maxSkinBones = settings.m_maxSkinBones;
+	options.m_singleContainer = settings.m_singleContainer;
+	options.m_objectStore = settings.m_cacheFolder ? &objectStore : HK_NULL;
+	options.m_reportFunction = settings.m_reportFunction;
+	options.m_reportUserData = settings.m_reportUserData;
+	options.m_manifest = &manifest;
+	options.m_profiler = settings.m_profiler;
+	options.m_memoryStats = settings.m_memoryStats;
+	options.m_reportSizes = settings.m_reportSizes;
+	FbxToHkxConverter converter(options);
+
+	// Scenes are saved as soon as they are converted, the manifest lists them while later stacks are still converting
+	converter.setOutput(path, name);
+
+	const bool converted = sceneSource ?
+		converter.createScenes(*sceneSource, modeller, filename, settings.m_noTakes, &exportDataIndex) :
+		converter.createScenes(fbxScene, settings.m_noTakes, &exportDataIndex);
+	if (converted)
+	{
+		sampleMemory(settings, "createScenes");
+		converter.saveScenes(path, name);
+		sampleMemory(settings, "saveScenes");
+
+		// A partially saved conversion is not cached
+		const int expectedFiles = settings.m_singleContainer ? 2 : converter.getNumScenes();
+		const bool allSaved = (converter.getSavedFiles().getSize() == expectedFiles);
+		manifest.finish(allSaved ? "succeeded" : "failed");
+
+		if (settings.m_cacheFolder != NULL && allSaved)
 		{
-			//export data folder specified
-			hkxExtraData_path = exportDataFolder;
-			hkxExtraData_path.pathNormalize();
-			struct stat info;
-			if (stat(hkxExtraData_path.cString(), &info) != 0)
+			std::vector<std::string> savedFiles;
+			for (int fileIndex = 0; fileIndex < converter.getSavedFiles().getSize(); fileIndex++)
 			{
-				printf("Specified export folder \r\n");
+				savedFiles.push_back(converter.getSavedFiles()[fileIndex].cString());
 			}
-    
-			if (!(info.st_mode & S_IFDIR))
+
+			if (cache.store(path, savedFiles, converter.getReport(), manifest.getCacheRecord()))
 			{
-				printf("-d specified but doesn't exist, or isn't a folder... \r\n");
-				HK_WARN(0x5216afed, "Failed to initialize mesh data path! Please ensure " << filename << " is a valid folder\n");
-				fbxSdkManager->Destroy();
-				return -1;
+				printf("Stored conversion %016llx in cache\n", (unsigned long long)cache.getKey());
 			}
+		}
+	}
+	else
+	{
+		HK_WARN(0x0, "Failed to convert the scene!\n");
+		releaseLoadedScene(settings, fbxSdkManager, fbxScene, sceneSource);
+		return -1;
+	}
+
+	const bool sdkLoaded = (fbxSdkManager != NULL);
+	releaseLoadedScene(settings, fbxSdkManager, fbxScene, sceneSource);
+	sampleMemory(settings, sdkLoaded ? "FBX SDK teardown" : "scene source teardown");
+
+	return 0;
+}
 
-		} else 
+// With an output (or manifest) folder every file of a batch is saved as <stem>.hkt (and <stem>.json) in it, so files
+// with the same name but another extension or folder would overwrite each other's outputs. Otherwise the outputs are
+// saved next to their inputs and only files with the same path up to the extension collide. Returns false and reports
+// them if there are any. Names are compared case insensitively, as they are on Windows.
+static bool checkBatchOutputNames(const std::vector<std::string>& files, bool sharedOutputFolder)
+{
+	std::map<std::string, size_t> outputs;
+	bool unique = true;
+	for (size_t fileIndex = 0; fileIndex < files.size(); fileIndex++)
+	{
+		const std::string& file = files[fileIndex];
+		std::string output = sharedOutputFolder ? getStem(file) : joinPath(getParentPath(file), getStem(file));
+		std::replace(output.begin(), output.end(), '\\', '/');
+		std::transform(output.begin(), output.end(), output.begin(), ::tolower);
+
+		std::map<std::string, size_t>::const_iterator it = outputs.find(output);
+		if (it != outputs.end())
 		{
-			//NO export data folder specified
-			hkxExtraData_path = filename;
-			hkxExtraData_path.pathDirname();
-			// Check if the resulting path is empty (no directory component)
-			if (hkxExtraData_path[0] == '\0') {  // Explicit empty string check
-				hkxExtraData_path = ".";
+			printf("Batch files %s and %s would be saved to the same output\n", files[it->second].c_str(), file.c_str());
+			unique = false;
+			continue;
+		}
+		outputs[output] = fileIndex;
+	}
+	return unique;
+}
+
+// Collects the files of a batch: every .fbx, .gltf and .glb file in a folder, or the files listed in a text file (one per line,
+// relative paths are relative to the list, empty lines and lines starting with '#' are ignored)
+static bool collectBatchFiles(const char* batchInput, std::vector<std::string>& filesOut)
+{
+	if (isDirectory(batchInput))
+	{
+		std::vector<std::string> names;
+		if (!listFiles(batchInput, names))
+		{
+			return false;
+		}
+		for (size_t nameIndex = 0; nameIndex < names.size(); nameIndex++)
+		{
+			std::string extension = getExtension(names[nameIndex]);
+			std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+			if (extension == ".fbx" || extension == ".gltf" || extension == ".glb")
+			{
+				filesOut.push_back(joinPath(batchInput, names[nameIndex]));
 			}
+		}
+		return true;
+	}
 
+	std::ifstream list(batchInput);
+	if (!list)
+	{
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(list, line))
+	{
+		const size_t first = line.find_first_not_of(" \t\r");
+		const size_t last = line.find_last_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+		{
+			continue;
 		}
-		printf("creating fbxsdk manager... \r\n");
-		FbxScene* fbxScene = FbxScene::Create(fbxSdkManager,"tempScene");
-		if (!fbxScene)
+
+		std::string file = line.substr(first, last - first + 1);
+		if (!isAbsolutePath(file))
+		{
+			file = joinPath(getParentPath(batchInput), file);
+		}
+		filesOut.push_back(file);
+	}
+	return true;
+}
+
+struct BatchResult
+{
+	BatchResult() : m_result(-1), m_seconds(0.0) {}
+
+	int m_result;
+	double m_seconds;
+};
+
+static void batchWorkerMain(const ConversionSettings& settings, const std::vector<std::string>& files, const char* outputFolder, std::atomic<int>& nextFile, std::vector<BatchResult>& results)
+{
+	// Every thread using Havok needs its own memory router
+	hkMemoryRouter memoryRouter;
+	hkMemorySystem::getInstance().threadInit(memoryRouter, "FBXImporter batch worker");
+	hkBaseSystem::initThread(&memoryRouter);
+
+	// The files of the worker are imported into one FbxManager, the SDK plugins are only registered once per worker
+	ConversionSettings workerSettings = settings;
+	workerSettings.m_fbxSdkManager = settings.m_ufbxLoader ? NULL : createFbxManager();
+
+	for (int fileIndex = nextFile++; fileIndex < (int)files.size(); fileIndex = nextFile++)
+	{
+		std::string outputFile;
+		if (outputFolder != NULL)
 		{
-			HK_ERROR(0x5216afed, "Failed to create the scene!\n");
-			fbxImporter->Destroy();
-			fbxSdkManager->Destroy();
+			outputFile = joinPath(outputFolder, getStem(files[fileIndex]) + ".hkt");
+		}
+
+		// The manifest option names a folder in batch mode, each file gets its own manifest
+		ConversionSettings fileSettings = workerSettings;
+		std::string manifestFile;
+		if (settings.m_manifestFile != NULL)
+		{
+			manifestFile = joinPath(settings.m_manifestFile, getStem(files[fileIndex]) + ".json");
+			fileSettings.m_manifestFile = manifestFile.c_str();
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		results[fileIndex].m_result = convertFbxFile(fileSettings, files[fileIndex].c_str(), outputFolder ? outputFile.c_str() : NULL);
+		results[fileIndex].m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	if (workerSettings.m_fbxSdkManager)
+	{
+		destroyFbxManager(workerSettings.m_fbxSdkManager);
+	}
+
+	hkBaseSystem::quitThread();
+	hkMemorySystem::getInstance().threadQuit(memoryRouter);
+}
+
+// Converts all files of the batch on numJobs worker threads (0 for one per hardware thread) and prints a summary.
+// Returns 0 if every file was converted.
+static int convertBatch(const ConversionSettings& settings, const char* batchInput, const char* outputFolder, int numJobs)
+{
+	std::vector<std::string> files;
+	if (!collectBatchFiles(batchInput, files))
+	{
+		printf("Cannot read batch: %s\n", batchInput);
+		return -1;
+	}
+	if (!checkBatchOutputNames(files, outputFolder != NULL || settings.m_manifestFile != NULL))
+	{
+		printf("Batch files have conflicting output names: %s\n", batchInput);
+		return -1;
+	}
+	if (files.empty())
+	{
+		printf("No files to convert in batch: %s\n", batchInput);
+		return -1;
+	}
+
+	if (numJobs <= 0)
+	{
+		numJobs = (int)std::thread::hardware_concurrency();
+	}
+	numJobs = std::max(1, std::min(numJobs, (int)files.size()));
+	printf("Batch: converting %d file(s) on %d worker(s)\n", (int)files.size(), numJobs);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<BatchResult> results(files.size());
+	std::atomic<int> nextFile(0);
+	std::vector<std::thread> workers;
+	for (int workerIndex = 0; workerIndex < numJobs; workerIndex++)
+	{
+		workers.push_back(std::thread(batchWorkerMain, std::cref(settings), std::cref(files), outputFolder, std::ref(nextFile), std::ref(results)));
+	}
+	for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+	{
+		workers[workerIndex].join();
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int numFailed = 0;
+	printf("-------------------------------------------------------------------------------\n");
+	for (size_t fileIndex = 0; fileIndex < files.size(); fileIndex++)
+	{
+		const bool success = (results[fileIndex].m_result == 0);
+		printf("%s %6.2fs %s\n", success ? "OK    " : "FAILED", results[fileIndex].m_seconds, files[fileIndex].c_str());
+		numFailed += success ? 0 : 1;
+	}
+	printf("Batch summary: %d converted, %d failed, %0.2fs\n", (int)files.size() - numFailed, numFailed, seconds);
+
+	return numFailed > 0 ? -1 : 0;
+}
+
+// The import options of the server process (--import, --importProfile), each job's "import" list is applied on top
+static const FbxToHkxConverter::Options* s_serverImportOptions = NULL;
+
+// Every server worker imports its jobs into one FbxManager, the SDK plugins are only registered once per worker
+static void* startServerWorker()
+{
+	return createFbxManager();
+}
+
+static void stopServerWorker(void* workerData)
+{
+	if (workerData)
+	{
+		destroyFbxManager(static_cast<FbxManager*>(workerData));
+	}
+}
+
+// Converts a job received by the conversion server, the report lines are streamed back to the client
+static int convertServerJob(const ConversionJob& job, void* workerData, ConversionServer::ReportFunction report, void* userData)
+{
+	FbxToHkxConverter::Options importOptions = *s_serverImportOptions;
+	std::string importError;
+	if (!setImportOptions(job.m_import.c_str(), importOptions, importError))
+	{
+		report(("Invalid import options: " + importError).c_str(), userData);
+		return -1;
+	}
+
+	ConversionSettings settings;
+	settings.m_noTakes = job.m_noTakes;
+	settings.m_singleContainer = job.m_singleContainer;
+	settings.m_exportDataFolder = job.m_exportDataFolder.empty() ? NULL : job.m_exportDataFolder.c_str();
+	settings.m_inputData = job.m_inputData.empty() ? NULL : job.m_inputData.data();
+	settings.m_inputSize = job.m_inputData.size();
+	settings.m_cacheFolder = job.m_cacheFolder.empty() ? NULL : job.m_cacheFolder.c_str();
+	settings.m_manifestFile = job.m_manifestFile.empty() ? NULL : job.m_manifestFile.c_str();
+	settings.m_profiler = NULL;
+	settings.m_memoryStats = NULL;
+	settings.m_reportSizes = false;
+	settings.m_ufbxLoader = false;
+	settings.m_importOptions = &importOptions;
+	settings.m_unitMeters = job.m_unitMeters;
+	settings.m_maxSkinBones = job.m_maxSkinBones;
+	settings.m_reportFunction = report;
+	settings.m_reportUserData = userData;
+	settings.m_fbxSdkManager = static_cast<FbxManager*>(workerData);
+
+	return convertFbxFile(settings, job.m_input.c_str(), job.m_output.empty() ? NULL : job.m_output.c_str());
+}
+
+// Loads the file with both loaders (--compareLoaders), converts it without saving and compares the scenes. ufbx runs
+// first and its scene is released before the SDK import, the peak RSS growth of the SDK is beyond the peak of ufbx.
+// Returns -4 if the scenes differ.
+static int compareLoaders(const ConversionSettings& settings, const char* inputFile, double tolerance)
+{
+	hkStringBuf filename = inputFile;
+	filename.pathNormalize();
+	if (isGltfFile(filename))
+	{
+		printf("Loaders can only be compared on FBX files\n");
+		return -1;
+	}
+
+	LoaderComparison::Measurement measurements[2];
+	FbxToHkxConverter* converters[2] = { NULL, NULL };
+	const char* loaderNames[2] = { "ufbx", "FBX SDK" };
+	for (int loader = 0; loader < 2; loader++)
+	{
+		LoaderComparison::Measurement& measurement = measurements[loader];
+
+		ConversionMemoryStats::Sample before;
+		ConversionMemoryStats::sample(before);
+		const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+
+		FbxManager* fbxSdkManager = NULL;
+		FbxScene* fbxScene = NULL;
+		SceneSource* sceneSource = NULL;
+		hkStringBuf modeller;
+		if (loader == 0)
+		{
+			sceneSource = loadSceneSource(settings, filename, modeller);
+		}
+		else
+		{
+			fbxScene = importFbxScene(settings, filename, fbxSdkManager);
+		}
+		if (!sceneSource && !fbxScene)
+		{
+			delete converters[0];
 			return -1;
 		}
 
-		fbxImporter->Import(fbxScene);
-		fbxImporter->Destroy();
+		const std::chrono::steady_clock::time_point convertStart = std::chrono::steady_clock::now();
+		measurement.m_loadSeconds = std::chrono::duration<double>(convertStart - loadStart).count();
+
+		ConversionMemoryStats::Sample loaded;
+		ConversionMemoryStats::sample(loaded);
+		measurement.m_loadRss = (loaded.m_rss > before.m_rss) ? loaded.m_rss - before.m_rss : 0;
 
-		// Currently assume that the file is loaded from 3dsmax
-		// According to https://www.soft8soft.com/wiki/index.php/Coordinate_Systems#Blender
-		// blender and 3dsmax uses the same z up coordinate system
-		
-		/*
-		FbxAxisSystem BlenderAxisSys;
-		bool createBlenderAxisSys = false;
-		createBlenderAxisSys = FbxAxisSystem::ParseAxisSystem("xzy", BlenderAxisSys);
-		if (createBlenderAxisSys) {
-			printf("created blender axis system\r\n");
-		}
-		BlenderAxisSys.ConvertScene(fbxScene);
-		*/
-		//FbxAxisSystem::MayaYUp.ConvertScene(fbxScene);
-		FbxAxisSystem::Max.ConvertScene(fbxScene);
-		
 		FbxToHkxConverter::Options options(fbxSdkManager);
-		FbxToHkxConverter converter(options);
+		copyImportOptions(*settings.m_importOptions, options);
+		options.m_unitMeters = settings.m_unitMeters;
+		options.m_maxSkinBones = settings.m_maxSkinBones;
+		options.m_profiler = settings.m_profiler;
+		converters[loader] = new FbxToHkxConverter(options);
+		const bool converted = sceneSource ?
+			converters[loader]->createScenes(*sceneSource, modeller, filename, settings.m_noTakes, HK_NULL) :
+			converters[loader]->createScenes(fbxScene, settings.m_noTakes, HK_NULL);
+
+		measurement.m_convertSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - convertStart).count();
+
+		ConversionMemoryStats::Sample afterConvert;
+		ConversionMemoryStats::sample(afterConvert);
+		measurement.m_peakRss = (afterConvert.m_peakRss > before.m_peakRss) ? afterConvert.m_peakRss - before.m_peakRss : 0;
+
+		releaseLoadedScene(settings, fbxSdkManager, fbxScene, sceneSource);
 
-		if(converter.createScenes(fbxScene, noTakes, hkxExtraData_path))
+		if (!converted)
 		{
-			hkStringBuf path;
-			hkStringBuf name;
-			// Was an output filename provided?
-			if (outputFile != NULL)
+			HK_WARN(0x0, "Failed to convert the scene loaded with " << loaderNames[loader] << "!\n");
+			delete converters[0];
+			delete converters[1];
+			return -1;
+		}
+	}
+
+	// The SDK conversion is the reference
+	const FbxToHkxConverter& reference = *converters[1];
+	const FbxToHkxConverter& candidate = *converters[0];
+
+	LoaderComparison comparison(tolerance);
+	if (reference.getNumScenes() != candidate.getNumScenes())
+	{
+		char difference[64];
+		sprintf(difference, "%d scenes instead of %d", candidate.getNumScenes(), reference.getNumScenes());
+		comparison.addDifference(difference);
+	}
+	for (int sceneIndex = 0; sceneIndex < std::min(reference.getNumScenes(), candidate.getNumScenes()); sceneIndex++)
+	{
+		comparison.compareScenes(reference.getScene(sceneIndex), candidate.getScene(sceneIndex));
+	}
+
+	printf("\n");
+	comparison.print(loaderNames[1], measurements[1], loaderNames[0], measurements[0]);
+
+	delete converters[0];
+	delete converters[1];
+	return comparison.hasDifferences() ? -4 : 0;
+}
+
+// Runs the benchmark cases of the baseline file (the default cases if it does not exist yet, which then becomes the
+// baseline). Returns -3 if a case regressed beyond the tolerance.
+static int runBenchmark(const ConversionSettings& settings, const char* baselineFile, const char* resultsFile, int numRuns, double tolerance)
+{
+	ConversionBenchmark benchmark(numRuns, tolerance);
+
+	const bool hasBaseline = benchmark.loadBaseline(baselineFile);
+	if (!hasBaseline)
+	{
+		printf("No benchmark baseline at %s, running the default cases\n", baselineFile);
+		benchmark.useDefaultCases();
+	}
+
+	const std::string outputFolder = joinPath(getTempDirectory(), "FBXImporterBenchmark");
+	const bool converted = benchmark.run(outputFolder.c_str(), settings.m_profiler);
+
+	printf("\n");
+	const bool withinTolerance = benchmark.compare();
+
+	const char* resultFiles[] = { resultsFile, hasBaseline ? NULL : baselineFile };
+	for (int fileIndex = 0; fileIndex < (int)HK_COUNT_OF(resultFiles); fileIndex++)
+	{
+		if (resultFiles[fileIndex] && converted)
+		{
+			if (benchmark.writeResults(resultFiles[fileIndex]))
 			{
-				path = outputFile;
-				path.pathNormalize();
-				name = path;
-				path.pathDirname();
-				name.pathBasename();
+				printf("Saved benchmark results: %s\n", resultFiles[fileIndex]);
 			}
 			else
 			{
-				path = filename;
-				path.pathDirname();
-				name = filename;
-				name.pathBasename();
+				printf("Cannot save file: %s\n", resultFiles[fileIndex]);
+			}
+		}
+	}
+
+	if (!converted)
+	{
+		return -1;
+	}
+	return withinTolerance ? 0 : -3;
+}
+
+int main(int argc, char* argv[])
+{
+	// initialize Havok internals
+	{
+		hkMemorySystem::FrameInfo frameInfo(0);
+
+#ifdef _DEBUG
+		// (Use debug mem manager to detect mem leaks in Havok code)
+		hkMemoryRouter* memoryRouter = hkMemoryInitUtil::initChecking(hkMallocAllocator::m_defaultMallocAllocator, frameInfo);
+#else
+		hkMemoryRouter* memoryRouter = hkMemoryInitUtil::initFreeListLargeBlock(hkMallocAllocator::m_defaultMallocAllocator, frameInfo);
+#endif
+
+		hkBaseSystem::init( memoryRouter, havokErrorReport );
+
+		hkError& errorhandler = hkError::getInstance();
+		errorhandler.enableAll();
+	}
+
+	bool noTakes = false;
+	bool singleContainer = false;
+	bool batch = false;
+	bool server = false;
+	const char* numJobs = NULL;
+	const char* inputFile = NULL;
+	const char* outputFile = NULL;
+	const char* exportDataFolder = NULL;
+	const char* cacheFolder = NULL;
+	const char* manifestFile = NULL;
+	const char* profileFile = NULL;
+	bool memoryStats = false;
+	const char* memoryPeakBudget = NULL;
+	const char* memoryLeakBudget = NULL;
+	bool reportSizes = false;
+	bool benchmark = false;
+	const char* benchmarkRuns = NULL;
+	const char* benchmarkTolerance = NULL;
+	const char* loader = NULL;
+	bool compareLoadersMode = false;
+	const char* loaderTolerance = NULL;
+	const char* importList = NULL;
+	const char* importProfile = NULL;
+	const char* units = NULL;
+	const char* bonePalette = NULL;
+	// Parse command line
+	hkOptionParser parser("FBXImporter", "Converts an fbx, gltf or glb file into a havok tagfile (.hkt)");
+	{
+		hkOptionParser::Option options[] = 
+		{
+			hkOptionParser::Option("t", "noTakes", "if set, the first animation take is stored in input.hkt and additional takes are ignored.", &noTakes, false),
+			hkOptionParser::Option("c", "container", "if set, all takes are stored as named variants of a single input.hkt, and a manifest of the variant names is written to input.scenes.txt.", &singleContainer, false),
+			hkOptionParser::Option("b", "batch", "if set, the input is a folder whose .fbx, .gltf and .glb files are converted, or a text file listing one file per line. All files are converted in one process on parallel workers.", &batch, false),
+			hkOptionParser::Option("s", "server", "if set, the process stays running and converts the jobs sent to it. The input is then the named pipe (\\\\.\\pipe\\name) or Unix domain socket path to listen on, see ConversionServer.h for the protocol.", &server, false),
+			hkOptionParser::Option("j", "jobs", "number of parallel workers in batch and server mode. If left unspecified, one worker per hardware thread is used.", &numJobs),
+			hkOptionParser::Option("o", "output", "the absolute path to the output filename (the output folder in batch mode). If left unspecified, the input filename is used instead with a changed extension.", &outputFile),
+			hkOptionParser::Option("d", "data", "absolute path to folder with mesh-related export data (for hkxVertexSelectionSets). If left unspecified, the input file path is used instead with a changed extension.", &exportDataFolder),
+			hkOptionParser::Option("k", "cache", "absolute path to a conversion cache folder. If the input, its export data and the options are unchanged since a cached conversion, the cached output is restored instead of converting again.", &cacheFolder),
+			hkOptionParser::Option("m", "manifest", "path to a JSON manifest of the conversion results (output files, stack names, frame counts, lengths, bone, mesh and vertex counts, timings). It is rewritten after every saved scene. In batch mode this is a folder receiving one manifest per input file.", &manifestFile),
+			hkOptionParser::Option("p", "profile", "path to a Chrome trace (chrome://tracing, ui.perfetto.dev) of the conversion phases and the work on each node. The slowest nodes are listed at the end of the output.", &profileFile),
+			hkOptionParser::Option("u", "memstats", "if set, the Havok heap use and process RSS are printed after each phase, with the peak heap use of each scene, the largest mesh peaks and a leak report at the end. Batch mode converts one file at a time.", &memoryStats, false),
+			hkOptionParser::Option("l", "memPeakBudget", "peak RSS budget in MB. If exceeded the conversion fails (exit code -2). Implies --memstats.", &memoryPeakBudget),
+			hkOptionParser::Option("g", "memLeakBudget", "budget in KB for Havok heap memory still in use after the conversion. If exceeded the conversion fails (exit code -2). Implies --memstats.", &memoryLeakBudget),
+			hkOptionParser::Option("z", "sizes", "if set, a breakdown of the bytes of each saved scene (node keyframes, vertex data by attribute, index buffers, user channels, materials, textures, attributes and annotations) is printed next to the tag file size, and added to the manifest.", &reportSizes, false),
+			hkOptionParser::Option("x", "benchmark", "if set, the input is a benchmark baseline (JSON). Synthetic scenes of the sizes listed in it are generated and converted, and the conversion times are compared against it. If it does not exist, the default cases are run and saved as the baseline. Exit code -3 if a case regressed. See ConversionBenchmark.h.", &benchmark, false),
+			hkOptionParser::Option("r", "benchmarkRuns", "number of runs of each benchmark case, the best time counts. Defaults to 3. The output option is the file receiving the results in the baseline format.", &benchmarkRuns),
+			hkOptionParser::Option("e", "benchmarkTolerance", "percentage a benchmark case may be slower than its baseline before it counts as a regression. Defaults to 10.", &benchmarkTolerance),
+			hkOptionParser::Option("f", "loader", "FBX loader: sdk (the FBX SDK, default) or ufbx. ufbx is faster and uses less memory, but the scenes only hold nodes, meshes, skins, materials and keyframes (no cameras, lights, splines, attributes or annotations). Needs a build with ufbx, see UfbxSceneSource.h.", &loader),
+			hkOptionParser::Option("q", "compareLoaders", "if set, the input is loaded with both the FBX SDK and ufbx and converted without saving. The node trees, keyframes and meshes are compared, and the load times and memory use of both loaders are printed. Exit code -4 if they differ.", &compareLoadersMode, false),
+			hkOptionParser::Option("a", "loaderTolerance", "largest difference between the keyframes and mesh bounds of the two loaders (relative above 1) that --compareLoaders accepts. Defaults to 0.001.", &loaderTolerance),
+			hkOptionParser::Option("i", "import", "comma separated content flags, e.g. lights=0,cameras=0,animations=0: meshes, materials, attributes, annotations, lights, cameras, splines, tangents, vertexAnimations, animations, embeddedMedia, animationOnlyStacks, visibleOnly, selectedOnly and rigidSections. Everything except embeddedMedia (extracting embedded textures to a .fbm folder), visibleOnly, selectedOnly and rigidSections is on by default. rigidSections moves the triangles of skinned meshes that follow a single bone into unskinned meshes under that bone. animationOnlyStacks leaves the meshes, splines, cameras and lights out of the scenes of the animation takes, they are only in the rig scene. With meshes=0 only the animation is converted and the geometry is not loaded (ufbx) or its skins, shapes and materials (FBX SDK). Content that is off is also skipped by the FBX SDK importer. Applied after --importProfile.", &importList),
+			hkOptionParser::Option("n", "importProfile", "path to an import profile, a JSON object of the --import flags, e.g. {\"lights\": false, \"cameras\": false}.", &importProfile),
+			hkOptionParser::Option("v", "units", "length of an output unit in meters, e.g. 1 for meters or 0.01 for centimeters. If left unspecified, the unit of the input is kept. The axes are always converted to the 3ds Max axis system (Z up), from the axis system stored in the input.", &units),
+			hkOptionParser::Option("w", "bonePalette", "largest number of bones a skinned mesh section may reference, e.g. 64 or 128 for GPU skinning, at least 12 (the bones of a triangle's three vertices). Larger sections are split, and each part gets a bone palette (hkxMeshSection::m_boneMatrixMap) its blend indices refer to. If left unspecified, only skins of more than 256 bones are split, as blend indices are 8 bit.", &bonePalette)
+		};
+
+		if (parser.setOptions(options, HK_COUNT_OF(options)))
+		{
+			parser.setArguments("input.fbx", "input FBX, glTF or GLB file that is converted to hkt (or the batch folder or list with --batch, or the address to listen on with --server).", hkOptionParser::ARGUMENTS_ONE, &inputFile, 1);
+			hkOptionParser::ParseResult result = parser.parse(argc, const_cast<const char**>(&argv[0]));
+			if (result != hkOptionParser::PARSE_SUCCESS)
+			{
+				return -1;
 			}
-			
-			int extensionIndex = hkString::lastIndexOf(name, '.');
-			if (extensionIndex >= 0)
-				name.slice(0, extensionIndex);
+		}
+	}
+	
+	ConversionSettings settings;
+	settings.m_noTakes = noTakes;
+	settings.m_singleContainer = singleContainer;
+	settings.m_exportDataFolder = exportDataFolder;
+	settings.m_inputData = NULL;
+	settings.m_inputSize = 0;
+	settings.m_cacheFolder = cacheFolder;
+	settings.m_manifestFile = manifestFile;
+	ConversionProfiler profiler;
+	settings.m_profiler = profileFile ? &profiler : NULL;
+	memoryStats = memoryStats || memoryPeakBudget || memoryLeakBudget;
+	ConversionMemoryStats* memoryStatsCollector = memoryStats ? new ConversionMemoryStats() : NULL;
+	settings.m_memoryStats = memoryStatsCollector;
+	settings.m_reportSizes = reportSizes;
+	settings.m_ufbxLoader = (loader != NULL && hkString::strCasecmp(loader, "ufbx") == 0);
+	FbxToHkxConverter::Options importOptions(HK_NULL);
+	settings.m_importOptions = &importOptions;
+	settings.m_unitMeters = units ? atof(units) : 0.0;
+	settings.m_maxSkinBones = bonePalette ? atoi(bonePalette) : 0;
+	s_serverImportOptions = &importOptions;
+	settings.m_reportFunction = NULL;
+	settings.m_reportUserData = NULL;
+	settings.m_fbxSdkManager = NULL;
 
-			converter.saveScenes(path, name);
+	// Load FBX and save as HKX
+	int result;
+	std::string importError;
+	if (loader != NULL && !settings.m_ufbxLoader && hkString::strCasecmp(loader, "sdk") != 0)
+	{
+		printf("Unknown loader: %s (expected sdk or ufbx)\n", loader);
+		result = -1;
+	}
+	else if (settings.m_maxSkinBones != 0 && settings.m_maxSkinBones < MIN_SKIN_BONE_PALETTE)
+	{
+		printf("Invalid bone palette: %s (expected at least %d bones)\n", bonePalette, MIN_SKIN_BONE_PALETTE);
+		result = -1;
+	}
+	else if ((importProfile != NULL && !loadImportProfile(importProfile, importOptions, importError)) ||
+		(importList != NULL && !setImportOptions(importList, importOptions, importError)))
+	{
+		printf("Invalid import options: %s\n", importError.c_str());
+		result = -1;
+	}
+	else if (benchmark)
+	{
+		result = runBenchmark(settings, inputFile, outputFile, benchmarkRuns ? atoi(benchmarkRuns) : 3, (benchmarkTolerance ? atof(benchmarkTolerance) : 10.0) / 100.0);
+	}
+	else if (compareLoadersMode)
+	{
+		result = compareLoaders(settings, inputFile, loaderTolerance ? atof(loaderTolerance) : 1e-3);
+	}
+	else if (server)
+	{
+		ConversionServer conversionServer(convertServerJob, numJobs ? atoi(numJobs) : 0, startServerWorker, stopServerWorker);
+		result = conversionServer.run(inputFile) ? 0 : -1;
+	}
+	else if (batch)
+	{
+		// The memory statistics are process-wide, they are only meaningful for one conversion at a time
+		result = convertBatch(settings, inputFile, outputFile, memoryStats ? 1 : (numJobs ? atoi(numJobs) : 0));
+	}
+	else
+	{
+		result = convertFbxFile(settings, inputFile, outputFile);
+	}
+
+	if (settings.m_profiler)
+	{
+		if (profiler.writeChromeTrace(profileFile))
+		{
+			printf("Saved profile: %s\n", profileFile);
 		}
 		else
 		{
-			HK_ERROR(0x0, "Failed to convert the scene!\n");
-			fbxSdkManager->Destroy();
-			return -1;
+			printf("Cannot save file: %s\n", profileFile);
 		}
+		profiler.printSlowestNodes(10);
+	}
 
-		fbxSdkManager->Destroy();
+	if (memoryStatsCollector)
+	{
+		memoryStatsCollector->printSummary(10);
+
+		const size_t peakBudget = memoryPeakBudget ? (size_t)(atof(memoryPeakBudget) * 1024.0 * 1024.0) : 0;
+		const hkLong leakBudget = memoryLeakBudget ? (hkLong)(atof(memoryLeakBudget) * 1024.0) : -1;
+		if (!memoryStatsCollector->checkBudgets(peakBudget, leakBudget) && result == 0)
+		{
+			result = -2;
+		}
+		delete memoryStatsCollector;
 	}
 
 	// quit Havok
@@ -211,7 +1014,7 @@ int main(int argc, char* argv[])
 		hkMemoryInitUtil::quit();
 	}
 	
-	return 0;
+	return result;
 }
 
 /*
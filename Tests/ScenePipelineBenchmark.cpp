@@ -0,0 +1,291 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+// Times the scene pipelines (ScenePipeline.h) on large synthetic scenes built with MemorySceneSource, and writes the
+// results as JSON to the given file, or to stdout. Like ScenePipelineTest.cpp it only needs the standard library:
+//
+//   cl /O2 /EHsc /I..\Source ScenePipelineBenchmark.cpp ..\Source\ScenePipeline.cpp ..\Source\MemorySceneSource.cpp
+//   g++ -O2 -std=c++11 -I../Source ScenePipelineBenchmark.cpp ../Source/ScenePipeline.cpp ../Source/MemorySceneSource.cpp
+//
+// Usage: ScenePipelineBenchmark [results.json [runs]]
+
+#include "MemorySceneSource.h"
+#include "ScenePipeline.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Control points per side of the mesh grid, two triangles per grid cell
+static const int MESH_GRID_SIZE = 300;
+// Skin clusters across the grid, each control point is blended between two neighbouring ones
+static const int MESH_NUM_BONES = 64;
+static const int MESH_BONE_PALETTE = 24;
+static const int MESH_NUM_UV_SETS = 2;
+
+static const int ANIMATION_NUM_NODES = 200;
+static const double ANIMATION_LENGTH = 10.0;
+
+struct BenchmarkResult
+{
+	const char* m_name;
+	// Triangles or nodes processed per run
+	int m_numItems;
+	double m_minMilliseconds;
+	double m_meanMilliseconds;
+};
+
+// Summed over all runs so the work can't be optimized away
+static double s_checksum = 0.0;
+
+static double getMilliseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void addRunTime(BenchmarkResult& result, double milliseconds, int run)
+{
+	if (run == 0 || milliseconds < result.m_minMilliseconds)
+	{
+		result.m_minMilliseconds = milliseconds;
+	}
+	result.m_meanMilliseconds += milliseconds;
+}
+
+//-------
+
+static void buildMeshScene(MemorySceneSource& source, int& nodeOut)
+{
+	nodeOut = source.addNode(0, "mesh", SceneSource::NODE_MESH);
+	SceneMesh& mesh = source.editMesh(nodeOut);
+
+	for (int y = 0; y < MESH_GRID_SIZE; y++)
+	{
+		for (int x = 0; x < MESH_GRID_SIZE; x++)
+		{
+			mesh.m_positions.push_back((float)x);
+			mesh.m_positions.push_back((float)y);
+			mesh.m_positions.push_back(0.f);
+
+			// Blend between the bones of the band the point is in and the next one
+			const float band = (float)x * (MESH_NUM_BONES - 1) / (MESH_GRID_SIZE - 1);
+			const int bone = (int)band < MESH_NUM_BONES - 1 ? (int)band : MESH_NUM_BONES - 2;
+			const float blend = band - (float)bone;
+			mesh.m_skinClusters.push_back(bone);
+			mesh.m_skinWeights.push_back(1.f - blend);
+			mesh.m_skinClusters.push_back(bone + 1);
+			mesh.m_skinWeights.push_back(blend);
+			for (int influence = 2; influence < 4; influence++)
+			{
+				mesh.m_skinClusters.push_back(0);
+				mesh.m_skinWeights.push_back(0.f);
+			}
+		}
+	}
+
+	for (int y = 0; y + 1 < MESH_GRID_SIZE; y++)
+	{
+		for (int x = 0; x + 1 < MESH_GRID_SIZE; x++)
+		{
+			const int corner = y * MESH_GRID_SIZE + x;
+			const int cell[6] = { corner, corner + 1, corner + MESH_GRID_SIZE, corner + 1, corner + MESH_GRID_SIZE + 1, corner + MESH_GRID_SIZE };
+			for (int i = 0; i < 6; i++)
+			{
+				mesh.m_triangles.push_back(cell[i]);
+			}
+		}
+	}
+
+	const int numCorners = (int)mesh.m_triangles.size();
+	mesh.m_normals.resize(numCorners * 3);
+	mesh.m_colors.resize(numCorners * 4);
+	mesh.m_uvSets.resize(MESH_NUM_UV_SETS);
+	for (int uvSet = 0; uvSet < MESH_NUM_UV_SETS; uvSet++)
+	{
+		mesh.m_uvSets[uvSet].resize(numCorners * 2);
+	}
+	for (int corner = 0; corner < numCorners; corner++)
+	{
+		const int point = mesh.m_triangles[corner];
+		mesh.m_normals[corner * 3 + 2] = 1.f;
+		for (int channel = 0; channel < 4; channel++)
+		{
+			mesh.m_colors[corner * 4 + channel] = 1.f;
+		}
+		for (int uvSet = 0; uvSet < MESH_NUM_UV_SETS; uvSet++)
+		{
+			mesh.m_uvSets[uvSet][corner * 2] = mesh.m_positions[point * 3] / MESH_GRID_SIZE;
+			mesh.m_uvSets[uvSet][corner * 2 + 1] = mesh.m_positions[point * 3 + 1] / MESH_GRID_SIZE;
+		}
+	}
+}
+
+// Nodes with a curve on every channel and a key at every frame of the stack
+static int buildAnimationScene(MemorySceneSource& source)
+{
+	const int stack = source.addStack("take", 0.0, ANIMATION_LENGTH);
+	const int numKeys = (int)(ANIMATION_LENGTH * 30.0) + 1;
+
+	int parent = 0;
+	for (int nodeIndex = 0; nodeIndex < ANIMATION_NUM_NODES; nodeIndex++)
+	{
+		char name[32];
+		sprintf(name, "bone%d", nodeIndex);
+		// Chains of ten bones, like the limbs of a skeleton
+		const int node = source.addNode(nodeIndex % 10 == 0 ? 0 : parent, name, SceneSource::NODE_SKELETON);
+		parent = node;
+
+		for (int channel = 0; channel < SceneSource::NUM_CHANNELS; channel++)
+		{
+			SceneCurve curve;
+			for (int key = 0; key < numKeys; key++)
+			{
+				curve.m_times.push_back(key / 30.0);
+				const float value = (float)((key * (channel + 1) + nodeIndex) % 50) * 0.1f;
+				// Scaling stays around 1
+				curve.m_values.push_back(channel >= SceneSource::SCALING_X ? 1.f + value * 0.01f : value);
+			}
+			source.setCurve(node, stack, (SceneSource::Channel)channel, curve);
+		}
+	}
+	return stack;
+}
+
+//-------
+
+static void benchmarkMesh(int numRuns, std::vector<BenchmarkResult>& resultsOut)
+{
+	MemorySceneSource source;
+	int node;
+	buildMeshScene(source, node);
+
+	SceneMesh mesh;
+	source.getMesh(node, mesh);
+	std::vector<int> triangles(mesh.getNumTriangles());
+	for (size_t triangle = 0; triangle < triangles.size(); triangle++)
+	{
+		triangles[triangle] = (int)triangle;
+	}
+
+	BenchmarkResult buffersResult = { "buildTriangleListBuffers", (int)triangles.size(), 0.0, 0.0 };
+	BenchmarkResult partitionResult = { "partitionSkinnedTriangles", (int)triangles.size(), 0.0, 0.0 };
+	for (int run = 0; run < numRuns; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		SceneVertexBuffers buffers;
+		buildTriangleListBuffers(mesh, &triangles[0], (int)triangles.size(), MESH_NUM_UV_SETS, buffers);
+		addRunTime(buffersResult, getMilliseconds(start), run);
+		s_checksum += buffers.m_numVertices + buffers.m_positions[buffers.m_positions.size() - 1];
+
+		start = std::chrono::steady_clock::now();
+		std::vector<SceneSkinPartition> partitions;
+		partitionSkinnedTriangles(mesh, &triangles[0], (int)triangles.size(), MESH_BONE_PALETTE, partitions);
+		addRunTime(partitionResult, getMilliseconds(start), run);
+		s_checksum += (double)partitions.size();
+	}
+	resultsOut.push_back(buffersResult);
+	resultsOut.push_back(partitionResult);
+}
+
+static void benchmarkAnimation(int numRuns, std::vector<BenchmarkResult>& resultsOut)
+{
+	MemorySceneSource source;
+	const int stack = buildAnimationScene(source);
+	const int numNodes = source.getNumNodes();
+
+	BenchmarkResult keyFramesResult = { "sampleKeyFrames", numNodes - 1, 0.0, 0.0 };
+	BenchmarkResult hintsResult = { "collectKeyTimeHints", numNodes - 1, 0.0, 0.0 };
+	std::vector<double> keyFrames;
+	std::vector<float> hints;
+	for (int run = 0; run < numRuns; run++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int node = 1; node < numNodes; node++)
+		{
+			s_checksum += sampleKeyFrames(source, node, stack, true, keyFrames);
+			s_checksum += keyFrames[keyFrames.size() - 4];
+		}
+		addRunTime(keyFramesResult, getMilliseconds(start), run);
+
+		start = std::chrono::steady_clock::now();
+		for (int node = 1; node < numNodes; node++)
+		{
+			collectKeyTimeHints(source, node, stack, hints);
+			s_checksum += (double)hints.size();
+		}
+		addRunTime(hintsResult, getMilliseconds(start), run);
+	}
+	resultsOut.push_back(keyFramesResult);
+	resultsOut.push_back(hintsResult);
+}
+
+//-------
+
+static void writeResults(FILE* file, const std::vector<BenchmarkResult>& results, int numRuns)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"runs\": %d,\n", numRuns);
+	fprintf(file, "\t\"checksum\": %.17g,\n", s_checksum);
+	fprintf(file, "\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		const double meanMilliseconds = result.m_meanMilliseconds / numRuns;
+		const double itemsPerSecond = result.m_minMilliseconds > 0.0 ? result.m_numItems * 1000.0 / result.m_minMilliseconds : 0.0;
+		fprintf(file, "\t\t{ \"name\": \"%s\", \"items\": %d, \"min_ms\": %.4f, \"mean_ms\": %.4f, \"items_per_second\": %.1f }%s\n",
+			result.m_name, result.m_numItems, result.m_minMilliseconds, meanMilliseconds, itemsPerSecond, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+	const char* resultsFile = argc > 1 ? argv[1] : NULL;
+	const int numRuns = argc > 2 ? atoi(argv[2]) : 5;
+	if (numRuns < 1)
+	{
+		printf("Usage: ScenePipelineBenchmark [results.json [runs]]\n");
+		return 1;
+	}
+
+	std::vector<BenchmarkResult> results;
+	benchmarkMesh(numRuns, results);
+	benchmarkAnimation(numRuns, results);
+
+	if (!resultsFile)
+	{
+		writeResults(stdout, results, numRuns);
+		return 0;
+	}
+
+	FILE* file = fopen(resultsFile, "w");
+	if (!file)
+	{
+		printf("Cannot write %s\n", resultsFile);
+		return 1;
+	}
+	writeResults(file, results, numRuns);
+	fclose(file);
+	printf("Wrote %s\n", resultsFile);
+	return 0;
+}
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */
@@ -0,0 +1,370 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2014 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+// Standalone checks of the scene pipelines (ScenePipeline.h) on synthetic scenes built with MemorySceneSource. They
+// only need the standard library, so they build without Havok or the FBX SDK:
+//
+//   cl /EHsc /I..\Source ScenePipelineTest.cpp ..\Source\ScenePipeline.cpp ..\Source\MemorySceneSource.cpp
+//   g++ -std=c++11 -I../Source ScenePipelineTest.cpp ../Source/ScenePipeline.cpp ../Source/MemorySceneSource.cpp
+//
+// or with CMakeLists.txt next to this file. Prints the failed checks and returns 1 if there are any.
+
+#include "MemorySceneSource.h"
+#include "ScenePipeline.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static int s_numChecks = 0;
+static int s_numFailures = 0;
+
+static void check(bool condition, const char* expression, int line)
+{
+	s_numChecks++;
+	if (!condition)
+	{
+		printf("ScenePipelineTest.cpp(%d): check failed: %s\n", line, expression);
+		s_numFailures++;
+	}
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static bool isNear(double a, double b, double tolerance = 1e-5)
+{
+	return fabs(a - b) <= tolerance;
+}
+
+// Four influences per control point, one cluster with full weight
+static void addRigidInfluence(SceneMesh& mesh, int cluster)
+{
+	mesh.m_skinClusters.push_back(cluster);
+	mesh.m_skinWeights.push_back(1.f);
+	for (int influence = 1; influence < 4; influence++)
+	{
+		mesh.m_skinClusters.push_back(0);
+		mesh.m_skinWeights.push_back(0.f);
+	}
+}
+
+static void addPoint(SceneMesh& mesh, float x, float y, float z)
+{
+	mesh.m_positions.push_back(x);
+	mesh.m_positions.push_back(y);
+	mesh.m_positions.push_back(z);
+}
+
+static void addTriangle(SceneMesh& mesh, int a, int b, int c)
+{
+	mesh.m_triangles.push_back(a);
+	mesh.m_triangles.push_back(b);
+	mesh.m_triangles.push_back(c);
+}
+
+//-------
+
+static void testTriangleListBuffers()
+{
+	MemorySceneSource source;
+	const int node = source.addNode(0, "mesh", SceneSource::NODE_MESH);
+
+	SceneMesh& mesh = source.editMesh(node);
+	addPoint(mesh, 0, 0, 0);
+	addPoint(mesh, 1, 0, 0);
+	addPoint(mesh, 0, 1, 0);
+	addTriangle(mesh, 0, 1, 2);
+	mesh.m_colors.assign(12, 1.f);
+	mesh.m_uvSets.resize(1);
+	mesh.m_uvSets[0].assign(6, 0.5f);
+	mesh.m_skinClusters.assign(12, 0);
+	mesh.m_skinWeights.assign(12, 0.5f);
+	mesh.m_skinClusters[1] = 1;
+	mesh.m_skinClusters[4] = 1;
+
+	SceneMesh sourceMesh;
+	CHECK(source.getMesh(node, sourceMesh));
+
+	SceneVertexBuffers buffers;
+	const int triangle = 0;
+	buildTriangleListBuffers(sourceMesh, &triangle, 1, 8, buffers);
+	CHECK(buffers.m_numVertices == 3);
+	CHECK(buffers.m_positions.size() == 9 && buffers.m_positions[3] == 1.f);
+	CHECK(buffers.m_normals.empty());
+	CHECK(buffers.m_colors.size() == 3 && buffers.m_colors[0] == 0xffffffff);
+	CHECK(buffers.m_uvSets.size() == 1 && buffers.m_uvSets[0].size() == 6);
+	// Skin indices are packed from the high to the low byte
+	CHECK(buffers.m_skinIndices.size() == 3 && buffers.m_skinIndices[0] == 0x00010000 && buffers.m_skinIndices[1] == 0x01000000);
+	CHECK(buffers.m_indices.size() == 3 && buffers.m_indices[0] == 0 && buffers.m_indices[1] == 1 && buffers.m_indices[2] == 2);
+}
+
+static void testSampleKeyFrames()
+{
+	MemorySceneSource source;
+	const int bone = source.addNode(0, "bone", SceneSource::NODE_SKELETON);
+	const float translation[3] = { 1, 2, 3 };
+	const float rotation[3] = { 0, 0, 90 };
+	const float scaling[3] = { 1, 1, 1 };
+	source.setLocalTransform(bone, translation, rotation, scaling);
+
+	const int stack = source.addStack("walk", 0.0, 1.0);
+	SceneCurve curve;
+	curve.m_times.push_back(0.0);
+	curve.m_times.push_back(0.5);
+	curve.m_times.push_back(2.0);
+	curve.m_values.push_back(0.f);
+	curve.m_values.push_back(1.f);
+	curve.m_values.push_back(4.f);
+	source.setCurve(bone, stack, SceneSource::TRANSLATION_X, curve);
+
+	// One second at 30 frames per second
+	std::vector<double> keyFrames;
+	const int numFrames = sampleKeyFrames(source, bone, stack, true, keyFrames);
+	CHECK(numFrames == 30);
+	CHECK(keyFrames.size() == 30 * 16);
+	CHECK(isNear(keyFrames[15 * 16 + 12], 1.0));
+	CHECK(isNear(keyFrames[15 * 16 + 13], 2.0));
+
+	// The rig pose is taken at time 0 of the first stack: the rotation of 90 degrees about Z, the curve's first value
+	sampleKeyFrames(source, bone, -1, false, keyFrames);
+	CHECK(keyFrames.size() == 16);
+	CHECK(isNear(keyFrames[1], 1.0) && isNear(keyFrames[4], -1.0) && isNear(keyFrames[10], 1.0));
+	CHECK(isNear(keyFrames[12], 0.0) && isNear(keyFrames[13], 2.0) && isNear(keyFrames[14], 3.0));
+
+	// A node that doesn't move gets two equal keys in an animated stack
+	const int still = source.addNode(0, "still", SceneSource::NODE_NULL);
+	sampleKeyFrames(source, still, stack, true, keyFrames);
+	CHECK(keyFrames.size() == 2 * 16);
+
+	// The key past the end of the stack adds its end
+	std::vector<float> hints;
+	collectKeyTimeHints(source, bone, stack, hints);
+	CHECK(hints.size() == 3 && hints[0] == 0.f && hints[1] == 0.5f && hints[2] == 1.f);
+}
+
+static void testSkinPartitions()
+{
+	// A strip of triangles over control points that each follow a bone of their own
+	SceneMesh mesh;
+	const int numPoints = 16;
+	for (int point = 0; point < numPoints; point++)
+	{
+		addPoint(mesh, (float)point, 0, 0);
+		addRigidInfluence(mesh, point);
+	}
+	std::vector<int> triangles;
+	for (int triangle = 0; triangle < numPoints - 2; triangle++)
+	{
+		addTriangle(mesh, triangle, triangle + 1, triangle + 2);
+		triangles.push_back(triangle);
+	}
+
+	std::vector<SceneSkinPartition> partitions;
+	partitionSkinnedTriangles(mesh, &triangles[0], (int)triangles.size(), 4, partitions);
+	CHECK(partitions.size() == 7);
+	int numPartitionedTriangles = 0;
+	for (size_t partitionIndex = 0; partitionIndex < partitions.size(); partitionIndex++)
+	{
+		CHECK(partitions[partitionIndex].m_bones.size() <= 4);
+		numPartitionedTriangles += (int)partitions[partitionIndex].m_triangles.size();
+	}
+	CHECK(numPartitionedTriangles == (int)triangles.size());
+	CHECK(partitions[1].m_triangles.size() == 2 && partitions[1].m_triangles[0] == 2);
+	CHECK(partitions[1].m_bones.size() == 4 && partitions[1].m_bones[0] == 2 && partitions[1].m_bones[3] == 5);
+
+	// The skin indices of a partition are positions in its palette
+	SceneVertexBuffers buffers;
+	const SceneSkinPartition& partition = partitions[1];
+	buildTriangleListBuffers(mesh, &partition.m_triangles[0], (int)partition.m_triangles.size(), 4, buffers, &partition.m_bones);
+	CHECK(buffers.m_numVertices == 6);
+	CHECK(buffers.m_skinIndices[0] == 0x00000000 && buffers.m_skinIndices[1] == 0x01000000 && buffers.m_skinIndices[5] == 0x03000000);
+
+	// Every triangle fits into the smallest palette the converter accepts
+	partitionSkinnedTriangles(mesh, &triangles[0], (int)triangles.size(), MIN_SKIN_BONE_PALETTE, partitions);
+	CHECK(partitions.size() == 2);
+	CHECK(partitions[0].m_bones.size() == MIN_SKIN_BONE_PALETTE);
+}
+
+static void testRigidTriangles()
+{
+	// Control points 0, 1 and 2 follow bone 1, 3 follows bone 2 and 4 is blended
+	SceneMesh mesh;
+	const float weights[5][2] = { { 1.f, 0.f }, { 0.9995f, 0.0005f }, { 0.5f, 0.f }, { 1.f, 0.f }, { 0.5f, 0.5f } };
+	const int clusters[5][2] = { { 1, 0 }, { 1, 2 }, { 1, 0 }, { 2, 0 }, { 1, 2 } };
+	for (int point = 0; point < 5; point++)
+	{
+		addPoint(mesh, (float)point, 0, 0);
+		for (int influence = 0; influence < 4; influence++)
+		{
+			mesh.m_skinClusters.push_back(influence < 2 ? clusters[point][influence] : 0);
+			mesh.m_skinWeights.push_back(influence < 2 ? weights[point][influence] : 0.f);
+		}
+	}
+	addTriangle(mesh, 0, 1, 2);
+	addTriangle(mesh, 0, 1, 3);
+	addTriangle(mesh, 3, 3, 3);
+	addTriangle(mesh, 0, 2, 4);
+	addTriangle(mesh, 2, 1, 0);
+	const int triangles[5] = { 0, 1, 2, 3, 4 };
+
+	std::vector<int> skinnedTriangles;
+	std::vector<SceneRigidPart> rigidParts;
+	extractRigidTriangles(mesh, triangles, 5, skinnedTriangles, rigidParts);
+	CHECK(skinnedTriangles.size() == 2 && skinnedTriangles[0] == 1 && skinnedTriangles[1] == 3);
+	CHECK(rigidParts.size() == 2);
+	CHECK(rigidParts[0].m_bone == 1 && rigidParts[0].m_triangles.size() == 2 && rigidParts[0].m_triangles[1] == 4);
+	CHECK(rigidParts[1].m_bone == 2 && rigidParts[1].m_triangles.size() == 1 && rigidParts[1].m_triangles[0] == 2);
+
+	// A morph target moving control point 2 keeps its triangles skinned
+	SceneBlendShape shape;
+	shape.m_controlPoints.push_back(2);
+	shape.m_positionDeltas.assign(3, 1.f);
+	mesh.m_blendShapes.push_back(shape);
+	extractRigidTriangles(mesh, triangles, 5, skinnedTriangles, rigidParts);
+	CHECK(skinnedTriangles.size() == 4);
+	CHECK(rigidParts.size() == 1 && rigidParts[0].m_bone == 2);
+
+	// The rigid vertices are moved into the space of their bone
+	const double transform[16] = { 0, 2, 0, 0, -2, 0, 0, 0, 0, 0, 3, 0, 5, 6, 7, 1 };
+	double inverse[16];
+	double product[16];
+	CHECK(invertAffineTransform(transform, inverse));
+	multiplyMatrices(transform, inverse, product);
+	for (int i = 0; i < 16; i++)
+	{
+		CHECK(isNear(product[i], (i % 5 == 0) ? 1.0 : 0.0, 1e-12));
+	}
+	const double singular[16] = { 0 };
+	CHECK(!invertAffineTransform(singular, inverse));
+
+	SceneVertexBuffers buffers;
+	buffers.m_numVertices = 1;
+	buffers.m_positions.push_back(1.f);
+	buffers.m_positions.push_back(0.f);
+	buffers.m_positions.push_back(1.f);
+	buffers.m_normals.push_back(0.f);
+	buffers.m_normals.push_back(0.f);
+	buffers.m_normals.push_back(1.f);
+	transformVertexBuffers(transform, buffers);
+	CHECK(isNear(buffers.m_positions[0], 5.0) && isNear(buffers.m_positions[1], 8.0) && isNear(buffers.m_positions[2], 10.0));
+	CHECK(isNear(buffers.m_normals[0], 0.0) && isNear(buffers.m_normals[2], 1.0));
+}
+
+static void testBlendShapeDeltas()
+{
+	SceneMesh mesh;
+	addPoint(mesh, 0, 0, 0);
+	addPoint(mesh, 1, 0, 0);
+	addPoint(mesh, 0, 1, 0);
+	addPoint(mesh, 1, 1, 0);
+	addTriangle(mesh, 0, 1, 2);
+	addTriangle(mesh, 1, 3, 2);
+
+	// The offset of control point 2 is too small to survive the quantization
+	SceneBlendShape shape;
+	shape.m_name = "smile";
+	shape.m_controlPoints.push_back(1);
+	shape.m_controlPoints.push_back(3);
+	shape.m_controlPoints.push_back(2);
+	const float positionDeltas[9] = { 0, 0, 2, 0, 0, -1, 0, 0, 1e-7f };
+	shape.m_positionDeltas.assign(positionDeltas, positionDeltas + 9);
+
+	SceneBlendShapeDeltas deltas;
+	const int secondTriangle = 1;
+	buildBlendShapeDeltas(mesh, shape, &secondTriangle, 1, deltas);
+	CHECK(deltas.m_vertices.size() == 2 && deltas.m_vertices[0] == 0 && deltas.m_vertices[1] == 1);
+	CHECK(deltas.m_normals.empty());
+	CHECK(deltas.m_positions.size() == 6 && deltas.m_positions[2] == 32767);
+	CHECK(isNear(deltas.m_positions[2] * deltas.m_positionScale, 2.0, 1e-3));
+	CHECK(isNear(deltas.m_positions[5] * deltas.m_positionScale, -1.0, 1e-3));
+
+	// A normal offset alone makes a vertex part of the target
+	const int bothTriangles[2] = { 0, 1 };
+	shape.m_normalDeltas.assign(18, 0.f);
+	shape.m_normalDeltas[2 * 3 + 1] = 0.5f;
+	buildBlendShapeDeltas(mesh, shape, bothTriangles, 2, deltas);
+	CHECK(deltas.m_vertices.size() == 4 && deltas.m_vertices[0] == 1);
+	CHECK(deltas.m_normals.size() == 12);
+}
+
+static void testOutputBasis()
+{
+	// glTF: Y up, right handed, in meters converted to centimeters
+	SceneSource::CoordinateSystem gltf;
+	gltf.m_right = SceneSource::AXIS_POSITIVE_X;
+	gltf.m_up = SceneSource::AXIS_POSITIVE_Y;
+	gltf.m_front = SceneSource::AXIS_POSITIVE_Z;
+
+	double basis[16];
+	double inverse[16];
+	CHECK(computeOutputBasis(gltf, 100.0, basis, inverse));
+	double product[16];
+	multiplyMatrices(basis, inverse, product);
+	for (int i = 0; i < 16; i++)
+	{
+		CHECK(isNear(product[i], (i % 5 == 0) ? 1.0 : 0.0));
+	}
+
+	SceneMesh mesh;
+	addPoint(mesh, 0, 1, 0);
+	mesh.m_normals.push_back(0.f);
+	mesh.m_normals.push_back(0.f);
+	mesh.m_normals.push_back(1.f);
+	addTriangle(mesh, 0, 0, 0);
+	transformSceneMesh(basis, inverse, mesh);
+	CHECK(isNear(mesh.m_positions[0], 0.0) && isNear(mesh.m_positions[1], 0.0) && isNear(mesh.m_positions[2], 100.0));
+	CHECK(isNear(mesh.m_normals[0], 0.0) && isNear(mesh.m_normals[1], -1.0) && isNear(mesh.m_normals[2], 0.0));
+	CHECK(!mesh.m_flipped);
+
+	// A left handed system is a reflection, the winding is flipped
+	SceneSource::CoordinateSystem leftHanded = gltf;
+	leftHanded.m_right = SceneSource::AXIS_NEGATIVE_X;
+	computeOutputBasis(leftHanded, 1.0, basis, inverse);
+	SceneMesh mirroredMesh;
+	addPoint(mirroredMesh, 1, 0, 0);
+	transformSceneMesh(basis, inverse, mirroredMesh);
+	CHECK(isNear(mirroredMesh.m_positions[0], -1.0));
+	CHECK(mirroredMesh.m_flipped);
+
+	SceneSource::CoordinateSystem invalid = gltf;
+	invalid.m_front = SceneSource::AXIS_NEGATIVE_Y;
+	CHECK(!computeOutputBasis(invalid, 2.0, basis, inverse));
+
+	// The default system of a source is the output system
+	MemorySceneSource source;
+	SceneSource::CoordinateSystem system;
+	source.getCoordinateSystem(system);
+	CHECK(computeOutputBasis(system, 1.0, basis, inverse));
+	CHECK(basis[0] == 1.0 && basis[5] == 1.0 && basis[10] == 1.0);
+}
+
+int main()
+{
+	testTriangleListBuffers();
+	testSampleKeyFrames();
+	testSkinPartitions();
+	testRigidTriangles();
+	testBlendShapeDeltas();
+	testOutputBasis();
+
+	printf("%d of %d checks passed\n", s_numChecks - s_numFailures, s_numChecks);
+	return s_numFailures > 0 ? 1 : 0;
+}
+/*
+ * Havok SDK - NO SOURCE PC DOWNLOAD, BUILD(#20140907)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2014
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available at www.havok.com/tryhavok.
+ * 
+ */